@@ -23,7 +23,14 @@ option ( ENABLE_PIGLET "enable piglet test harness" OFF )
 option ( ENABLE_COREFILES "Prevent Snort from generating core files" ON )
 option ( ENABLE_LARGE_PCAP "Enable support for pcaps larger than 2 GB" OFF )
 option ( ENABLE_STDLOG "Use file descriptor 3 instead of stdout for alerts" OFF )
-option ( ENABLE_TSC_CLOCK "Use timestamp counter register clock (x86 and arm only)" OFF )
+
+# the tsc clock is the default where the counter can be read
+if ( CMAKE_SYSTEM_PROCESSOR MATCHES "^(x86_64|AMD64|amd64|i[3-6]86|aarch64|arm64)$" )
+    set ( TSC_CLOCK_DEFAULT ON )
+else ()
+    set ( TSC_CLOCK_DEFAULT OFF )
+endif ()
+option ( ENABLE_TSC_CLOCK "Use timestamp counter register clock (x86 and arm only)" ${TSC_CLOCK_DEFAULT} )
 
 # documentation
 option ( MAKE_HTML_DOC "Create the HTML documentation" ON )
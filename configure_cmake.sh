@@ -45,7 +45,8 @@ Optional Features:
     --enable-shell          enable command line shell support
     --enable-large-pcap     enable support for pcaps larger than 2 GB
     --enable-stdlog         use file descriptor 3 instead of stdout for alerts
-    --enable-tsc-clock      use timestamp counter register clock (x86 and arm only)
+    --disable-tsc-clock     use the chrono clock instead of the timestamp counter
+                            register clock (default on x86 and arm)
     --enable-debug-msgs     enable debug printing options (bugreports and
                             developers only)
     --enable-debug          enable debugging options (bugreports and developers
@@ -259,6 +260,9 @@ while [ $# -ne 0 ]; do
         --enable-tsc-clock)
             append_cache_entry ENABLE_TSC_CLOCK         BOOL true
             ;;
+        --disable-tsc-clock)
+            append_cache_entry ENABLE_TSC_CLOCK         BOOL false
+            ;;
         --disable-snort-profiler)
             append_cache_entry DISABLE_SNORT_PROFILER   BOOL false
             ;;
@@ -25,8 +25,10 @@
 #include "file_decomp.h"
 
 #include <cassert>
+#include <cstddef>
 
 #include "detection/detection_util.h"
+#include "main/thread.h"
 #include "utils/util.h"
 
 #include "file_decomp_pdf.h"
@@ -34,6 +36,11 @@
 #include "file_decomp_zip.h"
 
 #ifdef UNIT_TEST
+#include <zlib.h>
+
+#include <algorithm>
+#include <vector>
+
 #include "catch/snort_catch.h"
 #endif
 
@@ -50,28 +57,136 @@ static const char ZIP_Sig[4] = { 'P', 'K', 0x03, 0x04 };
 /* Please assure that the following value correlates with the set of sig's */
 #define MAX_SIG_LENGTH (5)
 
-static struct sig_map_s
+/* A signature is searched for if the session's Modes include any of its modes */
+static const struct sig_map_s
 {
     const char* Sig;
     size_t Sig_Length;
-    bool Enabled;
+    uint32_t Modes;
     file_type_t File_Type;
     file_compression_type_t File_Compression_Type;
 } Signature_Map[] =
 {
     // none: compression type is embedded in PDF dictionaries
-    { PDF_Sig, sizeof(PDF_Sig), false, FILE_TYPE_PDF, FILE_COMPRESSION_TYPE_NONE },
+    { PDF_Sig, sizeof(PDF_Sig), FILE_PDF_ANY, FILE_TYPE_PDF, FILE_COMPRESSION_TYPE_NONE },
 
-    { SWF_ZLIB_Sig, sizeof(SWF_ZLIB_Sig), false, FILE_TYPE_SWF, FILE_COMPRESSION_TYPE_ZLIB },
+    { SWF_ZLIB_Sig, sizeof(SWF_ZLIB_Sig), FILE_SWF_ZLIB_BIT, FILE_TYPE_SWF,
+      FILE_COMPRESSION_TYPE_ZLIB },
 #ifdef HAVE_LZMA
-    { SWF_LZMA_Sig, sizeof(SWF_LZMA_Sig), false, FILE_TYPE_SWF, FILE_COMPRESSION_TYPE_LZMA },
+    { SWF_LZMA_Sig, sizeof(SWF_LZMA_Sig), FILE_SWF_LZMA_BIT, FILE_TYPE_SWF,
+      FILE_COMPRESSION_TYPE_LZMA },
 #endif
 
-    { ZIP_Sig, sizeof(ZIP_Sig), false, FILE_TYPE_ZIP, FILE_COMPRESSION_TYPE_NONE },
+    { ZIP_Sig, sizeof(ZIP_Sig), FILE_ZIP_DEFL_BIT, FILE_TYPE_ZIP, FILE_COMPRESSION_TYPE_NONE },
+
+    { nullptr, 0, 0, FILE_TYPE_NONE, FILE_COMPRESSION_TYPE_NONE }
+};
+
+/* The decompressors by file type */
+static const fd_api_t SWF_Api = { File_Decomp_Init_SWF, File_Decomp_SWF, File_Decomp_End_SWF };
+static const fd_api_t PDF_Api = { File_Decomp_Init_PDF, File_Decomp_PDF, File_Decomp_End_PDF };
+static const fd_api_t ZIP_Api = { File_Decomp_Init_ZIP, File_Decomp_ZIP, File_Decomp_End_ZIP };
 
-    { nullptr, 0, false, FILE_TYPE_NONE, FILE_COMPRESSION_TYPE_NONE }
+static const fd_api_t* const Decomp_Map[FILE_TYPE_MAX] =
+{
+    nullptr,     // FILE_TYPE_NONE
+    &SWF_Api,    // FILE_TYPE_SWF
+    &PDF_Api,    // FILE_TYPE_PDF
+    &ZIP_Api     // FILE_TYPE_ZIP
 };
 
+static inline const fd_api_t* Get_Api(const fd_session_t* SessionPtr)
+{
+    if ( SessionPtr->File_Type >= FILE_TYPE_MAX )
+        return nullptr;
+
+    return Decomp_Map[SessionPtr->File_Type];
+}
+
+//--------------------------------------------------------------------------
+// memory cache
+//--------------------------------------------------------------------------
+
+/* Blocks up to MAX_CACHED_SIZE are kept for reuse, matched by exact size.
+   That covers the session state and zlib's state and window.  lzma keeps
+   its own allocator since its dictionary is sized by the file. */
+#define MAX_CACHED_BLOCKS (16)
+#define MAX_CACHED_SIZE (64 * 1024)
+
+union Block_Header
+{
+    size_t Size;
+    max_align_t Align;
+};
+
+struct Cached_Block
+{
+    size_t Size;
+    Block_Header* Block;
+};
+
+static THREAD_LOCAL Cached_Block Block_Cache[MAX_CACHED_BLOCKS];
+static THREAD_LOCAL unsigned Num_Cached = 0;
+
+static void* Cache_Alloc(size_t Size)
+{
+    for ( unsigned i = 0; i < Num_Cached; i++ )
+    {
+        if ( Block_Cache[i].Size == Size )
+        {
+            Block_Header* Block = Block_Cache[i].Block;
+            Block_Cache[i] = Block_Cache[--Num_Cached];
+            return Block + 1;
+        }
+    }
+
+    Block_Header* Block = (Block_Header*)snort_alloc(sizeof(Block_Header) + Size);
+    Block->Size = Size;
+    return Block + 1;
+}
+
+static void Cache_Free(void* Ptr)
+{
+    Block_Header* Block = (Block_Header*)Ptr - 1;
+
+    if ( (Block->Size <= MAX_CACHED_SIZE) && (Num_Cached < MAX_CACHED_BLOCKS) )
+    {
+        Block_Cache[Num_Cached].Size = Block->Size;
+        Block_Cache[Num_Cached].Block = Block;
+        Num_Cached++;
+        return;
+    }
+
+    snort_free(Block);
+}
+
+void* File_Decomp_Alloc_State(size_t Size)
+{
+    void* State = Cache_Alloc(Size);
+    memset(State, 0, Size);
+    return State;
+}
+
+void File_Decomp_Free_State(void* State)
+{
+    Cache_Free(State);
+}
+
+void* File_Decomp_Alloc(void*, unsigned Items, unsigned Size)
+{
+    return Cache_Alloc((size_t)Items * Size);
+}
+
+void File_Decomp_Dealloc(void*, void* Ptr)
+{
+    if ( Ptr != nullptr )
+        Cache_Free(Ptr);
+}
+
+//--------------------------------------------------------------------------
+// decompression
+//--------------------------------------------------------------------------
+
 /* Define the elements of the Sig_State value (packed for storage efficiency */
 #define SIG_MATCH_ACTIVE    (0x80)
 #define SIG_SIG_INDEX_MASK  (0x70)
@@ -129,7 +244,7 @@ static fd_status_t Locate_Sig_Here(fd_session_t* SessionPtr)
             return( File_Decomp_NoSig );
 
         /* Get next char and see if it matches next char in sig */
-        if ( (Signature_Map[Sig_Index].Enabled) &&
+        if ( ((Signature_Map[Sig_Index].Modes & SessionPtr->Modes) != 0) &&
             (*(SessionPtr->Next_In+Char_Index) == *(Signature_Map[Sig_Index].Sig+Char_Index)) )
         {
             /* Check to see if we are at the end of the sig string. */
@@ -186,26 +301,12 @@ static fd_status_t Locate_Sig_Here(fd_session_t* SessionPtr)
 
 static fd_status_t Initialize_Decompression(fd_session_t* SessionPtr)
 {
-    fd_status_t Ret_Code = File_Decomp_OK;
+    const fd_api_t* Api = Get_Api(SessionPtr);
 
-    switch ( SessionPtr->File_Type )
-    {
-    case ( FILE_TYPE_SWF ):
-    {
-        Ret_Code = File_Decomp_Init_SWF(SessionPtr);
-        break;
-    }
-    case ( FILE_TYPE_PDF ):
-    {
-        Ret_Code = File_Decomp_Init_PDF(SessionPtr);
-        break;
-    }
-    case ( FILE_TYPE_ZIP ):
-        Ret_Code = File_Decomp_Init_ZIP(SessionPtr);
-        break;
-    default:
+    if ( Api == nullptr )
         return( File_Decomp_Error );
-    }
+
+    fd_status_t Ret_Code = Api->Init(SessionPtr);
 
     if ( Ret_Code == File_Decomp_OK )
         SessionPtr->State = STATE_ACTIVE;
@@ -215,31 +316,12 @@ static fd_status_t Initialize_Decompression(fd_session_t* SessionPtr)
 
 static fd_status_t Process_Decompression(fd_session_t* SessionPtr)
 {
-    fd_status_t Ret_Code = File_Decomp_OK;
+    const fd_api_t* Api = Get_Api(SessionPtr);
 
-    switch ( SessionPtr->File_Type )
-    {
-    case ( FILE_TYPE_SWF ):
-    {
-        Ret_Code = File_Decomp_SWF(SessionPtr);
-        break;
-    }
-    case ( FILE_TYPE_PDF ):
-    {
-        Ret_Code = File_Decomp_PDF(SessionPtr);
-        break;
-    }
-    case ( FILE_TYPE_ZIP ):
-    {
-        if (SessionPtr->Modes & FILE_VBA_EXTR_BIT)
-            SessionPtr->vba_analysis = true;
-
-        Ret_Code = File_Decomp_ZIP(SessionPtr);
-        break;
-    }
-    default:
+    if ( Api == nullptr )
         return( File_Decomp_Error );
-    }
+
+    fd_status_t Ret_Code = Api->Run(SessionPtr);
 
     if ( Ret_Code == File_Decomp_Complete )
         SessionPtr->State = STATE_COMPLETE;
@@ -247,43 +329,48 @@ static fd_status_t Process_Decompression(fd_session_t* SessionPtr)
     return( Ret_Code );
 }
 
+static fd_status_t Run_Decompression(fd_session_t* SessionPtr)
+{
+    fd_status_t Return_Code;
+
+    /* STATE_NEW: Look for one of the configured file signatures. */
+    if ( SessionPtr->State == STATE_READY )
+    {
+        /* Look for the signature at the beginning of the payload stream. */
+        if ( (Return_Code = Locate_Sig_Here(SessionPtr)) == File_Decomp_OK )
+        {
+            /* We now know the file type and decompression type.  Setup appropriate state. */
+            if ( (Return_Code = Initialize_Decompression(SessionPtr)) == File_Decomp_OK )
+            {
+                return( Process_Decompression(SessionPtr) );
+            }
+            else
+                return( Return_Code );
+        }
+        else
+            /* Locate_Sig_Here() might return BlockIn, BlockOut, Error, or NoSig */
+            return( Return_Code );
+    }
+    else if ( SessionPtr->State == STATE_ACTIVE )
+    {
+        return( Process_Decompression(SessionPtr) );
+    }
+    else
+        return( File_Decomp_Error );
+}
+
 namespace snort
 {
 /* The caller provides Compr_Depth, Decompr_Depth and Modes in the session object.
    Based on the requested Modes, gear=up to initialize the potential decompressors. */
 fd_status_t File_Decomp_Init(fd_session_t* SessionPtr)
 {
-    int Sig;
-
     if ( SessionPtr == nullptr )
         return( File_Decomp_Error );
 
     SessionPtr->State = STATE_READY;
     SessionPtr->Decomp_Type = FILE_COMPRESSION_TYPE_NONE;
 
-    for ( Sig=0; Signature_Map[Sig].Sig != nullptr; Sig++ )
-    {
-        if ( (Signature_Map[Sig].File_Type == FILE_TYPE_PDF ) &&
-            ((SessionPtr->Modes & FILE_PDF_ANY) != 0) )
-            Signature_Map[Sig].Enabled = true;
-
-        if ( (Signature_Map[Sig].File_Type == FILE_TYPE_SWF ) &&
-            (Signature_Map[Sig].File_Compression_Type == FILE_COMPRESSION_TYPE_ZLIB) &&
-            ((SessionPtr->Modes & FILE_SWF_ZLIB_BIT) != 0) )
-            Signature_Map[Sig].Enabled = true;
-
-#ifdef HAVE_LZMA
-        if ( (Signature_Map[Sig].File_Type == FILE_TYPE_SWF ) &&
-            (Signature_Map[Sig].File_Compression_Type == FILE_COMPRESSION_TYPE_LZMA) &&
-            ((SessionPtr->Modes & FILE_SWF_LZMA_BIT) != 0) )
-            Signature_Map[Sig].Enabled = true;
-#endif
-
-        if ( (Signature_Map[Sig].File_Type == FILE_TYPE_ZIP ) &&
-            ((SessionPtr->Modes & FILE_ZIP_DEFL_BIT) != 0) )
-            Signature_Map[Sig].Enabled = true;
-    }
-
     return( File_Decomp_OK );
 }
 
@@ -300,6 +387,8 @@ fd_session_t* File_Decomp_New()
     New_Session->Next_In = nullptr;
     New_Session->Avail_Out = 0;
     New_Session->Next_Out = nullptr;
+    New_Session->Budget = nullptr;
+    New_Session->Context = nullptr;
     New_Session->File_Type = FILE_TYPE_NONE;
     New_Session->vba_analysis = false;
     New_Session->ole_data_ptr = nullptr;
@@ -313,36 +402,17 @@ fd_session_t* File_Decomp_New()
 */
 fd_status_t File_Decomp(fd_session_t* SessionPtr)
 {
-    fd_status_t Return_Code;
-
     if ( (SessionPtr == nullptr) || (SessionPtr->State == STATE_NEW) ||
         (SessionPtr->Next_In == nullptr) || (SessionPtr->Next_Out == nullptr) )
         return( File_Decomp_Error );
 
-    /* STATE_NEW: Look for one of the configured file signatures. */
-    if ( SessionPtr->State == STATE_READY )
-    {
-        /* Look for the signature at the beginning of the payload stream. */
-        if ( (Return_Code = Locate_Sig_Here(SessionPtr)) == File_Decomp_OK )
-        {
-            /* We now know the file type and decompression type.  Setup appropriate state. */
-            if ( (Return_Code = Initialize_Decompression(SessionPtr)) == File_Decomp_OK )
-            {
-                return( Process_Decompression(SessionPtr) );
-            }
-            else
-                return( Return_Code );
-        }
-        else
-            /* Locate_Sig_Here() might return BlockIn, BlockOut, Error, or NoSig */
-            return( Return_Code );
-    }
-    else if ( SessionPtr->State == STATE_ACTIVE )
-    {
-        return( Process_Decompression(SessionPtr) );
-    }
-    else
-        return( File_Decomp_Error );
+    /* Once the flow's budget is spent it is done decompressing; the caller
+       passes the input through as it does when there is no sig.  A budget
+       spent during this call blocks the engine on output instead. */
+    if ( SessionPtr->Budget and *SessionPtr->Budget == 0 )
+        return( File_Decomp_BudgetOut );
+
+    return( Run_Decompression(SessionPtr) );
 }
 
 fd_status_t File_Decomp_End(fd_session_t* SessionPtr)
@@ -350,21 +420,12 @@ fd_status_t File_Decomp_End(fd_session_t* SessionPtr)
     if ( SessionPtr == nullptr )
         return( File_Decomp_Error );
 
-    switch ( SessionPtr->File_Type )
-    {
-    case ( FILE_TYPE_SWF ):
-    {
-        return( File_Decomp_End_SWF(SessionPtr) );
-    }
-    case ( FILE_TYPE_PDF ):
-    {
-        return( File_Decomp_End_PDF(SessionPtr) );
-    }
-    case ( FILE_TYPE_ZIP ):
-        return( File_Decomp_End_ZIP(SessionPtr) );
-    }
+    const fd_api_t* Api = Get_Api(SessionPtr);
+
+    if ( Api == nullptr )
+        return( File_Decomp_Error );
 
-    return( File_Decomp_Error );
+    return( Api->End(SessionPtr) );
 }
 
 fd_status_t File_Decomp_Reset(fd_session_t* SessionPtr)
@@ -396,21 +457,10 @@ void File_Decomp_Free(fd_session_t* SessionPtr)
 {
     assert(SessionPtr);
 
-    switch ( SessionPtr->File_Type )
+    if ( Get_Api(SessionPtr) != nullptr )
     {
-    case FILE_TYPE_SWF:
-        assert(SessionPtr->SWF);
-        snort_free(SessionPtr->SWF);
-        break;
-
-    case FILE_TYPE_PDF:
-        assert(SessionPtr->PDF);
-        snort_free(SessionPtr->PDF);
-        break;
-    case FILE_TYPE_ZIP:
-        assert(SessionPtr->ZIP);
-        snort_free(SessionPtr->ZIP);
-        break;
+        assert(SessionPtr->Context);
+        File_Decomp_Free_State(SessionPtr->Context);
     }
 
     delete SessionPtr;
@@ -423,6 +473,12 @@ void File_Decomp_Alert(fd_session_t* SessionPtr, int Event)
         (SessionPtr->Alert_Callback)(SessionPtr->Alert_Context, Event);
 }
 
+void File_Decomp_Thread_Term()
+{
+    while ( Num_Cached > 0 )
+        snort_free(Block_Cache[--Num_Cached].Block);
+}
+
 } // namespace snort
 
 //--------------------------------------------------------------------------
@@ -509,5 +565,199 @@ TEST_CASE("Process_Decompression-not_active", "[file_decomp]")
     REQUIRE((Process_Decompression(p_s) == File_Decomp_Error));
     File_Decomp_Free(p_s);
 }
+
+TEST_CASE("File_Decomp_Alloc_State-reuse", "[file_decomp]")
+{
+    uint8_t* p = (uint8_t*)File_Decomp_Alloc_State(100);
+    memset(p, 0xff, 100);
+    File_Decomp_Free_State(p);
+
+    uint8_t* q = (uint8_t*)File_Decomp_Alloc_State(100);
+    REQUIRE(q == p);
+
+    for ( unsigned i = 0; i < 100; i++ )
+        REQUIRE(q[i] == 0);
+
+    File_Decomp_Free_State(q);
+    File_Decomp_Thread_Term();
+}
+
+// a ZIP local file header followed by a deflated member of Len 'A's
+static std::vector<uint8_t> Make_ZIP(unsigned Len)
+{
+    std::vector<uint8_t> Plain(Len, 'A');
+    std::vector<uint8_t> Comp(compressBound(Len));
+
+    z_stream z_s;
+    memset(&z_s, 0, sizeof(z_s));
+    REQUIRE(deflateInit2(&z_s, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+        Z_DEFAULT_STRATEGY) == Z_OK);
+
+    z_s.next_in = Plain.data();
+    z_s.avail_in = Len;
+    z_s.next_out = Comp.data();
+    z_s.avail_out = Comp.size();
+    REQUIRE(deflate(&z_s, Z_FINISH) == Z_STREAM_END);
+    Comp.resize(z_s.total_out);
+    deflateEnd(&z_s);
+
+    const uint8_t Header[] =
+    {
+        'P', 'K', 0x03, 0x04, 20, 0, 0, 0, 8, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        (uint8_t)Comp.size(), (uint8_t)(Comp.size() >> 8), 0, 0,
+        (uint8_t)Len, (uint8_t)(Len >> 8), 0, 0, 1, 0, 0, 0, 'a'
+    };
+    std::vector<uint8_t> Zip(Header, Header + sizeof(Header));
+    Zip.insert(Zip.end(), Comp.begin(), Comp.end());
+    return Zip;
+}
+
+TEST_CASE("File_Decomp-budget", "[file_decomp]")
+{
+    std::vector<uint8_t> Zip = Make_ZIP(20000);
+    std::vector<uint8_t> Out(30000);
+    uint64_t Budget = 1000;
+
+    fd_session_t* p_s = File_Decomp_New();
+    p_s->Modes = FILE_ZIP_DEFL_BIT;
+    p_s->Alert_Callback = nullptr;
+    p_s->Budget = &Budget;
+    REQUIRE(File_Decomp_Init(p_s) == File_Decomp_OK);
+
+    p_s->Next_In = Zip.data();
+    p_s->Avail_In = Zip.size();
+    p_s->Next_Out = Out.data();
+    p_s->Avail_Out = Out.size();
+
+    CHECK(File_Decomp(p_s) == File_Decomp_BlockOut);
+    CHECK(std::count(Out.data(), p_s->Next_Out, 'A') == 1000);
+    CHECK(Budget == 0);
+
+    // the rest of the file is not decompressed
+    uint8_t* Next_Out = p_s->Next_Out;
+    CHECK(File_Decomp(p_s) == File_Decomp_BudgetOut);
+    CHECK(p_s->Next_Out == Next_Out);
+
+    // nor is the next file of the flow
+    File_Decomp_Reset(p_s);
+    p_s->Next_In = Zip.data();
+    p_s->Avail_In = Zip.size();
+    p_s->Next_Out = Out.data();
+    p_s->Avail_Out = Out.size();
+
+    CHECK(File_Decomp(p_s) == File_Decomp_BudgetOut);
+    CHECK(p_s->Next_Out == Out.data());
+    CHECK(p_s->Next_In == Zip.data());
+
+    File_Decomp_StopFree(p_s);
+    File_Decomp_Thread_Term();
+}
+
+TEST_CASE("File_Decomp-budget_engine_output", "[file_decomp]")
+{
+    std::vector<uint8_t> Zip = Make_ZIP(20000);
+    std::vector<uint8_t> Out(30000);
+    uint64_t Budget = 100000;
+
+    fd_session_t* p_s = File_Decomp_New();
+    p_s->Modes = FILE_ZIP_DEFL_BIT;
+    p_s->Alert_Callback = nullptr;
+    p_s->Budget = &Budget;
+    REQUIRE(File_Decomp_Init(p_s) == File_Decomp_OK);
+
+    p_s->Next_In = Zip.data();
+    p_s->Avail_In = Zip.size();
+    p_s->Next_Out = Out.data();
+    p_s->Avail_Out = Out.size();
+
+    // the header fields passed through aren't charged
+    File_Decomp(p_s);
+    CHECK(p_s->Next_Out - Out.data() > 20000);
+    CHECK(p_s->Avail_Out == Out.size() - (p_s->Next_Out - Out.data()));
+    CHECK(Budget == 100000 - 20000);
+
+    File_Decomp_StopFree(p_s);
+    File_Decomp_Thread_Term();
+}
+
+TEST_CASE("File_Decomp-budget_uncompressed_file", "[file_decomp]")
+{
+    std::vector<uint8_t> Zip = Make_ZIP(20000);
+    const uint8_t Plain[] = "plain text body that is not compressed";
+    std::vector<uint8_t> Out(30000);
+    uint64_t Budget = 1000;
+
+    fd_session_t* p_s = File_Decomp_New();
+    p_s->Modes = FILE_ZIP_DEFL_BIT;
+    p_s->Alert_Callback = nullptr;
+    p_s->Budget = &Budget;
+    REQUIRE(File_Decomp_Init(p_s) == File_Decomp_OK);
+
+    p_s->Next_In = Zip.data();
+    p_s->Avail_In = Zip.size();
+    p_s->Next_Out = Out.data();
+    p_s->Avail_Out = Out.size();
+
+    CHECK(File_Decomp(p_s) == File_Decomp_BlockOut);
+    CHECK(Budget == 0);
+
+    // a second, uncompressed file is left for the caller to pass through
+    File_Decomp_Reset(p_s);
+    p_s->Next_In = Plain;
+    p_s->Avail_In = sizeof(Plain);
+    p_s->Next_Out = Out.data();
+    p_s->Avail_Out = Out.size();
+
+    CHECK(File_Decomp(p_s) == File_Decomp_BudgetOut);
+    CHECK(p_s->Next_In == Plain);
+    CHECK(p_s->Avail_In == sizeof(Plain));
+    CHECK(p_s->Next_Out == Out.data());
+    CHECK(p_s->Avail_Out == Out.size());
+
+    File_Decomp_StopFree(p_s);
+    File_Decomp_Thread_Term();
+}
+
+TEST_CASE("File_Decomp-no_budget", "[file_decomp]")
+{
+    std::vector<uint8_t> Zip = Make_ZIP(20000);
+    std::vector<uint8_t> Out(30000);
+
+    fd_session_t* p_s = File_Decomp_New();
+    p_s->Modes = FILE_ZIP_DEFL_BIT;
+    p_s->Alert_Callback = nullptr;
+    REQUIRE(File_Decomp_Init(p_s) == File_Decomp_OK);
+
+    p_s->Next_In = Zip.data();
+    p_s->Avail_In = Zip.size();
+    p_s->Next_Out = Out.data();
+    p_s->Avail_Out = Out.size();
+
+    // the member follows the header fields that are passed through
+    File_Decomp(p_s);
+    REQUIRE(p_s->Next_Out - Out.data() > 20000);
+    CHECK(std::all_of(p_s->Next_Out - 20000, p_s->Next_Out, [](uint8_t c) { return c == 'A'; }));
+
+    File_Decomp_StopFree(p_s);
+    File_Decomp_Thread_Term();
+}
+
+TEST_CASE("File_Decomp-mode_not_enabled", "[file_decomp]")
+{
+    std::vector<uint8_t> Zip = Make_ZIP(100);
+    std::vector<uint8_t> Out(1000);
+
+    fd_session_t* p_s = File_Decomp_New();
+    p_s->Modes = FILE_PDF_DEFL_BIT;
+    REQUIRE(File_Decomp_Init(p_s) == File_Decomp_OK);
+
+    p_s->Next_In = Zip.data();
+    p_s->Avail_In = Zip.size();
+    p_s->Next_Out = Out.data();
+    p_s->Avail_Out = Out.size();
+
+    CHECK(File_Decomp(p_s) == File_Decomp_NoSig);
+    File_Decomp_Free(p_s);
+}
 #endif
 
@@ -47,7 +47,8 @@ enum fd_status_t
     File_Decomp_Complete = 2,      /* Completed */
     File_Decomp_BlockOut = 3,      /* Blocked due to lack of output space */
     File_Decomp_BlockIn = 4,       /* Blocked due to lack in input data */
-    File_Decomp_Eof = 5            /* End of file located */
+    File_Decomp_Eof = 5,           /* End of file located */
+    File_Decomp_BudgetOut = 6      /* Decompression budget of the flow is spent */
 };
 
 enum file_compression_type_t
@@ -105,10 +106,10 @@ enum fd_states_t
 /* Primary file decompression session state context */
 struct fd_session_t
 {
-    // FIXIT-L replace with abstract base class pointer used for
-    // PDF or SWF subclass and eliminate switches on File_Type
+    // state of the decompressor of File_Type, from File_Decomp_Alloc_State()
     union
     {
+        void* Context;
         struct fd_PDF_t* PDF;
         struct fd_SWF_t* SWF;
         struct fd_ZIP_t* ZIP;
@@ -133,6 +134,12 @@ struct fd_session_t
     uint32_t Decompr_Depth;
     uint32_t Modes;      // Bit mapped set of potential file/algo modes
 
+    // Bytes the decompression engines (zlib, LZMA) of the flow may still
+    // produce; what is passed through as is isn't counted.  The caller owns
+    // the count and shares it with every session of the flow so that the
+    // flow's files together can't exceed it; nullptr for no limit.
+    uint64_t* Budget;
+
     int Error_Event;     // Specific event indicated by DecomprError return
 
     // Internal State
@@ -157,6 +164,48 @@ struct fd_session_t
     } 
 };
 
+/* Decompressor registry.  Each file type that can be decompressed provides
+   these and File_Decomp() dispatches on the file type of the signature found. */
+struct fd_api_t
+{
+    fd_status_t (* Init)(fd_session_t*);   // allocate and set initial state
+    fd_status_t (* Run)(fd_session_t*);    // decompress what's available
+    fd_status_t (* End)(fd_session_t*);    // release the engine's resources
+};
+
+/* Per thread cache of decompressor memory.  The session state and the
+   buffers zlib allocates for each stream are reused by the next session of
+   the thread instead of going back to the heap, which matters for PDFs that
+   start a new deflate stream for each object. */
+void* File_Decomp_Alloc_State(size_t);   // zeroed
+void File_Decomp_Free_State(void*);
+
+void* File_Decomp_Alloc(void* opaque, unsigned items, unsigned size);   // zlib zalloc
+void File_Decomp_Dealloc(void* opaque, void* ptr);                     // zlib zfree
+
+/* The output space a decompression engine may fill: the free space limited
+   by the flow's budget.  The engine blocks on output when this is 0. */
+inline uint32_t Engine_Avail_Out(const fd_session_t* SessionPtr)
+{
+    if ( SessionPtr->Budget and *SessionPtr->Budget < SessionPtr->Avail_Out )
+        return( (uint32_t)*SessionPtr->Budget );
+
+    return( SessionPtr->Avail_Out );
+}
+
+/* Take the output of a decompression engine that ends at Next_Out and charge
+   it to the flow's budget. */
+inline void Engine_Out(fd_session_t* SessionPtr, uint8_t* Next_Out)
+{
+    uint32_t Len = Next_Out - SessionPtr->Next_Out;
+
+    SessionPtr->Next_Out = Next_Out;
+    SessionPtr->Avail_Out -= Len;
+
+    if ( SessionPtr->Budget )
+        *SessionPtr->Budget -= Len;
+}
+
 /* Macros */
 
 /* Macros used to sync my decompression context with that
@@ -167,7 +216,7 @@ struct fd_session_t
     (dest)->avail_in = SessionPtr->Avail_In; \
     (dest)->total_in = SessionPtr->Total_In; \
     (dest)->next_out = SessionPtr->Next_Out; \
-    (dest)->avail_out = SessionPtr->Avail_Out; \
+    (dest)->avail_out = Engine_Avail_Out(SessionPtr); \
     (dest)->total_out = SessionPtr->Total_Out;
 #endif
 
@@ -176,8 +225,7 @@ struct fd_session_t
     SessionPtr->Next_In = (const uint8_t*)(src)->next_in; \
     SessionPtr->Avail_In = (src)->avail_in; \
     SessionPtr->Total_In = (src)->total_in; \
-    SessionPtr->Next_Out = (uint8_t*)(src)->next_out; \
-    SessionPtr->Avail_Out = (src)->avail_out; \
+    Engine_Out(SessionPtr, (uint8_t*)(src)->next_out); \
     SessionPtr->Total_Out = (src)->total_out;
 #endif
 
@@ -321,6 +369,9 @@ SO_PUBLIC void File_Decomp_Free(fd_session_t*);
 
 /* Call the error alerting call-back function */
 SO_PUBLIC void File_Decomp_Alert(fd_session_t*, int Event);
+
+/* Release the memory cached by the calling thread */
+SO_PUBLIC void File_Decomp_Thread_Term();
 }
 #endif
 
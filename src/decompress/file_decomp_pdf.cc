@@ -908,8 +908,8 @@ static fd_status_t Init_Stream(fd_session_t* SessionPtr)
 
         memset( (char*)z_s, 0, sizeof(z_stream));
 
-        z_s->zalloc = (alloc_func)nullptr;
-        z_s->zfree = (free_func)nullptr;
+        z_s->zalloc = File_Decomp_Alloc;
+        z_s->zfree = File_Decomp_Dealloc;
         SYNC_IN(z_s)
 
         z_ret = inflateInit2(z_s, 47);
@@ -934,10 +934,10 @@ static fd_status_t Decomp_Stream(fd_session_t* SessionPtr)
     fd_PDF_t* StPtr = SessionPtr->PDF;
 
     /* No reason to decompress if there's no input or
-       room for output. */
+       room for output within the budget. */
     if ( SessionPtr->Avail_In == 0 )
         return File_Decomp_BlockIn;
-    if ( SessionPtr->Avail_Out == 0 )
+    if ( Engine_Avail_Out(SessionPtr) == 0 )
         return File_Decomp_BlockOut;
 
     switch ( StPtr->Decomp_Type )
@@ -1028,7 +1028,7 @@ fd_status_t File_Decomp_Init_PDF(fd_session_t* SessionPtr)
     if ( SessionPtr == nullptr )
         return File_Decomp_Error;
 
-    SessionPtr->PDF = (fd_PDF_t*)snort_calloc(sizeof(fd_PDF_t));
+    SessionPtr->PDF = (fd_PDF_t*)File_Decomp_Alloc_State(sizeof(fd_PDF_t));
 
     fd_PDF_t* StPtr = SessionPtr->PDF;
 
@@ -1161,7 +1161,7 @@ TEST_CASE("File_Decomp_PDF-not_pdf-error", "[file_decomp_pdf]")
     fd_session_t* p_s = File_Decomp_New();
 
     REQUIRE(p_s != nullptr);
-    p_s->PDF = (fd_PDF_t*)snort_calloc(sizeof(fd_PDF_t));
+    p_s->PDF = (fd_PDF_t*)File_Decomp_Alloc_State(sizeof(fd_PDF_t));
     p_s->File_Type = FILE_TYPE_SWF;
     REQUIRE((File_Decomp_PDF(p_s) == File_Decomp_Error));
     p_s->File_Type = FILE_TYPE_PDF;
@@ -1173,7 +1173,7 @@ TEST_CASE("File_Decomp_PDF-bad_state-error", "[file_decomp_pdf]")
     fd_session_t* p_s = File_Decomp_New();
 
     REQUIRE(p_s != nullptr);
-    p_s->PDF = (fd_PDF_t*)snort_calloc(sizeof(fd_PDF_t));
+    p_s->PDF = (fd_PDF_t*)File_Decomp_Alloc_State(sizeof(fd_PDF_t));
     p_s->File_Type = FILE_TYPE_PDF;
     p_s->PDF->State = PDF_STATE_NEW;
     REQUIRE((File_Decomp_PDF(p_s) == File_Decomp_Error));
@@ -1185,7 +1185,7 @@ TEST_CASE("File_Decomp_End_PDF-bad_type-error", "[file_decomp_pdf]")
     fd_session_t* p_s = File_Decomp_New();
 
     REQUIRE(p_s != nullptr);
-    p_s->PDF = (fd_PDF_t*)snort_calloc(sizeof(fd_PDF_t));
+    p_s->PDF = (fd_PDF_t*)File_Decomp_Alloc_State(sizeof(fd_PDF_t));
     p_s->File_Type = FILE_TYPE_PDF;
     p_s->PDF->Decomp_Type = FILE_COMPRESSION_TYPE_LZMA;
     p_s->PDF->State = PDF_STATE_PROCESS_STREAM;
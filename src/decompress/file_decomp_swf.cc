@@ -70,7 +70,7 @@ static fd_status_t File_Decomp_Process_LZMA_Header(fd_session_t* SessionPtr)
         LZMA_Header[LZMA_PRP_OFFSET + idx] = *(SWF_Header + SWF_PRP_OFFSET + idx);
 
     l_s->next_out = SessionPtr->Next_Out;
-    l_s->avail_out = SessionPtr->Avail_Out;
+    l_s->avail_out = Engine_Avail_Out(SessionPtr);
     l_s->total_out = SessionPtr->Total_Out;
 
     l_s->next_in = LZMA_Header;
@@ -78,8 +78,7 @@ static fd_status_t File_Decomp_Process_LZMA_Header(fd_session_t* SessionPtr)
 
     l_ret = lzma_code(l_s, LZMA_RUN);
 
-    SessionPtr->Next_Out = l_s->next_out;
-    SessionPtr->Avail_Out = l_s->avail_out;
+    Engine_Out(SessionPtr, l_s->next_out);
     SessionPtr->Total_Out = l_s->total_out;
 
     if ( l_ret != LZMA_OK )
@@ -95,6 +94,10 @@ static fd_status_t File_Decomp_Process_LZMA_Header(fd_session_t* SessionPtr)
 
 static fd_status_t Decomp(fd_session_t* SessionPtr)
 {
+    // the flow's budget is spent
+    if ( Engine_Avail_Out(SessionPtr) == 0 )
+        return( File_Decomp_BlockOut );
+
     switch ( SessionPtr->Decomp_Type )
     {
     case FILE_COMPRESSION_TYPE_ZLIB:
@@ -198,7 +201,7 @@ fd_status_t File_Decomp_Init_SWF(fd_session_t* SessionPtr)
     if ( SessionPtr == nullptr )
         return( File_Decomp_Error );
 
-    SessionPtr->SWF = (fd_SWF_t*)snort_calloc(sizeof(fd_SWF_t));
+    SessionPtr->SWF = (fd_SWF_t*)File_Decomp_Alloc_State(sizeof(fd_SWF_t));
 
     /* Indicate the we need to look for the remainder of the
        uncompressed header. */
@@ -219,8 +222,8 @@ fd_status_t File_Decomp_Init_SWF(fd_session_t* SessionPtr)
 
         memset( (char*)z_s, 0, sizeof(z_stream));
 
-        z_s->zalloc = (alloc_func)nullptr;
-        z_s->zfree = (free_func)nullptr;
+        z_s->zalloc = File_Decomp_Alloc;
+        z_s->zfree = File_Decomp_Dealloc;
         SYNC_IN(z_s)
 
         z_ret = inflateInit(z_s);
@@ -358,7 +361,7 @@ TEST_CASE("File_Decomp_SWF-not_swf-error", "[file_decomp_swf]")
     fd_session_t* p_s = File_Decomp_New();
 
     REQUIRE(p_s != nullptr);
-    p_s->SWF = (fd_SWF_t*)snort_calloc(sizeof(fd_SWF_t));
+    p_s->SWF = (fd_SWF_t*)File_Decomp_Alloc_State(sizeof(fd_SWF_t));
     p_s->File_Type = FILE_TYPE_PDF;
     REQUIRE((File_Decomp_SWF(p_s) == File_Decomp_Error));
     p_s->File_Type = FILE_TYPE_SWF;
@@ -370,7 +373,7 @@ TEST_CASE("File_Decomp_SWF-bad_state-error", "[file_decomp_swf]")
     fd_session_t* p_s = File_Decomp_New();
 
     REQUIRE(p_s != nullptr);
-    p_s->SWF = (fd_SWF_t*)snort_calloc(sizeof(fd_SWF_t));
+    p_s->SWF = (fd_SWF_t*)File_Decomp_Alloc_State(sizeof(fd_SWF_t));
     p_s->File_Type = FILE_TYPE_SWF;
     p_s->SWF->State = SWF_STATE_NEW;
     REQUIRE((File_Decomp_SWF(p_s) == File_Decomp_Error));
@@ -393,7 +396,7 @@ TEST_CASE("File_Decomp_End_SWF-bad_type-error", "[file_decomp_swf]")
     fd_session_t* p_s = File_Decomp_New();
 
     REQUIRE(p_s != nullptr);
-    p_s->SWF = (fd_SWF_t*)snort_calloc(sizeof(fd_SWF_t));
+    p_s->SWF = (fd_SWF_t*)File_Decomp_Alloc_State(sizeof(fd_SWF_t));
     p_s->Decomp_Type = FILE_COMPRESSION_TYPE_DEFLATE;
     REQUIRE((File_Decomp_End_SWF(p_s) == File_Decomp_Error));
     p_s->File_Type = FILE_TYPE_SWF;
@@ -35,8 +35,8 @@ static fd_status_t Inflate_Init(fd_session_t* SessionPtr)
 
     memset((char*)z_s, 0, sizeof(z_stream));
 
-    z_s->zalloc = (alloc_func)nullptr;
-    z_s->zfree = (free_func)nullptr;
+    z_s->zalloc = File_Decomp_Alloc;
+    z_s->zfree = File_Decomp_Dealloc;
 
     SYNC_IN(z_s)
 
@@ -65,6 +65,10 @@ static fd_status_t Inflate(fd_session_t* SessionPtr)
 
     z_stream* z_s = &(SessionPtr->ZIP->Stream);
 
+    // the flow's budget is spent
+    if ( Engine_Avail_Out(SessionPtr) == 0 )
+        return File_Decomp_BlockOut;
+
     zlib_start = SessionPtr->Next_In;
 
     SYNC_IN(z_s)
@@ -84,7 +88,7 @@ static fd_status_t Inflate(fd_session_t* SessionPtr)
     if ( z_ret != Z_OK )
         return File_Decomp_Error;
 
-    if ( SessionPtr->Avail_Out == 0 and SessionPtr->Avail_In > 0)
+    if ( Engine_Avail_Out(SessionPtr) == 0 and SessionPtr->Avail_In > 0)
         return File_Decomp_BlockOut;
 
     return File_Decomp_OK;
@@ -96,7 +100,10 @@ fd_status_t File_Decomp_Init_ZIP(fd_session_t* SessionPtr)
     if ( SessionPtr == nullptr )
         return File_Decomp_Error;
 
-    SessionPtr->ZIP = (fd_ZIP_t*)snort_calloc(sizeof(fd_ZIP_t));
+    SessionPtr->ZIP = (fd_ZIP_t*)File_Decomp_Alloc_State(sizeof(fd_ZIP_t));
+
+    if ( SessionPtr->Modes & FILE_VBA_EXTR_BIT )
+        SessionPtr->vba_analysis = true;
 
     // file_decomp.cc already matched the local header
     // skip the version (2 bytes)
@@ -0,0 +1,77 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// event_order.h
+
+#ifndef EVENT_ORDER_H
+#define EVENT_ORDER_H
+
+// orderings for the matches of an action group per event_queue.order_events.
+// only as many matches as can still be queued need to be in order so the
+// best n are selected and just those are sorted.
+
+#include <algorithm>
+
+#include "detection/treenodes.h"
+
+struct PriorityOrder
+{
+    bool operator()(const OptTreeNode* a, const OptTreeNode* b) const
+    {
+        if ( a->sigInfo.priority != b->sigInfo.priority )
+            return a->sigInfo.priority < b->sigInfo.priority;
+
+        // this improves stability of repeated tests
+        return a->sigInfo.sid < b->sigInfo.sid;
+    }
+};
+
+// FIXIT-L pattern length is not a valid event sort criterion for
+// non-literals
+struct ContentLengthOrder
+{
+    bool operator()(const OptTreeNode* a, const OptTreeNode* b) const
+    {
+        if ( a->longestPatternLen != b->longestPatternLen )
+            return a->longestPatternLen > b->longestPatternLen;
+
+        // this improves stability of repeated tests
+        return a->sigInfo.sid > b->sigInfo.sid;
+    }
+};
+
+// moves the best n of [first, last) to the front in order and returns the
+// end of the ordered part; the rest is left unordered
+template<typename Order>
+const OptTreeNode** order_events(
+    const OptTreeNode** first, const OptTreeNode** last, unsigned n, Order order)
+{
+    if ( n >= (unsigned)(last - first) )
+    {
+        std::sort(first, last, order);
+        return last;
+    }
+    const OptTreeNode** end = first + n;
+
+    std::nth_element(first, end, last, order);
+    std::sort(first, end, order);
+
+    return end;
+}
+
+#endif
+
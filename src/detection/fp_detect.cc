@@ -73,6 +73,7 @@
 #include "detection_engine.h"
 #include "detection_module.h"
 #include "detection_options.h"
+#include "event_order.h"
 #include "fp_config.h"
 #include "fp_create.h"
 #include "ips_context.h"
@@ -462,60 +463,17 @@ static void rule_tree_match(
     }
 }
 
-static int sortOrderByPriority(const void* e1, const void* e2)
+// orders enough of the remaining matches to fill the rest of the queue
+static unsigned order_matches(MatchInfo& mi, unsigned start, unsigned n, int order)
 {
-    const OptTreeNode* otn1;
-    const OptTreeNode* otn2;
+    const OptTreeNode** first = mi.MatchArray + start;
+    const OptTreeNode** last = mi.MatchArray + mi.iMatchCount;
 
-    if (!e1 || !e2)
-        return 0;
-
-    otn1 = *(OptTreeNode* const*)e1;
-    otn2 = *(OptTreeNode* const*)e2;
-
-    if ( otn1->sigInfo.priority < otn2->sigInfo.priority )
-        return -1;
-
-    if ( otn1->sigInfo.priority > otn2->sigInfo.priority )
-        return +1;
-
-    /* This improves stability of repeated tests */
-    if ( otn1->sigInfo.sid < otn2->sigInfo.sid )
-        return -1;
-
-    if ( otn1->sigInfo.sid > otn2->sigInfo.sid )
-        return +1;
-
-    return 0;
-}
-
-// FIXIT-L pattern length is not a valid event sort criterion for
-// non-literals
-static int sortOrderByContentLength(const void* e1, const void* e2)
-{
-    const OptTreeNode* otn1;
-    const OptTreeNode* otn2;
-
-    if (!e1 || !e2)
-        return 0;
-
-    otn1 = *(OptTreeNode* const*)e1;
-    otn2 = *(OptTreeNode* const*)e2;
-
-    if (otn1->longestPatternLen < otn2->longestPatternLen)
-        return +1;
+    const OptTreeNode** end = ( order == SNORT_EVENTQ_PRIORITY ) ?
+        order_events(first, last, n, PriorityOrder()) :
+        order_events(first, last, n, ContentLengthOrder());
 
-    if (otn1->longestPatternLen > otn2->longestPatternLen)
-        return -1;
-
-    /* This improves stability of repeated tests */
-    if ( otn1->sigInfo.sid < otn2->sigInfo.sid )
-        return +1;
-
-    if ( otn1->sigInfo.sid > otn2->sigInfo.sid )
-        return -1;
-
-    return 0;
+    return end - mi.MatchArray;
 }
 
 /*
@@ -635,9 +593,6 @@ static inline int fpFinalSelectEvent(OtnxMatchData* omd, Packet* p)
 
     unsigned tcnt = 0;
     EventQueueConfig* eq = p->context->conf->event_queue_config;
-    int (*compar)(const void *, const void *);
-    compar = ( eq->order == SNORT_EVENTQ_PRIORITY )
-        ? &sortOrderByPriority : sortOrderByContentLength;
 
     for ( unsigned i = 0; i < p->context->conf->num_rule_types; i++ )
     {
@@ -649,8 +604,8 @@ static inline int fpFinalSelectEvent(OtnxMatchData* omd, Packet* p)
         if ( omd->matchInfo[i].iMatchCount )
         {
             /*
-             * We must always sort so if we que 8 and log 3 and they are
-             * all from the same action group we want them sorted so we get
+             * We must always order so if we que 8 and log 3 and they are
+             * all from the same action group we want them ordered so we get
              * the highest 3 in priority, priority and length sort do NOT
              * take precedence over 'alert drop pass ...' ordering.  If
              * order is 'drop alert', and we log 3 for drop alerts do not
@@ -658,15 +613,21 @@ static inline int fpFinalSelectEvent(OtnxMatchData* omd, Packet* p)
              * alert, then no drops are logged.  So, there should be a
              * built in drop/block/reset comes before alert/pass/log as
              * part of the natural ordering....Jan '06..
+             *
+             * Only the matches that can still be queued are put in order.
+             * More are ordered if some of those are not queued because
+             * the session already alerted on them.
              */
-            /* Sort the rules in this action group */
-            qsort(omd->matchInfo[i].MatchArray, omd->matchInfo[i].iMatchCount,
-                sizeof(void*), compar);
+            MatchInfo& mi = omd->matchInfo[i];
+            unsigned ordered = 0;
 
             /* Process each event in the action (alert,drop,log,...) groups */
-            for (unsigned j = 0; j < omd->matchInfo[i].iMatchCount; j++)
+            for (unsigned j = 0; j < mi.iMatchCount; j++)
             {
-                const OptTreeNode* otn = omd->matchInfo[i].MatchArray[j];
+                if ( j == ordered )
+                    ordered = order_matches(mi, j, eq->max_events - tcnt, eq->order);
+
+                const OptTreeNode* otn = mi.MatchArray[j];
                 RuleTreeNode* rtn = getRtnFromOtn(otn);
 
                 if ( otn && rtn && ( p->packet_flags & PKT_PASS_RULE ) )
@@ -679,7 +640,7 @@ static inline int fpFinalSelectEvent(OtnxMatchData* omd, Packet* p)
                 //  Loop here so we don't log the same event multiple times.
                 for (unsigned k = 0; k < j; k++)
                 {
-                    if ( omd->matchInfo[i].MatchArray[k] == otn )
+                    if ( mi.MatchArray[k] == otn )
                     {
                         otn = nullptr;
                         break;
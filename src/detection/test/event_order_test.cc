@@ -0,0 +1,194 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// event_order_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "detection/event_order.h"
+#include "events/event_queue.h"
+#include "events/sfeventq.h"
+
+OptTreeNode::~OptTreeNode() = default;
+
+// the queue limits of alert heavy traffic: every rule of a group matches
+// and only a few can be queued
+static constexpr unsigned num_matches = 100;
+
+static std::vector<OptTreeNode> make_otns(unsigned n)
+{
+    std::mt19937 rng(1);
+    std::vector<OptTreeNode> otns(n);
+
+    for ( unsigned i = 0; i < n; ++i )
+    {
+        otns[i].sigInfo.sid = i + 1;
+        otns[i].sigInfo.priority = rng() % 4;
+        otns[i].longestPatternLen = rng() % 16;
+    }
+    return otns;
+}
+
+static std::vector<const OptTreeNode*> get_matches(const std::vector<OptTreeNode>& otns)
+{
+    std::vector<const OptTreeNode*> v;
+
+    for ( const auto& otn : otns )
+        v.emplace_back(&otn);
+
+    std::shuffle(v.begin(), v.end(), std::mt19937(2));
+    return v;
+}
+
+#ifdef CATCH_TEST_BUILD
+
+TEST_CASE("event order selects best matches", "[detection]")
+{
+    std::vector<OptTreeNode> otns = make_otns(num_matches);
+    std::vector<const OptTreeNode*> matches = get_matches(otns);
+
+    std::vector<const OptTreeNode*> sorted = matches;
+    std::sort(sorted.begin(), sorted.end(), PriorityOrder());
+
+    SECTION("prefix")
+    {
+        const OptTreeNode** first = matches.data();
+        const OptTreeNode** end = order_events(first, first + matches.size(), 8, PriorityOrder());
+
+        CHECK(end == first + 8);
+        CHECK(std::equal(first, end, sorted.begin()));
+    }
+    SECTION("extended")
+    {
+        const OptTreeNode** first = matches.data();
+        const OptTreeNode** last = first + matches.size();
+        const OptTreeNode** end = order_events(first, last, 8, PriorityOrder());
+
+        end = order_events(end, last, 8, PriorityOrder());
+        CHECK(end == first + 16);
+        CHECK(std::equal(first, end, sorted.begin()));
+    }
+    SECTION("all")
+    {
+        const OptTreeNode** first = matches.data();
+        const OptTreeNode** last = first + matches.size();
+
+        CHECK(order_events(first, last, 200, PriorityOrder()) == last);
+        CHECK(std::equal(first, last, sorted.begin()));
+    }
+    SECTION("content length")
+    {
+        const OptTreeNode** first = matches.data();
+        const OptTreeNode** end = order_events(first, first + matches.size(), 3, ContentLengthOrder());
+
+        for ( const OptTreeNode** p = end; p < first + matches.size(); ++p )
+            CHECK(!ContentLengthOrder()(*p, end[-1]));
+
+        CHECK(first[0]->longestPatternLen >= first[1]->longestPatternLen);
+        CHECK(first[1]->longestPatternLen >= first[2]->longestPatternLen);
+    }
+}
+
+static int count_events(void* event, void* user)
+{
+    EventNode* en = (EventNode*)event;
+    std::vector<const OptTreeNode*>* v = (std::vector<const OptTreeNode*>*)user;
+    v->emplace_back(en->otn);
+    return 0;
+}
+
+TEST_CASE("event queue keeps insertion order", "[detection]")
+{
+    std::vector<OptTreeNode> otns = make_otns(10);
+    SF_EVENTQ* eq = sfeventq_new(8, 3, sizeof(EventNode));
+
+    for ( unsigned n = 0; n < 2; ++n )
+    {
+        for ( unsigned i = 0; i < otns.size(); ++i )
+        {
+            EventNode* en = (EventNode*)sfeventq_event_alloc(eq);
+
+            if ( i < 8 )
+            {
+                REQUIRE(en);
+                en->otn = &otns[i];
+                CHECK(sfeventq_add(eq, en) == 0);
+            }
+            else if ( en )
+                CHECK(sfeventq_add(eq, en) == -1);
+        }
+
+        std::vector<const OptTreeNode*> logged;
+        CHECK(sfeventq_action(eq, count_events, &logged) == 1);
+        REQUIRE(logged.size() == 3);
+        CHECK(logged[0] == &otns[0]);
+        CHECK(logged[2] == &otns[2]);
+
+        CHECK(sfeventq_reset(eq) == 1);
+        CHECK(sfeventq_action(eq, count_events, &logged) == 0);
+    }
+    sfeventq_free(eq);
+}
+
+#endif // CATCH_TEST_BUILD
+
+#ifdef BENCHMARK_TEST
+
+static int sort_by_priority(const void* e1, const void* e2)
+{
+    const OptTreeNode* otn1 = *(OptTreeNode* const*)e1;
+    const OptTreeNode* otn2 = *(OptTreeNode* const*)e2;
+
+    if ( otn1->sigInfo.priority != otn2->sigInfo.priority )
+        return otn1->sigInfo.priority < otn2->sigInfo.priority ? -1 : 1;
+
+    if ( otn1->sigInfo.sid != otn2->sigInfo.sid )
+        return otn1->sigInfo.sid < otn2->sigInfo.sid ? -1 : 1;
+
+    return 0;
+}
+
+TEST_CASE("event order", "[detection]")
+{
+    std::vector<OptTreeNode> otns = make_otns(num_matches);
+    std::vector<const OptTreeNode*> matches = get_matches(otns);
+    std::vector<const OptTreeNode*> work(matches.size());
+
+    BENCHMARK("qsort all matches")
+    {
+        work = matches;
+        qsort(work.data(), work.size(), sizeof(void*), sort_by_priority);
+        return work[0];
+    };
+
+    BENCHMARK("select max_queue matches")
+    {
+        work = matches;
+        order_events(work.data(), work.data() + work.size(), 8, PriorityOrder());
+        return work[0];
+    };
+}
+
+#endif // BENCHMARK_TEST
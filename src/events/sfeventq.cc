@@ -68,8 +68,7 @@ SF_EVENTQ* sfeventq_new(int max_nodes, int log_nodes, int event_size)
 
     SF_EVENTQ* eq = (SF_EVENTQ*)snort_calloc(sizeof(SF_EVENTQ));
 
-    /* Initialize the memory for the nodes that we are going to use. */
-    eq->node_mem = (SF_EVENTQ_NODE*)snort_calloc(max_nodes, sizeof(SF_EVENTQ_NODE));
+    /* Initialize the memory for the events that we are going to use. */
     eq->event_mem = (char*)snort_calloc(max_nodes + 1, event_size);
 
     eq->max_nodes = max_nodes;
@@ -126,7 +125,6 @@ unsigned sfeventq_reset(SF_EVENTQ* eq)
 {
     unsigned fails = eq->fails;
     eq->fails = 0;
-    eq->head = nullptr;
     eq->cur_nodes = 0;
     eq->cur_events = 0;
     eq->reserve_event = (char*)(&eq->event_mem[eq->max_nodes * eq->event_size]);
@@ -138,13 +136,6 @@ void sfeventq_free(SF_EVENTQ* eq)
     if (eq == nullptr)
         return;
 
-    /* Free the memory for the nodes that were in use. */
-    if (eq->node_mem != nullptr)
-    {
-        snort_free(eq->node_mem);
-        eq->node_mem = nullptr;
-    }
-
     if (eq->event_mem != nullptr)
     {
         snort_free(eq->event_mem);
@@ -155,35 +146,11 @@ void sfeventq_free(SF_EVENTQ* eq)
 }
 
 /*
-**  This function returns a ptr to the node to use.  We allocate the last
-**  event node if we have exhausted the event queue.  Before we allocate
-**  the last node, we determine if the incoming event has a higher
-**  priority than the last node.  If it does, we allocate the node, otherwise
-**  we drop it because it is lower priority.
-**
-**  If the last node is allocated, we have to point the reserve_event to
-**  the allocated event memory, since the reserved_event memory was used
-**  for the incoming event.
-**
-**  @return SF_EVENTQ_NODE *
-**
-**  @retval null - resource exhaustion and event is lower priority than last node
-**  @retval !null - ptr to node memory.
-*/
-static SF_EVENTQ_NODE* get_eventq_node(SF_EVENTQ* eq, void*)
-{
-    if (eq->cur_nodes >= eq->max_nodes)
-        return nullptr;
-
-    //  We grab the next node from the node memory.
-    return &eq->node_mem[eq->cur_nodes++];
-}
-
-/*
-**  Add this event to the queue using the supplied ordering
-**  function.  If the queue is exhausted, then we compare the
-**  event to be added with the last event, and decide whether
-**  it is a higher priority than the last node.
+**  Add this event to the queue.  Events are kept in the order they
+**  were added, which must be the order they were allocated in.  If
+**  the queue is exhausted the event is dropped.  Ordering events by
+**  priority or content length is done by the caller before they are
+**  queued.
 **
 **  @return integer
 **
@@ -194,36 +161,14 @@ int sfeventq_add(SF_EVENTQ* eq, void* event)
 {
     assert(event);
 
-    /*
-    **  If get_eventq_node() returns null, this means that
-    **  we have exhausted the eventq and the incoming event
-    **  is lower in priority then the last ranked event.
-    **  So we just drop it.
-    */
-    SF_EVENTQ_NODE* node = get_eventq_node(eq, event);
-
-    if ( !node )
+    if (eq->cur_nodes >= eq->max_nodes)
     {
         ++eq->fails;
         return -1;
     }
 
-    node->event = event;
-    node->next  = nullptr;
-    node->prev  = nullptr;
-
-    if (eq->cur_nodes == 1)
-    {
-        //  This is the first node
-        eq->head = eq->last = node;
-        return 0;
-    }
-
-    //  This means we are the last node.
-    node->prev = eq->last;
-
-    eq->last->next = node;
-    eq->last = node;
+    assert(event == &eq->event_mem[eq->cur_nodes * eq->event_size]);
+    eq->cur_nodes++;
 
     return 0;
 }
@@ -240,24 +185,16 @@ int sfeventq_add(SF_EVENTQ* eq, void* event)
 */
 int sfeventq_action(SF_EVENTQ* eq, int (* action_func)(void*, void*), void* user)
 {
-    SF_EVENTQ_NODE* node;
-    int logged = 0;
-
     if (action_func == nullptr)
         return -1;
 
-    if (eq->head == nullptr)
+    if (!eq->cur_nodes)
         return 0;
 
-    for (node = eq->head; node != nullptr; node = node->next)
+    for (int i = 0; i < eq->cur_nodes && i < eq->log_nodes; i++)
     {
-        if (logged >= eq->log_nodes)
-            return 1;
-
-        if (action_func(node->event, user))
+        if (action_func(&eq->event_mem[i * eq->event_size], user))
             return -1;
-
-        logged++;
     }
 
     return 1;
@@ -20,31 +20,18 @@
 #ifndef SFEVENTQ_H
 #define SFEVENTQ_H
 
-struct SF_EVENTQ_NODE
-{
-    void* event;
-
-    SF_EVENTQ_NODE* prev;
-    SF_EVENTQ_NODE* next;
-};
-
 struct SF_EVENTQ
 {
     /*
-    **  Handles the actual ordering and memory
-    **  of the event queue and it's nodes.
+    **  Events are stored contiguously in the order they
+    **  were added so the queue needs no per event nodes.
     */
-    SF_EVENTQ_NODE* head;
-    SF_EVENTQ_NODE* last;
-
-    SF_EVENTQ_NODE* node_mem;
     char* event_mem;
 
     /*
-    **  The reserve event allows us to allocate one extra node
-    **  and compare against the last event in the queue to determine
-    **  if the incoming event is a higher priority than the last
-    **  event in the queue.
+    **  The reserve event allows us to allocate one extra event
+    **  when the queue is full.  Adding it fails, which counts
+    **  the dropped event.
     */
     char* reserve_event;
 
@@ -57,7 +44,7 @@ struct SF_EVENTQ
 
     /*
     **  This element tracks the current number of
-    **  nodes in the event queue.
+    **  events added to and allocated from the queue.
     */
     int cur_nodes;
     int cur_events;
@@ -30,11 +30,20 @@
 
 #include "file_capture.h"
 
-#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
+#include <atomic>
 #include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <functional>
+#include <thread>
 
 #include "log/messages.h"
+#include "main/thread.h"
+#include "main/thread_config.h"
 #include "utils/stats.h"
 #include "utils/util.h"
 
@@ -50,11 +59,8 @@ using namespace snort;
 FileMemPool* FileCapture::file_mempool = nullptr;
 int64_t FileCapture::capture_block_size = 0;
 
-std::mutex FileCapture::capture_mutex;
-std::condition_variable FileCapture::capture_cv;
-std::thread* FileCapture::file_storer = nullptr;
-std::queue<FileCapture*> FileCapture::files_waiting;
-bool FileCapture::running = true;
+FileStorer* FileCapture::storers = nullptr;
+unsigned FileCapture::num_storers = 0;
 
 FileCaptureState FileCapture::error_capture(FileCaptureState state)
 {
@@ -62,30 +68,154 @@ FileCaptureState FileCapture::error_capture(FileCaptureState state)
     return state;
 }
 
-// Only one writer thread supported
-void FileCapture::writer_thread()
+//--------------------------------------------------------------------------
+// storers
+//--------------------------------------------------------------------------
+
+// Bounded multiple producer, single consumer queue of the files waiting to
+// be written by one storer thread.  Each slot's sequence number tells
+// whether it is free for the producer claiming that position or full for
+// the consumer.
+class FileStorer
+{
+public:
+    ~FileStorer();
+
+    void start(uint64_t size);
+    void stop();
+
+    bool put(FileCapture*);
+
+private:
+    FileCapture* get();
+    void run();
+
+    struct Slot
+    {
+        std::atomic<uint64_t> seq;
+        FileCapture* file;
+    };
+
+    Slot* slots = nullptr;
+    uint64_t mask = 0;
+
+    std::atomic<uint64_t> head { 0 };
+    uint64_t tail = 0;
+
+    std::thread* thread = nullptr;
+    std::atomic<bool> running { true };
+};
+
+FileStorer::~FileStorer()
+{
+    stop();
+    delete[] slots;
+}
+
+void FileStorer::start(uint64_t size)
+{
+    uint64_t n = 1;
+
+    while (n < size)
+        n <<= 1;
+
+    slots = new Slot[n];
+    mask = n - 1;
+
+    for (uint64_t i = 0; i < n; ++i)
+        slots[i].seq.store(i, std::memory_order_relaxed);
+
+    thread = new std::thread(&FileStorer::run, this);
+}
+
+// When !running we write out any remaining files before exiting.
+// FIXIT-L should take dirty_pig into account. But this thread does not have convenient
+// access to snort_conf.
+void FileStorer::stop()
+{
+    if (!thread)
+        return;
+
+    running.store(false, std::memory_order_release);
+    thread->join();
+
+    delete thread;
+    thread = nullptr;
+}
+
+bool FileStorer::put(FileCapture* file)
 {
+    uint64_t pos = head.load(std::memory_order_relaxed);
+    Slot* slot;
+
     while (true)
     {
-        // Wait until there are files
-        std::unique_lock<std::mutex> lk(capture_mutex);
-        capture_cv.wait(lk, [] { return !running or !files_waiting.empty(); });
+        slot = &slots[pos & mask];
+        int64_t diff = (int64_t)slot->seq.load(std::memory_order_acquire) - (int64_t)pos;
+
+        if (!diff)
+        {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+            return false;
+
+        else
+            pos = head.load(std::memory_order_relaxed);
+    }
+
+    slot->file = file;
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
 
-        // When !running we write out any remaining files before exiting.
-        // FIXIT-L should take dirty_pig into account. But this thread does not have convenient
-        // access to snort_conf.
-        if (files_waiting.empty())
-            break;
+FileCapture* FileStorer::get()
+{
+    Slot* slot = &slots[tail & mask];
+
+    if (slot->seq.load(std::memory_order_acquire) != tail + 1)
+        return nullptr;
 
-        FileCapture* file = files_waiting.front();
-        files_waiting.pop();
-        lk.unlock();
+    FileCapture* file = slot->file;
+    slot->seq.store(tail + mask + 1, std::memory_order_release);
+    ++tail;
+
+    return file;
+}
+
+void FileStorer::run()
+{
+    while (true)
+    {
+        FileCapture* file = get();
+
+        if (!file)
+        {
+            if (!running.load(std::memory_order_acquire))
+            {
+                // files queued before stop() are visible now
+                file = get();
+
+                if (!file)
+                    break;
+            }
+            else
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+        }
 
         file->store_file();
         delete file;
     }
 }
 
+//--------------------------------------------------------------------------
+// capture
+//--------------------------------------------------------------------------
+
 FileCapture::FileCapture(int64_t min_size, int64_t max_size)
 {
     capture_size = 0;
@@ -131,11 +261,31 @@ FileCapture::~FileCapture()
         delete file_info;
 }
 
-void FileCapture::init(int64_t memcap, int64_t block_size)
+void FileCapture::init(int64_t memcap, int64_t block_size, unsigned n)
 {
     capture_block_size = block_size;
     init_mempool(memcap, capture_block_size);
-    file_storer = new std::thread(writer_thread);
+
+    // every queued file holds at least one block so the queues can't fill
+    uint64_t size = file_mempool ? file_mempool->total_objects() : 1;
+
+    num_storers = n ? n : 1;
+    storers = new FileStorer[num_storers];
+
+    for (unsigned i = 0; i < num_storers; ++i)
+        storers[i].start(size);
+}
+
+void FileCapture::thread_init()
+{
+    if (file_mempool)
+        file_mempool->tinit(get_instance_id());
+}
+
+void FileCapture::thread_term()
+{
+    if (file_mempool)
+        file_mempool->tterm();
 }
 
 /*
@@ -144,18 +294,9 @@ void FileCapture::init(int64_t memcap, int64_t block_size)
  */
 void FileCapture::exit()
 {
-    {
-        std::lock_guard<std::mutex> lk(capture_mutex);
-        running = false;
-    }
-    capture_cv.notify_one();
-
-    if (file_storer)
-    {
-        file_storer->join();
-        delete file_storer;
-        file_storer = nullptr;
-    }
+    delete[] storers;
+    storers = nullptr;
+    num_storers = 0;
 }
 
 /*
@@ -180,7 +321,7 @@ void FileCapture::init_mempool(int64_t max_file_mem, int64_t block_len)
 
     int max_files = max_file_mem_in_bytes / block_size;
 
-    file_mempool = new FileMemPool(max_files, block_size);
+    file_mempool = new FileMemPool(max_files, block_size, ThreadConfig::get_instance_max());
 }
 
 inline FileCaptureBlock* FileCapture::create_file_buffer()
@@ -433,43 +574,40 @@ FileCaptureBlock* FileCapture::get_file_data(uint8_t** buff, int* size)
 /*
  * writing file data to the disk.
  *
- * In the case of interrupt errors, the write is retried, but only for a
- * finite number of times.
+ * Interrupted and partial writes are continued until all is written or
+ * there is an error.
  */
-void FileCapture::write_file_data(uint8_t* buf, size_t buf_len, FILE* fh)
+bool FileCapture::write_file_data(int fd, struct iovec* iov, int iovcnt)
 {
-    int max_retries = 3;
-    size_t bytes_written = 0;
-    int err;
-
-    /* Nothing to write or nothing to write to */
-    if ((buf == nullptr) || (fh == nullptr))
-        return;
-
-    /* writing several times */
-    do
+    while (iovcnt)
     {
-        size_t bytes_left = buf_len - bytes_written;
-
-        bytes_written += fwrite(buf + bytes_written, 1, bytes_left, fh);
+        ssize_t n = writev(fd, iov, iovcnt);
 
-        err = ferror(fh);
-        if (err && (err != EINTR) && (err != EAGAIN))
+        if (n < 0)
         {
-            break;
-        }
+            if (errno == EINTR or errno == EAGAIN)
+                continue;
 
-        max_retries--;
-    }
-    while ((max_retries > 0) && (bytes_written < buf_len));
+            ErrorMessage("File inspect: disk writing error - %s!\n", get_error(errno));
+            return false;
+        }
 
-    if (bytes_written < buf_len)
-    {
-        ErrorMessage("File inspect: disk writing error - %s!\n", get_error(err));
+        while (iovcnt and (size_t)n >= iov->iov_len)
+        {
+            n -= iov->iov_len;
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt)
+        {
+            iov->iov_base = (uint8_t*)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
     }
+    return true;
 }
 
-// Store files on local disk
+// Store files on local disk, writing many blocks per call
 void FileCapture::store_file()
 {
     if (!file_info)
@@ -477,39 +615,44 @@ void FileCapture::store_file()
 
     std::string& file_full_name = file_info->get_file_name();
 
-    /*Check whether the file exists*/
-    struct stat buffer;
-    if (stat (file_full_name.c_str(), &buffer) == 0)
-    {
-        return;
-    }
+    /*Fails if the file exists*/
+    int fd = open(file_full_name.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
 
-    FILE* fh = fopen(file_full_name.c_str(), "w");
-    if (!fh )
-    {
+    if (fd < 0)
         return;
-    }
 
-    // Check the file buffer
-    uint8_t* buff = nullptr;
-    int size = 0;
-    void* file_mem;
+    struct iovec iov[64];
+    int iovcnt = 0;
+    bool more = true;
 
-    do
+    // Check the file buffer
+    while (more)
     {
-        file_mem = get_file_data(&buff, &size);
+        uint8_t* buff = nullptr;
+        int size = 0;
+
         // Get file from file buffer
-        if (!buff || !size )
+        more = get_file_data(&buff, &size) != nullptr;
+
+        if (buff and size)
         {
-            fclose(fh);
-            return;
+            iov[iovcnt].iov_base = buff;
+            iov[iovcnt].iov_len = size;
+            ++iovcnt;
         }
+        else
+            more = false;
+
+        if (iovcnt == (int)array_size(iov) or (!more and iovcnt))
+        {
+            if (!write_file_data(fd, iov, iovcnt))
+                break;
 
-        write_file_data(buff, size, fh);
+            iovcnt = 0;
+        }
     }
-    while (file_mem);
 
-    fclose(fh);
+    close(fd);
 }
 
 // Queue files to be stored to disk
@@ -529,9 +672,11 @@ void FileCapture::store_file_async()
     get_instance_file(file_full_name, file_name.c_str());
     file_info->set_file_name(file_full_name.c_str(), file_full_name.size());
 
-    std::lock_guard<std::mutex> lk(capture_mutex);
-    files_waiting.push(this);
-    capture_cv.notify_one();
+    assert(storers);
+    FileStorer& storer = storers[std::hash<std::string>()(file_full_name) % num_storers];
+
+    while (!storer.put(this))
+        std::this_thread::yield();
 }
 
 /*Log file capture mempool usage*/
@@ -30,15 +30,16 @@
 //     data will stay in the mempool.
 // 3) Then file data can be read through file_capture_read()
 // 4) Finally, file data must be released from mempool file_capture_release()
-
-#include <condition_variable>
-#include <mutex>
-#include <queue>
-#include <thread>
+//
+// Files are stored to disk by a configurable number of storer threads.  Each
+// storer has a lock-free queue that any packet thread can add to; a file
+// always goes to the same storer based on its name.
 
 #include "file_api.h"
 
 class FileMemPool;
+class FileStorer;
+struct iovec;
 
 namespace snort
 {
@@ -57,7 +58,11 @@ public:
     ~FileCapture();
 
     // this must be called during snort init
-    static void init(int64_t memcap, int64_t block_size);
+    static void init(int64_t memcap, int64_t block_size, unsigned storers = 1);
+
+    // packet threads
+    static void thread_init();
+    static void thread_term();
 
     // Capture file data to local buffer
     // This is the main function call to enable file capture
@@ -100,19 +105,15 @@ public:
 private:
 
     static void init_mempool(int64_t max_file_mem, int64_t block_size);
-    static void writer_thread();
     inline FileCaptureBlock* create_file_buffer();
     inline FileCaptureState save_to_file_buffer(const uint8_t* file_data, int data_size,
         int64_t max_size);
-    void write_file_data(uint8_t* buf, size_t buf_len, FILE* fh);
+    bool write_file_data(int fd, struct iovec*, int iovcnt);
 
     static FileMemPool* file_mempool;
     static int64_t capture_block_size;
-    static std::mutex capture_mutex;
-    static std::condition_variable capture_cv;
-    static std::thread* file_storer;
-    static std::queue<FileCapture*> files_waiting;
-    static bool running;
+    static FileStorer* storers;
+    static unsigned num_storers;
 
     uint64_t capture_size;
     FileCaptureBlock* last;  /* last block of file data */
@@ -63,6 +63,11 @@ void FileConfig::process_file_rule(FileMagicRule& rule)
     fileIdentifier.insert_file_rule(rule);
 }
 
+void FileConfig::compile_file_rules()
+{
+    fileIdentifier.compile();
+}
+
 const FileMagicRule* FileConfig::get_rule_from_id(uint32_t id) const
 {
     return fileIdentifier.get_rule_from_id(id);
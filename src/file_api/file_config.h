@@ -37,6 +37,7 @@
 #define DEFAULT_FILE_CAPTURE_BLOCK_SIZE     32768       // 32 KiB
 #define DEFAULT_MAX_FILES_CACHED            65536
 #define DEFAULT_MAX_FILES_PER_FLOW          128
+#define DEFAULT_FILE_HASH_MEMCAP            16          // 16 MiB
 
 #define FILE_ID_NAME "file_id"
 #define FILE_ID_HELP "configure file identification"
@@ -48,6 +49,7 @@ public:
     void get_magic_rule_ids_from_type(const std::string&, const std::string&,
         snort::FileTypeBitSet&) const;
     void process_file_rule(FileMagicRule&);
+    void compile_file_rules();
     bool process_file_magic(FileMagicData&);
     uint32_t find_file_type_id(const uint8_t* buf, int len, uint64_t file_offset, void** context);
     std::string file_type_name(uint32_t id) const;
@@ -61,9 +63,12 @@ public:
     int64_t capture_max_size = DEFAULT_FILE_CAPTURE_MAX_SIZE;
     int64_t capture_min_size = DEFAULT_FILE_CAPTURE_MIN_SIZE;
     int64_t capture_block_size = DEFAULT_FILE_CAPTURE_BLOCK_SIZE;
+    unsigned capture_storers = 1;
     int64_t file_depth =  0;
     int64_t max_files_cached = DEFAULT_MAX_FILES_CACHED;
     uint64_t max_files_per_flow = DEFAULT_MAX_FILES_PER_FLOW;
+    unsigned hash_threads = 0;
+    int64_t hash_memcap = DEFAULT_FILE_HASH_MEMCAP;
 
     int64_t show_data_depth = DEFAULT_FILE_SHOW_DATA_DEPTH;
     bool trace_type = false;
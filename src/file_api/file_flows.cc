@@ -555,11 +555,14 @@ static void file_config_show(const FileConfig* fc)
         ConfigLogger::log_value("capture_max_size", fc->capture_max_size);
         ConfigLogger::log_value("capture_min_size", fc->capture_min_size);
         ConfigLogger::log_value("capture_block_size", fc->capture_block_size);
+        ConfigLogger::log_value("capture_storers", fc->capture_storers);
     }
 
     ConfigLogger::log_value("lookup_timeout", fc->file_lookup_timeout);
     ConfigLogger::log_value("max_files_cached", fc->max_files_cached);
     ConfigLogger::log_value("max_files_per_flow", fc->max_files_per_flow);
+    ConfigLogger::log_value("hash_threads", fc->hash_threads);
+    ConfigLogger::log_value("hash_memcap", fc->hash_memcap);
     ConfigLogger::log_value("show_data_depth", fc->show_data_depth);
 
     ConfigLogger::log_flag("trace_type", fc->trace_type);
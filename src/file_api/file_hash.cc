@@ -0,0 +1,238 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// file_hash.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "file_hash.h"
+
+#include <cassert>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "utils/util.h"
+
+#include "file_stats.h"
+
+using namespace snort;
+
+//-------------------------------------------------------------------------
+// hash threads
+//-------------------------------------------------------------------------
+
+struct HashJob
+{
+    FileHash* hash;
+    uint8_t* data;
+    size_t len;
+};
+
+class HashWorker
+{
+public:
+    HashWorker();
+    ~HashWorker();
+
+    void put(const HashJob&);
+
+    // block till the hash has no updates queued to this worker
+    void wait(const FileHash*);
+
+private:
+    void run();
+
+private:
+    std::deque<HashJob> jobs;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::condition_variable done;
+    std::thread* thread;
+    bool go = true;
+};
+
+static std::vector<HashWorker*> workers;
+static std::atomic<unsigned> next_worker { 0 };
+
+// bytes copied for the hash threads but not hashed yet
+static std::atomic<size_t> queued_bytes { 0 };
+static size_t hash_memcap = 0;
+
+HashWorker::HashWorker()
+{ thread = new std::thread(&HashWorker::run, this); }
+
+HashWorker::~HashWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        go = false;
+    }
+    cond.notify_one();
+
+    thread->join();
+    delete thread;
+
+    assert(jobs.empty());
+}
+
+void HashWorker::put(const HashJob& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.emplace_back(job);
+    }
+    cond.notify_one();
+}
+
+void HashWorker::wait(const FileHash* hash)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // pending is only decremented with the mutex held so the wakeup isn't lost
+    done.wait(lock, [hash]()
+        { return !hash->pending.load(std::memory_order_acquire); });
+}
+
+void HashWorker::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while ( true )
+    {
+        if ( jobs.empty() )
+        {
+            if ( !go )
+                break;
+
+            cond.wait(lock);
+            continue;
+        }
+        HashJob job = jobs.front();
+        jobs.pop_front();
+        lock.unlock();
+
+        SHA256_Update(&job.hash->ctx, job.data, job.len);
+        snort_free(job.data);
+
+        queued_bytes.fetch_sub(job.len, std::memory_order_relaxed);
+        lock.lock();
+
+        if ( job.hash->pending.fetch_sub(1, std::memory_order_release) == 1 )
+            done.notify_all();
+    }
+}
+
+void FileHash::start(unsigned threads, size_t memcap)
+{
+    assert(workers.empty());
+    hash_memcap = memcap;
+
+    for ( unsigned i = 0; i < threads; ++i )
+        workers.emplace_back(new HashWorker);
+}
+
+void FileHash::stop()
+{
+    for ( auto* w : workers )
+        delete w;
+
+    workers.clear();
+}
+
+//-------------------------------------------------------------------------
+// file hash
+//-------------------------------------------------------------------------
+
+FileHash::FileHash()
+{
+    worker = workers.empty() ? 0 : next_worker++ % workers.size();
+    SHA256_Init(&ctx);
+}
+
+FileHash::~FileHash()
+{ wait(); }
+
+void FileHash::wait()
+{
+    if ( !pending.load(std::memory_order_acquire) )
+        return;
+
+    file_counts.hash_waits++;
+    workers[worker]->wait(this);
+}
+
+void FileHash::reset()
+{
+    wait();
+    SHA256_Init(&ctx);
+}
+
+// claim room for len more bytes under the memcap shared by all packet threads
+static bool reserve(size_t len)
+{
+    size_t queued = queued_bytes.load(std::memory_order_relaxed);
+
+    do
+    {
+        if ( queued + len > hash_memcap )
+            return false;
+    }
+    while ( !queued_bytes.compare_exchange_weak(queued, queued + len,
+        std::memory_order_relaxed) );
+
+    return true;
+}
+
+void FileHash::update(const uint8_t* data, size_t len)
+{
+    // the queued updates go first so the order is kept
+    wait();
+    SHA256_Update(&ctx, data, len);
+}
+
+void FileHash::queue(const uint8_t* data, size_t len)
+{
+    if ( workers.empty() or !reserve(len) )
+    {
+        update(data, len);
+        return;
+    }
+
+    uint8_t* copy = (uint8_t*)snort_alloc(len);
+    memcpy(copy, data, len);
+
+    pending.fetch_add(1, std::memory_order_relaxed);
+    workers[worker]->put({ this, copy, len });
+
+    file_counts.hash_offloads++;
+    file_counts.hash_offload_bytes += len;
+}
+
+void FileHash::get_digest(uint8_t* digest)
+{
+    wait();
+
+    SHA256_CTX tmp = ctx;
+    SHA256_Final(digest, &tmp);
+}
+
@@ -0,0 +1,71 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// file_hash.h
+
+#ifndef FILE_HASH_H
+#define FILE_HASH_H
+
+// SHA-256 of file data.  When file_id.hash_threads is set, updates whose
+// digest isn't needed right away are copied and queued to a pool of hash
+// threads instead of being hashed on the packet thread.  All updates of a
+// file go to the same hash thread so they are applied in order; hashing on
+// the packet thread or getting the digest waits for any still queued.
+
+#include <openssl/sha.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class FileHash
+{
+public:
+    FileHash();
+    ~FileHash();
+
+    FileHash(const FileHash&) = delete;
+    FileHash& operator=(const FileHash&) = delete;
+
+    // start over with no data
+    void reset();
+
+    // hash on this thread
+    void update(const uint8_t*, size_t);
+
+    // hash on a hash thread if there is one and the data fits in the memcap,
+    // else on this thread
+    void queue(const uint8_t*, size_t);
+
+    // digest of the data so far; more data may be added afterwards
+    void get_digest(uint8_t* digest);
+
+    // main thread
+    static void start(unsigned threads, size_t memcap);
+    static void stop();
+
+private:
+    friend class HashWorker;
+    void wait();
+
+    SHA256_CTX ctx;
+    std::atomic<unsigned> pending { 0 };
+    unsigned worker;
+};
+
+#endif
+
@@ -31,6 +31,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <map>
+#include <unordered_map>
 
 #include "hash/ghash.h"
 #include "log/messages.h"
@@ -73,13 +75,25 @@ void FileIdentifier::init_merge_hash()
 }
 
 FileIdentifier::~FileIdentifier()
+{
+    free_trie();
+}
+
+void FileIdentifier::free_trie()
 {
     /*Release memory used for identifiers*/
     for (auto mem_block:id_memory_blocks)
         snort_free(mem_block);
 
+    id_memory_blocks.clear();
+    identifier_root = nullptr;
+    memory_used = 0;
+
     if (identifier_merge_hash != nullptr)
+    {
         delete identifier_merge_hash;
+        identifier_merge_hash = nullptr;
+    }
 }
 
 void* FileIdentifier::calloc_mem(size_t size)
@@ -282,6 +296,8 @@ void FileIdentifier::insert_file_rule(FileMagicRule& rule)
 {
     IdentifierNode* node;
 
+    assert(!compiled);
+
     if (!identifier_root)
     {
         identifier_root = (IdentifierNode*)calloc_mem(sizeof(*identifier_root));
@@ -306,9 +322,81 @@ void FileIdentifier::insert_file_rule(FileMagicRule& rule)
     update_trie(identifier_root, node);
 }
 
+void FileIdentifier::compile()
+{
+    compiled = true;
+
+    if (!identifier_root)
+        return;
+
+    /*Number the nodes reachable from the root, the trie shares nodes*/
+    std::unordered_map<const IdentifierNode*, uint32_t> ids;
+    std::vector<const IdentifierNode*> nodes { nullptr, identifier_root };
+    std::vector<const IdentifierNode*> stack { identifier_root };
+
+    ids[nullptr] = 0;
+    ids[identifier_root] = 1;
+
+    while (!stack.empty())
+    {
+        const IdentifierNode* node = stack.back();
+        stack.pop_back();
+
+        for (unsigned i = 0; i < MAX_BRANCH; i++)
+        {
+            const IdentifierNode* next = node->next[i];
+
+            if (next and ids.emplace(next, nodes.size()).second)
+            {
+                nodes.emplace_back(next);
+                stack.emplace_back(next);
+            }
+        }
+    }
+
+    /*Split the bytes into classes that go to the same node from every node*/
+    unsigned num_classes = 1;
+
+    for (unsigned n = 1; n < nodes.size(); n++)
+    {
+        std::map<std::pair<uint8_t, const IdentifierNode*>, uint8_t> split;
+
+        for (unsigned i = 0; i < MAX_BRANCH; i++)
+        {
+            auto key = std::make_pair(byte_class[i], (const IdentifierNode*)nodes[n]->next[i]);
+            byte_class[i] = split.emplace(key, split.size()).first->second;
+        }
+        num_classes = split.size();
+    }
+
+    uint8_t class_byte[MAX_BRANCH];
+
+    for (unsigned i = 0; i < MAX_BRANCH; i++)
+        class_byte[byte_class[i]] = i;
+
+    /*Lay out the rows with the next states as row indexes*/
+    row_size = num_classes + 2;
+    dfa.assign(nodes.size() * row_size, 0);
+
+    for (unsigned n = 1; n < nodes.size(); n++)
+    {
+        uint32_t* row = &dfa[n * row_size];
+
+        row[0] = nodes[n]->offset;
+        row[1] = nodes[n]->type_id;
+
+        for (unsigned c = 0; c < num_classes; c++)
+            row[c + 2] = ids[nodes[n]->next[class_byte[c]]] * row_size;
+    }
+
+    free_trie();
+
+    memory_used = dfa.size() * sizeof(uint32_t);
+}
+
 /*
  * This is the main function to find file type
- * Find file type is to traverse the tries.
+ * Find file type is to run the DFA over the bytes at the offsets it examines.
  * Context is saved to continue file type identification as data becomes available
  */
 uint32_t FileIdentifier::find_file_type_id(const uint8_t* buf, int len, uint64_t file_offset,
@@ -317,37 +405,40 @@ uint32_t FileIdentifier::find_file_type_id(const uint8_t* buf, int len, uint64_t
     uint32_t file_type_id = SNORT_FILE_TYPE_CONTINUE;
 
     assert(context);
+    assert(compiled);
 
     if ( !buf || len <= 0 )
         return SNORT_FILE_TYPE_CONTINUE;
 
-    if (!(*context))
-        *context = (void*)(identifier_root);
+    uint32_t current = (uint32_t)(uintptr_t)(*context);
 
-    IdentifierNode* current = (IdentifierNode*)(*context);
+    if (!current)
+        current = dfa.empty() ? 0 : row_size;
 
     uint64_t end = file_offset + len;
 
-    while (current &&  (current->offset >= file_offset))
+    while (current && (dfa[current] >= file_offset))
     {
+        const uint32_t* row = &dfa[current];
+
         /*Found file id, save and continue*/
-        if (current->type_id)
+        if (row[1])
         {
-            file_type_id = current->type_id;
+            file_type_id = row[1];
         }
 
-        if ( current->offset >= end )
+        if ( row[0] >= end )
         {
             /* Save current state */
-            *context = current;
+            *context = (void*)(uintptr_t)current;
             if (file_type_id)
                 return file_type_id;
             else
                 return SNORT_FILE_TYPE_CONTINUE;
         }
 
-        /*Move to the next level*/
-        current = current->next[buf[current->offset - file_offset ]];
+        /*Move to the next state*/
+        current = row[2 + byte_class[buf[row[0] - file_offset]]];
     }
 
     /*Either end of magics or passed the current offset*/
@@ -414,6 +505,7 @@ TEST_CASE ("FileIdRulePDF", "[FileMagic]")
     FileIdentifier rc;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "PDF";
 
@@ -438,6 +530,7 @@ TEST_CASE ("FileIdRuleUnknow", "[FileMagic]")
     FileIdentifier rc;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "DDF";
 
@@ -473,6 +566,7 @@ TEST_CASE ("FileIdRuleEXE", "[FileMagic]")
     rule.id = 3;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "PDFooo";
     void* context = nullptr;
@@ -506,6 +600,7 @@ TEST_CASE ("FileIdRulePDFEXE", "[FileMagic]")
     rule.id = 3;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "PDFEXE";
     void* context = nullptr;
@@ -540,6 +635,7 @@ TEST_CASE ("FileIdRuleFirst", "[FileMagic]")
     rule.id = 3;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "PDF";
     void* context = nullptr;
@@ -25,6 +25,11 @@
 // File type identification is based on file magic. To improve the detection
 // performance, a trie is created to scan file data once. Currently, only the
 // most specific file type is returned.
+//
+// Once all rules are inserted, the trie is compiled into a DFA stored in one
+// flat array. Each state examines the byte at a fixed file offset and bytes
+// that lead to the same state from every state share a column of the
+// transition table, so the table stays small and lookups touch few cache lines.
 
 #include <list>
 #include <vector>
@@ -90,6 +95,10 @@ public:
     ~FileIdentifier();
     uint32_t memory_usage() const { return memory_used; }
     void insert_file_rule(FileMagicRule& rule);
+
+    // build the DFA used by find_file_type_id(); no rules can be
+    // inserted after this
+    void compile();
     uint32_t find_file_type_id(const uint8_t* buf, int len, uint64_t offset, void** context);
     const FileMagicRule* get_rule_from_id(uint32_t) const;
     void get_magic_rule_ids_from_type(const std::string&, const std::string&,
@@ -103,6 +112,7 @@ private:
     bool update_next(IdentifierNode* start, IdentifierNode** next_ptr, IdentifierNode* append);
     IdentifierNode* create_trie_from_magic(FileMagicRule& rule, uint32_t type_id);
     void update_trie(IdentifierNode* start, IdentifierNode* append);
+    void free_trie();
 
     /*properties*/
     IdentifierNode* identifier_root = nullptr; /*Root of magic tries*/
@@ -110,6 +120,14 @@ private:
     snort::GHash* identifier_merge_hash = nullptr;
     FileMagicRule file_magic_rules[FILE_ID_MAX + 1];
     IDMemoryBlocks id_memory_blocks;
+
+    // a row per state: the offset examined, the type found on reaching the
+    // state and the row of the next state for each byte class; row 0 is
+    // the dead state and the start state follows it
+    std::vector<uint32_t> dfa;
+    uint32_t row_size = 0;
+    uint8_t byte_class[MAX_BRANCH] = { };
+    bool compiled = false;
 };
 
 #endif
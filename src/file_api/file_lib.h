@@ -38,6 +38,7 @@ const std::string VerdictName[] =
 {"Unknown", "Log", "Stop", "Block", "Reset", "Pending", "Stop Capture", "INVALID"};
 
 class FileConfig;
+class FileHash;
 class FileSegments;
 
 namespace snort
@@ -157,7 +158,7 @@ public:
 private:
     uint64_t processed_bytes = 0;
     void* file_type_context;
-    void* file_signature_context;
+    FileHash* file_hash;
     FileSegments* file_segments;
     FileInspect* inspector;
     FileConfig*  config;
@@ -31,9 +31,18 @@
 
 #include "file_mempool.h"
 
-#include "log/messages.h"
+#include <cassert>
+
+#include "main/thread.h"
 #include "utils/util.h"
 
+#ifdef UNIT_TEST
+#include <thread>
+#include <vector>
+
+#include "catch/snort_catch.h"
+#endif
+
 using namespace snort;
 
 /*This magic is used for double free detection*/
@@ -41,66 +50,71 @@ using namespace snort;
 #define FREE_MAGIC    0x2525252525252525
 typedef uint64_t MagicType;
 
+// a free object starts with the magic followed by the next free object
+struct FreeObject
+{
+    MagicType magic;
+    FreeObject* next;
+};
 
-void FileMemPool::free_pools()
+struct FileMemShard
 {
-    if (datapool != nullptr)
-    {
-        snort_free(datapool);
-        datapool = nullptr;
-    }
+    // touched only by the owning thread
+    FreeObject* local = nullptr;
 
-    cbuffer_free(free_list);
-    cbuffer_free(released_list);
-}
+    // objects of this shard freed by other threads
+    std::atomic<FreeObject*> remote { nullptr };
+
+    // read for stats only
+    std::atomic<uint64_t> local_count { 0 };
+    std::atomic<uint64_t> used { 0 };
+
+    // keep the shards of different threads apart
+    uint8_t pad[32];
+};
+
+struct ShardOwner
+{
+    const FileMemPool* pool;
+    FileMemShard* shard;
+};
+
+static THREAD_LOCAL ShardOwner owner = { nullptr, nullptr };
 
 /*
  * Purpose: initialize a FileMemPool object and allocate memory for it
  * Args:
  *   num_objects - number of items in this pool
  *   obj_size    - size of the items
+ *   num_shards  - number of threads allocating from this pool
  */
 
-FileMemPool::FileMemPool(uint64_t num_objects, size_t o_size)
+FileMemPool::FileMemPool(uint64_t num_objects, size_t o_size, unsigned n)
 {
-    unsigned int i;
-
-    if ((num_objects < 1) || (o_size < 1))
+    if ((num_objects < 1) || (o_size < 1) || (n < 1))
         return;
 
-    obj_size = o_size;
+    // free objects must hold the free list links
+    obj_size = o_size < sizeof(FreeObject) ? sizeof(FreeObject) : o_size;
 
     // this is the basis pool that represents all the *data pointers in the list
-    datapool = (void**)snort_calloc(num_objects, obj_size);
+    datapool = snort_calloc(num_objects, obj_size);
 
-    /* sets up the memory list */
-    free_list = cbuffer_init(num_objects);
-    if (!free_list)
-    {
-        free_pools();
-        return;
-    }
-
-    released_list = cbuffer_init(num_objects);
-    if (!released_list)
-    {
-        free_pools();
-        return;
-    }
+    num_shards = n;
+    per_shard = (num_objects + n - 1) / n;
+    shards = new FileMemShard[n];
 
-    total = 0;
-    for (i=0; i<num_objects; i++)
+    for (uint64_t i = num_objects; i-- > 0; )
     {
-        void* data = ((char*)datapool) + (i * obj_size);
+        FreeObject* obj = (FreeObject*)((char*)datapool + (i * obj_size));
+        FileMemShard* s = &shards[i / per_shard];
 
-        if (cbuffer_write(free_list,  data))
-        {
-            free_pools();
-            return;
-        }
-        *(MagicType*)data = FREE_MAGIC;
-        total++;
+        obj->magic = FREE_MAGIC;
+        obj->next = s->local;
+        s->local = obj;
+        s->local_count++;
     }
+    total = num_objects;
 }
 
 /*
@@ -109,7 +123,91 @@ FileMemPool::FileMemPool(uint64_t num_objects, size_t o_size)
  */
 FileMemPool::~FileMemPool()
 {
-    free_pools();
+    if (owner.pool == this)
+        owner = { nullptr, nullptr };
+
+    delete[] shards;
+    snort_free(datapool);
+}
+
+void FileMemPool::tinit(unsigned shard)
+{
+    if (shard >= num_shards)
+        return;
+
+    owner = { this, &shards[shard] };
+}
+
+void FileMemPool::tterm()
+{
+    FileMemShard* s = get_shard();
+
+    if (!s)
+        return;
+
+    while (s->local)
+    {
+        FreeObject* obj = s->local;
+        s->local = obj->next;
+        push_remote(get_home(obj), obj);
+    }
+    s->local_count = 0;
+    owner = { nullptr, nullptr };
+}
+
+inline FileMemShard* FileMemPool::get_shard()
+{ return owner.pool == this ? owner.shard : nullptr; }
+
+// the shard an object was carved from or nullptr if it isn't from this pool
+FileMemShard* FileMemPool::get_home(void* obj)
+{
+    if (obj < datapool)
+        return nullptr;
+
+    uint64_t offset = (char*)obj - (char*)datapool;
+
+    if ((offset % obj_size) or (offset / obj_size >= total))
+        return nullptr;
+
+    return &shards[offset / obj_size / per_shard];
+}
+
+void FileMemPool::push_remote(FileMemShard* s, void* obj)
+{
+    FreeObject* f = (FreeObject*)obj;
+    f->next = s->remote.load(std::memory_order_relaxed);
+
+    while (!s->remote.compare_exchange_weak(f->next, f,
+        std::memory_order_release, std::memory_order_relaxed));
+}
+
+// pop from the owner's list, refilling it from the objects released by
+// other threads or, failing that, from the releases of other shards
+void* FileMemPool::take(FileMemShard* s)
+{
+    for (unsigned i = 0; !s->local and i < num_shards; ++i)
+    {
+        FileMemShard* from = &shards[(s - shards + i) % num_shards];
+        s->local = from->remote.exchange(nullptr, std::memory_order_acquire);
+
+        uint64_t n = 0;
+
+        for (FreeObject* f = s->local; f; f = f->next)
+            ++n;
+
+        s->local_count.store(n, std::memory_order_relaxed);
+    }
+
+    FreeObject* obj = s->local;
+
+    if (!obj)
+        return nullptr;
+
+    s->local = obj->next;
+    s->local_count.store(s->local_count.load(std::memory_order_relaxed) - 1,
+        std::memory_order_relaxed);
+
+    return obj;
 }
 
 /*
@@ -123,53 +221,88 @@ FileMemPool::~FileMemPool()
 
 void* FileMemPool::m_alloc()
 {
-    void* b = nullptr;
+    if (!shards)
+        return nullptr;
+
+    FreeObject* obj = nullptr;
+    FileMemShard* s = get_shard();
 
-    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (s)
+        obj = (FreeObject*)take(s);
 
-    if (cbuffer_read(free_list, &b))
+    else
     {
-        if (cbuffer_read(released_list, &b))
+        // without a shard of its own, borrow one object from a released list
+        for (unsigned i = 0; !obj and i < num_shards; ++i)
         {
-            return nullptr;
+            obj = shards[i].remote.exchange(nullptr, std::memory_order_acquire);
+
+            if (obj and obj->next)
+            {
+                FreeObject* first = obj->next;
+                FreeObject* last = first;
+
+                while (last->next)
+                    last = last->next;
+
+                last->next = shards[i].remote.load(std::memory_order_relaxed);
+
+                while (!shards[i].remote.compare_exchange_weak(last->next, first,
+                    std::memory_order_release, std::memory_order_relaxed));
+            }
         }
     }
 
-    return b;
+    if (!obj)
+        return nullptr;
+
+    obj->magic = 0;
+    get_home(obj)->used.fetch_add(1, std::memory_order_relaxed);
+
+    return obj;
 }
 
 /*
- * Free a new object from the buffer
- * We use circular buffer to synchronize one reader and one writer
+ * Free an object back to the pool.  It goes on the calling thread's free
+ * list if the thread owns the object's shard, else on the released list
+ * of that shard.
  */
-int FileMemPool::remove(CircularBuffer* cb, void* obj)
+int FileMemPool::remove(void* obj)
 {
     if (obj == nullptr)
         return FILE_MEM_FAIL;
 
-    if (cbuffer_write(cb, obj))
-    {
+    FileMemShard* home = get_home(obj);
+
+    if (!home)
         return FILE_MEM_FAIL;
-    }
 
-    if (*(MagicType*)obj == FREE_MAGIC)
+    FreeObject* f = (FreeObject*)obj;
+
+    if (f->magic == FREE_MAGIC)
     {
         return FILE_MEM_FAIL;
     }
 
-    *(MagicType*)obj = FREE_MAGIC;
+    f->magic = FREE_MAGIC;
+    home->used.fetch_sub(1, std::memory_order_relaxed);
+
+    if (get_shard() == home)
+    {
+        f->next = home->local;
+        home->local = f;
+        home->local_count.store(home->local_count.load(std::memory_order_relaxed) + 1,
+            std::memory_order_relaxed);
+    }
+    else
+        push_remote(home, f);
 
     return FILE_MEM_SUCCESS;
 }
 
 int FileMemPool::m_free(void* obj)
 {
-    std::lock_guard<std::mutex> lock(pool_mutex);
-
-    int ret = remove(free_list, obj);
-
-
-    return ret;
+    return remove(obj);
 }
 
 /*
@@ -181,31 +314,107 @@ int FileMemPool::m_free(void* obj)
 
 int FileMemPool::m_release(void* obj)
 {
-    std::lock_guard<std::mutex> lock(pool_mutex);
-
-    /*A writer that might from different thread*/
-    int ret = remove(released_list, obj);
-
-
-    return ret;
+    return remove(obj);
 }
 
 /* Returns number of elements allocated in current buffer*/
 uint64_t FileMemPool::allocated()
 {
-    uint64_t total_freed = released() + freed();
-    return (total - total_freed);
+    uint64_t n = 0;
+
+    for (unsigned i = 0; i < num_shards; ++i)
+        n += shards[i].used.load(std::memory_order_relaxed);
+
+    return n;
 }
 
 /* Returns number of elements freed in current buffer*/
 uint64_t FileMemPool::freed()
 {
-    return (cbuffer_used(free_list));
+    uint64_t n = 0;
+
+    for (unsigned i = 0; i < num_shards; ++i)
+        n += shards[i].local_count.load(std::memory_order_relaxed);
+
+    return n;
 }
 
 /* Returns number of elements released in current buffer*/
 uint64_t FileMemPool::released()
 {
-    return (cbuffer_used(released_list));
+    uint64_t used = allocated() + freed();
+    return (total > used ? total - used : 0);
+}
+
+//--------------------------------------------------------------------------
+// unit tests
+//--------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+TEST_CASE ("file mempool alloc and free", "[file_mempool]")
+{
+    FileMemPool pool(4, 64);
+    pool.tinit(0);
+
+    std::vector<void*> objs;
+
+    for (unsigned i = 0; i < 4; ++i)
+        objs.emplace_back(pool.m_alloc());
+
+    CHECK(pool.m_alloc() == nullptr);
+    CHECK(pool.allocated() == 4);
+
+    CHECK(pool.m_free(objs[0]) == FILE_MEM_SUCCESS);
+    CHECK(pool.m_free(objs[0]) == FILE_MEM_FAIL);
+    CHECK(pool.m_free((char*)objs[1] + 1) == FILE_MEM_FAIL);
+
+    CHECK(pool.allocated() == 3);
+    CHECK(pool.freed() == 1);
+    CHECK(pool.m_alloc() == objs[0]);
+
+    for (auto* obj : objs)
+        CHECK(pool.m_free(obj) == FILE_MEM_SUCCESS);
+
+    CHECK(pool.freed() == 4);
+    pool.tterm();
 }
 
+TEST_CASE ("file mempool release from other threads", "[file_mempool]")
+{
+    FileMemPool pool(64, 64, 2);
+    std::vector<void*> objs[2];
+
+    auto alloc = [&](unsigned shard)
+    {
+        pool.tinit(shard);
+
+        // takes the other shard's released objects when its own run out
+        for (void* obj = pool.m_alloc(); obj; obj = pool.m_alloc())
+            objs[shard].emplace_back(obj);
+    };
+
+    std::thread t0(alloc, 0);
+    t0.join();
+    CHECK(objs[0].size() == 32);
+
+    std::thread storer([&]
+    {
+        for (auto* obj : objs[0])
+            CHECK(pool.m_release(obj) == FILE_MEM_SUCCESS);
+    });
+    storer.join();
+
+    CHECK(pool.released() == 32);
+
+    std::thread t1(alloc, 1);
+    t1.join();
+    CHECK(objs[1].size() == 64);
+    CHECK(pool.allocated() == 64);
+
+    for (auto* obj : objs[1])
+        CHECK(pool.m_release(obj) == FILE_MEM_SUCCESS);
+
+    CHECK(pool.released() == 64);
+    CHECK(pool.m_alloc() != nullptr);
+}
+#endif
@@ -23,45 +23,58 @@
 #define FILE_MEMPOOL_H
 
 //  This mempool implementation has very efficient alloc/free operations.
-//  In addition, it provides thread-safe alloc/free for one allocation/free
-//  thread and one release thread.
+//  The pool is split into one shard per packet thread.  A packet thread
+//  allocates from and frees to the free list of its own shard without any
+//  locking.  Objects freed by other threads, such as the file storers, are
+//  pushed onto a lock-free list of the shard owning the memory, which the
+//  owner takes over in one exchange when its own list runs out.  A thread
+//  may also take over the lists of other shards before failing.
 //  One more bonus: Double free detection is also added into this library
-//  This is a thread safe version of memory pool for one writer and one reader thread
 
-#include <mutex>
-
-#include "circular_buffer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 
 #define FILE_MEM_SUCCESS    0  // FIXIT-RC use bool
 #define FILE_MEM_FAIL      (-1)
 
+struct FileMemShard;
+
 class FileMemPool
 {
 public:
 
-    FileMemPool(uint64_t num_objects, size_t obj_size);
+    FileMemPool(uint64_t num_objects, size_t obj_size, unsigned num_shards = 1);
     ~FileMemPool();
 
+    // Make the calling thread the owner of the given shard; threads that
+    // don't own a shard can still allocate and free, just more slowly
+    void tinit(unsigned shard);
+
+    // Give the objects in the calling thread's free list back to their
+    // shards so other threads can use them
+    void tterm();
+
     // Allocate a new object from the FileMemPool
     // Note: Memory block will not be zeroed for performance
     // Returns: a pointer to the FileMemPool object on success, nullptr on failure
     void* m_alloc();
 
-    // This must be called by the same thread calling file_mempool_alloc()
+    // This should be called by the thread that allocated the object
     // Return: FILE_MEM_SUCCESS or FILE_MEM_FAIL
     int m_free(void* obj);
 
-    // This can be called by a different thread calling file_mempool_alloc()
+    // This can be called by any thread
     // Return: FILE_MEM_SUCCESS or FILE_MEM_FAIL
     int m_release(void* obj);
 
     //Returns number of elements allocated
     uint64_t allocated();
 
-    // Returns number of elements freed in current buffer
+    // Returns number of elements in the free lists of the shard owners
     uint64_t freed();
 
-    // Returns number of elements released in current buffer
+    // Returns number of elements released by other threads
     uint64_t released();
 
     // Returns total number of elements in current buffer
@@ -69,16 +82,18 @@ public:
 
 private:
 
-    void free_pools();
-    int remove(CircularBuffer* cb, void* obj);
+    FileMemShard* get_shard();
+    FileMemShard* get_home(void* obj);
+    int remove(void* obj);
+    void push_remote(FileMemShard*, void* obj);
+    void* take(FileMemShard*);
 
-    void** datapool = nullptr; /* memory buffer */
+    void* datapool = nullptr; /* memory buffer */
     uint64_t total = 0;
-    CircularBuffer* free_list = nullptr;
-    CircularBuffer* released_list = nullptr;
+    uint64_t per_shard = 0;
+    FileMemShard* shards = nullptr;
+    unsigned num_shards = 0;
     size_t obj_size = 0;
-    std::mutex pool_mutex;
 };
 
 #endif
-
@@ -111,12 +111,21 @@ static const Parameter file_id_params[] =
     { "capture_block_size", Parameter::PT_INT, "8:max53", "32768",
       "file capture block size in bytes" },
 
+    { "capture_storers", Parameter::PT_INT, "1:64", "1",
+      "number of threads storing captured files to disk" },
+
     { "max_files_cached", Parameter::PT_INT, "8:max53", "65536",
       "maximal number of files cached in memory" },
 
     { "max_files_per_flow", Parameter::PT_INT, "1:max53", "128",
       "maximal number of files able to be concurrently processed per flow" },
 
+    { "hash_threads", Parameter::PT_INT, "0:64", "0",
+      "number of threads computing file signatures (0 computes them on the packet threads)" },
+
+    { "hash_memcap", Parameter::PT_INT, "1:max53", "16",
+      "memcap in megabytes for file data waiting for the hash threads" },
+
     { "show_data_depth", Parameter::PT_INT, "0:max53", "100",
       "print this many octets" },
 
@@ -150,6 +159,10 @@ static const Parameter file_id_params[] =
     { "decompress_buffer_size", Parameter::PT_INT, "1024:max31", "100000",
       "file decompression buffer size" },
 
+    { "decompress_flow_budget", Parameter::PT_INT, "0:max53", "0",
+      "maximum bytes inflated from all files of a flow, not counting data passed through "
+      "(0 = unlimited)" },
+
     { "qp_decode_depth", Parameter::PT_INT, "-1:65535", "-1",
       "Quoted Printable decoding depth (-1 no limit)" },
 
@@ -166,6 +179,9 @@ static const PegInfo file_pegs[] =
     { CountType::SUM, "cache_failures", "number of file cache add failures" },
     { CountType::SUM, "files_not_processed", "number of files not processed due to per-flow limit" },
     { CountType::MAX, "max_concurrent_files", "maximum files processed concurrently on a flow" },
+    { CountType::SUM, "hash_offloads", "number of file segments queued to the hash threads" },
+    { CountType::SUM, "hash_offload_bytes", "number of file bytes queued to the hash threads" },
+    { CountType::SUM, "hash_waits", "number of times a packet thread waited for the hash threads" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -241,12 +257,21 @@ bool FileIdModule::set(const char*, Value& v, SnortConfig*)
     else if ( v.is("capture_block_size") )
         fc->capture_block_size = v.get_int64();
 
+    else if ( v.is("capture_storers") )
+        fc->capture_storers = v.get_uint8();
+
     else if ( v.is("max_files_cached") )
         fc->max_files_cached = v.get_int64();
 
     else if ( v.is("max_files_per_flow") )
         fc->max_files_per_flow = v.get_uint64();
 
+    else if ( v.is("hash_threads") )
+        fc->hash_threads = v.get_uint8();
+
+    else if ( v.is("hash_memcap") )
+        fc->hash_memcap = v.get_int64();
+
     else if ( v.is("show_data_depth") )
         fc->show_data_depth = v.get_int64();
 
@@ -271,6 +296,9 @@ bool FileIdModule::set(const char*, Value& v, SnortConfig*)
     else if ( v.is("decompress_buffer_size") )
         FileService::decode_conf.set_decompress_buffer_size(v.get_uint32());
 
+    else if ( v.is("decompress_flow_budget") )
+        FileService::decode_conf.set_decompress_flow_budget(v.get_uint64());
+
     else if (v.is("b64_decode_depth"))
     {
         int32_t value = v.get_int32();
@@ -370,6 +398,9 @@ bool FileIdModule::end(const char* fqn, int idx, SnortConfig*)
 
 void FileIdModule::load_config(FileConfig*& dst)
 {
+    if (fc)
+        fc->compile_file_rules();
+
     dst = fc;
     fc = nullptr;
 }
@@ -29,6 +29,7 @@
 
 #include "file_service.h"
 
+#include "decompress/file_decomp.h"
 #include "log/messages.h"
 #include "main/snort_config.h"
 #include "mime/file_mime_process.h"
@@ -37,6 +38,7 @@
 #include "file_cache.h"
 #include "file_capture.h"
 #include "file_flows.h"
+#include "file_hash.h"
 #include "file_stats.h"
 
 using namespace snort;
@@ -53,6 +55,9 @@ DecodeConfig FileService::decode_conf;
 static int64_t max_files_cached = 0;
 static int64_t capture_memcap = 0;
 static int64_t capture_block_size = 0;
+static unsigned capture_storers = 0;
+static unsigned hash_threads = 0;
+static int64_t hash_memcap = 0;
 
 void FileService::init()
 {
@@ -80,9 +85,17 @@ void FileService::post_init(const SnortConfig* sc)
 
     if (file_capture_enabled)
     {
-        FileCapture::init(conf->capture_memcap, conf->capture_block_size);
+        FileCapture::init(conf->capture_memcap, conf->capture_block_size, conf->capture_storers);
         capture_memcap = conf->capture_memcap;
         capture_block_size = conf->capture_block_size;
+        capture_storers = conf->capture_storers;
+    }
+
+    if (file_signature_enabled and conf->hash_threads)
+    {
+        FileHash::start(conf->hash_threads, conf->hash_memcap * 1024 * 1024);
+        hash_threads = conf->hash_threads;
+        hash_memcap = conf->hash_memcap;
     }
 }
 
@@ -96,12 +109,20 @@ void FileService::verify_reload(const SnortConfig* sc)
     if (max_files_cached != conf->max_files_cached)
         ReloadError("Changing file_id.max_files_cached requires a restart.\n");
 
+    if (file_signature_enabled and hash_threads != conf->hash_threads)
+        ReloadError("Changing file_id.hash_threads requires a restart.\n");
+
+    if (file_signature_enabled and hash_threads and hash_memcap != conf->hash_memcap)
+        ReloadError("Changing file_id.hash_memcap requires a restart.\n");
+
     if (file_capture_enabled)
     {
         if (capture_memcap != conf->capture_memcap)
             ReloadError("Changing file_id.capture_memcap requires a restart.\n");
         if (capture_block_size != conf->capture_block_size)
             ReloadError("Changing file_id.capture_block_size requires a restart.\n");
+        if (capture_storers != conf->capture_storers)
+            ReloadError("Changing file_id.capture_storers requires a restart.\n");
     }
 }
 
@@ -110,15 +131,23 @@ void FileService::close()
     if (file_cache)
         delete file_cache;
 
+    FileHash::stop();
     MimeSession::exit();
     FileCapture::exit();
 }
 
 void FileService::thread_init()
-{ file_stats_init(); }
+{
+    file_stats_init();
+    FileCapture::thread_init();
+}
 
 void FileService::thread_term()
-{ file_stats_term(); }
+{
+    File_Decomp_Thread_Term();
+    FileCapture::thread_term();
+    file_stats_term();
+}
 
 void FileService::enable_file_type()
 {
@@ -0,0 +1,164 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// file_hash_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <openssl/sha.h>
+
+#include <cstring>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "file_api/file_hash.h"
+#include "file_api/file_stats.h"
+
+THREAD_LOCAL FileCounts file_counts;
+
+#ifdef CATCH_TEST_BUILD
+
+static std::vector<uint8_t> make_data(size_t len, unsigned seed)
+{
+    std::vector<uint8_t> data(len);
+
+    for ( size_t i = 0; i < len; ++i )
+        data[i] = (uint8_t)(i * 31 + seed);
+
+    return data;
+}
+
+static std::vector<uint8_t> expected(const std::vector<uint8_t>& data, size_t len)
+{
+    std::vector<uint8_t> digest(SHA256_DIGEST_LENGTH);
+    SHA256(data.data(), len, digest.data());
+    return digest;
+}
+
+static std::vector<uint8_t> digest_of(FileHash& hash)
+{
+    std::vector<uint8_t> digest(SHA256_DIGEST_LENGTH);
+    hash.get_digest(digest.data());
+    return digest;
+}
+
+// odd sized segments so they end at various offsets
+static size_t segment_len(unsigned i)
+{ return 1 + (i * 977) % 4096; }
+
+TEST_CASE("file hash without hash threads", "[file_hash]")
+{
+    std::vector<uint8_t> data = make_data(100000, 1);
+    FileHash hash;
+    size_t done = 0;
+
+    for ( unsigned i = 0; done + segment_len(i) <= data.size(); done += segment_len(i++) )
+        hash.queue(data.data() + done, segment_len(i));
+
+    CHECK(digest_of(hash) == expected(data, done));
+}
+
+TEST_CASE("file hash keeps the order of queued segments", "[file_hash]")
+{
+    FileHash::start(3, 1 << 20);
+    PegCount offloads = file_counts.hash_offloads;
+
+    std::vector<std::vector<uint8_t>> data;
+    std::vector<FileHash*> hashes;
+    std::vector<size_t> done;
+
+    for ( unsigned f = 0; f < 8; ++f )
+    {
+        data.emplace_back(make_data(200000, f));
+        hashes.emplace_back(new FileHash);
+        done.emplace_back(0);
+    }
+
+    // interleave the files as packets of many flows would
+    for ( unsigned i = 0; i < 40; ++i )
+    {
+        for ( unsigned f = 0; f < hashes.size(); ++f )
+        {
+            size_t len = segment_len(i + f);
+            hashes[f]->queue(data[f].data() + done[f], len);
+            done[f] += len;
+        }
+    }
+    CHECK(file_counts.hash_offloads > offloads);
+
+    // the last segment is hashed here, after the queued ones
+    for ( unsigned f = 0; f < hashes.size(); ++f )
+    {
+        hashes[f]->update(data[f].data() + done[f], 100);
+        done[f] += 100;
+
+        CHECK(digest_of(*hashes[f]) == expected(data[f], done[f]));
+        delete hashes[f];
+    }
+
+    FileHash::stop();
+}
+
+TEST_CASE("file hash digest can be taken while more data follows", "[file_hash]")
+{
+    FileHash::start(2, 1 << 20);
+
+    std::vector<uint8_t> data = make_data(10000, 7);
+    FileHash hash;
+
+    hash.queue(data.data(), 4000);
+    CHECK(digest_of(hash) == expected(data, 4000));
+
+    hash.queue(data.data() + 4000, 6000);
+    CHECK(digest_of(hash) == expected(data, 10000));
+
+    // starting over drops what was queued before
+    hash.queue(data.data(), 3000);
+    hash.reset();
+    hash.queue(data.data(), 5000);
+    CHECK(digest_of(hash) == expected(data, 5000));
+
+    FileHash::stop();
+}
+
+TEST_CASE("file hash falls back to the packet thread over the memcap", "[file_hash]")
+{
+    FileHash::start(2, 1000);
+    PegCount offloads = file_counts.hash_offloads;
+
+    std::vector<uint8_t> data = make_data(20000, 3);
+    FileHash hash;
+
+    // too big for the memcap
+    hash.queue(data.data(), 5000);
+    CHECK(file_counts.hash_offloads == offloads);
+
+    // these fit
+    hash.queue(data.data() + 5000, 500);
+    hash.queue(data.data() + 5500, 500);
+    hash.queue(data.data() + 6000, 14000);
+
+    CHECK(file_counts.hash_offloads <= offloads + 2);
+    CHECK(digest_of(hash) == expected(data, 20000));
+
+    FileHash::stop();
+}
+
+#endif
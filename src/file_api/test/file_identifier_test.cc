@@ -0,0 +1,246 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// file_identifier_test.cc
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "file_api/file_identifier.h"
+#include "log/messages.h"
+#include "main/snort_config.h"
+
+using namespace snort;
+
+namespace snort
+{
+const SnortConfig* SnortConfig::get_conf() { return nullptr; }
+void ParseError(const char*, ...) { }
+void ParseWarning(WarningGroup, const char*, ...) { }
+}
+
+struct Magic
+{
+    uint32_t id;
+    std::vector<std::pair<uint32_t, std::string>> contents;
+};
+
+// a sample of the default file magic rules
+static const Magic magics[] =
+{
+    { 1, { { 512, std::string("\x09\x08\x10\x00\x00\x06\x05\x00", 8) } } },
+    { 2, { { 257, std::string("ustar\x00", 6) } } },
+    { 3, { { 257, "ustar " } } },
+    { 4, { { 4, "free" } } },
+    { 5, { { 4, "moov" } } },
+    { 8, { { 4, "ftyp" } } },
+    { 9, { { 2, "-lh" } } },
+    { 10, { { 32769, "CD001" } } },
+    { 14, { { 4, "\x11\xaf" }, { 8, "\x40\x01" }, { 10, std::string("\xc8\x00", 2) },
+        { 20, std::string("\x00\x00", 2) }, { 42, std::string(8, '\0') } } },
+    { 21, { { 0, "MZ" } } },
+    { 22, { { 0, "%PDF" } } },
+    { 23, { { 0, "{\\rt" } } },
+    { 24, { { 0, "RIFF" } } },
+    { 26, { { 0, "MSCF" } } },
+    { 27, { { 0, "\xd0\xcf\x11\xe0\xa1\xb1\x1a\xe1" } } },
+    { 29, { { 0, "PK\x03\x04" } } },
+    { 30, { { 0, std::string("Rar!\x1a\x07\x00", 7) } } },
+    { 31, { { 0, "GIF87a" } } },
+    { 32, { { 0, "GIF89a" } } },
+    { 33, { { 0, "\x89PNG\x0d\x0a\x1a\x0a" } } },
+    { 34, { { 0, "\xff\xd8\xff\xe0" } } },
+    { 35, { { 0, "\x7f""ELF" } } },
+};
+
+static void load_rules(FileIdentifier& fi)
+{
+    for ( const auto& m : magics )
+    {
+        FileMagicRule rule;
+        rule.id = m.id;
+        rule.type = std::to_string(m.id);
+
+        for ( const auto& c : m.contents )
+        {
+            FileMagicData magic;
+            magic.offset = c.first;
+            magic.content = c.second;
+            rule.file_magics.emplace_back(magic);
+        }
+        fi.insert_file_rule(rule);
+    }
+    fi.compile();
+}
+
+struct Sample
+{
+    std::string data;
+    uint32_t id;
+};
+
+// headers of the file type depth with the magic of each rule and some
+// with none
+static std::vector<Sample> make_samples(unsigned n, unsigned size)
+{
+    std::mt19937 rng(7);
+    std::vector<Sample> samples;
+
+    for ( unsigned i = 0; i < n; ++i )
+    {
+        Sample s;
+        s.data.resize(size);
+
+        for ( auto& c : s.data )
+            c = 'a' + rng() % 26;
+
+        unsigned r = rng() % (sizeof(magics) / sizeof(magics[0]) + 4);
+        s.id = SNORT_FILE_TYPE_UNKNOWN;
+
+        if ( r < sizeof(magics) / sizeof(magics[0]) )
+        {
+            s.id = magics[r].id;
+
+            for ( const auto& c : magics[r].contents )
+            {
+                if ( c.first + c.second.size() > size )
+                    s.id = SNORT_FILE_TYPE_UNKNOWN;
+                else
+                    s.data.replace(c.first, c.second.size(), c.second);
+            }
+        }
+        samples.emplace_back(s);
+    }
+    return samples;
+}
+
+static uint32_t find(FileIdentifier& fi, const std::string& data, unsigned chunk)
+{
+    void* context = nullptr;
+    uint32_t id = SNORT_FILE_TYPE_CONTINUE;
+
+    for ( unsigned off = 0; off < data.size() and id == SNORT_FILE_TYPE_CONTINUE; off += chunk )
+    {
+        unsigned len = std::min(chunk, (unsigned)data.size() - off);
+        id = fi.find_file_type_id((const uint8_t*)data.data() + off, len, off, &context);
+
+        if ( id != SNORT_FILE_TYPE_CONTINUE and context )
+        {
+            // keep going for a more specific type like file processing does
+            uint32_t more = id;
+
+            while ( context and (off += chunk) < data.size() )
+            {
+                len = std::min(chunk, (unsigned)data.size() - off);
+                more = fi.find_file_type_id((const uint8_t*)data.data() + off, len, off, &context);
+            }
+            if ( more != SNORT_FILE_TYPE_CONTINUE and more != SNORT_FILE_TYPE_UNKNOWN )
+                id = more;
+        }
+    }
+
+    // like the type depth being reached
+    if ( id == SNORT_FILE_TYPE_CONTINUE )
+        id = SNORT_FILE_TYPE_UNKNOWN;
+
+    return id;
+}
+
+#ifdef CATCH_TEST_BUILD
+
+TEST_CASE("compiled magic identifies sample headers", "[file_identifier]")
+{
+    FileIdentifier fi;
+    load_rules(fi);
+
+    for ( const auto& s : make_samples(2000, 1460) )
+    {
+        CHECK(find(fi, s.data, s.data.size()) == s.id);
+        CHECK(find(fi, s.data, 100) == s.id);
+        CHECK(find(fi, s.data, 1) == s.id);
+    }
+}
+
+TEST_CASE("compiled magic continues past the data", "[file_identifier]")
+{
+    FileIdentifier fi;
+    load_rules(fi);
+
+    std::string data(40000, 'x');
+    data.replace(32769, 5, "CD001");
+
+    void* context = nullptr;
+    CHECK(fi.find_file_type_id((const uint8_t*)data.data(), 1460, 0, &context)
+        == SNORT_FILE_TYPE_CONTINUE);
+    CHECK(context);
+
+    CHECK(fi.find_file_type_id((const uint8_t*)data.data() + 1460, data.size() - 1460, 1460,
+        &context) == 10);
+    CHECK(!context);
+
+    // skipping the examined offset ends the search
+    context = nullptr;
+    CHECK(fi.find_file_type_id((const uint8_t*)data.data(), 1460, 0, &context)
+        == SNORT_FILE_TYPE_CONTINUE);
+    CHECK(fi.find_file_type_id((const uint8_t*)data.data() + 34000, 100, 34000, &context)
+        == SNORT_FILE_TYPE_UNKNOWN);
+}
+
+TEST_CASE("compiled magic is smaller than the trie", "[file_identifier]")
+{
+    FileIdentifier fi;
+    load_rules(fi);
+
+    CHECK(fi.memory_usage() > 0);
+    CHECK(fi.memory_usage() < 64 * 1024);
+}
+
+#endif // CATCH_TEST_BUILD
+
+#ifdef BENCHMARK_TEST
+
+TEST_CASE("file type id over sample headers", "[file_identifier]")
+{
+    FileIdentifier fi;
+    load_rules(fi);
+
+    std::vector<Sample> samples = make_samples(1000, 1460);
+
+    BENCHMARK("find_file_type_id")
+    {
+        unsigned found = 0;
+
+        for ( const auto& s : samples )
+        {
+            void* context = nullptr;
+            found += fi.find_file_type_id((const uint8_t*)s.data.data(), s.data.size(), 0,
+                &context) != SNORT_FILE_TYPE_UNKNOWN;
+        }
+        return found;
+    };
+}
+
+#endif // BENCHMARK_TEST
+
@@ -35,6 +35,8 @@ using namespace snort;
 THREAD_LOCAL ProfileStats snort::detectionFilterPerfStats;
 
 XHash* detection_filter_hash = nullptr;
+static THREAD_LOCAL XHash* detection_filter_shard = nullptr;
+static unsigned detection_filter_sync = 1;
 
 DetectionFilterConfig* DetectionFilterConfigNew()
 {
@@ -42,6 +44,7 @@ DetectionFilterConfig* DetectionFilterConfigNew()
         (DetectionFilterConfig*)snort_calloc(sizeof(DetectionFilterConfig));
 
     df->memcap = 1024 * 1024;
+    df->sync = 1;
     df->enabled = 1;
 
     return df;
@@ -62,8 +65,8 @@ int detection_filter_test(void* pv, const SfIp* sip, const SfIp* dip, long curti
     if (pv == nullptr)
         return 0;
 
-    return sfthd_test_rule(detection_filter_hash, (THD_NODE*)pv,
-        sip, dip, curtime, get_ips_policy()->policy_id);
+    return sfthd_test_rule_shard(detection_filter_hash, detection_filter_shard,
+        detection_filter_sync, (THD_NODE*)pv, sip, dip, curtime, get_ips_policy()->policy_id);
 }
 
 THD_NODE* detection_filter_create(DetectionFilterConfig* df_config, THDX_STRUCT* thdx)
@@ -87,6 +90,8 @@ void detection_filter_init(DetectionFilterConfig* df_config)
 
     if ( !detection_filter_hash )
         detection_filter_hash = sfthd_local_new(df_config->memcap);
+
+    detection_filter_sync = df_config->sync;
 }
 
 void detection_filter_term()
@@ -98,3 +103,16 @@ void detection_filter_term()
     detection_filter_hash = nullptr;
 }
 
+void detection_filter_tinit(DetectionFilterConfig* df_config)
+{
+    if ( !df_config->enabled or df_config->sync <= 1 )
+        return;
+
+    detection_filter_shard = sfthd_shard_new(df_config->memcap);
+}
+
+void detection_filter_tterm()
+{
+    delete detection_filter_shard;
+    detection_filter_shard = nullptr;
+}
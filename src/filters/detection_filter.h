@@ -42,6 +42,7 @@ struct SfIp;
 struct DetectionFilterConfig
 {
     unsigned memcap;
+    unsigned sync;
     int count;
     int enabled;
 };
@@ -52,6 +53,9 @@ void DetectionFilterConfigFree(DetectionFilterConfig*);
 void detection_filter_init(DetectionFilterConfig*);
 void detection_filter_term();
 
+void detection_filter_tinit(DetectionFilterConfig*);
+void detection_filter_tterm();
+
 int detection_filter_test(void*, const snort::SfIp* sip, const snort::SfIp* dip, long curtime);
 struct THD_NODE* detection_filter_create(DetectionFilterConfig*, struct THDX_STRUCT*);
 
@@ -34,6 +34,7 @@
 #include "sfthd.h"
 
 #include <cassert>
+#include <mutex>
 
 #include "hash/ghash.h"
 #include "hash/hash_defs.h"
@@ -51,6 +52,9 @@ using namespace snort;
 
 THREAD_LOCAL EventFilterStats event_filter_stats;
 
+// guards rule hashes, the only tables shared by the packet threads
+static std::mutex sfthd_hash_mutex;
+
 XHash* sfthd_new_hash(unsigned nbytes, size_t key, size_t data)
 {
     size_t size = key + data;
@@ -105,6 +109,11 @@ XHash* sfthd_global_new(unsigned bytes)
     return global_hash;
 }
 
+XHash* sfthd_shard_new(unsigned bytes)
+{
+    return sfthd_new_hash(bytes, sizeof(THD_IP_NODE_KEY), sizeof(THD_IP_SHARD_NODE));
+}
+
 THD_STRUCT* sfthd_new(unsigned lbytes, unsigned gbytes)
 {
     THD_STRUCT* thd;
@@ -629,11 +638,88 @@ int sfthd_test_rule(XHash* rule_hash, THD_NODE* sfthd_node,
     if ((rule_hash == nullptr) || (sfthd_node == nullptr))
         return 0;
 
+    std::lock_guard<std::mutex> lock(sfthd_hash_mutex);
     int status = sfthd_test_local(rule_hash, sfthd_node, sip, dip, curtime, policy_id);
 
     return (status < -1) ? 1 : status;
 }
 
+/*
+ *  Fold the events a thread counted for one node into the shared table and
+ *  refresh the thread's copy. The window rolls over as in the detect test,
+ *  with all pending events attributed to curtime.
+ */
+static void sfthd_merge_shard(XHash* rule_hash, THD_NODE* sfthd_node,
+    const THD_IP_NODE_KEY& key, THD_IP_SHARD_NODE* shard_node, time_t curtime)
+{
+    THD_IP_NODE data;
+    data.count = 0;
+    data.prev = 0;
+    data.tstart = data.tlast = curtime;
+
+    std::lock_guard<std::mutex> lock(sfthd_hash_mutex);
+
+    int status = rule_hash->insert((const void*)&key, &data);
+    if ( status != HASH_OK and status != HASH_INTABLE )
+    {
+        event_filter_stats.xhash_nomem_peg_local++;
+        return;
+    }
+
+    THD_IP_NODE* node = (THD_IP_NODE*)rule_hash->get_user_data();
+
+    if ( (unsigned)(curtime - node->tstart) >= sfthd_node->seconds )
+    {
+        node->prev = ( (unsigned)(curtime - node->tlast) > sfthd_node->seconds ) ?
+            0 : node->count;
+        node->count = 0;
+        node->tstart = curtime;
+    }
+    node->count += shard_node->pending;
+    node->tlast = curtime;
+
+    shard_node->node = *node;
+    shard_node->pending = 0;
+}
+
+int sfthd_test_rule_shard(XHash* rule_hash, XHash* shard_hash, unsigned sync,
+    THD_NODE* sfthd_node, const SfIp* sip, const SfIp* dip, long curtime, PolicyId policy_id)
+{
+    if ((rule_hash == nullptr) || (sfthd_node == nullptr))
+        return 0;
+
+    // only the detect test counts in a way that can be summed across threads
+    if ( !shard_hash or sync <= 1 or sfthd_node->type != THD_TYPE_DETECT or
+        sfthd_node->count == THD_NO_THRESHOLD )
+        return sfthd_test_rule(rule_hash, sfthd_node, sip, dip, curtime, policy_id);
+
+    THD_IP_NODE_KEY key;
+    key.policyId = policy_id;
+    key.ip = (sfthd_node->tracking == THD_TRK_SRC) ? *sip : *dip;
+    key.thd_id = sfthd_node->thd_id;
+    key.padding = 0;
+
+    THD_IP_SHARD_NODE data = { };
+    int status = shard_hash->insert((void*)&key, &data);
+
+    if ( status != HASH_OK and status != HASH_INTABLE )
+        return sfthd_test_rule(rule_hash, sfthd_node, sip, dip, curtime, policy_id);
+
+    THD_IP_SHARD_NODE* shard_node = (THD_IP_SHARD_NODE*)shard_hash->get_user_data();
+    shard_node->pending++;
+    shard_node->node.count++;
+
+    if ( status == HASH_OK or shard_node->pending >= sync or
+        (unsigned)(curtime - shard_node->node.tstart) >= sfthd_node->seconds )
+        sfthd_merge_shard(rule_hash, sfthd_node, key, shard_node, curtime);
+
+    if ( (int)shard_node->node.count > sfthd_node->count or
+        (int)shard_node->node.prev > sfthd_node->count )
+        return 0;
+
+    return 1;
+}
+
 static inline int sfthd_test_suppress(
     THD_NODE* sfthd_node,
     const SfIp* ip)
@@ -880,9 +966,6 @@ int sfthd_test_local(
     /*
      * Check for any Permanent sig_id objects for this gen_id  or add this one ...
      */
-
-    std::lock_guard<std::mutex> lock(sfthd_hash_mutex);
-
     int status = local_hash->insert((void*)&key, &data);
     if (status == HASH_INTABLE)
     {
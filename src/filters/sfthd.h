@@ -28,8 +28,6 @@
 #include "sfip/sf_ip.h"
 #include "utils/cpp_macros.h"
 
-#include <mutex>
-
 namespace snort
 {
 class GHash;
@@ -39,8 +37,6 @@ struct SnortConfig;
 
 typedef struct sf_list SF_LIST;
 
-static std::mutex sfthd_hash_mutex;
-
 /*!
     Max GEN_ID value - Set this to the Max Used by Snort, this is used for the
     dimensions of the gen_id lookup array.
@@ -97,6 +93,18 @@ struct THD_IP_NODE
     time_t tlast;
 };
 
+/*!
+    THD_IP_SHARD_NODE
+
+    A packet thread's copy of a shared THD_IP_NODE along with the events it
+    counted since it last merged them into the shared table.
+*/
+struct THD_IP_SHARD_NODE
+{
+    THD_IP_NODE node;
+    unsigned pending;
+};
+
 /*!
     THD_IP_NODE_KEY
 
@@ -227,13 +235,21 @@ struct EventFilterStats
 THD_STRUCT* sfthd_new(unsigned lbytes, unsigned gbytes);
 snort::XHash* sfthd_local_new(unsigned bytes);
 snort::XHash* sfthd_global_new(unsigned bytes);
+snort::XHash* sfthd_shard_new(unsigned bytes);
 void sfthd_free(THD_STRUCT*);
 ThresholdObjects* sfthd_objs_new();
 void sfthd_objs_free(ThresholdObjects*);
 
+// rule_hash is shared by all packet threads
 int sfthd_test_rule(snort::XHash* rule_hash, THD_NODE* sfthd_node,
     const snort::SfIp* sip, const snort::SfIp* dip, long curtime, PolicyId policy_id);
 
+// same as sfthd_test_rule but counts in the calling thread's shard_hash and
+// merges into rule_hash every sync events per node (or when the window ends)
+int sfthd_test_rule_shard(snort::XHash* rule_hash, snort::XHash* shard_hash, unsigned sync,
+    THD_NODE* sfthd_node, const snort::SfIp* sip, const snort::SfIp* dip, long curtime,
+    PolicyId policy_id);
+
 THD_NODE* sfthd_create_rule_threshold(
     int id,
     int tracking,
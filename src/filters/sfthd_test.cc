@@ -967,3 +967,61 @@ TEST_CASE("sfthd detect", "[sfthd]")
     Term();
 }
 
+
+static int ShardTest(XHash* shard, unsigned sync, THD_NODE* rule, long curtime)
+{
+    SfIp sip, dip;
+    sip.set(IP4_SRC);
+    dip.set(IP4_DST);
+
+    return sfthd_test_rule_shard(
+        dThd, shard, sync, rule, &sip, &dip, curtime, get_ips_policy()->policy_id);
+}
+
+TEST_CASE("sfthd detect shard", "[sfthd]")
+{
+    SnortConfig sc;
+    InitDetect(&sc);
+
+    SECTION("sync 1 is exact")
+    {
+        XHash* shard = sfthd_shard_new(MEM_DEFAULT);
+
+        for ( unsigned i = 0; i < NUM_PKTS; ++i )
+        {
+            EventData* p = pktData + i;
+            SfIp sip, dip;
+            sip.set(p->sip);
+            dip.set(p->dip);
+
+            int status = sfthd_test_rule_shard(dThd, shard, 1, ruleData[p->sid].rule,
+                &sip, &dip, (long)p->now, get_ips_policy()->policy_id);
+            CHECK(status == p->expect);
+        }
+        delete shard;
+    }
+    SECTION("counts merge across threads")
+    {
+        const unsigned sync = 4;
+        THD_NODE* rule = sfthd_create_rule_threshold(100, THD_TRK_SRC, THD_TYPE_DETECT, 10, 60);
+        XHash* shard[2] = { sfthd_shard_new(MEM_DEFAULT), sfthd_shard_new(MEM_DEFAULT) };
+
+        unsigned fired = 0;
+        for ( unsigned i = 0; i < 40 and !fired; ++i )
+        {
+            if ( ShardTest(shard[i % 2], sync, rule, 0) == LOG_OK )
+                fired = i + 1;
+        }
+        // never early, and late by at most sync - 1 events per thread
+        CHECK(fired > 10);
+        CHECK(fired <= 10 + 2 * (sync - 1) + 1);
+
+        // a new window starts from zero
+        CHECK(ShardTest(shard[0], sync, rule, 120) == LOG_NO);
+
+        delete shard[0];
+        delete shard[1];
+        sfthd_node_free(rule);
+    }
+    Term();
+}
@@ -33,6 +33,7 @@
 #include "flow/deferred_trust.h"
 #include "flow/flow_data.h"
 #include "flow/flow_stash.h"
+#include "flow/flow_timer_wheel.h"
 #include "framework/data_bus.h"
 #include "framework/decode_data.h"
 #include "framework/inspector.h"
@@ -423,6 +424,7 @@ public:  // FIXIT-M privatize if possible
     Inspector* ssn_server;
 
     long last_data_seen;
+    FlowTimer timer;
     Layer mpls_client, mpls_server;
 
     // everything from here down is zeroed
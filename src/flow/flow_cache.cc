@@ -24,6 +24,8 @@
 
 #include "flow/flow_cache.h"
 
+#include <algorithm>
+
 #include "detection/detection_engine.h"
 #include "hash/hash_defs.h"
 #include "hash/zhash.h"
@@ -50,6 +52,7 @@ using namespace snort;
 static const unsigned ALLOWED_FLOWS_ONLY = 1;
 static const unsigned OFFLOADED_FLOWS_TOO = 2;
 static const unsigned ALL_FLOWS = 3;
+static const unsigned TIMEOUT_VISITS_PER_FLOW = 4;
 
 //-------------------------------------------------------------------------
 // FlowCache stuff
@@ -87,6 +90,7 @@ void FlowCache::push(Flow* flow)
 {
     void* key = hash_table->push(flow);
     flow->key = (FlowKey*)key;
+    flow->timer.flow = flow;
     ++flows_allocated;
 }
 
@@ -105,6 +109,13 @@ Flow* FlowCache::find(const FlowKey* key)
 
         if ( flow->last_data_seen < t )
             flow->last_data_seen = t;
+
+        // later expiry is found when the timer pops but earlier must be
+        // scheduled now, as when the flow's idle timeout is reduced
+        uint64_t expiry = get_expiry(flow);
+
+        if ( expiry < flow->timer.time and t < flow->timer.time )
+            timers.schedule(&flow->timer, expiry, t);
     }
 
     return flow;
@@ -183,12 +194,14 @@ Flow* FlowCache::allocate(const FlowKey* key)
         flow->term();
 
     flow->last_data_seen = timestamp;
+    timers.schedule(&flow->timer, get_expiry(flow), timestamp);
 
     return flow;
 }
 
 void FlowCache::remove(Flow* flow)
 {
+    timers.cancel(&flow->timer);
     unlink_uni(flow);
 
     hash_table->release_node(flow->key);
@@ -225,6 +238,20 @@ void FlowCache::retire(Flow* flow)
     remove(flow);
 }
 
+uint64_t FlowCache::get_expiry(Flow* flow) const
+{
+    if ( flow->is_hard_expiration() )
+        return std::min(flow->expire_time, (uint64_t)UINT32_MAX);
+
+    uint32_t idle = flow->default_session_timeout;
+
+    // the session timeout set by the stream inspector overrides the protocol's
+    if ( !idle )
+        idle = config.proto[to_utype(flow->key->pkt_type)].nominal_timeout;
+
+    return std::min((uint64_t)flow->last_data_seen + idle, (uint64_t)UINT32_MAX);
+}
+
 unsigned FlowCache::prune_stale(uint32_t thetime, const Flow* save_me)
 {
     ActiveSuspendContext act_susp(Active::ASP_PRUNE);
@@ -383,42 +410,52 @@ bool FlowCache::prune_one(PruneReason reason, bool do_cleanup)
     return true;
 }
 
+// flows are scheduled to expire when allocated and are checked again when
+// their timer pops.  since that is usually before the flow has been idle for
+// its timeout, each flow is rescheduled about once per timeout period and
+// only flows that are due are visited.  flows that are still active or
+// can't be released yet are rescheduled, so every pop counts against a visit
+// budget and any flows left due are visited on the next call.
 unsigned FlowCache::timeout(unsigned num_flows, time_t thetime)
 {
     ActiveSuspendContext act_susp(Active::ASP_TIMEOUT);
 
     unsigned retired = 0;
+    uint64_t visits = (uint64_t)num_flows * TIMEOUT_VISITS_PER_FLOW;
 
     {
         PacketTracerSuspend pt_susp;
 
-        auto flow = static_cast<Flow*>(hash_table->lru_current());
+        while ( retired < num_flows and visits )
+        {
+            --visits;
 
-        if ( !flow )
-            flow = static_cast<Flow*>(hash_table->lru_first());
+            Flow* flow = timers.pop(thetime);
 
-        while ( flow and (retired < num_flows) )
-        {
-            if ( flow->is_hard_expiration() )
+            if ( !flow )
+                break;
+
+            uint64_t expiry = get_expiry(flow);
+
+            if ( expiry > (uint64_t)thetime )
             {
-                if ( flow->expire_time > (uint64_t) thetime )
-                    break;
+                timers.schedule(&flow->timer, expiry, thetime);
+                continue;
             }
-            else if ( flow->last_data_seen + config.proto[to_utype(flow->key->pkt_type)].nominal_timeout > thetime )
-                break;
 
             if ( HighAvailabilityManager::in_standby(flow) or
                     flow->is_suspended() )
             {
-                flow = static_cast<Flow*>(hash_table->lru_next());
+                timers.schedule(&flow->timer, thetime + 1, thetime);
                 continue;
             }
 
             flow->ssn_state.session_flags |= SSNFLAG_TIMEDOUT;
+
             if ( release(flow, PruneReason::IDLE) )
                 ++retired;
-
-            flow = static_cast<Flow*>(hash_table->lru_current());
+            else
+                timers.schedule(&flow->timer, thetime + 1, thetime);
         }
     }
 
@@ -443,6 +480,7 @@ unsigned FlowCache::delete_active_flows(unsigned mode, unsigned num_to_delete, u
         }
 
         // we have a winner...
+        timers.cancel(&flow->timer);
         unlink_uni(flow);
 
         if ( flow->was_blocked() )
@@ -32,6 +32,7 @@
 #include "main/thread.h"
 
 #include "flow_config.h"
+#include "flow_timer_wheel.h"
 #include "prune_stats.h"
 
 namespace snort
@@ -106,6 +107,7 @@ private:
     void link_uni(snort::Flow*);
     void remove(snort::Flow*);
     void retire(snort::Flow*);
+    uint64_t get_expiry(snort::Flow*) const;
     unsigned prune_unis(PktType);
     unsigned delete_active_flows
         (unsigned mode, unsigned num_to_delete, unsigned &deleted);
@@ -120,6 +122,7 @@ private:
     unsigned flows_allocated = 0;
     FlowUniList* uni_flows;
     FlowUniList* uni_ip_flows;
+    FlowTimerWheel timers;
 
     PruneStats prune_stats;
     FlowDeleteStats delete_stats;
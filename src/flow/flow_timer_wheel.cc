@@ -0,0 +1,179 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// flow_timer_wheel.cc
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "flow_timer_wheel.h"
+
+#include <cassert>
+
+using namespace snort;
+
+void FlowTimerWheel::link(FlowTimer* t, unsigned level, unsigned slot)
+{
+    FlowTimer*& head = heads[level][slot];
+
+    t->prev = nullptr;
+    t->next = head;
+
+    if ( head )
+        head->prev = t;
+
+    head = t;
+    masks[level] |= 1ULL << slot;
+
+    t->level = level;
+    t->slot = slot;
+    t->scheduled = true;
+    ++count;
+}
+
+void FlowTimerWheel::unlink(FlowTimer* t)
+{
+    assert(t->scheduled);
+
+    if ( t->prev )
+        t->prev->next = t->next;
+    else
+    {
+        heads[t->level][t->slot] = t->next;
+
+        if ( !t->next )
+            masks[t->level] &= ~(1ULL << t->slot);
+    }
+
+    if ( t->next )
+        t->next->prev = t->prev;
+
+    t->prev = t->next = nullptr;
+    t->scheduled = false;
+    --count;
+}
+
+// the timer's time is never before the current time and differs from it in
+// the digit of its level, so that slot is after the current one
+void FlowTimerWheel::place(FlowTimer* t, uint32_t time)
+{
+    if ( time < cur )
+        time = cur;
+
+    uint32_t diff = time ^ cur;
+    unsigned level = diff ? (31 - __builtin_clz(diff)) / bits : 0;
+    unsigned slot = (time >> (level * bits)) & (slots - 1);
+
+    t->time = time;
+    link(t, level, slot);
+}
+
+void FlowTimerWheel::schedule(FlowTimer* t, uint32_t time, uint32_t now)
+{
+    if ( t->scheduled )
+        unlink(t);
+
+    // nothing is pending so the wheel can move up to now
+    if ( !count and now > cur )
+        cur = now;
+
+    place(t, time);
+}
+
+void FlowTimerWheel::cancel(FlowTimer* t)
+{
+    if ( t->scheduled )
+        unlink(t);
+}
+
+// the earliest time after the current one when a level 0 slot is due or a
+// slot of a higher level must be redistributed
+bool FlowTimerWheel::next_event(uint32_t& time) const
+{
+    bool found = false;
+
+    for ( unsigned level = 0; level < levels; ++level )
+    {
+        unsigned shift = level * bits;
+        unsigned digit = (cur >> shift) & (slots - 1);
+
+        if ( digit == slots - 1 )
+            continue;
+
+        uint64_t after = masks[level] & (~0ULL << (digit + 1));
+
+        if ( !after )
+            continue;
+
+        uint32_t base = (uint32_t)(((uint64_t)cur >> (shift + bits)) << (shift + bits));
+        uint32_t t = base | ((uint32_t)__builtin_ctzll(after) << shift);
+
+        if ( !found or t < time )
+        {
+            time = t;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void FlowTimerWheel::cascade()
+{
+    for ( unsigned level = levels - 1; level > 0; --level )
+    {
+        unsigned shift = level * bits;
+
+        if ( cur & ((1u << shift) - 1) )
+            continue;
+
+        unsigned slot = (cur >> shift) & (slots - 1);
+
+        while ( FlowTimer* t = heads[level][slot] )
+        {
+            unlink(t);
+            place(t, t->time);
+        }
+    }
+}
+
+Flow* FlowTimerWheel::pop(uint32_t now)
+{
+    while ( true )
+    {
+        if ( FlowTimer* t = heads[0][cur & (slots - 1)] )
+        {
+            unlink(t);
+            return t->flow;
+        }
+
+        uint32_t next;
+
+        if ( !next_event(next) or next > now )
+        {
+            if ( now > cur )
+                cur = now;
+
+            return nullptr;
+        }
+
+        cur = next;
+        cascade();
+    }
+}
+
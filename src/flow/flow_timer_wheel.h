@@ -0,0 +1,80 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// flow_timer_wheel.h
+
+
+#ifndef FLOW_TIMER_WHEEL_H
+#define FLOW_TIMER_WHEEL_H
+
+// a hierarchical timing wheel of flow expiry times in packet seconds.  each
+// level has 64 slots.  a timer goes in the level of the highest 6 bit digit
+// where its time differs from the current time of the wheel so only slots
+// that become due are visited as time advances.  when the current time
+// reaches a slot of a higher level, its timers are redistributed to lower
+// levels.  there are enough levels to cover any 32 bit time.
+
+#include <cstdint>
+
+namespace snort
+{
+class Flow;
+}
+
+struct FlowTimer
+{
+    snort::Flow* flow;
+    FlowTimer* prev;
+    FlowTimer* next;
+    uint32_t time;
+    uint8_t level;
+    uint8_t slot;
+    bool scheduled;
+};
+
+class FlowTimerWheel
+{
+public:
+    // reschedules the timer if it is already scheduled
+    void schedule(FlowTimer*, uint32_t time, uint32_t now);
+    void cancel(FlowTimer*);
+
+    // unschedules and returns the flow of a timer due at or before now
+    snort::Flow* pop(uint32_t now);
+
+    unsigned get_count() const
+    { return count; }
+
+private:
+    static constexpr unsigned bits = 6;
+    static constexpr unsigned slots = 1 << bits;
+    static constexpr unsigned levels = (32 + bits - 1) / bits;
+
+    void place(FlowTimer*, uint32_t time);
+    void link(FlowTimer*, unsigned level, unsigned slot);
+    void unlink(FlowTimer*);
+    bool next_event(uint32_t& time) const;
+    void cascade();
+
+    FlowTimer* heads[levels][slots] = { };
+    uint64_t masks[levels] = { };
+    uint32_t cur = 0;
+    unsigned count = 0;
+};
+
+#endif
+
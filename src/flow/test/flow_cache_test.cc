@@ -93,7 +93,7 @@ ExpectCache::ExpectCache(uint32_t) { }
 bool ExpectCache::check(Packet*, Flow*) { return true; }
 bool ExpectCache::is_expected(Packet*) { return true; }
 Flow* HighAvailabilityManager::import(Packet&, FlowKey&) { return nullptr; }
-bool HighAvailabilityManager::in_standby(Flow*) { return true; }
+bool HighAvailabilityManager::in_standby(Flow*) { return false; }
 SfIpRet SfIp::set(void const*, int) { return SFIP_SUCCESS; }
 void snort::trace_vprintf(const char*, TraceLevel, const char*, const Packet*, const char*, va_list) {}
 uint8_t snort::TraceApi::get_constraints_generation() { return 0; }
@@ -105,7 +105,8 @@ namespace layer
 {
 const vlan::VlanTagHdr* get_vlan_layer(const Packet* const) { return nullptr; }
 }
-time_t packet_time() { return 0; }
+static time_t s_packet_time = 0;
+time_t packet_time() { return s_packet_time; }
 }
 
 namespace snort
@@ -258,6 +259,92 @@ TEST(flow_prune, prune_all_blocked_flows)
     delete cache;
 }
 
+// flows time out by their own idle timeouts rather than in LRU order
+TEST(flow_prune, timeout_flows)
+{
+    FlowCacheConfig fcg;
+    fcg.max_flows = 3;
+    fcg.proto[to_utype(PktType::TCP)].nominal_timeout = 3600;
+    fcg.proto[to_utype(PktType::UDP)].nominal_timeout = 180;
+    FlowCache *cache = new FlowCache(fcg);
+
+    FlowKey flow_key;
+    memset(&flow_key, 0, sizeof(FlowKey));
+    s_packet_time = 1000;
+
+    flow_key.pkt_type = PktType::TCP;
+    flow_key.port_l = 1;
+    cache->allocate(&flow_key);
+
+    flow_key.pkt_type = PktType::UDP;
+    flow_key.port_l = 2;
+    cache->allocate(&flow_key);
+
+    // a reduced timeout takes effect with the flow's next lookup
+    flow_key.port_l = 3;
+    Flow* flow = cache->allocate(&flow_key);
+    flow->set_default_session_timeout(30, true);
+    CHECK(cache->find(&flow_key) == flow);
+
+    CHECK(cache->timeout(3, 1029) == 0);
+    CHECK(cache->timeout(3, 1030) == 1);
+
+    s_packet_time = 1100;
+    flow_key.port_l = 2;
+    CHECK(cache->find(&flow_key) != nullptr);
+
+    CHECK(cache->timeout(3, 1180) == 0);
+    CHECK(cache->timeout(3, 1280) == 1);
+    CHECK(cache->timeout(3, 4599) == 0);
+    CHECK(cache->timeout(3, 4600) == 1);
+    CHECK(cache->get_count() == 0);
+
+    cache->purge();
+    CHECK(cache->get_flows_allocated() == 0);
+    delete cache;
+    s_packet_time = 0;
+}
+
+// flows that are due but still active are rescheduled and count against the
+// visit budget so a single call can't walk every due flow
+TEST(flow_prune, timeout_visit_budget)
+{
+    FlowCacheConfig fcg;
+    fcg.max_flows = 9;
+    fcg.proto[to_utype(PktType::UDP)].nominal_timeout = 180;
+    FlowCache *cache = new FlowCache(fcg);
+
+    FlowKey flow_key;
+    memset(&flow_key, 0, sizeof(FlowKey));
+    flow_key.pkt_type = PktType::UDP;
+    s_packet_time = 1000;
+
+    // the flows are visited in allocation order so the idle one is last
+    for ( unsigned i = 1; i <= 9; ++i )
+    {
+        flow_key.port_l = i;
+        cache->allocate(&flow_key);
+    }
+
+    s_packet_time = 1100;
+
+    for ( unsigned i = 1; i <= 8; ++i )
+    {
+        flow_key.port_l = i;
+        CHECK(cache->find(&flow_key) != nullptr);
+    }
+
+    CHECK(cache->timeout(1, 1180) == 0);
+    CHECK(cache->timeout(1, 1180) == 0);
+    CHECK(cache->timeout(1, 1180) == 1);
+    CHECK(cache->get_count() == 8);
+
+    cache->purge();
+    CHECK(cache->get_flows_allocated() == 0);
+    delete cache;
+    s_packet_time = 0;
+}
+
 int main(int argc, char** argv)
 {
     return CommandLineTestRunner::RunAllTests(argc, argv);
@@ -0,0 +1,185 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// flow_timer_wheel_test.cc
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "flow/flow_timer_wheel.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+using namespace snort;
+
+// the wheel only passes flow pointers through so timers get unique tokens
+static std::vector<FlowTimer> make_timers(unsigned n)
+{
+    std::vector<FlowTimer> timers(n);
+
+    for ( unsigned i = 0; i < n; ++i )
+    {
+        timers[i] = { };
+        timers[i].flow = (Flow*)(uintptr_t)(i + 1);
+    }
+    return timers;
+}
+
+static unsigned get_index(Flow* flow)
+{ return (unsigned)(uintptr_t)flow - 1; }
+
+TEST_GROUP(flow_timer_wheel) { };
+
+TEST(flow_timer_wheel, empty)
+{
+    FlowTimerWheel wheel;
+
+    CHECK(wheel.pop(0) == nullptr);
+    CHECK(wheel.pop(1000000) == nullptr);
+    CHECK(wheel.get_count() == 0);
+}
+
+TEST(flow_timer_wheel, due_in_order)
+{
+    FlowTimerWheel wheel;
+    auto timers = make_timers(4);
+    const uint32_t now = 1600000000;
+
+    wheel.schedule(&timers[0], now + 300, now);
+    wheel.schedule(&timers[1], now + 30, now);
+    wheel.schedule(&timers[2], now + 5000, now);
+    wheel.schedule(&timers[3], now, now);
+    CHECK(wheel.get_count() == 4);
+
+    CHECK(get_index(wheel.pop(now)) == 3);
+    CHECK(wheel.pop(now + 29) == nullptr);
+    CHECK(get_index(wheel.pop(now + 30)) == 1);
+    CHECK(wheel.pop(now + 299) == nullptr);
+    CHECK(get_index(wheel.pop(now + 4999)) == 0);
+    CHECK(wheel.pop(now + 4999) == nullptr);
+    CHECK(get_index(wheel.pop(now + 100000)) == 2);
+    CHECK(wheel.get_count() == 0);
+}
+
+TEST(flow_timer_wheel, cancel_and_reschedule)
+{
+    FlowTimerWheel wheel;
+    auto timers = make_timers(3);
+    const uint32_t now = 1000;
+
+    wheel.schedule(&timers[0], now + 10, now);
+    wheel.schedule(&timers[1], now + 10, now);
+    wheel.schedule(&timers[2], now + 10, now);
+
+    wheel.cancel(&timers[1]);
+    wheel.cancel(&timers[1]);
+    CHECK_FALSE(timers[1].scheduled);
+
+    wheel.schedule(&timers[0], now + 100, now);
+    CHECK(wheel.get_count() == 2);
+
+    CHECK(get_index(wheel.pop(now + 50)) == 2);
+    CHECK(wheel.pop(now + 50) == nullptr);
+    CHECK(get_index(wheel.pop(now + 100)) == 0);
+}
+
+TEST(flow_timer_wheel, far)
+{
+    FlowTimerWheel wheel;
+    auto timers = make_timers(2);
+    const uint32_t now = 5;
+
+    wheel.schedule(&timers[0], UINT32_MAX, now);
+    wheel.schedule(&timers[1], now + (1u << 24), now);
+
+    CHECK(wheel.pop(now + (1u << 24) - 1) == nullptr);
+    CHECK(get_index(wheel.pop(now + (1u << 24))) == 1);
+    CHECK(wheel.pop(UINT32_MAX - 1) == nullptr);
+    CHECK(get_index(wheel.pop(UINT32_MAX)) == 0);
+}
+
+// pops must return exactly the timers due by each time, whatever the gaps
+TEST(flow_timer_wheel, matches_reference)
+{
+    std::mt19937 rng(1);
+    FlowTimerWheel wheel;
+    auto timers = make_timers(2000);
+    std::multimap<uint32_t, unsigned> ref;
+    std::vector<uint32_t> due(timers.size(), 0);
+
+    uint32_t now = 1500000000;
+    const uint32_t spans[] = { 4, 64, 600, 5000, 300000, 20000000 };
+
+    for ( unsigned step = 0; step < 20000; ++step )
+    {
+        unsigned i = rng() % timers.size();
+
+        if ( rng() % 4 )
+        {
+            if ( timers[i].scheduled )
+            {
+                auto r = ref.equal_range(due[i]);
+                for ( auto it = r.first; it != r.second; ++it )
+                    if ( it->second == i ) { ref.erase(it); break; }
+            }
+            due[i] = now + rng() % spans[rng() % 6];
+            wheel.schedule(&timers[i], due[i], now);
+            ref.emplace(due[i], i);
+        }
+        else if ( timers[i].scheduled )
+        {
+            wheel.cancel(&timers[i]);
+            auto r = ref.equal_range(due[i]);
+            for ( auto it = r.first; it != r.second; ++it )
+                if ( it->second == i ) { ref.erase(it); break; }
+        }
+
+        if ( !(rng() % 8) )
+            now += (rng() % 16) ? rng() % 100 : rng() % 1000000;
+
+        while ( Flow* flow = wheel.pop(now) )
+        {
+            unsigned j = get_index(flow);
+            uint32_t t = due[j];
+            CHECK(t <= now);
+
+            auto r = ref.equal_range(t);
+            bool found = false;
+            for ( auto it = r.first; it != r.second; ++it )
+                if ( it->second == j ) { ref.erase(it); found = true; break; }
+            CHECK(found);
+        }
+
+        // nothing due may remain
+        CHECK(ref.empty() or ref.begin()->first > now);
+        CHECK(wheel.get_count() == ref.size());
+    }
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
+
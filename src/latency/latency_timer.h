@@ -28,6 +28,7 @@ class LatencyTimer
 {
 public:
     using duration = typename Clock::duration;
+    using time_point = typename Clock::time_point;
 
     LatencyTimer(duration d) :
         max_time(d)
@@ -36,8 +37,15 @@ public:
     duration elapsed() const
     { return sw.get(); }
 
+    // the overload takes an elapsed time already read to save a clock read
     bool timed_out() const
-    { return (max_time > CLOCK_ZERO) && (elapsed() > max_time); }
+    { return timed_out(elapsed()); }
+
+    bool timed_out(duration d) const
+    { return (max_time > CLOCK_ZERO) && (d > max_time); }
+
+    time_point started() const
+    { return sw.started(); }
 
 private:
     duration max_time;
@@ -149,8 +149,9 @@ inline bool Impl<Clock>::pop(const Packet* p)
     const auto& timer = timers.back();
 
     auto timed_out = timer.marked_as_fastpathed;
+    auto elapsed_time = timer.elapsed();
 
-    bool force_timeout = timer.timed_out();
+    bool force_timeout = timer.timed_out(elapsed_time);
 
 #ifdef REG_TEST
     force_timeout = config->test_timeout ? true : force_timeout;
@@ -161,12 +162,12 @@ inline bool Impl<Clock>::pop(const Packet* p)
         timed_out = true;
 
         // timer.mark implies fastpath-related timeout
-        Event e { p, timer.marked_as_fastpathed, timer.elapsed() };
+        Event e { p, timer.marked_as_fastpathed, elapsed_time };
 
         event_handler.handle(e);
     }
 
-    elapsed = clock_usecs(TO_USECS(timer.elapsed()));
+    elapsed = clock_usecs(TO_USECS(elapsed_time));
 
     timers.pop_back();
     return timed_out;
@@ -247,7 +248,6 @@ void PacketLatency::pop(const Packet* p)
         if ( packet_latency::get_impl().pop(p) )
             ++latency_stats.packet_timeouts;
 
-        // FIXIT-L the timer is still running so this max is slightly larger than logged
         if ( elapsed > latency_stats.max_usecs )
             latency_stats.max_usecs = elapsed;
 
@@ -301,7 +301,7 @@ struct EventHandlerSpy : public packet_latency::EventHandler
     { ++count; }
 };
 
-struct MockClock : public ClockTraits<hr_clock>
+struct MockClock : public ClockTraits<SnortClock>
 {
     static hr_time t;
 
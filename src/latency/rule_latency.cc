@@ -227,7 +227,7 @@ inline bool Impl<Clock, RuleTree>::push(detection_option_tree_root_t* root, Pack
 
     if ( config->allow_reenable() )
     {
-        if ( RuleTree::reenable(*root, config->max_suspend_time, Clock::now()) )
+        if ( RuleTree::reenable(*root, config->max_suspend_time, timers.back().started()) )
         {
             Event e { Event::EVENT_ENABLED, config->max_suspend_time, root, p };
             event_handler.handle(e);
@@ -248,19 +248,21 @@ inline bool Impl<Clock, RuleTree>::pop()
 
     if ( !RuleTree::is_suspended(*timer.root) )
     {
-        timed_out = timer.timed_out();
+        auto elapsed = timer.elapsed();
+
+        timed_out = timer.timed_out(elapsed);
 #ifdef REG_TEST
         timed_out = config->test_timeout ? true : timed_out;
 #endif
         if ( timed_out )
         {
             auto suspended = RuleTree::timeout_and_suspend(*timer.root, config->suspend_threshold,
-                Clock::now(), config->suspend);
+                timer.started() + elapsed, config->suspend);
 
             Event e
             {
                 suspended ? Event::EVENT_SUSPENDED : Event::EVENT_TIMED_OUT,
-                timer.elapsed(), timer.root, timer.packet
+                elapsed, timer.root, timer.packet
             };
 
             event_handler.handle(e);
@@ -398,7 +400,7 @@ struct EventHandlerSpy : public rule_latency::EventHandler
     { ++count; }
 };
 
-struct MockClock : public ClockTraits<hr_clock>
+struct MockClock : public ClockTraits<SnortClock>
 {
     static hr_time t;
 
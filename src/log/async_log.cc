@@ -0,0 +1,378 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// async_log.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "async_log.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "log/messages.h"
+#include "utils/util.h"
+
+using namespace snort;
+
+const PegInfo async_log_pegs[] =
+{
+    { CountType::SUM, "async_records", "log records queued for the writer thread" },
+    { CountType::SUM, "async_bytes", "log bytes queued for the writer thread" },
+    { CountType::SUM, "async_drops", "log records dropped because the queue was full" },
+    { CountType::SUM, "async_blocks", "log records that waited for space in the queue" },
+    { CountType::MAX, "async_max_depth", "maximum bytes waiting in the queue" },
+    { CountType::END, nullptr, nullptr }
+};
+
+THREAD_LOCAL AsyncLogStats async_log_stats;
+
+//-------------------------------------------------------------------------
+// ring
+//-------------------------------------------------------------------------
+
+// records are a header followed by the data, padded so headers stay aligned;
+// a header with a negative fd marks the unused end of the buffer
+struct RecordHeader
+{
+    uint32_t len;
+    int32_t fd;
+};
+
+static constexpr size_t align = sizeof(RecordHeader);
+
+static inline size_t record_size(size_t len)
+{ return (sizeof(RecordHeader) + len + align - 1) & ~(align - 1); }
+
+class LogRing
+{
+public:
+    LogRing(size_t);
+    ~LogRing();
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    // producer
+    bool put(int fd, const struct iovec*, int iovcnt, size_t len, bool block);
+
+    bool empty() const
+    { return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire); }
+
+    // consumer; returns false if there was nothing to write
+    bool drain();
+
+private:
+    RecordHeader* at(size_t pos) const
+    { return (RecordHeader*)(buf + pos % size); }
+
+private:
+    uint8_t* buf;
+    size_t size;
+
+    // running byte counts; the difference is the queue depth
+    std::atomic<size_t> head { 0 };
+    std::atomic<size_t> tail { 0 };
+
+    bool write_error = false;
+};
+
+LogRing::LogRing(size_t n)
+{
+    size = std::max(n & ~(align - 1), (size_t)4096);
+    buf = (uint8_t*)snort_alloc(size);
+}
+
+LogRing::~LogRing()
+{ snort_free(buf); }
+
+bool LogRing::put(int fd, const struct iovec* iov, int iovcnt, size_t len, bool block)
+{
+    size_t need = record_size(len);
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t room = size - h % size;
+    size_t pad = room < need ? room : 0;
+
+    if ( pad + need > size )
+    {
+        ++async_log_stats.drops;
+        return false;
+    }
+
+    if ( size - (h - tail.load(std::memory_order_acquire)) < pad + need )
+    {
+        if ( !block )
+        {
+            ++async_log_stats.drops;
+            return false;
+        }
+        ++async_log_stats.blocks;
+
+        while ( size - (h - tail.load(std::memory_order_acquire)) < pad + need )
+            std::this_thread::yield();
+    }
+
+    if ( pad )
+    {
+        RecordHeader* rh = at(h);
+        rh->len = 0;
+        rh->fd = -1;
+        h += pad;
+    }
+
+    RecordHeader* rh = at(h);
+    rh->len = len;
+    rh->fd = fd;
+
+    uint8_t* data = (uint8_t*)(rh + 1);
+
+    for ( int i = 0; i < iovcnt; ++i )
+    {
+        memcpy(data, iov[i].iov_base, iov[i].iov_len);
+        data += iov[i].iov_len;
+    }
+    h += need;
+    head.store(h, std::memory_order_release);
+
+    size_t depth = h - tail.load(std::memory_order_relaxed);
+
+    if ( depth > async_log_stats.max_depth )
+        async_log_stats.max_depth = depth;
+
+    ++async_log_stats.records;
+    async_log_stats.bytes += len;
+
+    return true;
+}
+
+// writes the leading run of records for the same fd in one call
+bool LogRing::drain()
+{
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t h = head.load(std::memory_order_acquire);
+
+    if ( t == h )
+        return false;
+
+    struct iovec iov[64];
+    int iovcnt = 0;
+    int fd = -1;
+
+    while ( t != h and iovcnt < (int)array_size(iov) )
+    {
+        const RecordHeader* rh = at(t);
+
+        if ( rh->fd < 0 )
+        {
+            t += size - t % size;
+            continue;
+        }
+        if ( iovcnt and rh->fd != fd )
+            break;
+
+        fd = rh->fd;
+        iov[iovcnt].iov_base = (void*)(rh + 1);
+        iov[iovcnt].iov_len = rh->len;
+        ++iovcnt;
+
+        t += record_size(rh->len);
+    }
+
+    struct iovec* next = iov;
+
+    while ( iovcnt )
+    {
+        ssize_t n = writev(fd, next, iovcnt);
+
+        if ( n < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+
+            if ( !write_error )
+            {
+                ErrorMessage("async log failed to write: %s\n", get_error(errno));
+                write_error = true;
+            }
+            break;
+        }
+
+        // skip what was written in case of a short write
+        while ( iovcnt and (size_t)n >= next->iov_len )
+        {
+            n -= next->iov_len;
+            ++next;
+            --iovcnt;
+        }
+        if ( iovcnt )
+        {
+            next->iov_base = (uint8_t*)next->iov_base + n;
+            next->iov_len -= n;
+        }
+    }
+
+    tail.store(t, std::memory_order_release);
+    return true;
+}
+
+//-------------------------------------------------------------------------
+// writer
+//-------------------------------------------------------------------------
+
+// the writer drains a snapshot of the list so the mutex isn't held across
+// writev(); shared ownership keeps a ring alive until both are done with it
+static std::vector<std::shared_ptr<LogRing>> rings;
+static std::mutex rings_mutex;
+
+static std::thread* writer = nullptr;
+static std::atomic<bool> writer_done { false };
+
+static size_t ring_size = 0;
+static bool ring_block = false;
+
+static THREAD_LOCAL LogRing* ring = nullptr;
+
+static void write_rings()
+{
+    std::vector<std::shared_ptr<LogRing>> snapshot;
+
+    while ( true )
+    {
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex);
+            snapshot.assign(rings.begin(), rings.end());
+        }
+
+        bool idle = true;
+
+        for ( auto& r : snapshot )
+        {
+            if ( r->drain() )
+                idle = false;
+        }
+
+        if ( idle )
+        {
+            if ( writer_done.load(std::memory_order_acquire) )
+                break;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+void async_log_start(size_t queue_size, bool block)
+{
+    assert(!writer);
+
+    if ( !queue_size )
+        return;
+
+    ring_size = queue_size;
+    ring_block = block;
+
+    writer_done = false;
+    writer = new std::thread(write_rings);
+}
+
+void async_log_stop()
+{
+    if ( !writer )
+        return;
+
+    writer_done.store(true, std::memory_order_release);
+    writer->join();
+
+    delete writer;
+    writer = nullptr;
+    ring_size = 0;
+}
+
+void async_log_tinit()
+{
+    if ( !writer )
+        return;
+
+    auto sp = std::make_shared<LogRing>(ring_size);
+    ring = sp.get();
+
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    rings.emplace_back(std::move(sp));
+}
+
+void async_log_tterm()
+{
+    if ( !ring )
+        return;
+
+    async_log_flush();
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        rings.erase(std::find_if(rings.begin(), rings.end(),
+            [](const std::shared_ptr<LogRing>& sp) { return sp.get() == ring; }));
+    }
+    ring = nullptr;
+}
+
+//-------------------------------------------------------------------------
+// api
+//-------------------------------------------------------------------------
+
+namespace snort
+{
+bool async_log_enabled()
+{ return ring != nullptr; }
+
+bool async_log_write(int fd, const struct iovec* iov, int iovcnt)
+{
+    assert(ring);
+    size_t len = 0;
+
+    for ( int i = 0; i < iovcnt; ++i )
+        len += iov[i].iov_len;
+
+    return ring->put(fd, iov, iovcnt, len, ring_block);
+}
+
+bool async_log_write(int fd, const void* data, size_t len)
+{
+    struct iovec iov = { (void*)data, len };
+    return async_log_write(fd, &iov, 1);
+}
+
+void async_log_flush()
+{
+    if ( !ring )
+        return;
+
+    while ( !ring->empty() )
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+}
+
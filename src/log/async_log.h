@@ -0,0 +1,75 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// async_log.h
+
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+// Loggers format their output on the packet thread.  When output.async_queue
+// is set, the formatted records are copied into a single producer, single
+// consumer ring of the packet thread instead of being written to the file
+// there.  A dedicated writer thread drains the rings of all packet threads
+// and writes runs of records for the same file with one writev().  Records
+// queued by a thread are written in the order they were queued.
+
+#include <sys/uio.h>
+
+#include <cstddef>
+
+#include "framework/counts.h"
+#include "main/snort_types.h"
+#include "main/thread.h"
+
+struct AsyncLogStats
+{
+    PegCount records;
+    PegCount bytes;
+    PegCount drops;
+    PegCount blocks;
+    PegCount max_depth;
+};
+
+extern const PegInfo async_log_pegs[];
+extern THREAD_LOCAL AsyncLogStats async_log_stats;
+
+namespace snort
+{
+// true if the calling thread queues its output; otherwise callers write
+// as usual
+SO_PUBLIC bool async_log_enabled();
+
+// queues a record for fd; returns false if the record was dropped because
+// the queue is full and the overflow policy is drop
+SO_PUBLIC bool async_log_write(int fd, const struct iovec*, int iovcnt);
+SO_PUBLIC bool async_log_write(int fd, const void*, size_t);
+
+// waits until everything queued by the calling thread has been written;
+// must be called before closing or rolling a file with queued records
+SO_PUBLIC void async_log_flush();
+}
+
+// main thread
+void async_log_start(size_t queue_size, bool block);
+void async_log_stop();
+
+// packet threads
+void async_log_tinit();
+void async_log_tterm();
+
+#endif
+
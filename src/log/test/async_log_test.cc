@@ -0,0 +1,301 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// async_log_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// the ring is private to async_log.cc
+#include "../async_log.cc"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+//-------------------------------------------------------------------------
+// stubs
+//-------------------------------------------------------------------------
+
+static unsigned errors = 0;
+
+namespace snort
+{
+void ErrorMessage(const char*, ...) { ++errors; }
+const char* get_error(int) { return ""; }
+}
+
+// writes go to memory so short, interrupted and failed writes can be made up
+static std::mutex sink_mutex;
+static std::map<int, std::string> sinks;
+static unsigned writev_calls = 0;
+static size_t max_write = SIZE_MAX;
+static unsigned interrupts = 0;
+static int fail_errno = 0;
+
+ssize_t writev(int fd, const struct iovec* iov, int iovcnt)
+{
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    ++writev_calls;
+
+    if ( interrupts )
+    {
+        --interrupts;
+        errno = EINTR;
+        return -1;
+    }
+    if ( fail_errno )
+    {
+        errno = fail_errno;
+        return -1;
+    }
+
+    size_t n = 0;
+
+    for ( int i = 0; i < iovcnt and n < max_write; ++i )
+    {
+        size_t len = std::min(iov[i].iov_len, max_write - n);
+        sinks[fd].append((const char*)iov[i].iov_base, len);
+        n += len;
+    }
+    return n;
+}
+
+static void reset_sinks()
+{
+    sinks.clear();
+    writev_calls = 0;
+    max_write = SIZE_MAX;
+    interrupts = 0;
+    fail_errno = 0;
+    errors = 0;
+}
+
+static std::string record(char c, size_t len)
+{ return std::string(len, c); }
+
+static bool put(LogRing& r, int fd, const std::string& s, bool block = false)
+{
+    struct iovec iov = { (void*)s.data(), s.size() };
+    return r.put(fd, &iov, 1, s.size(), block);
+}
+
+static void drain_all(LogRing& r)
+{
+    while ( r.drain() )
+        ;
+}
+
+#ifdef CATCH_TEST_BUILD
+
+//-------------------------------------------------------------------------
+// ring
+//-------------------------------------------------------------------------
+
+TEST_CASE("runs of records for the same file share a writev", "[async_log]")
+{
+    reset_sinks();
+    LogRing r(4096);
+
+    CHECK(!r.drain());
+
+    CHECK(put(r, 1, "a"));
+    CHECK(put(r, 1, "bb"));
+    CHECK(put(r, 2, "ccc"));
+    CHECK(put(r, 1, "dddd"));
+
+    CHECK(r.drain());
+    CHECK(writev_calls == 1);
+    CHECK(sinks[1] == "abb");
+    CHECK(sinks[2].empty());
+
+    CHECK(r.drain());
+    CHECK(sinks[2] == "ccc");
+
+    CHECK(r.drain());
+    CHECK(sinks[1] == "abbdddd");
+
+    CHECK(!r.drain());
+    CHECK(r.empty());
+    CHECK(writev_calls == 3);
+}
+
+TEST_CASE("records wrap around the end of the ring", "[async_log]")
+{
+    reset_sinks();
+    LogRing r(4096);
+
+    // 4 records of 1008 bytes leave 64 at the end
+    for ( char c = 'a'; c < 'e'; ++c )
+        REQUIRE(put(r, 1, record(c, 1000)));
+
+    drain_all(r);
+    CHECK(sinks[1].size() == 4000);
+
+    // the end is padded and the record goes to the start
+    REQUIRE(put(r, 1, record('e', 200)));
+    REQUIRE(put(r, 1, record('f', 100)));
+    drain_all(r);
+    CHECK(sinks[1] == record('a', 1000) + record('b', 1000) + record('c', 1000) +
+        record('d', 1000) + record('e', 200) + record('f', 100));
+
+    // an empty ring can't take a record that needs padding to exceed it
+    PegCount drops = async_log_stats.drops;
+    CHECK(!put(r, 1, record('g', 4088)));
+    CHECK(async_log_stats.drops == drops + 1);
+
+    // but one that ends at the end of the buffer needs no padding; the 'e'
+    // and 'f' records took 320 bytes from the start
+    sinks.clear();
+    REQUIRE(put(r, 1, record('h', 4096 - 320 - 8)));
+    REQUIRE(put(r, 1, record('i', 100)));
+    drain_all(r);
+    CHECK(sinks[1] == record('h', 3768) + record('i', 100));
+    CHECK(r.empty());
+}
+
+TEST_CASE("a full ring drops or blocks", "[async_log]")
+{
+    reset_sinks();
+    LogRing r(4096);
+
+    for ( char c = 'a'; c < 'e'; ++c )
+        REQUIRE(put(r, 1, record(c, 1000)));
+
+    SECTION("drop")
+    {
+        PegCount drops = async_log_stats.drops;
+        CHECK(!put(r, 1, record('e', 1000)));
+        CHECK(async_log_stats.drops == drops + 1);
+
+        drain_all(r);
+        CHECK(sinks[1].size() == 4000);
+    }
+
+    SECTION("block")
+    {
+        PegCount blocks = async_log_stats.blocks;
+        PegCount drops = async_log_stats.drops;
+
+        std::thread writer([&r]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            drain_all(r);
+        });
+
+        CHECK(put(r, 1, record('e', 1000), true));
+        writer.join();
+        drain_all(r);
+
+        CHECK(async_log_stats.blocks == blocks + 1);
+        CHECK(async_log_stats.drops == drops);
+        CHECK(sinks[1] == record('a', 1000) + record('b', 1000) + record('c', 1000) +
+            record('d', 1000) + record('e', 1000));
+    }
+}
+
+TEST_CASE("short and interrupted writes are resumed", "[async_log]")
+{
+    reset_sinks();
+    LogRing r(4096);
+
+    // records are gathered from several buffers
+    std::string head = "0123456789";
+    std::string body = "abcdefghijklmnopqrstuvwxyz";
+
+    for ( int i = 0; i < 3; ++i )
+    {
+        struct iovec iov[2] = { { (void*)head.data(), head.size() },
+            { (void*)body.data(), body.size() } };
+        REQUIRE(r.put(5, iov, 2, head.size() + body.size(), false));
+    }
+
+    max_write = 7;
+    interrupts = 1;
+
+    CHECK(r.drain());
+    CHECK(!r.drain());
+
+    CHECK(sinks[5] == head + body + head + body + head + body);
+    CHECK(writev_calls == 1 + (3 * 36 + 6) / 7);
+    CHECK(errors == 0);
+}
+
+TEST_CASE("failed writes are reported once and dropped", "[async_log]")
+{
+    reset_sinks();
+    LogRing r(4096);
+    fail_errno = EBADF;
+
+    CHECK(put(r, 1, "lost"));
+    CHECK(put(r, 2, "gone"));
+    drain_all(r);
+
+    CHECK(r.empty());
+    CHECK(errors == 1);
+    CHECK(sinks.empty());
+}
+
+//-------------------------------------------------------------------------
+// writer thread
+//-------------------------------------------------------------------------
+
+TEST_CASE("the writer thread drains every packet thread", "[async_log]")
+{
+    reset_sinks();
+    max_write = 5;
+
+    CHECK(!async_log_enabled());
+    async_log_start(4096, true);
+
+    auto packet_thread = [](int fd)
+    {
+        async_log_tinit();
+        CHECK(async_log_enabled());
+
+        for ( unsigned i = 0; i < 500; ++i )
+        {
+            std::string s = std::to_string(i) + record('x', i % 50) + "\n";
+            async_log_write(fd, s.data(), s.size());
+        }
+
+        async_log_flush();
+        async_log_tterm();
+        CHECK(!async_log_enabled());
+    };
+
+    std::thread t1(packet_thread, 10);
+    std::thread t2(packet_thread, 11);
+    t1.join();
+    t2.join();
+
+    async_log_stop();
+
+    std::string expected;
+
+    for ( unsigned i = 0; i < 500; ++i )
+        expected += std::to_string(i) + record('x', i % 50) + "\n";
+
+    CHECK(sinks[10] == expected);
+    CHECK(sinks[11] == expected);
+    CHECK(errors == 0);
+}
+
+#endif
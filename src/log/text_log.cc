@@ -38,6 +38,7 @@
 
 #include "utils/util.h"
 
+#include "async_log.h"
 #include "log.h"
 
 using namespace snort;
@@ -146,6 +147,7 @@ void TextLog_Term(TextLog* const txt)
         return;
 
     TextLog_Flush(txt);
+    async_log_flush();
     TextLog_Close(txt->file);
 
     if ( txt->name )
@@ -166,6 +168,7 @@ static void TextLog_Roll(TextLog* const txt)
     if ( txt->last >= time(nullptr) )
         return;
 
+    async_log_flush();
     TextLog_Close(txt->file);
     RollAlertFile(txt->name);
     txt->file = TextLog_Open(txt->name);
@@ -188,6 +191,18 @@ bool TextLog_Flush(TextLog* const txt)
     if ( txt->maxFile and txt->size + txt->pos > txt->maxFile )
         TextLog_Roll(txt);
 
+    // stdout is left to stdio so it stays in line with other messages
+    if ( txt->file != stdout and async_log_enabled() )
+    {
+        bool queued = async_log_write(fileno(txt->file), txt->buf, txt->pos);
+
+        if ( queued )
+            txt->size += txt->pos;
+
+        TextLog_Reset(txt);
+        return queued;
+    }
+
     ok = fwrite(txt->buf, txt->pos, 1, txt->file);
 
     if ( ok == 1 )
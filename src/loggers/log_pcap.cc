@@ -27,6 +27,7 @@
 #include "detection/ips_context.h"
 #include "framework/logger.h"
 #include "framework/module.h"
+#include "log/async_log.h"
 #include "log/messages.h"
 #include "main/snort_config.h"
 #include "packet_io/sfdaq.h"
@@ -130,6 +131,21 @@ static void LogTcpdumpSingle(
     if ( data->limit && (context.size + dumpSize > data->limit) )
         TcpdumpRollLogFile(data);
 
+    if ( async_log_enabled() )
+    {
+        // this is the dumped header of PCAP_PKT_HDR_SZ, not pcap_pkthdr
+        uint32_t hdr[4] =
+        {
+            (uint32_t)p->pkth->ts.tv_sec, (uint32_t)p->pkth->ts.tv_usec,
+            p->pktlen, p->pkth->pktlen
+        };
+        struct iovec iov[2] = { { hdr, sizeof(hdr) }, { (void*)p->pkt, p->pktlen } };
+
+        if ( async_log_write(fileno(pcap_dump_file(context.dumpd)), iov, 2) )
+            context.size += dumpSize;
+        return;
+    }
+
     struct pcap_pkthdr pcaphdr;
     pcaphdr.ts = p->pkth->ts;
     pcaphdr.caplen = p->pktlen;
@@ -189,6 +205,10 @@ static void TcpdumpInitLogFile(LtdConfig*, bool no_timestamp)
     }
     pcap_close(pcap);
 
+    // the file header must precede any queued packets
+    if ( async_log_enabled() )
+        pcap_dump_flush(context.dumpd);
+
     context.file = snort_strdup(file.c_str());
     context.size = PCAP_FILE_HDR_SZ;
 }
@@ -206,6 +226,7 @@ static void TcpdumpRollLogFile(LtdConfig* data)
     /* close the output file */
     if ( context.dumpd != nullptr )
     {
+        async_log_flush();
         pcap_dump_close(context.dumpd);
         context.dumpd = nullptr;
         context.size = 0;
@@ -278,6 +299,7 @@ void PcapLogger::close()
 
     if ( context.dumpd )
     {
+        async_log_flush();
         pcap_dump_close(context.dumpd);
         context.dumpd = nullptr;
     }
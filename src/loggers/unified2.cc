@@ -36,6 +36,7 @@
 #include "events/event.h"
 #include "framework/logger.h"
 #include "framework/module.h"
+#include "log/async_log.h"
 #include "log/messages.h"
 #include "log/obfuscator.h"
 #include "log/unified2.h"
@@ -143,6 +144,7 @@ static void Unified2InitFile(Unified2Config* config)
 
 static inline void Unified2RotateFile(Unified2Config* config)
 {
+    async_log_flush();
     fclose(u2.stream);
     u2.current = 0;
     Unified2InitFile(config);
@@ -435,6 +437,15 @@ static void Unified2Write(uint8_t* buf, uint32_t buf_len, Unified2Config* config
     if ((buf == nullptr) || (config == nullptr) || (u2.stream == nullptr))
         return;
 
+    /* The writer thread writes whole records so spoolers still get an
+     * entire record.  Write errors are reported by the writer thread. */
+    if ( async_log_enabled() )
+    {
+        if ( async_log_write(fileno(u2.stream), buf, buf_len) )
+            u2.current += buf_len;
+        return;
+    }
+
     /* Don't use fsync().  It is a total performance killer */
     if (((fwcount = fwrite(buf, (size_t)buf_len, 1, u2.stream)) != 1) ||
         (fflush(u2.stream) != 0))
@@ -884,7 +895,10 @@ void U2Logger::open()
 void U2Logger::close()
 {
     if ( u2.stream )
+    {
+        async_log_flush();
         fclose(u2.stream);
+    }
 
     delete[] write_pkt_buffer;
     delete[] io_buffer;
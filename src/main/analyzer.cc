@@ -43,6 +43,7 @@
 #include "framework/data_bus.h"
 #include "latency/packet_latency.h"
 #include "latency/rule_latency.h"
+#include "log/async_log.h"
 #include "log/messages.h"
 #include "main/swapper.h"
 #include "main.h"
@@ -539,6 +540,7 @@ void Analyzer::idle()
     increment = { static_cast<time_t>(timeout / 1000), static_cast<suseconds_t>((timeout % 1000) * 1000) };
     timeradd(&now, &increment, &now);
     packet_time_update(&now);
+    packet_thread_time_update();
 
     DataBus::publish(THREAD_IDLE_EVENT, nullptr);
 
@@ -589,6 +591,7 @@ void Analyzer::init_unprivileged()
     InitTag();
     EventTrace_Init();
 
+    async_log_tinit();
     EventManager::open_outputs();
     IpsManager::setup_options(sc);
     ActionManager::thread_init(sc);
@@ -606,6 +609,7 @@ void Analyzer::init_unprivileged()
     // init filters hash tables that depend on alerts
     sfthreshold_alloc(sc->threshold_config->memcap, sc->threshold_config->memcap);
     SFRF_Alloc(sc->rate_filter_config->memcap);
+    detection_filter_tinit(sc->detection_filter_config);
 }
 
 void Analyzer::reinit(const SnortConfig* sc)
@@ -645,6 +649,7 @@ void Analyzer::term()
 
     IpsManager::clear_options(sc);
     EventManager::close_outputs();
+    async_log_tterm();
     CodecManager::thread_term();
     HighAvailabilityManager::thread_term();
     SideChannelManager::thread_term();
@@ -671,6 +676,7 @@ void Analyzer::term()
 
     sfthreshold_free();
     RateFilter_Cleanup();
+    detection_filter_tterm();
 
     TraceApi::thread_term();
 
@@ -824,6 +830,7 @@ DAQ_RecvStatus Analyzer::process_messages()
         Profile profile(daqPerfStats);
         rstat = daq_instance->receive_messages(max_recv);
     }
+    packet_thread_time_update();
 
     // Preemptively service available onloads to potentially unblock processing the first message.
     // This conveniently handles servicing offloads in the no messages received case as well.
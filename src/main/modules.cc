@@ -43,6 +43,7 @@
 #include "host_tracker/host_tracker_module.h"
 #include "host_tracker/host_cache_module.h"
 #include "latency/latency_module.h"
+#include "log/async_log.h"
 #include "log/messages.h"
 #include "managers/module_manager.h"
 #include "managers/plugin_manager.h"
@@ -624,6 +625,10 @@ static const Parameter alerts_params[] =
     { "detection_filter_memcap", Parameter::PT_INT, "0:max32", "1048576",
       "set available MB of memory for detection_filters" },
 
+    { "detection_filter_sync", Parameter::PT_INT, "1:max32", "1",
+      "number of detection_filter matches per address a packet thread may count "
+      "before merging them into the shared counts; 1 keeps exact counts" },
+
     { "event_filter_memcap", Parameter::PT_INT, "0:max32", "1048576",
       "set available MB of memory for event_filters" },
 
@@ -670,6 +675,9 @@ bool AlertsModule::set(const char*, Value& v, SnortConfig* sc)
     else if ( v.is("detection_filter_memcap") )
         sc->detection_filter_config->memcap = v.get_uint32();
 
+    else if ( v.is("detection_filter_sync") )
+        sc->detection_filter_config->sync = v.get_uint32();
+
     else if ( v.is("event_filter_memcap") )
         sc->threshold_config->memcap = v.get_uint32();
 
@@ -708,6 +716,13 @@ static const Parameter output_event_trace_params[] =
 
 static const Parameter output_params[] =
 {
+    { "async_queue", Parameter::PT_INT, "0:maxSZ", "0",
+      "bytes of log output each packet thread can queue for a separate writer thread "
+      "(0 writes from the packet threads)" },
+
+    { "async_overflow", Parameter::PT_ENUM, "drop|block", "drop",
+      "drop log output or wait for the writer when the queue is full" },
+
     { "dump_chars_only", Parameter::PT_BOOL, nullptr, "false",
       "turns on character dumps (same as -C)" },
 
@@ -771,11 +786,23 @@ public:
 
     const RuleMap* get_rules() const override
     { return output_rules; }
+
+    const PegInfo* get_pegs() const override
+    { return async_log_pegs; }
+
+    PegCount* get_counts() const override
+    { return (PegCount*)&async_log_stats; }
 };
 
 bool OutputModule::set(const char*, Value& v, SnortConfig* sc)
 {
-    if ( v.is("dump_chars_only") )
+    if ( v.is("async_queue") )
+        sc->async_log_queue = v.get_size();
+
+    else if ( v.is("async_overflow") )
+        sc->async_log_block = v.get_uint8() == 1;
+
+    else if ( v.is("dump_chars_only") )
         v.update_mask(sc->output_flags, OUTPUT_FLAG__CHAR_DATA);
 
     else if ( v.is("dump_payload") )
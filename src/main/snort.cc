@@ -41,6 +41,7 @@
 #include "helpers/process.h"
 #include "host_tracker/host_cache.h"
 #include "ips_options/ips_options.h"
+#include "log/async_log.h"
 #include "log/log.h"
 #include "log/messages.h"
 #include "loggers/loggers.h"
@@ -423,6 +424,8 @@ void Snort::setup(int argc, char* argv[])
 
     host_cache.print_config();
 
+    async_log_start(sc->async_log_queue, sc->async_log_block);
+
     TimeStart();
 }
 
@@ -436,6 +439,7 @@ void Snort::cleanup()
     if ( !SnortConfig::get_conf()->test_mode() )  // FIXIT-M ideally the check is in one place
         PrintStatistics();
 
+    async_log_stop();
     CloseLogger();
     ThreadConfig::term();
     clean_exit(0);
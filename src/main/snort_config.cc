@@ -506,6 +506,15 @@ bool SnortConfig::verify() const
     else if (sc->detection_filter_config->memcap != detection_filter_config->memcap)
         ReloadError("Changing alerts.detection_filter_memcap requires a restart.\n");
 
+    else if (sc->detection_filter_config->sync != detection_filter_config->sync)
+        ReloadError("Changing alerts.detection_filter_sync requires a restart.\n");
+
+    else if (sc->async_log_queue != async_log_queue)
+        ReloadError("Changing output.async_queue requires a restart.\n");
+
+    else if (sc->async_log_block != async_log_block)
+        ReloadError("Changing output.async_overflow requires a restart.\n");
+
     else
         config_ok = true;
 
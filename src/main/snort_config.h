@@ -232,6 +232,9 @@ public:
     uint32_t tagged_packet_limit = 256;
     uint16_t event_trace_max = 0;
 
+    size_t async_log_queue = 0;
+    bool async_log_block = false;
+
     std::string log_dir;
 
     //------------------------------------------------------
@@ -90,12 +90,16 @@ void EventTrace_Init() { }
 void EventTrace_Term() { }
 void detection_filter_init(DetectionFilterConfig*) { }
 void detection_filter_term() { }
+void detection_filter_tinit(DetectionFilterConfig*) { }
+void detection_filter_tterm() { }
 void RuleLatency::tterm() { }
 void PacketLatency::tterm() { }
 void SideChannelManager::thread_init() { }
 void SideChannelManager::thread_term() { }
 void CodecManager::thread_init(const snort::SnortConfig*) { }
 void CodecManager::thread_term() { }
+void async_log_tinit() { }
+void async_log_tterm() { }
 void EventManager::open_outputs() { }
 void EventManager::close_outputs() { }
 void IpsManager::setup_options(const snort::SnortConfig*) { }
@@ -105,6 +109,7 @@ void ActionManager::thread_term() { }
 void ActionManager::thread_reinit(const snort::SnortConfig*) { }
 int SFRF_Alloc(unsigned int) { return -1; }
 void packet_time_update(const struct timeval*) { }
+void packet_thread_time_update() { }
 void main_poke(unsigned) { }
 void set_default_policy(const snort::SnortConfig*) { }
 bool snort_ignore(snort::Packet*) { return false; }
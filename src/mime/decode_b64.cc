@@ -26,6 +26,7 @@
 
 #include "utils/util_unfold.h"
 
+#include "decode_block.h"
 #include "decode_buffer.h"
 
 using namespace snort;
@@ -155,8 +156,32 @@ int sf_base64decode(uint8_t* inbuf, uint32_t inbuf_size, uint8_t* outbuf, uint32
     *bytes_written = 0;
     cursor = inbuf;
     outbuf_ptr = outbuf;
+    /* Whole groups of clean input are decoded in blocks. When a block can't be decoded that
+       way, the byte loop below takes over for at least one block. */
+    uint8_t* scalar_end = cursor;
+
     while ((cursor < endofinbuf) && (n < max_base64_chars))
     {
+        if ((base64data_ptr == base64data) && (cursor >= scalar_end))
+        {
+            uint32_t len = endofinbuf - cursor;
+
+            if (len > max_base64_chars - n)
+                len = max_base64_chars - n;
+
+            if (len > (outbuf_size - *bytes_written) / 3 * 4)
+                len = (outbuf_size - *bytes_written) / 3 * 4;
+
+            len = b64_decode_blocks(cursor, len, outbuf_ptr);
+
+            cursor += len;
+            n += len;
+            outbuf_ptr += len / 4 * 3;
+            *bytes_written += len / 4 * 3;
+            scalar_end = cursor + 32;
+            continue;
+        }
+
         if (sf_decode64tab[*cursor] != 100)
         {
             *base64data_ptr++ = *cursor;
@@ -28,7 +28,8 @@ enum DecodeResult
 {
     DECODE_SUCCESS,
     DECODE_EXCEEDED, // Decode Complete when we reach the max depths
-    DECODE_FAIL
+    DECODE_FAIL,
+    DECODE_BUDGET    // Decompression budget of the flow is spent
 };
 
 class DataDecode
@@ -0,0 +1,292 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// decode_block.cc
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "decode_block.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) and defined(__GNUC__)
+#include <immintrin.h>
+#define DECODE_BLOCK_X86
+#endif
+
+#ifdef DECODE_BLOCK_X86
+
+//-------------------------------------------------------------------------
+// ssse3
+//-------------------------------------------------------------------------
+
+// base64 characters are validated and translated to their 6 bit values with
+// nibble lookups as described by Wojciech Mula and Daniel Lemire in "Faster
+// Base64 Encoding and Decoding Using AVX2 Instructions"
+
+__attribute__((target("ssse3")))
+static inline bool b64_values(__m128i in, __m128i& out)
+{
+    const __m128i lut_lo = _mm_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+
+    const __m128i lut_hi = _mm_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+
+    const __m128i lut_roll = _mm_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+
+    __m128i hi = _mm_and_si128(_mm_srli_epi32(in, 4), nibble);
+    __m128i lo = _mm_and_si128(in, nibble);
+
+    __m128i bad = _mm_and_si128(_mm_shuffle_epi8(lut_lo, lo), _mm_shuffle_epi8(lut_hi, hi));
+
+    if ( _mm_movemask_epi8(_mm_cmpeq_epi8(bad, _mm_setzero_si128())) != 0xffff )
+        return false;
+
+    __m128i slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+    __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(slash, hi));
+
+    out = _mm_add_epi8(in, roll);
+    return true;
+}
+
+// packs 16 6 bit values into 12 bytes
+__attribute__((target("ssse3")))
+static inline void pack_values(__m128i v, uint8_t* out)
+{
+    v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+    v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+    v = _mm_shuffle_epi8(v, _mm_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+    _mm_storel_epi64((__m128i*)out, v);
+    uint32_t last = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+    memcpy(out + 8, &last, sizeof(last));
+}
+
+__attribute__((target("ssse3")))
+static uint32_t b64_decode_ssse3(const uint8_t* in, uint32_t len, uint8_t* out)
+{
+    uint32_t i = 0;
+
+    for ( ; i + 16 <= len; i += 16, out += 12 )
+    {
+        __m128i v;
+
+        if ( !b64_values(_mm_loadu_si128((const __m128i*)(in + i)), v) )
+            break;
+
+        pack_values(v, out);
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+static uint32_t uu_decode_ssse3(const uint8_t* in, uint32_t len, uint8_t* out)
+{
+    uint32_t i = 0;
+
+    for ( ; i + 16 <= len; i += 16, out += 12 )
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        v = _mm_and_si128(_mm_sub_epi8(v, _mm_set1_epi8(0x20)), _mm_set1_epi8(0x3f));
+        pack_values(v, out);
+    }
+    return i;
+}
+
+//-------------------------------------------------------------------------
+// avx2
+//-------------------------------------------------------------------------
+
+// packs 32 6 bit values into 24 bytes
+__attribute__((target("avx2")))
+static inline void pack_values(__m256i v, uint8_t* out)
+{
+    v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+    v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+    v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+    _mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(v));
+    _mm_storel_epi64((__m128i*)(out + 16), _mm256_extracti128_si256(v, 1));
+}
+
+__attribute__((target("avx2")))
+static uint32_t b64_decode_avx2(const uint8_t* in, uint32_t len, uint8_t* out)
+{
+    const __m256i lut_lo = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+
+    const __m256i lut_hi = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+
+    const __m256i lut_roll = _mm256_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i slash = _mm256_set1_epi8('/');
+
+    uint32_t i = 0;
+
+    for ( ; i + 32 <= len; i += 32, out += 24 )
+    {
+        __m256i in_v = _mm256_loadu_si256((const __m256i*)(in + i));
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi32(in_v, 4), nibble);
+        __m256i lo = _mm256_and_si256(in_v, nibble);
+
+        __m256i bad = _mm256_and_si256(
+            _mm256_shuffle_epi8(lut_lo, lo), _mm256_shuffle_epi8(lut_hi, hi));
+
+        if ( !_mm256_testz_si256(bad, bad) )
+            break;
+
+        __m256i roll = _mm256_shuffle_epi8(
+            lut_roll, _mm256_add_epi8(_mm256_cmpeq_epi8(in_v, slash), hi));
+
+        pack_values(_mm256_add_epi8(in_v, roll), out);
+    }
+
+    // the tail may still hold a whole 16 character block
+    return i + b64_decode_ssse3(in + i, len - i, out);
+}
+
+__attribute__((target("avx2")))
+static uint32_t uu_decode_avx2(const uint8_t* in, uint32_t len, uint8_t* out)
+{
+    uint32_t i = 0;
+
+    for ( ; i + 32 <= len; i += 32, out += 24 )
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i));
+        v = _mm256_and_si256(_mm256_sub_epi8(v, _mm256_set1_epi8(0x20)), _mm256_set1_epi8(0x3f));
+        pack_values(v, out);
+    }
+    return i + uu_decode_ssse3(in + i, len - i, out);
+}
+
+//-------------------------------------------------------------------------
+// sse2
+//-------------------------------------------------------------------------
+
+// sf_qpdecode() copies printable characters, tab, cr and lf and drops other
+// bytes; '=' starts an escape
+static uint32_t qp_literal_sse2(const uint8_t* in, uint32_t len)
+{
+    const __m128i lo = _mm_set1_epi8(0x1f);
+    const __m128i hi = _mm_set1_epi8(0x7f);
+    const __m128i eq = _mm_set1_epi8('=');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+
+    uint32_t i = 0;
+
+    for ( ; i + 16 <= len; i += 16 )
+    {
+        // bytes above 0x7f are negative and fail the signed range check
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i ok = _mm_and_si128(_mm_cmpgt_epi8(v, lo), _mm_cmplt_epi8(v, hi));
+
+        ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, tab));
+        ok = _mm_or_si128(ok, _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+        ok = _mm_andnot_si128(_mm_cmpeq_epi8(v, eq), ok);
+
+        unsigned stop = ~_mm_movemask_epi8(ok) & 0xffff;
+
+        if ( stop )
+            return i + __builtin_ctz(stop);
+    }
+    return i;
+}
+
+//-------------------------------------------------------------------------
+// dispatch
+//-------------------------------------------------------------------------
+
+typedef uint32_t (* DecodeBlocks)(const uint8_t*, uint32_t, uint8_t*);
+
+struct DecodeImpl
+{
+    DecodeBlocks b64;
+    DecodeBlocks uu;
+
+    DecodeImpl();
+};
+
+static uint32_t no_blocks(const uint8_t*, uint32_t, uint8_t*)
+{ return 0; }
+
+DecodeImpl::DecodeImpl()
+{
+    __builtin_cpu_init();
+
+    if ( __builtin_cpu_supports("avx2") )
+    {
+        b64 = b64_decode_avx2;
+        uu = uu_decode_avx2;
+    }
+    else if ( __builtin_cpu_supports("ssse3") )
+    {
+        b64 = b64_decode_ssse3;
+        uu = uu_decode_ssse3;
+    }
+    else
+        b64 = uu = no_blocks;
+}
+
+static const DecodeImpl impl;
+
+uint32_t b64_decode_blocks(const uint8_t* in, uint32_t len, uint8_t* out)
+{ return impl.b64(in, len, out); }
+
+uint32_t uu_decode_blocks(const uint8_t* in, uint32_t len, uint8_t* out)
+{ return impl.uu(in, len, out); }
+
+uint32_t qp_literal_span(const uint8_t* in, uint32_t len)
+{ return qp_literal_sse2(in, len); }
+
+#else
+
+uint32_t b64_decode_blocks(const uint8_t*, uint32_t, uint8_t*)
+{ return 0; }
+
+uint32_t uu_decode_blocks(const uint8_t*, uint32_t, uint8_t*)
+{ return 0; }
+
+uint32_t qp_literal_span(const uint8_t*, uint32_t)
+{ return 0; }
+
+#endif
+
@@ -0,0 +1,48 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// decode_block.h
+
+
+#ifndef DECODE_BLOCK_H
+#define DECODE_BLOCK_H
+
+// Vectorized inner loops of the base64, quoted-printable and uuencode
+// decoders.  Each handles only the regular bulk of the input a block at a
+// time and leaves everything else to the byte loop of its caller, so the
+// output is the same as that of the byte loop alone.  The widest
+// implementation the CPU supports is selected at startup; without one the
+// functions do nothing.
+
+#include <cstdint>
+
+// decodes whole 16 character blocks of base64 up to the first block with a
+// character outside of the alphabet, including padding; returns the number
+// of characters decoded and writes 3/4 as many bytes to out
+uint32_t b64_decode_blocks(const uint8_t* in, uint32_t len, uint8_t* out);
+
+// decodes whole 16 character blocks of uuencoded line data; returns the
+// number of characters decoded and writes 3/4 as many bytes to out
+uint32_t uu_decode_blocks(const uint8_t* in, uint32_t len, uint8_t* out);
+
+// returns the length of the leading run of whole 16 byte blocks and then
+// bytes that quoted-printable decoding copies as is, ie the bytes before
+// the first '=' or byte that is dropped
+uint32_t qp_literal_span(const uint8_t* in, uint32_t len);
+
+#endif
+
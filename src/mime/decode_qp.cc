@@ -26,9 +26,11 @@
 
 #include <cctype>
 #include <cstdlib>
+#include <cstring>
 
 #include "utils/util_unfold.h"
 
+#include "decode_block.h"
 #include "decode_buffer.h"
 
 using namespace snort;
@@ -110,6 +112,22 @@ int sf_qpdecode(const char* src, uint32_t slen, char* dst, uint32_t dlen, uint32
 
     while ( (*bytes_read < slen) && (*bytes_copied < dlen))
     {
+        uint32_t len = slen - *bytes_read;
+
+        if ( len > dlen - *bytes_copied )
+            len = dlen - *bytes_copied;
+
+        /* copy runs of literal characters in bulk */
+        len = qp_literal_span((const uint8_t*)src + *bytes_read, len);
+
+        if ( len )
+        {
+            memcpy(dst + *bytes_copied, src + *bytes_read, len);
+            *bytes_read += len;
+            *bytes_copied += len;
+            continue;
+        }
+
         char ch = src[*bytes_read];
         *bytes_read += 1;
 
@@ -29,6 +29,7 @@
 #include "utils/safec.h"
 #include "utils/util_cstring.h"
 
+#include "decode_block.h"
 #include "decode_buffer.h"
 
 using namespace snort;
@@ -217,6 +218,11 @@ int sf_uudecode(uint8_t* src, uint32_t slen, uint8_t* dst, uint32_t dlen, uint32
 
             ptr++;
 
+            uint32_t n = uu_decode_blocks(ptr, length, dptr);
+            ptr += n;
+            dptr += n / 4 * 3;
+            length -= n;
+
             while ( length > 0 )
             {
                 *dptr++ = (UU_DECODE_CHAR(ptr[0]) << 2) | (UU_DECODE_CHAR(ptr[1]) >> 4);
@@ -131,6 +131,16 @@ uint32_t DecodeConfig::get_decompress_buffer_size() const
     return decompress_buffer_size;
 }
 
+void DecodeConfig::set_decompress_flow_budget(uint64_t budget)
+{
+    decompress_flow_budget = budget;
+}
+
+uint64_t DecodeConfig::get_decompress_flow_budget() const
+{
+    return decompress_flow_budget;
+}
+
 int64_t DecodeConfig::get_file_depth() const
 {
     return file_depth;
@@ -183,5 +193,6 @@ void DecodeConfig::show(bool full) const
     ConfigLogger::log_flag("decompress_zip", decompress_zip);
     ConfigLogger::log_flag("decompress_vba", decompress_vba);
     ConfigLogger::log_value("decompress_buffer_size", decompress_buffer_size);
+    ConfigLogger::log_limit("decompress_flow_budget", (int64_t)decompress_flow_budget, (int64_t)0);
 }
 
@@ -69,6 +69,10 @@ public:
     void set_decompress_buffer_size(uint32_t);
     uint32_t get_decompress_buffer_size() const;
 
+    // 0 is no limit
+    void set_decompress_flow_budget(uint64_t);
+    uint64_t get_decompress_flow_budget() const;
+
     int64_t get_file_depth() const;
     bool is_decoding_enabled() const;
     void sync_all_depths();
@@ -86,6 +90,7 @@ private:
     bool decompress_zip = false;
     bool decompress_vba = false;
     uint32_t decompress_buffer_size = DEFAULT_DECOMP;
+    uint64_t decompress_flow_budget = 0;
     int64_t file_depth = MIN_DEPTH;
     bool decode_enabled = true;
 };
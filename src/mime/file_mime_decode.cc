@@ -177,6 +177,12 @@ DecodeResult MimeDecode::decompress_data(const uint8_t* buf_in, uint32_t size_in
     case File_Decomp_NoSig:
     case File_Decomp_Error:
         break;
+    case File_Decomp_BudgetOut:
+        // stays off for the rest of the flow since reset skips a null session
+        File_Decomp_StopFree(fd_state);
+        fd_state = nullptr;
+        result = DECODE_BUDGET;
+        break;
     default:
         buf_out = decompress_buf;
         size_out = fd_state->Next_Out - decompress_buf;
@@ -267,12 +273,16 @@ void MimeDecode::file_decomp_init()
     fd_state->Compr_Depth = 0;
     fd_state->Decompr_Depth = 0;
 
+    if ( config->get_decompress_flow_budget() )
+        fd_state->Budget = &fd_budget;
+
     (void)File_Decomp_Init(fd_state);
 }
 
 MimeDecode::MimeDecode(DecodeConfig* conf)
 {
     config = conf;
+    fd_budget = config->get_decompress_flow_budget();
     file_decomp_init();
 }
 
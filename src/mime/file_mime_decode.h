@@ -93,6 +93,7 @@ private:
     snort::DecodeConfig* config;
     DataDecode* decoder = nullptr;
     fd_session_t* fd_state = nullptr;
+    uint64_t fd_budget = 0;   // shared by the attachments of the flow
     BufferData ole_data;
     BufferData decompressed_vba_data;
 };
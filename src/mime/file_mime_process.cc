@@ -587,7 +587,9 @@ const uint8_t* MimeSession::process_mime_data_paf(
                 buffer, detection_size, decomp_buffer, decomp_buf_size
             );
 
-            if ( result != DECODE_SUCCESS )
+            if ( result == DECODE_BUDGET )
+                decompress_budget_alert();
+            else if ( result != DECODE_SUCCESS )
                 decompress_alert();
 
             if (!is_http)
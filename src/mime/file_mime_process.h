@@ -108,6 +108,7 @@ private:
     virtual int normalize_data(const uint8_t*, const uint8_t*, Packet*) { return 0; }
     virtual void decode_alert() { }
     virtual void decompress_alert() { }
+    virtual void decompress_budget_alert() { }
     virtual void reset_state(Flow*) { }
     virtual bool is_end_of_data(Flow*) { return false; }
 
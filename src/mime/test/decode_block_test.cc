@@ -0,0 +1,557 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// decode_block_test.cc
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "mime/decode_b64.h"
+#include "mime/decode_qp.h"
+#include "mime/decode_uu.h"
+#include "utils/util_cstring.h"
+
+using namespace snort;
+
+extern uint8_t sf_decode64tab[256];
+
+//-------------------------------------------------------------------------
+// the byte loops the vectorized decoders must match
+//-------------------------------------------------------------------------
+
+#define UU_DECODE_CHAR(c) (((c) - 0x20) & 0x3f)
+
+static int ref_base64decode(uint8_t* inbuf, uint32_t inbuf_size, uint8_t* outbuf, uint32_t outbuf_size,
+    uint32_t* bytes_written)
+{
+    uint8_t* cursor, * endofinbuf;
+    uint8_t* outbuf_ptr;
+    uint8_t base64data[4], * base64data_ptr; /* temporary holder for current base64 chunk */
+    uint8_t tableval_a, tableval_b, tableval_c, tableval_d;
+
+    uint32_t n;
+    uint32_t max_base64_chars; /* The max number of decoded base64 chars that fit into outbuf */
+
+    int error = 0;
+
+    /* This algorithm will waste up to 4 bytes but we really don't care.
+       At the end we're going to copy the exact number of bytes requested. */
+    max_base64_chars = (outbuf_size / 3) * 4 + 4; /* 4 base64 bytes gives 3 data bytes, plus
+                                                    an extra 4 to take care of any rounding */
+
+    base64data_ptr = base64data;
+    endofinbuf = inbuf + inbuf_size;
+
+    /* Strip non-base64 chars from inbuf and decode */
+    n = 0;
+    *bytes_written = 0;
+    cursor = inbuf;
+    outbuf_ptr = outbuf;
+    while ((cursor < endofinbuf) && (n < max_base64_chars))
+    {
+        if (sf_decode64tab[*cursor] != 100)
+        {
+            *base64data_ptr++ = *cursor;
+            n++; /* Number of base64 bytes we've stored */
+            if (!(n % 4))
+            {
+                /* We have four databytes upon which to operate */
+
+                if ((base64data[0] == '=') || (base64data[1] == '='))
+                {
+                    /* Error in input data */
+                    error = 1;
+                    break;
+                }
+
+                /* retrieve values from lookup table */
+                tableval_a = sf_decode64tab[base64data[0]];
+                tableval_b = sf_decode64tab[base64data[1]];
+                tableval_c = sf_decode64tab[base64data[2]];
+                tableval_d = sf_decode64tab[base64data[3]];
+
+                if (*bytes_written < outbuf_size)
+                {
+                    *outbuf_ptr++ = (tableval_a << 2) | (tableval_b >> 4);
+                    (*bytes_written)++;
+                }
+
+                if ((base64data[2] != '=') && (*bytes_written < outbuf_size))
+                {
+                    *outbuf_ptr++ = (tableval_b << 4) | (tableval_c >> 2);
+                    (*bytes_written)++;
+                }
+                else
+                {
+                    break;
+                }
+
+                if ((base64data[3] != '=') && (*bytes_written < outbuf_size))
+                {
+                    *outbuf_ptr++ = (tableval_c << 6) | tableval_d;
+                    (*bytes_written)++;
+                }
+                else
+                {
+                    break;
+                }
+
+                /* Reset our decode pointer for the next group of four */
+                base64data_ptr = base64data;
+            }
+        }
+        cursor++;
+    }
+
+    if (error)
+        return(-1);
+    else
+        return(0);
+}
+
+static int ref_qpdecode(const char* src, uint32_t slen, char* dst, uint32_t dlen, uint32_t* bytes_read,
+    uint32_t* bytes_copied)
+{
+    if (!src || !slen || !dst || !dlen || !bytes_read || !bytes_copied )
+        return -1;
+
+    *bytes_read = 0;
+    *bytes_copied = 0;
+
+    while ( (*bytes_read < slen) && (*bytes_copied < dlen))
+    {
+        char ch = src[*bytes_read];
+        *bytes_read += 1;
+
+        if ( ch == '=' )
+        {
+            if ( (*bytes_read < slen))
+            {
+                if (src[*bytes_read] == '\n')
+                {
+                    *bytes_read += 1;
+                    continue;
+                }
+                else if ( *bytes_read < (slen - 1) )
+                {
+                    char ch1 = src[*bytes_read];
+                    char ch2 = src[*bytes_read + 1];
+                    if ( ch1 == '\r' && ch2 == '\n')
+                    {
+                        *bytes_read += 2;
+                        continue;
+                    }
+                    if (isxdigit((int)ch1) && isxdigit((int)ch2))
+                    {
+                        char hexBuf[3];
+                        char* eptr;
+                        hexBuf[0] = ch1;
+                        hexBuf[1] = ch2;
+                        hexBuf[2] = '\0';
+                        dst[*bytes_copied]= (char)strtoul(hexBuf, &eptr, 16);
+                        if ((*eptr != '\0'))
+                        {
+                            return -1;
+                        }
+                        *bytes_read += 2;
+                        *bytes_copied +=1;
+                        continue;
+                    }
+                    dst[*bytes_copied] = ch;
+                    *bytes_copied +=1;
+                    continue;
+                }
+                else
+                {
+                    *bytes_read -= 1;
+                    return 0;
+                }
+            }
+            else
+            {
+                *bytes_read -= 1;
+                return 0;
+            }
+        }
+        else if ( isprint(ch) || isblank(ch) || ch == '\r' || ch == '\n' )
+        {
+            dst[*bytes_copied] = ch;
+            *bytes_copied +=1;
+        }
+    }
+
+    return 0;
+}
+
+static int ref_uudecode(uint8_t* src, uint32_t slen, uint8_t* dst, uint32_t dlen, uint32_t* bytes_read,
+    uint32_t* bytes_copied, bool* begin_found, bool* end_found)
+{
+    int sol = 1, length = 0;
+    const uint8_t* ptr;
+    uint8_t* end, * dptr, * dend;
+
+    if (!src || !slen || !dst || !dlen ||  !bytes_read || !bytes_copied || !begin_found ||
+        !end_found )
+        return -1;
+
+    ptr = src;
+    end = src + slen;
+    dptr = dst;
+    dend = dst + dlen;
+    /* begin not found. Search for begin */
+    if ( !(*begin_found) )
+    {
+        if ( slen < 5 )
+        {
+            /* Not enough data to search */
+            *bytes_read = 0;
+            *bytes_copied = 0;
+            return 0;
+        }
+        else
+        {
+            const uint8_t* sod = (const uint8_t*)SnortStrnStr((const char*)src, 5, "begin");
+
+            if (sod)
+            {
+                *begin_found = true;
+                /*begin str found. Move to the actual data*/
+                ptr = (const uint8_t*)SnortStrnStr((const char*)(sod), (end - sod), "\n");
+                if ( !ptr )
+                {
+                    *bytes_read = slen;
+                    *bytes_copied = 0;
+                    return 0;
+                }
+            }
+            else
+            {
+                /*Encoded data for UUencode should start with begin. Error encountered.*/
+                return -1;
+            }
+        }
+    }
+
+    while ( (ptr < end) && (dptr < dend))
+    {
+        if (*ptr == '\n')
+        {
+            sol = 1;
+            ptr++;
+            continue;
+        }
+
+        if (sol)
+        {
+            sol = 0;
+            length = UU_DECODE_CHAR(*ptr);
+
+            if ( length <= 0 )
+            {
+                /* empty line with no encoded characters indicates end of output */
+                break;
+            }
+            else if ( length == 5 )
+            {
+                if (*ptr == 'e')
+                {
+                    *end_found = true;
+                    break;
+                }
+            }
+            /* check if destination buffer is big enough */
+            if (( dend - dptr) < length)
+            {
+                length = dend - dptr;
+            }
+
+            length = (length * 4) / 3;
+
+            /*check if src buffer has enough encoded data*/
+            if ( (end - (ptr + 1)) < length)
+            {
+                /*not enough data to decode. We will wait for the next packet*/
+                break;
+            }
+
+            ptr++;
+
+            while ( length > 0 )
+            {
+                *dptr++ = (UU_DECODE_CHAR(ptr[0]) << 2) | (UU_DECODE_CHAR(ptr[1]) >> 4);
+                ptr++;
+                if (--length == 0 )
+                    break;
+
+                *dptr++ = (UU_DECODE_CHAR(ptr[0]) << 4) | (UU_DECODE_CHAR(ptr[1]) >> 2);
+                ptr++;
+                if (--length == 0)
+                    break;
+
+                *dptr++ = (UU_DECODE_CHAR(ptr[0]) << 6) | (UU_DECODE_CHAR(ptr[1]));
+                ptr += 2;
+                length -= 2;
+            }
+        }
+        else
+        {
+            /* probably padding. skip over it.*/
+            ptr++;
+        }
+    }
+
+    if (*end_found)
+        *bytes_read = end - src;
+    else
+        *bytes_read = ptr - src;
+    *bytes_copied = dptr - dst;
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+// inputs
+//-------------------------------------------------------------------------
+
+static const char b64_alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// base64 with the occasional line break, stray byte or padding
+static std::string make_b64(std::mt19937& rng, unsigned len, unsigned noise)
+{
+    std::string s;
+
+    for ( unsigned i = 0; i < len; ++i )
+    {
+        unsigned r = rng() % 1000;
+
+        if ( r < noise )
+            s += "\r\n=-.\x80 "[rng() % 7];
+        else
+            s += b64_alphabet[rng() % 64];
+    }
+    return s;
+}
+
+// mostly text with some escapes, soft line breaks and bytes that are dropped
+static std::string make_qp(std::mt19937& rng, unsigned len, unsigned noise)
+{
+    static const char hex[] = "0123456789ABCDEFabcdefgz";
+    std::string s;
+
+    while ( s.size() < len )
+    {
+        unsigned r = rng() % 1000;
+
+        if ( r < noise )
+        {
+            switch ( rng() % 6 )
+            {
+            case 0: s += "="; s += hex[rng() % 24]; s += hex[rng() % 24]; break;
+            case 1: s += "=\r\n"; break;
+            case 2: s += "=\n"; break;
+            case 3: s += "\r\n"; break;
+            case 4: s += (char)(rng() % 32); break;
+            default: s += (char)(0x7f + rng() % 129); break;
+            }
+        }
+        else
+            s += (char)(0x20 + rng() % 95);
+    }
+    return s;
+}
+
+// uuencoded lines of 1 to 45 bytes with the begin and end lines
+static std::string make_uu(std::mt19937& rng, unsigned lines, bool begin)
+{
+    std::string s = begin ? "begin 644 file\n" : "";
+
+    for ( unsigned i = 0; i < lines; ++i )
+    {
+        unsigned n = (rng() % 4) ? 45 : 1 + rng() % 45;
+        s += (char)(0x20 + n);
+
+        for ( unsigned j = 0; j < (n + 2) / 3 * 4; ++j )
+            s += (char)(0x21 + rng() % 64);
+
+        s += "\n";
+    }
+    s += "`\nend\n";
+    return s;
+}
+
+//-------------------------------------------------------------------------
+// comparisons
+//-------------------------------------------------------------------------
+
+static void check_b64(std::string in, uint32_t out_size)
+{
+    std::vector<uint8_t> ref(out_size + 1), out(out_size + 1);
+    uint32_t ref_n = 0, n = 0;
+
+    int ref_rc = ref_base64decode((uint8_t*)&in[0], in.size(), ref.data(), out_size, &ref_n);
+    int rc = sf_base64decode((uint8_t*)&in[0], in.size(), out.data(), out_size, &n);
+
+    REQUIRE(rc == ref_rc);
+    REQUIRE(n == ref_n);
+    REQUIRE(out == ref);
+}
+
+static void check_qp(const std::string& in, uint32_t out_size)
+{
+    std::vector<char> ref(out_size + 1), out(out_size + 1);
+    uint32_t ref_read = 0, ref_n = 0, read = 0, n = 0;
+
+    int ref_rc = ref_qpdecode(in.data(), in.size(), ref.data(), out_size, &ref_read, &ref_n);
+    int rc = sf_qpdecode(in.data(), in.size(), out.data(), out_size, &read, &n);
+
+    REQUIRE(rc == ref_rc);
+    REQUIRE(read == ref_read);
+    REQUIRE(n == ref_n);
+    REQUIRE(out == ref);
+}
+
+static void check_uu(std::string in, uint32_t out_size, bool begin)
+{
+    std::vector<uint8_t> ref(out_size + 1), out(out_size + 1);
+    uint32_t ref_read = 0, ref_n = 0, read = 0, n = 0;
+    bool ref_begin = begin, ref_end = false, b = begin, e = false;
+
+    int ref_rc = ref_uudecode((uint8_t*)&in[0], in.size(), ref.data(), out_size,
+        &ref_read, &ref_n, &ref_begin, &ref_end);
+    int rc = sf_uudecode((uint8_t*)&in[0], in.size(), out.data(), out_size,
+        &read, &n, &b, &e);
+
+    REQUIRE(rc == ref_rc);
+    REQUIRE(read == ref_read);
+    REQUIRE(n == ref_n);
+    REQUIRE(b == ref_begin);
+    REQUIRE(e == ref_end);
+    REQUIRE(out == ref);
+}
+
+#ifdef CATCH_TEST_BUILD
+
+TEST_CASE("base64 blocks match byte loop", "[mime]")
+{
+    std::mt19937 rng(1);
+
+    for ( unsigned i = 0; i < 20000; ++i )
+    {
+        unsigned noise = (i % 4) ? rng() % 20 : 0;
+        std::string in = make_b64(rng, rng() % 600, noise);
+        check_b64(in, 1 + rng() % 500);
+    }
+}
+
+TEST_CASE("base64 padding", "[mime]")
+{
+    check_b64("QUJDREVGR0hJSktMTU5PUFFSU1RVVldY", 100);
+    check_b64("QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVo=", 100);
+    check_b64("QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWQ==QUJD", 100);
+    check_b64("QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVo=", 24);
+    check_b64("QUJDREVGR0hJSktMTU5PUFFSU1RVVldY=QUJDREVGR0hJSktM", 100);
+}
+
+TEST_CASE("quoted-printable literal runs match byte loop", "[mime]")
+{
+    std::mt19937 rng(2);
+
+    for ( unsigned i = 0; i < 20000; ++i )
+    {
+        std::string in = make_qp(rng, 1 + rng() % 600, rng() % 100);
+        check_qp(in, 1 + rng() % 700);
+    }
+}
+
+TEST_CASE("uuencode blocks match byte loop", "[mime]")
+{
+    std::mt19937 rng(3);
+
+    for ( unsigned i = 0; i < 5000; ++i )
+    {
+        bool begin = rng() & 1;
+        std::string in = make_uu(rng, rng() % 12, !begin);
+
+        // cut the data short or add stray bytes
+        if ( rng() & 1 )
+            in.resize(rng() % (in.size() + 1));
+        else if ( rng() & 1 )
+            in.insert(rng() % (in.size() + 1), 1, (char)(rng() % 256));
+
+        check_uu(in, 1 + rng() % 600, begin);
+    }
+}
+
+#endif
+
+#ifdef BENCHMARK_TEST
+
+TEST_CASE("mime decode throughput", "[mime]")
+{
+    std::mt19937 rng(4);
+    std::string b64 = make_b64(rng, 64 * 1024, 0);
+    std::string qp = make_qp(rng, 64 * 1024, 10);
+    std::string uu = make_uu(rng, 64 * 1024 / 61, false);
+    std::vector<uint8_t> out(64 * 1024);
+    uint32_t read, n;
+    bool begin, end;
+
+    BENCHMARK("base64 64 KiB")
+    {
+        return sf_base64decode((uint8_t*)&b64[0], b64.size(), out.data(), out.size(), &n);
+    };
+    BENCHMARK("base64 64 KiB byte loop")
+    {
+        return ref_base64decode((uint8_t*)&b64[0], b64.size(), out.data(), out.size(), &n);
+    };
+    BENCHMARK("quoted-printable 64 KiB")
+    {
+        return sf_qpdecode(qp.data(), qp.size(), (char*)out.data(), out.size(), &read, &n);
+    };
+    BENCHMARK("quoted-printable 64 KiB byte loop")
+    {
+        return ref_qpdecode(qp.data(), qp.size(), (char*)out.data(), out.size(), &read, &n);
+    };
+    BENCHMARK("uuencode 64 KiB")
+    {
+        begin = true;
+        end = false;
+        return sf_uudecode((uint8_t*)&uu[0], uu.size(), out.data(), out.size(),
+            &read, &n, &begin, &end);
+    };
+    BENCHMARK("uuencode 64 KiB byte loop")
+    {
+        begin = true;
+        end = false;
+        return ref_uudecode((uint8_t*)&uu[0], uu.size(), out.data(), out.size(),
+            &read, &n, &begin, &end);
+    };
+}
+
+#endif
+
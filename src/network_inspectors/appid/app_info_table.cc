@@ -134,6 +134,14 @@ char* AppInfoManager::strdup_to_lower(const char* source)
     return dest;
 }
 
+static void set_static_entry(AppInfoTable& table, AppId index, AppInfoTableEntry* entry)
+{
+    if (table.empty())
+        table.resize(SF_APPID_MAX, nullptr);
+
+    table[index] = entry;
+}
+
 bool AppInfoManager::configured()
 {
     return !app_info_table.empty();
@@ -143,22 +151,15 @@ AppInfoTableEntry* AppInfoManager::get_app_info_entry(AppId appId,
     const AppInfoTable& lookup_table)
 {
     AppId tmp;
-    AppInfoTable::const_iterator app;
-    AppInfoTableEntry* entry = nullptr;
 
     if ((tmp = get_static_app_info_entry(appId)))
-    {
-        app = lookup_table.find(tmp);
-        if (app != lookup_table.end())
-            entry = app->second;
-    }
-    else
-    {
-        app = custom_app_info_table.find(appId);
-        if (app != custom_app_info_table.end())
-            entry = app->second;
-    }
-    return entry;
+        return ((size_t)tmp < lookup_table.size()) ? lookup_table[tmp] : nullptr;
+
+    if (appId < SF_APPID_DYNAMIC_MIN)
+        return nullptr;
+
+    size_t index = appId - SF_APPID_DYNAMIC_MIN;
+    return (index < custom_app_info_table.size()) ? custom_app_info_table[index] : nullptr;
 }
 
 AppInfoTableEntry* AppInfoManager::get_app_info_entry(AppId appId)
@@ -177,42 +178,50 @@ AppInfoTableEntry* AppInfoManager::add_dynamic_app_entry(const char* app_name)
     AppInfoTableEntry* entry = find_app_info_by_name(app_name);
     if (!entry)
     {
-        entry = new AppInfoTableEntry(next_custom_appid++, snort_strdup(app_name));
-        custom_app_info_table[entry->appId] = entry;
+        entry = new AppInfoTableEntry(next_custom_appid, snort_strdup(app_name));
 
         if (!add_entry_to_app_info_name_table(entry->app_name_key, entry))
         {
             delete entry;
             return nullptr;
         }
+
+        // custom ids are handed out in order, so the table stays dense
+        custom_app_info_table.emplace_back(entry);
+        next_custom_appid++;
     }
     return entry;
 }
 
 void AppInfoManager::cleanup_appid_info_table()
 {
-    for (auto& kv: app_info_table)
-        delete(kv.second);
-    app_info_table.erase(app_info_table.begin(), app_info_table.end());
-
-    for (auto& kv: custom_app_info_table)
-        delete(kv.second);
-
-    custom_app_info_table.erase(custom_app_info_table.begin(), custom_app_info_table.end());
+    for (auto entry: app_info_table)
+        delete entry;
+    app_info_table.clear();
+    app_info_service_table.clear();
+    app_info_client_table.clear();
+    app_info_payload_table.clear();
+
+    for (auto entry: custom_app_info_table)
+        delete entry;
+
+    custom_app_info_table.clear();
+    next_custom_appid = SF_APPID_DYNAMIC_MIN;
     app_info_name_table.erase(app_info_name_table.begin(), app_info_name_table.end());
 }
 
 void AppInfoManager::dump_app_info_table()
 {
     LogMessage("Cisco provided detectors:\n");
-    for (auto& kv: app_info_table)
-        LogMessage("%s\t%d\t%s\n", kv.second->app_name, kv.second->appId,
-            (kv.second->flags & APPINFO_FLAG_ACTIVE) ? "active" : "inactive");
+    for (auto entry: app_info_table)
+        if (entry)
+            LogMessage("%s\t%d\t%s\n", entry->app_name, entry->appId,
+                (entry->flags & APPINFO_FLAG_ACTIVE) ? "active" : "inactive");
 
     LogMessage("User provided detectors:\n");
-    for (auto& kv: custom_app_info_table)
-        LogMessage("%s\t%d\t%s\n", kv.second->app_name, kv.second->appId,
-            (kv.second->flags & APPINFO_FLAG_ACTIVE) ? "active" : "inactive");
+    for (auto entry: custom_app_info_table)
+        LogMessage("%s\t%d\t%s\n", entry->app_name, entry->appId,
+            (entry->flags & APPINFO_FLAG_ACTIVE) ? "active" : "inactive");
 }
 
 AppId AppInfoManager::get_appid_by_service_id(uint32_t id)
@@ -720,21 +729,24 @@ void AppInfoManager::init_appid_info_table(const AppIdConfig& config,
             if (token)
                 entry->snort_protocol_id = add_appid_protocol_reference(token, sc);
 
+            if (!add_entry_to_app_info_name_table(entry->app_name_key, entry))
+            {
+                delete entry;
+                continue;
+            }
+
             if ((app_id = get_static_app_info_entry(entry->appId)))
             {
-                app_info_table[app_id] = entry;
+                set_static_entry(app_info_table, app_id, entry);
                 AppIdPegCounts::add_app_peg_info(entry->app_name_key, app_id);
             }
 
             if ((app_id = get_static_app_info_entry(entry->serviceId)))
-                app_info_service_table[app_id] = entry;
+                set_static_entry(app_info_service_table, app_id, entry);
             if ((app_id = get_static_app_info_entry(entry->clientId)))
-                app_info_client_table[app_id] = entry;
+                set_static_entry(app_info_client_table, app_id, entry);
             if ((app_id = get_static_app_info_entry(entry->payloadId)))
-                app_info_payload_table[app_id] = entry;
-
-            if (!add_entry_to_app_info_name_table(entry->app_name_key, entry))
-                delete entry;
+                set_static_entry(app_info_payload_table, app_id, entry);
         }
         fclose(tableFile);
 
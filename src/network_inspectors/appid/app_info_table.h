@@ -83,7 +83,9 @@ public:
     char* app_name_key = nullptr;
 };
 
-typedef std::unordered_map<AppId, AppInfoTableEntry*> AppInfoTable;
+// Indexed by the id that get_static_app_info_entry maps an AppId to, or for the custom table,
+// by the offset of the AppId from SF_APPID_DYNAMIC_MIN
+typedef std::vector<AppInfoTableEntry*> AppInfoTable;
 typedef std::unordered_map<std::string, AppInfoTableEntry*> AppInfoNameTable;
 
 class AppInfoManager
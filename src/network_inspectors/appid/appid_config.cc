@@ -155,6 +155,8 @@ void AppIdContext::show() const
 
 OdpContext::OdpContext(const AppIdConfig& config, SnortConfig* sc)
 {
+    service_disco_mgr.set_patterns(detector_patterns);
+    client_disco_mgr.set_patterns(detector_patterns);
     app_info_mgr.init_appid_info_table(config, sc, *this);
     client_pattern_detector = new PatternClientDetector(&client_disco_mgr);
     service_pattern_detector = new PatternServiceDetector(&service_disco_mgr);
@@ -165,8 +167,7 @@ void OdpContext::initialize(AppIdInspector& inspector)
 {
     service_pattern_detector->finalize_service_port_patterns(inspector);
     client_pattern_detector->finalize_client_port_patterns(inspector);
-    service_disco_mgr.finalize_service_patterns();
-    client_disco_mgr.finalize_client_patterns();
+    detector_patterns.prep();
     http_matchers.finalize_patterns();
     eve_ca_matchers.finalize_patterns();
     // sip patterns need to be finalized after http patterns because they
@@ -174,6 +175,7 @@ void OdpContext::initialize(AppIdInspector& inspector)
     sip_matchers.finalize_patterns(*this);
     ssl_matchers.finalize_patterns();
     dns_matchers.finalize_patterns();
+    host_port_cache.finalize();
 }
 
 void OdpContext::reload()
@@ -182,8 +184,7 @@ void OdpContext::reload()
     service_pattern_detector->reload_service_port_patterns();
     assert(client_pattern_detector);
     client_pattern_detector->reload_client_port_patterns();
-    service_disco_mgr.reload_service_patterns();
-    client_disco_mgr.reload_client_patterns();
+    detector_patterns.reload();
     eve_ca_matchers.reload_patterns();
     http_matchers.reload_patterns();
     sip_matchers.reload_patterns();
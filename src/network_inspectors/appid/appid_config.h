@@ -150,13 +150,13 @@ public:
 
     HostPortVal* host_port_cache_find(const snort::SfIp* ip, uint16_t port, IpProtocol proto)
     {
-        return host_port_cache.find(ip, port, proto, *this);
+        return host_port_cache.find(ip, port, proto, allow_port_wildcard_host_cache);
     }
 
     bool host_port_cache_add(const snort::SfIp* ip, uint16_t port, IpProtocol proto, unsigned type,
         AppId appid)
     {
-        return host_port_cache.add(ip, port, proto, type, appid);
+        return host_port_cache.add(ip, port, proto, type, appid, allow_port_wildcard_host_cache);
     }
 
     AppId length_cache_find(const LengthKey& key)
@@ -216,6 +216,7 @@ public:
 
 private:
     AppInfoManager app_info_mgr;
+    AppIdPatterns detector_patterns;
     ClientDiscovery client_disco_mgr;
     HostPortCache host_port_cache;
     LengthCache length_cache;
@@ -27,6 +27,7 @@
 #include "host_tracker/host_cache.h"
 
 #include "log/messages.h"
+#include "main/thread.h"
 #include "packet_tracer/packet_tracer.h"
 #include "profiler/profiler.h"
 #include "protocols/packet.h"
@@ -87,8 +88,96 @@ AppIdDiscovery::~AppIdDiscovery()
         delete kv.second;
 }
 
+// hits of the last packet scanned on the thread
+struct AppIdPatternPass
+{
+    const AppIdPatterns* patterns = nullptr;    // nullptr until the packet is scanned
+    IpProtocol proto = IpProtocol::PROTO_NOT_SET;
+    std::vector<AppIdPatternMatch> matches[AppIdPatterns::max_sets];
+};
+
+static THREAD_LOCAL AppIdPatternPass* pattern_pass = nullptr;
+
 void AppIdDiscovery::tterm()
 {
+    AppIdPatterns::tterm();
+}
+
+static int pattern_match(void* id, void*, int match_end_pos, void* data, void*)
+{
+    AppIdPatternPass* pass = (AppIdPatternPass*)data;
+    AppIdPatternMatchNode* pd = (AppIdPatternMatchNode*)id;
+
+    if ( !pd->valid_match(match_end_pos) )
+        return 0;
+
+    std::vector<AppIdPatternMatch>& matches = pass->matches[pd->pattern_set];
+
+    // A payload hits few detectors, so a linear search is fine
+    for ( auto& match : matches )
+    {
+        if ( match.detector == pd->service )
+        {
+            match.count++;
+            return 0;
+        }
+    }
+
+    matches.push_back({ pd->service, 1, pd->size });
+    return 0;
+}
+
+void AppIdPatterns::add(IpProtocol proto, AppIdPatternMatchNode* pd,
+    const uint8_t* const pattern, unsigned size, unsigned nocase)
+{
+    SearchTool& st = (proto == IpProtocol::TCP) ? tcp_patterns : udp_patterns;
+    st.add((const char*)pattern, size, pd, nocase);
+}
+
+void AppIdPatterns::prep()
+{
+    tcp_patterns.prep();
+    udp_patterns.prep();
+}
+
+void AppIdPatterns::reload()
+{
+    tcp_patterns.reload();
+    udp_patterns.reload();
+}
+
+std::vector<AppIdPatternMatch>& AppIdPatterns::find(const Packet* pkt, IpProtocol proto,
+    unsigned set)
+{
+    if ( !pattern_pass )
+        pattern_pass = new AppIdPatternPass;
+
+    if ( pattern_pass->patterns != this or pattern_pass->proto != proto )
+    {
+        for ( auto& matches : pattern_pass->matches )
+            matches.clear();
+
+        SearchTool& st = (proto == IpProtocol::TCP) ? tcp_patterns : udp_patterns;
+        st.find_all((const char*)pkt->data, pkt->dsize, &pattern_match, false,
+            (void*)pattern_pass);
+
+        pattern_pass->patterns = this;
+        pattern_pass->proto = proto;
+    }
+
+    return pattern_pass->matches[set];
+}
+
+void AppIdPatterns::new_packet()
+{
+    if ( pattern_pass )
+        pattern_pass->patterns = nullptr;
+}
+
+void AppIdPatterns::tterm()
+{
+    delete pattern_pass;
+    pattern_pass = nullptr;
 }
 
 void AppIdDiscovery::register_detector(const std::string& name, AppIdDetector* cd, IpProtocol proto)
@@ -102,26 +191,27 @@ void AppIdDiscovery::register_detector(const std::string& name, AppIdDetector* c
         ErrorMessage("Detector %s has unsupported protocol %u", name.c_str(), (unsigned)proto);
 }
 
-void AppIdDiscovery::add_pattern_data(AppIdDetector* detector, SearchTool& st, int position, const
-    uint8_t* const pattern, unsigned size, unsigned nocase)
+void AppIdDiscovery::add_pattern_data(AppIdDetector* detector, IpProtocol proto, int position,
+    const uint8_t* const pattern, unsigned size, unsigned nocase)
 {
-    AppIdPatternMatchNode* pd = new AppIdPatternMatchNode(detector, position, size);
+    assert(patterns);
+    AppIdPatternMatchNode* pd = new AppIdPatternMatchNode(detector, position, size, pattern_set);
     pattern_data.emplace_back(pd);
-    st.add((const char*)pattern, size, pd, nocase);
+    patterns->add(proto, pd, pattern, size, nocase);
 }
 
 void AppIdDiscovery::register_tcp_pattern(AppIdDetector* detector, const uint8_t* const pattern,
     unsigned size, int position, unsigned nocase)
 {
     tcp_pattern_count++;
-    add_pattern_data(detector, tcp_patterns, position, pattern, size, nocase);
+    add_pattern_data(detector, IpProtocol::TCP, position, pattern, size, nocase);
 }
 
 void AppIdDiscovery::register_udp_pattern(AppIdDetector* detector, const uint8_t* const pattern,
     unsigned size, int position, unsigned nocase)
 {
     udp_pattern_count++;
-    add_pattern_data(detector, udp_patterns, position, pattern, size, nocase);
+    add_pattern_data(detector, IpProtocol::UDP, position, pattern, size, nocase);
 }
 
 int AppIdDiscovery::add_service_port(AppIdDetector*, const ServiceDetectorPort&)
@@ -140,6 +230,8 @@ void AppIdDiscovery::do_application_discovery(Packet* p, AppIdInspector& inspect
     if (!do_pre_discovery(p, asd, inspector, protocol, outer_protocol, direction, odp_ctxt))
         return;
 
+    AppIdPatterns::new_packet();
+
     AppId service_id = APP_ID_NONE;
     AppId client_id = APP_ID_NONE;
     AppId payload_id = APP_ID_NONE;
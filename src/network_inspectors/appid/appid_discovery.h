@@ -22,6 +22,7 @@
 #ifndef APPID_DISCOVERY_H
 #define APPID_DISCOVERY_H
 
+#include <cassert>
 #include <map>
 #include <string>
 #include <vector>
@@ -64,8 +65,8 @@ struct Packet;
 class AppIdPatternMatchNode
 {
 public:
-    AppIdPatternMatchNode(AppIdDetector* detector, int start, unsigned len)
-        : service(detector), pattern_start_pos(start), size(len) { }
+    AppIdPatternMatchNode(AppIdDetector* detector, int start, unsigned len, unsigned set)
+        : service(detector), pattern_start_pos(start), size(len), pattern_set(set) { }
 
     bool valid_match(int end_position)
     {
@@ -78,14 +79,49 @@ public:
     AppIdDetector* service;
     int pattern_start_pos;
     unsigned size;
+    unsigned pattern_set;   // of the discovery manager that registered the pattern
 };
 
-struct ServiceMatch
+// Detector hit by one pattern pass over the payload
+struct AppIdPatternMatch
 {
-    struct ServiceMatch* next;
+    AppIdDetector* detector;
     unsigned count;
-    unsigned size;
-    ServiceDetector* service = nullptr;
+    unsigned size;  // length of the first pattern matched
+};
+
+// The detector patterns of all the discovery managers of an ODP context, in one combined
+// automaton per protocol. Each manager has its own set of patterns. The first manager that
+// asks for the hits of a packet runs the pass, which sorts the hits of every set, and the
+// others get theirs from the same pass.
+class AppIdPatterns
+{
+public:
+    static constexpr unsigned max_sets = 2;
+
+    unsigned add_set()
+    {
+        assert(num_sets < max_sets);
+        return num_sets++;
+    }
+
+    void add(IpProtocol, AppIdPatternMatchNode*, const uint8_t* const pattern, unsigned size,
+        unsigned nocase);
+    void prep();
+    void reload();
+
+    // The detectors of the set hit by the payload, in the order of their first hit. The list
+    // belongs to the pass and is reused by the next packet on the thread.
+    std::vector<AppIdPatternMatch>& find(const snort::Packet*, IpProtocol, unsigned set);
+
+    // the pass of the previous packet is not reused
+    static void new_packet();
+    static void tterm();
+
+private:
+    snort::SearchTool tcp_patterns;
+    snort::SearchTool udp_patterns;
+    unsigned num_sets = 0;
 };
 
 typedef std::map<std::string, AppIdDetector*> AppIdDetectors;
@@ -105,7 +141,7 @@ public:
     virtual void initialize(AppIdInspector&) = 0;
     virtual void reload() = 0;
     virtual void register_detector(const std::string&, AppIdDetector*,  IpProtocol);
-    virtual void add_pattern_data(AppIdDetector*, snort::SearchTool&, int position,
+    virtual void add_pattern_data(AppIdDetector*, IpProtocol, int position,
         const uint8_t* const pattern, unsigned size, unsigned nocase);
     virtual void register_tcp_pattern(AppIdDetector*, const uint8_t* const pattern, unsigned size,
         int position, unsigned nocase);
@@ -126,14 +162,29 @@ public:
         return &udp_detectors;
     }
 
+    // the combined automata the patterns of the manager's detectors are added to
+    void set_patterns(AppIdPatterns& ap)
+    {
+        patterns = &ap;
+        pattern_set = ap.add_set();
+    }
+
 protected:
+    // The detectors of this manager hit by the payload, from the single pass of the combined
+    // automaton over the packet.
+    std::vector<AppIdPatternMatch>& find_pattern_matches(const snort::Packet* pkt,
+        IpProtocol proto)
+    {
+        return patterns->find(pkt, proto, pattern_set);
+    }
+
     AppIdDetectors tcp_detectors;
     AppIdDetectors udp_detectors;
-    snort::SearchTool tcp_patterns;
     int tcp_pattern_count = 0;
-    snort::SearchTool udp_patterns;
     int udp_pattern_count = 0;
     std::vector<AppIdPatternMatchNode*> pattern_data;
+    AppIdPatterns* patterns = nullptr;
+    unsigned pattern_set = 0;
 
 private:
     static bool do_pre_discovery(snort::Packet* p, AppIdSession*& asd, AppIdInspector& inspector,
@@ -26,6 +26,7 @@
 #include <ctime>
 #include <map>
 
+#include "time/packet_time.h"
 #include "utils/sflsq.h"
 #include "utils/util.h"
 
@@ -73,7 +74,7 @@ private:
 
     time_t get_time()
     {
-        auto now = time(nullptr);
+        auto now = snort::packet_thread_time();
         return now - (now % bucket_interval);
     }
 
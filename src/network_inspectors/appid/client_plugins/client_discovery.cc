@@ -80,151 +80,52 @@ void ClientDiscovery::reload()
         kv.second->reload();
 }
 
-void ClientDiscovery::finalize_client_patterns()
+// Takes the detector with the most hits, then the highest precedence, out of the matches. On a
+// tie, the detector whose first hit came last wins.
+static ClientDetector* get_next_detector(std::vector<AppIdPatternMatch>& matches)
 {
-    tcp_patterns.prep();
-    udp_patterns.prep();
-}
-
-void ClientDiscovery::reload_client_patterns()
-{
-    tcp_patterns.reload();
-    udp_patterns.reload();
-}
-
-/*
- * Callback function for string search
- *
- * @param   id      id in array of search strings from pop_config.cmds
- * @param   index   index in array of search strings from pop_config.cmds
- * @param   data    buffer passed in to search function
- *
- * @return response
- * @retval 1        commands caller to stop searching
- */
-static int pattern_match(void* id, void* /*unused_tree*/, int match_end_pos, void* data,
-    void* /*unused_neg*/)
-{
-    ClientAppMatch** matches = (ClientAppMatch**)data;
-    AppIdPatternMatchNode* pd = (AppIdPatternMatchNode*)id;
+    AppIdPatternMatch* max_match = nullptr;
+    unsigned max_count = 0;
+    unsigned max_precedence = 0;
 
-    if ( pd->valid_match(match_end_pos) )
+    for ( auto it = matches.rbegin(); it != matches.rend(); ++it )
     {
-        ClientAppMatch* cam;
-
-        for (cam = *matches; cam; cam = cam->next)
-            if (cam->detector == pd->service)
-                break;
-
-        if (cam)
-            cam->count++;
-        else
-        {
-            cam = (ClientAppMatch*)snort_alloc(sizeof(ClientAppMatch));
-
-            cam->count = 1;
-            cam->detector =  static_cast<const ClientDetector*>(pd->service);
-            cam->next = *matches;
-            *matches = cam;
-        }
-    }
-
-    return 0;
-}
+        const ClientDetector* cd = static_cast<const ClientDetector*>(it->detector);
 
-static const ClientDetector* get_next_detector(ClientAppMatch** match_list)
-{
-    ClientAppMatch* curr;
-    ClientAppMatch* prev = nullptr;
-    ClientAppMatch* max_curr = nullptr;
-    ClientAppMatch* max_prev = nullptr;
-    unsigned max_count;
-    unsigned max_precedence;
-
-    curr = *match_list;
-    max_count = 0;
-    max_precedence = 0;
-    while (curr)
-    {
-        if (curr->count >= curr->detector->get_minimum_matches()
-            && ((curr->count > max_count)
-            || (curr->count == max_count && curr->detector->get_precedence() > max_precedence)))
+        if ( it->count and it->count >= cd->get_minimum_matches()
+            and (it->count > max_count
+            or (it->count == max_count and cd->get_precedence() > max_precedence)) )
         {
-            max_count = curr->count;
-            max_precedence = curr->detector->get_precedence();
-            max_curr = curr;
-            max_prev = prev;
+            max_count = it->count;
+            max_precedence = cd->get_precedence();
+            max_match = &*it;
         }
-        prev = curr;
-        curr = curr->next;
     }
 
-    if (max_curr != nullptr)
-    {
-        if (max_prev == nullptr)
-            *match_list = (*match_list)->next;
-        else
-            max_prev->next = max_curr->next;
-
-        const ClientDetector* detector = max_curr->detector;
-        snort_free(max_curr);
-        return detector;
-    }
-    else
+    if ( !max_match )
         return nullptr;
-}
-
-static void free_matched_list(ClientAppMatch** match_list)
-{
-    ClientAppMatch* cam;
-    ClientAppMatch* tmp;
-
-    cam = *match_list;
-    while (cam)
-    {
-        tmp = cam;
-        cam = tmp->next;
-        snort_free(tmp);
-    }
 
-    *match_list = nullptr;
-}
-
-ClientAppMatch* ClientDiscovery::find_detector_candidates(const Packet* pkt, const AppIdSession& asd)
-{
-    ClientAppMatch* match_list = nullptr;
-    SearchTool* patterns;
-
-    if (asd.protocol == IpProtocol::TCP)
-        patterns = &asd.get_odp_ctxt().get_client_disco_mgr().tcp_patterns;
-    else
-        patterns = &asd.get_odp_ctxt().get_client_disco_mgr().udp_patterns;
-
-    if ( patterns )
-        patterns->find_all((const char*)pkt->data, pkt->dsize, &pattern_match, false, (void*)&match_list);
-
-    return match_list;
+    max_match->count = 0;
+    return static_cast<ClientDetector*>(max_match->detector);
 }
 
 void ClientDiscovery::create_detector_candidates_list(AppIdSession& asd, Packet* p)
 {
-    ClientAppMatch* match_list;
-
     if ( !p->dsize || asd.client_detector != nullptr || !asd.client_candidates.empty() )
         return;
 
-    match_list = find_detector_candidates(p, asd);
+    std::vector<AppIdPatternMatch>& matches =
+        asd.get_odp_ctxt().get_client_disco_mgr().find_pattern_matches(p, asd.protocol);
+
     while ( asd.client_candidates.size() < MAX_CANDIDATE_CLIENTS )
     {
-        ClientDetector* cd = const_cast<ClientDetector*>(get_next_detector(&match_list));
+        ClientDetector* cd = get_next_detector(matches);
         if (!cd)
             break;
 
         if ( asd.client_candidates.find(cd->get_name()) == asd.client_candidates.end() )
             asd.client_candidates[cd->get_name()] = cd;
     }
-
-    free_matched_list(&match_list);
 }
 
 int ClientDiscovery::get_detector_candidates_list(AppIdSession& asd, Packet* p, AppidSessionDirection direction)
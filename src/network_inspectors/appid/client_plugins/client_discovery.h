@@ -32,28 +32,18 @@ class ClientDetector;
 class AppIdInspector;
 class AppIdSession;
 
-struct ClientAppMatch
-{
-    struct ClientAppMatch* next;
-    unsigned count;
-    const ClientDetector* detector = nullptr;
-};
-
 class ClientDiscovery : public AppIdDiscovery
 {
 public:
     void initialize(AppIdInspector&) override;
     void reload() override;
 
-    void finalize_client_patterns();
-    void reload_client_patterns();
     bool do_client_discovery(AppIdSession&, snort::Packet*,
         AppidSessionDirection direction, AppidChangeBits& change_bits);
 
 private:
     void exec_client_detectors(AppIdSession&, snort::Packet*,
         AppidSessionDirection direction, AppidChangeBits& change_bits);
-    ClientAppMatch* find_detector_candidates(const snort::Packet* pkt, const AppIdSession&);
     void create_detector_candidates_list(AppIdSession&, snort::Packet*);
     int get_detector_candidates_list(AppIdSession&, snort::Packet*, AppidSessionDirection direction);
 };
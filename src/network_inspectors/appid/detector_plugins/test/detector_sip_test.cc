@@ -142,7 +142,7 @@ void ClientDiscovery::reload() { }
 void AppIdDiscovery::register_detector(const string&, AppIdDetector*, IpProtocol) { }
 
 // LCOV_EXCL_START
-void AppIdDiscovery::add_pattern_data(AppIdDetector*, snort::SearchTool&, int,
+void AppIdDiscovery::add_pattern_data(AppIdDetector*, IpProtocol, int,
     unsigned char const*, unsigned int, unsigned int) { }
 void AppIdDiscovery::register_tcp_pattern(AppIdDetector*, unsigned char const*, unsigned int,
     int, unsigned int) { }
@@ -23,55 +23,64 @@
 #include "config.h"
 #endif
 
-#include <map>
+#include <algorithm>
 
 #include "host_port_app_cache.h"
 #include "log/messages.h"
-#include "main/thread.h"
-#include "managers/inspector_manager.h"
-#include "appid_config.h"
-#include "appid_inspector.h"
 
 using namespace snort;
 
 HostPortVal* HostPortCache::find(const SfIp* ip, uint16_t port, IpProtocol protocol,
-    const OdpContext& odp_ctxt)
+    bool port_wildcard)
 {
     HostPortKey hk;
 
     hk.ip = *ip;
-    hk.port = (odp_ctxt.allow_port_wildcard_host_cache)? 0 : port;
+    hk.port = port_wildcard ? 0 : port;
     hk.proto = protocol;
 
-    std::map<HostPortKey, HostPortVal>::iterator it;
-    it = cache.find(hk);
-    if (it != cache.end())
+    auto it = std::lower_bound(cache.begin(), cache.end(), hk,
+        [](const HostPortEntry& entry, const HostPortKey& key)
+        { return entry.first < key; });
+
+    if (it != cache.end() and !(hk < it->first))
         return &it->second;
     else
         return nullptr;
 }
 
 bool HostPortCache::add(const SfIp* ip, uint16_t port, IpProtocol proto, unsigned type, AppId
-    appId)
+    appId, bool port_wildcard)
 {
     HostPortKey hk;
     HostPortVal hv;
 
     hk.ip = *ip;
-    AppIdInspector* inspector = (AppIdInspector*) InspectorManager::get_inspector(MOD_NAME);
-    assert(inspector);
-    const AppIdContext& ctxt = inspector->get_ctxt();
-    hk.port = (ctxt.get_odp_ctxt().allow_port_wildcard_host_cache)? 0 : port;
+    hk.port = port_wildcard ? 0 : port;
     hk.proto = proto;
 
     hv.appId = appId;
     hv.type = type;
 
-    cache[ hk ] = hv;
+    pending[ hk ] = hv;
 
     return true;
 }
 
+void HostPortCache::finalize()
+{
+    if ( pending.empty() )
+        return;
+
+    // later additions replace frozen entries with the same key
+    for ( auto& entry : cache )
+        pending.emplace(entry.first, entry.second);
+
+    cache.assign(pending.begin(), pending.end());
+    cache.shrink_to_fit();
+    pending.clear();
+}
+
 void HostPortCache::dump()
 {
     for ( auto& kv : cache )
@@ -23,14 +23,15 @@
 #define HOST_PORT_APP_CACHE_H
 
 #include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
 
 #include "application_ids.h"
 #include "protocols/protocol_ids.h"
 #include "sfip/sf_ip.h"
 #include "utils/cpp_macros.h"
 
-class OdpContext;
-
 PADDING_GUARD_BEGIN
 struct HostPortKey
 {
@@ -60,20 +61,26 @@ struct HostPortVal
     unsigned type;
 };
 
+// Entries are added while the detectors are loaded and are frozen into a sorted array by
+// finalize before any packet is processed, so a lookup is a binary search over contiguous
+// memory. find only sees the frozen entries.
 class HostPortCache
 {
 public:
-    HostPortVal* find(const snort::SfIp*, uint16_t port, IpProtocol, const OdpContext&);
-    bool add(const snort::SfIp*, uint16_t port, IpProtocol, unsigned type, AppId);
+    HostPortVal* find(const snort::SfIp*, uint16_t port, IpProtocol, bool port_wildcard);
+    bool add(const snort::SfIp*, uint16_t port, IpProtocol, unsigned type, AppId,
+        bool port_wildcard);
+    void finalize();
     void dump();
 
-    ~HostPortCache()
-    {
-        cache.clear();
-    }
+    size_t size() const
+    { return cache.size(); }
 
 private:
-    std::map<HostPortKey, HostPortVal> cache;
+    typedef std::pair<HostPortKey, HostPortVal> HostPortEntry;
+
+    std::map<HostPortKey, HostPortVal> pending;
+    std::vector<HostPortEntry> cache;
 };
 
 #endif
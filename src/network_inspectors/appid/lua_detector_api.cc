@@ -242,6 +242,74 @@ static int service_register_pattern(lua_State* L)
     return 1;
 }
 
+// Reads the arguments shared by service_addFastMatch and client_addFastMatch, starting at the
+// protocol, and registers the pattern for fast pattern matching of the detector.
+static bool get_fast_match(lua_State* L, AppIdDiscovery& disco_mgr, AppIdDetector* detector,
+    LuaFastMatch& fm)
+{
+    int index = 1;
+
+    IpProtocol protocol;
+    if (toipprotocol(L, ++index, protocol))
+        return false;
+
+    unsigned dir = lua_tointeger(L, ++index);
+    fm.dir = (dir < APP_ID_APPID_SESSION_DIRECTION_MAX) ?
+        (AppidSessionDirection)dir : APP_ID_APPID_SESSION_DIRECTION_MAX;
+    fm.offset = lua_tointeger(L, ++index);
+
+    size_t size = 0;
+    const char* pattern = lua_tolstring(L, ++index, &size);
+    if (!pattern or !size)
+        return false;
+    fm.pattern.assign(pattern, size);
+
+    if (protocol == IpProtocol::TCP)
+        disco_mgr.register_tcp_pattern(detector, (const uint8_t*)pattern, size, fm.offset, 0);
+    else
+        disco_mgr.register_udp_pattern(detector, (const uint8_t*)pattern, size, fm.offset, 0);
+
+    return true;
+}
+
+// Declare a payload match that identifies the service natively. The pattern is also
+// registered for fast pattern matching, so a matching packet selects the detector and the
+// service is added without calling the Lua validator.
+//
+// lua params:
+//  #1 - detector/stack - detector object
+//  #2 - protocol/stack - protocol type. Values can be {tcp=6, udp=17 }
+//  #3 - direction/stack - 0 from initiator, 1 from responder, any other value for both
+//  #4 - offset/stack - position of the pattern in the payload
+//  #5 - pattern/stack - pattern string
+//  #6 - service_id/stack - service id added on a match
+//  #7 - vendor/stack - name of vendor of service. This is optional.
+//  #8 - version/stack - version of service. This is optional.
+//  return - status/stack - 0 if successful, -1 otherwise.
+static int service_add_fast_match(lua_State* L)
+{
+    auto& ud = *UserData<LuaServiceObject>::check(L, DETECTOR, 1);
+    // Verify detector user data and that we are NOT in packet context
+    ud->validate_lua_state(false);
+    if (!init(L, 1)) return 1;
+
+    LuaFastMatch fm;
+    if (!get_fast_match(L, ud->get_odp_ctxt().get_service_disco_mgr(), ud->sd, fm))
+    {
+        lua_pushnumber(L, -1);
+        return 1;
+    }
+
+    fm.service_id = lua_tointeger(L, 6);
+    fm.client_id = APP_ID_NONE;
+    fm.vendor = luaL_optstring(L, 7, "");
+    fm.version = luaL_optstring(L, 8, "");
+    static_cast<LuaServiceDetector*>(ud->sd)->fast_matches.add(std::move(fm));
+
+    lua_pushnumber(L, 0);
+    return 1;
+}
+
 static int common_register_application_id(lua_State* L)
 {
     auto& ud = *UserData<LuaObject>::check(L, DETECTOR, 1);
@@ -496,6 +564,7 @@ static int service_set_validator(lua_State* L)
 
     lua_pop(L, 1);
     ud->lsd.package_info.validateFunctionName = pValidator;
+    static_cast<LuaServiceDetector*>(ud->sd)->fast_matches.has_validator = true;
     lua_pushnumber(L, 0);
     return 1;
 }
@@ -895,6 +964,43 @@ static int client_register_pattern(lua_State* L)
     return 1;   /*number of results */
 }
 
+// Declare a payload match that identifies the client natively. The pattern is also
+// registered for fast pattern matching, so a matching packet selects the detector and the
+// client is added without calling the Lua validator.
+//
+// lua params:
+//  #1 - detector/stack - detector object
+//  #2 - protocol/stack - protocol type. Values can be {tcp=6, udp=17 }
+//  #3 - direction/stack - 0 from initiator, 1 from responder, any other value for both
+//  #4 - offset/stack - position of the pattern in the payload
+//  #5 - pattern/stack - pattern string
+//  #6 - service_id/stack - service id added on a match
+//  #7 - client_id/stack - client id added on a match
+//  #8 - version/stack - version of client. This is optional.
+//  return - status/stack - 0 if successful, -1 otherwise.
+static int client_add_fast_match(lua_State* L)
+{
+    auto& ud = *UserData<LuaClientObject>::check(L, DETECTOR, 1);
+    // Verify detector user data and that we are NOT in packet context
+    ud->validate_lua_state(false);
+    if (!init(L, 1)) return 1;
+
+    LuaFastMatch fm;
+    if (!get_fast_match(L, ud->get_odp_ctxt().get_client_disco_mgr(), ud->cd, fm))
+    {
+        lua_pushnumber(L, -1);
+        return 1;
+    }
+
+    fm.service_id = lua_tointeger(L, 6);
+    fm.client_id = lua_tointeger(L, 7);
+    fm.version = luaL_optstring(L, 8, "");
+    static_cast<LuaClientDetector*>(ud->cd)->fast_matches.add(std::move(fm));
+
+    lua_pushnumber(L, 0);
+    return 1;
+}
+
 /**Creates a new detector instance. Creates a new detector instance and leaves the instance
  * on stack. This is the first call by a lua detector to create an instance. Later calls
  * provide the detector instance.
@@ -2693,6 +2799,7 @@ static const luaL_Reg detector_methods[] =
     /*service API */
     { "service_init",               service_init },
     { "service_registerPattern",    service_register_pattern },
+    { "service_addFastMatch",       service_add_fast_match },
     { "service_getServiceId",       service_get_service_id },
     { "service_addPort",            service_add_ports },
     { "service_removePort",         service_remove_ports },
@@ -2711,6 +2818,7 @@ static const luaL_Reg detector_methods[] =
     /*client init API */
     { "client_init",              client_init },
     { "client_registerPattern",   client_register_pattern },
+    { "client_addFastMatch",      client_add_fast_match },
     { "client_getServiceId",      service_get_service_id },
 
     /*client service API */
@@ -2904,6 +3012,7 @@ LuaServiceDetector::LuaServiceDetector(AppIdDiscovery* sdm, const std::string& d
 {
     handler = sdm;
     name = detector_name;
+    global_name = detector_name + "_";
     log_name = logging_name;
     custom_detector = is_custom;
     minimum_matches = min_match;
@@ -2916,12 +3025,14 @@ LuaServiceObject::LuaServiceObject(AppIdDiscovery* sdm, const std::string& detec
     const std::string& log_name, bool is_custom, IpProtocol protocol, lua_State* L,
     OdpContext& odp_ctxt) : LuaObject(odp_ctxt)
 {
-    init_lsd(&lsd, detector_name, L);
+    bool has_validator = init_lsd(&lsd, detector_name, L);
 
     if (init(L))
     {
-        sd = new LuaServiceDetector(sdm, detector_name,
+        LuaServiceDetector* lsd_detector = new LuaServiceDetector(sdm, detector_name,
             log_name, is_custom, lsd.package_info.minimum_matches, protocol);
+        lsd_detector->fast_matches.has_validator = has_validator;
+        sd = lsd_detector;
     }
     else
     {
@@ -2958,13 +3069,25 @@ LuaServiceObject::LuaServiceObject(AppIdDiscovery* sdm, const std::string& detec
 
 int LuaServiceDetector::validate(AppIdDiscoveryArgs& args)
 {
+    if (const LuaFastMatch* fm = fast_matches.find(args.data, args.size, args.dir))
+    {
+        AppInfoManager& app_info_mgr = args.asd.get_odp_ctxt().get_app_info_mgr();
+        return add_service(args.change_bits, args.asd, args.pkt, args.dir,
+            app_info_mgr.get_appid_by_service_id(fm->service_id),
+            fm->vendor.empty() ? nullptr : fm->vendor.c_str(),
+            fm->version.empty() ? nullptr : fm->version.c_str());
+    }
+
+    int ret;
+    if (!fast_matches.need_validator(args.dir, ret))
+        return ret;
+
     auto my_lua_state = odp_thread_local_ctxt->get_lua_detector_mgr().L;
     if (lua_gettop(my_lua_state))
         WarningMessage("appid: leak of %d lua stack elements before service validate\n",
             lua_gettop(my_lua_state));
 
-    std::string name = this->name + "_";
-    lua_getglobal(my_lua_state, name.c_str());
+    lua_getglobal(my_lua_state, global_name.c_str());
     auto& ud = *UserData<LuaServiceObject>::check(my_lua_state, DETECTOR, 1);
     return ud->lsd.lua_validate(args);
 }
@@ -2974,6 +3097,7 @@ LuaClientDetector::LuaClientDetector(AppIdDiscovery* cdm, const std::string& det
 {
     handler = cdm;
     name = detector_name;
+    global_name = detector_name + "_";
     log_name = logging_name;
     custom_detector = is_custom;
     minimum_matches = min_match;
@@ -2989,8 +3113,10 @@ LuaClientObject::LuaClientObject(const std::string& detector_name,
 
     if (init(L))
     {
-        cd = new LuaClientDetector(&(odp_ctxt.get_client_disco_mgr()), detector_name,
-            log_name, is_custom, lsd.package_info.minimum_matches, protocol);
+        LuaClientDetector* lcd = new LuaClientDetector(&(odp_ctxt.get_client_disco_mgr()),
+            detector_name, log_name, is_custom, lsd.package_info.minimum_matches, protocol);
+        lcd->fast_matches.has_validator = has_validate;
+        cd = lcd;
     }
     else
     {
@@ -3034,13 +3160,26 @@ LuaStateDescriptor* LuaObject::validate_lua_state(bool packet_context)
 
 int LuaClientDetector::validate(AppIdDiscoveryArgs& args)
 {
+    if (const LuaFastMatch* fm = fast_matches.find(args.data, args.size, args.dir))
+    {
+        AppInfoManager& app_info_mgr = args.asd.get_odp_ctxt().get_app_info_mgr();
+        add_app(*args.pkt, args.asd, args.dir,
+            app_info_mgr.get_appid_by_service_id(fm->service_id),
+            app_info_mgr.get_appid_by_client_id(fm->client_id),
+            fm->version.empty() ? nullptr : fm->version.c_str(), args.change_bits);
+        return APPID_SUCCESS;
+    }
+
+    int ret;
+    if (!fast_matches.need_validator(args.dir, ret))
+        return ret;
+
     auto my_lua_state = odp_thread_local_ctxt->get_lua_detector_mgr().L;
     if (lua_gettop(my_lua_state))
         WarningMessage("appid: leak of %d lua stack elements before client validate\n",
             lua_gettop(my_lua_state));
 
-    std::string name = this->name + "_";
-    lua_getglobal(my_lua_state, name.c_str());
+    lua_getglobal(my_lua_state, global_name.c_str());
     auto& ud = *UserData<LuaClientObject>::check(my_lua_state, DETECTOR, 1);
     return ud->lsd.lua_validate(args);
 }
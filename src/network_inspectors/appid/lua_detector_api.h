@@ -29,6 +29,7 @@
 
 #include "appid_types.h"
 #include "client_plugins/client_detector.h"
+#include "lua_fast_match.h"
 #include "service_plugins/service_detector.h"
 
 namespace snort
@@ -87,6 +88,11 @@ public:
     LuaServiceDetector(AppIdDiscovery* sdm, const std::string& detector_name,
         const std::string& log_name, bool is_custom, unsigned min_match, IpProtocol protocol);
     int validate(AppIdDiscoveryArgs&) override;
+
+    LuaFastMatches fast_matches;
+
+private:
+    std::string global_name;
 };
 
 class LuaClientDetector : public ClientDetector
@@ -95,6 +101,11 @@ public:
     LuaClientDetector(AppIdDiscovery* cdm, const std::string& detector_name,
         const std::string& log_name, bool is_custom, unsigned min_match, IpProtocol protocol);
     int validate(AppIdDiscoveryArgs&) override;
+
+    LuaFastMatches fast_matches;
+
+private:
+    std::string global_name;
 };
 
 
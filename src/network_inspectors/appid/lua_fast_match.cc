@@ -0,0 +1,70 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// lua_fast_match.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "lua_fast_match.h"
+
+#include <cstring>
+
+#include "appid_detector.h"
+
+bool LuaFastMatch::match(const uint8_t* data, uint16_t size, AppidSessionDirection pkt_dir) const
+{
+    if (dir != APP_ID_APPID_SESSION_DIRECTION_MAX and dir != pkt_dir)
+        return false;
+
+    if (offset > size or pattern.size() > size - offset)
+        return false;
+
+    return !memcmp(data + offset, pattern.data(), pattern.size());
+}
+
+const LuaFastMatch* LuaFastMatches::find(const uint8_t* data, uint16_t size,
+    AppidSessionDirection dir) const
+{
+    for (const auto& fm : matches)
+        if (fm.match(data, size, dir))
+            return &fm;
+
+    return nullptr;
+}
+
+// With no Lua validator, a packet in a direction none of the matches look at leaves the
+// detector in process, any other packet is not a match.
+bool LuaFastMatches::need_validator(AppidSessionDirection dir, int& result) const
+{
+    if (has_validator)
+        return true;
+
+    result = matches.empty() ? APPID_NOMATCH : APPID_INPROCESS;
+
+    for (const auto& fm : matches)
+    {
+        if (fm.dir == APP_ID_APPID_SESSION_DIRECTION_MAX or fm.dir == dir)
+        {
+            result = APPID_NOMATCH;
+            break;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,66 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// lua_fast_match.h
+
+#ifndef LUA_FAST_MATCH_H
+#define LUA_FAST_MATCH_H
+
+// Payload checks declared by a Lua detector at init with service_addFastMatch or
+// client_addFastMatch. The checks are run natively before the Lua validator, so a packet
+// they decide never enters the Lua state.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "application_ids.h"
+#include "appid_types.h"
+
+struct LuaFastMatch
+{
+    std::string pattern;
+    unsigned offset;
+    AppidSessionDirection dir;  // APP_ID_APPID_SESSION_DIRECTION_MAX for either direction
+    AppId service_id;           // ids as known to the detector, mapped when reported
+    AppId client_id;
+    std::string vendor;
+    std::string version;
+
+    bool match(const uint8_t* data, uint16_t size, AppidSessionDirection) const;
+};
+
+class LuaFastMatches
+{
+public:
+    void add(LuaFastMatch&& fm)
+    { matches.emplace_back(std::move(fm)); }
+
+    // the first declared match of the payload, if any
+    const LuaFastMatch* find(const uint8_t* data, uint16_t size, AppidSessionDirection) const;
+
+    // for a payload none of the matches found, returns true if the Lua validator must
+    // decide it, else sets the result
+    bool need_validator(AppidSessionDirection, int& result) const;
+
+    bool has_validator = true;
+
+private:
+    std::vector<LuaFastMatch> matches;
+};
+
+#endif
@@ -146,18 +146,6 @@ void ServiceDiscovery::reload()
         kv.second->reload();
 }
 
-void ServiceDiscovery::finalize_service_patterns()
-{
-    tcp_patterns.prep();
-    udp_patterns.prep();
-}
-
-void ServiceDiscovery::reload_service_patterns()
-{
-    tcp_patterns.reload();
-    udp_patterns.reload();
-}
-
 int ServiceDiscovery::add_service_port(AppIdDetector* detector, const ServiceDetectorPort& pp)
 {
     ServiceDetector* service = static_cast<ServiceDetector*>(detector);
@@ -186,45 +174,12 @@ int ServiceDiscovery::add_service_port(AppIdDetector* detector, const ServiceDet
     return 0;
 }
 
-static int AppIdPatternPrecedence(const void* a, const void* b)
-{
-    const ServiceMatch* sm1 = (const ServiceMatch*)a;
-    const ServiceMatch* sm2 = (const ServiceMatch*)b;
-
-    /*higher precedence should be before lower precedence */
-    if (sm1->count != sm2->count)
-        return (sm2->count - sm1->count);
-    else
-        return (sm2->size - sm1->size);
-}
-
-static int pattern_match(void* id, void*, int match_end_pos, void* data, void*)
+// Higher count first, then longer pattern
+static bool AppIdPatternPrecedence(const AppIdPatternMatch& a, const AppIdPatternMatch& b)
 {
-    ServiceMatch** matches = (ServiceMatch**)data;
-    AppIdPatternMatchNode* pd = (AppIdPatternMatchNode*)id;
-
-    if ( pd->valid_match(match_end_pos) )
-    {
-        ServiceMatch* sm;
-
-        for (sm = *matches; sm; sm = sm->next)
-            if (sm->service == (ServiceDetector*)pd->service)
-                break;
-
-        if (sm)
-            sm->count++;
-        else
-        {
-            sm = (ServiceMatch*)snort_calloc(sizeof(ServiceMatch));
-            sm->count++;
-            sm->service = static_cast<ServiceDetector*>(pd->service);
-            sm->size = pd->size;
-            sm->next = *matches;
-            *matches = sm;
-        }
-    }
-
-    return 0;
+    if (a.count != b.count)
+        return a.count > b.count;
+    return a.size > b.size;
 }
 
 /**Perform pattern match of a packet and construct a list of services sorted in order of
@@ -236,35 +191,19 @@ static int pattern_match(void* id, void*, int match_end_pos, void* data, void*)
 */
 void ServiceDiscovery::match_by_pattern(AppIdSession& asd, const Packet* pkt, IpProtocol proto)
 {
-    SearchTool* patterns = nullptr;
+    std::vector<AppIdPatternMatch>& matches = find_pattern_matches(pkt, proto);
 
-    if (proto == IpProtocol::TCP)
-        patterns = &tcp_patterns;
-    else
-        patterns = &udp_patterns;
+    if (matches.empty())
+        return;
 
-    if (patterns)
+    std::stable_sort(matches.begin(), matches.end(), AppIdPatternPrecedence);
+    for ( auto& sm : matches )
     {
-        ServiceMatch* match_list = nullptr;
-        patterns->find_all((const char*)pkt->data, pkt->dsize, &pattern_match, false,
-            (void*)&match_list);
-
-        std::vector<ServiceMatch*> smOrderedList;
-        for (ServiceMatch* sm = match_list; sm; sm = sm->next)
-            smOrderedList.emplace_back(sm);
-
-        if (!smOrderedList.empty() )
+        ServiceDetector* service = static_cast<ServiceDetector*>(sm.detector);
+        if ( std::find(asd.service_candidates.begin(), asd.service_candidates.end(),
+            service) == asd.service_candidates.end() )
         {
-            std::sort(smOrderedList.begin(), smOrderedList.end(), AppIdPatternPrecedence);
-            for ( auto& sm : smOrderedList )
-            {
-                if ( std::find(asd.service_candidates.begin(), asd.service_candidates.end(),
-                    sm->service) == asd.service_candidates.end() )
-                {
-                    asd.service_candidates.emplace_back(sm->service);
-                }
-                snort_free(sm);
-            }
+            asd.service_candidates.emplace_back(service);
         }
     }
 }
@@ -66,8 +66,6 @@ public:
     ~ServiceDiscovery() override = default;
     void initialize(AppIdInspector&) override;
     void reload() override;
-    void finalize_service_patterns();
-    void reload_service_patterns();
     int add_service_port(AppIdDetector*, const ServiceDetectorPort&) override;
 
     AppIdDetectorsIterator get_detector_iterator(IpProtocol);
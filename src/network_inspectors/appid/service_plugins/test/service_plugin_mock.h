@@ -99,7 +99,7 @@ void AppIdDetector::add_app(const snort::Packet&, AppIdSession&, AppidSessionDir
 void ApplicationDescriptor::set_id(AppId){}
 void ServiceAppDescriptor::set_id(AppId, OdpContext&){}
 void ClientAppDescriptor::update_user(AppId, const char*, AppidChangeBits&){}
-void AppIdDiscovery::add_pattern_data(AppIdDetector*, snort::SearchTool&, int,
+void AppIdDiscovery::add_pattern_data(AppIdDetector*, IpProtocol, int,
         const uint8_t* const, unsigned, unsigned){}
 void AppIdDiscovery::register_detector(const std::string&, AppIdDetector*,  IpProtocol){}
 void AppIdDiscovery::register_tcp_pattern(AppIdDetector*, const uint8_t* const, unsigned,
@@ -0,0 +1,157 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// host_port_app_cache_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "network_inspectors/appid/host_port_app_cache.h"
+
+using namespace snort;
+
+namespace snort
+{
+void LogMessage(const char*, ...) { }
+char* snort_strdup(const char* str) { return strdup(str); }
+}
+
+static SfIp make_ip(uint32_t n)
+{
+    SfIp ip;
+    uint32_t addr = htonl(0x0a000000 | n);
+    ip.set(&addr, AF_INET);
+    return ip;
+}
+
+#ifdef CATCH_TEST_BUILD
+
+TEST_CASE("host port cache lookups", "[appid]")
+{
+    HostPortCache cache;
+    SfIp ip1 = make_ip(1);
+    SfIp ip2 = make_ip(2);
+
+    cache.add(&ip1, 80, IpProtocol::TCP, 1, 100, false);
+    cache.add(&ip2, 53, IpProtocol::UDP, 2, 200, false);
+
+    SECTION("entries are found once frozen")
+    {
+        CHECK(cache.find(&ip1, 80, IpProtocol::TCP, false) == nullptr);
+        cache.finalize();
+
+        HostPortVal* hv = cache.find(&ip1, 80, IpProtocol::TCP, false);
+        REQUIRE(hv);
+        CHECK(hv->appId == 100);
+        CHECK(hv->type == 1);
+
+        hv = cache.find(&ip2, 53, IpProtocol::UDP, false);
+        REQUIRE(hv);
+        CHECK(hv->appId == 200);
+    }
+
+    SECTION("misses")
+    {
+        cache.finalize();
+        CHECK(cache.find(&ip1, 81, IpProtocol::TCP, false) == nullptr);
+        CHECK(cache.find(&ip1, 80, IpProtocol::UDP, false) == nullptr);
+        CHECK(cache.find(&ip2, 80, IpProtocol::TCP, false) == nullptr);
+    }
+
+    SECTION("later additions replace frozen entries")
+    {
+        cache.finalize();
+        cache.add(&ip1, 80, IpProtocol::TCP, 1, 300, false);
+        cache.finalize();
+
+        HostPortVal* hv = cache.find(&ip1, 80, IpProtocol::TCP, false);
+        REQUIRE(hv);
+        CHECK(hv->appId == 300);
+        CHECK(cache.size() == 2);
+    }
+
+    SECTION("port wildcard")
+    {
+        cache.add(&ip1, 443, IpProtocol::TCP, 1, 400, true);
+        cache.finalize();
+
+        HostPortVal* hv = cache.find(&ip1, 8443, IpProtocol::TCP, true);
+        REQUIRE(hv);
+        CHECK(hv->appId == 400);
+    }
+}
+
+#endif // CATCH_TEST_BUILD
+
+#ifdef BENCHMARK_TEST
+
+TEST_CASE("host port cache lookup", "[appid]")
+{
+    constexpr unsigned num_entries = 4096;
+
+    HostPortCache cache;
+    std::map<HostPortKey, HostPortVal> tree;
+    std::vector<SfIp> ips;
+
+    for ( unsigned i = 0; i < num_entries; ++i )
+    {
+        SfIp ip = make_ip(i * 7);
+        cache.add(&ip, 443, IpProtocol::TCP, 1, i, false);
+
+        HostPortKey hk;
+        hk.ip = ip;
+        hk.port = 443;
+        hk.proto = IpProtocol::TCP;
+        tree[hk] = { (AppId)i, 1 };
+
+        // every other lookup misses
+        ips.emplace_back(ip);
+        ips.emplace_back(make_ip(i * 7 + 1));
+    }
+    cache.finalize();
+
+    BENCHMARK("frozen sorted array")
+    {
+        unsigned found = 0;
+        for ( const auto& ip : ips )
+            found += cache.find(&ip, 443, IpProtocol::TCP, false) != nullptr;
+        return found;
+    };
+
+    BENCHMARK("std::map")
+    {
+        unsigned found = 0;
+        for ( const auto& ip : ips )
+        {
+            HostPortKey hk;
+            hk.ip = ip;
+            hk.port = 443;
+            hk.proto = IpProtocol::TCP;
+            found += tree.find(hk) != tree.end();
+        }
+        return found;
+    };
+}
+
+#endif // BENCHMARK_TEST
@@ -0,0 +1,135 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// lua_fast_match_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+
+#include "catch/catch.hpp"
+
+#include "network_inspectors/appid/appid_detector.h"
+#include "network_inspectors/appid/lua_fast_match.h"
+
+#ifdef CATCH_TEST_BUILD
+
+static LuaFastMatch make_match(const char* pattern, unsigned offset, AppidSessionDirection dir,
+    AppId service_id)
+{
+    LuaFastMatch fm;
+    fm.pattern = pattern;
+    fm.offset = offset;
+    fm.dir = dir;
+    fm.service_id = service_id;
+    fm.client_id = APP_ID_NONE;
+    return fm;
+}
+
+static const LuaFastMatch* find(const LuaFastMatches& fms, const char* payload,
+    AppidSessionDirection dir)
+{
+    return fms.find((const uint8_t*)payload, strlen(payload), dir);
+}
+
+TEST_CASE("fast match pattern at an offset", "[appid]")
+{
+    LuaFastMatch fm = make_match("SSH-", 2, APP_ID_APPID_SESSION_DIRECTION_MAX, 10);
+
+    CHECK(fm.match((const uint8_t*)"..SSH-2.0", 9, APP_ID_FROM_INITIATOR));
+    CHECK(fm.match((const uint8_t*)"..SSH-2.0", 9, APP_ID_FROM_RESPONDER));
+    CHECK(fm.match((const uint8_t*)"..SSH-", 6, APP_ID_FROM_RESPONDER));
+
+    CHECK(!fm.match((const uint8_t*)"SSH-2.0", 7, APP_ID_FROM_INITIATOR));
+    CHECK(!fm.match((const uint8_t*)"..SSX-2.0", 9, APP_ID_FROM_INITIATOR));
+
+    // the payload must hold the whole pattern
+    CHECK(!fm.match((const uint8_t*)"..SSH", 5, APP_ID_FROM_INITIATOR));
+    CHECK(!fm.match((const uint8_t*)"..", 2, APP_ID_FROM_INITIATOR));
+    CHECK(!fm.match((const uint8_t*)"", 0, APP_ID_FROM_INITIATOR));
+
+    fm.offset = 0xffffffff;
+    CHECK(!fm.match((const uint8_t*)"..SSH-2.0", 9, APP_ID_FROM_INITIATOR));
+}
+
+TEST_CASE("fast match direction", "[appid]")
+{
+    LuaFastMatch fm = make_match("220 ", 0, APP_ID_FROM_RESPONDER, 10);
+
+    CHECK(fm.match((const uint8_t*)"220 ready", 9, APP_ID_FROM_RESPONDER));
+    CHECK(!fm.match((const uint8_t*)"220 ready", 9, APP_ID_FROM_INITIATOR));
+}
+
+TEST_CASE("fast matches find the first match", "[appid]")
+{
+    LuaFastMatches fms;
+    fms.add(make_match("GET ", 0, APP_ID_FROM_INITIATOR, 10));
+    fms.add(make_match("HTTP/", 0, APP_ID_FROM_RESPONDER, 20));
+    fms.add(make_match("GET /x", 0, APP_ID_FROM_INITIATOR, 30));
+
+    const LuaFastMatch* fm = find(fms, "GET /x HTTP/1.1", APP_ID_FROM_INITIATOR);
+    REQUIRE(fm);
+    CHECK(fm->service_id == 10);
+
+    fm = find(fms, "HTTP/1.1 200 OK", APP_ID_FROM_RESPONDER);
+    REQUIRE(fm);
+    CHECK(fm->service_id == 20);
+
+    CHECK(!find(fms, "HTTP/1.1 200 OK", APP_ID_FROM_INITIATOR));
+    CHECK(!find(fms, "POST / HTTP/1.1", APP_ID_FROM_INITIATOR));
+}
+
+TEST_CASE("fast match misses fall back to the Lua validator", "[appid]")
+{
+    LuaFastMatches fms;
+    fms.add(make_match("220 ", 0, APP_ID_FROM_RESPONDER, 10));
+    int result = -1;
+
+    SECTION("with a validator")
+    {
+        CHECK(fms.need_validator(APP_ID_FROM_INITIATOR, result));
+        CHECK(fms.need_validator(APP_ID_FROM_RESPONDER, result));
+        CHECK(result == -1);
+    }
+
+    SECTION("without a validator")
+    {
+        fms.has_validator = false;
+
+        // the responder's payload is what the match looks at
+        CHECK(!fms.need_validator(APP_ID_FROM_INITIATOR, result));
+        CHECK(result == APPID_INPROCESS);
+        CHECK(!fms.need_validator(APP_ID_FROM_RESPONDER, result));
+        CHECK(result == APPID_NOMATCH);
+
+        fms.add(make_match("HELO", 0, APP_ID_APPID_SESSION_DIRECTION_MAX, 20));
+        CHECK(!fms.need_validator(APP_ID_FROM_INITIATOR, result));
+        CHECK(result == APPID_NOMATCH);
+    }
+
+    SECTION("without matches or a validator")
+    {
+        LuaFastMatches none;
+        none.has_validator = false;
+        CHECK(!none.need_validator(APP_ID_FROM_INITIATOR, result));
+        CHECK(result == APPID_NOMATCH);
+    }
+}
+
+#endif
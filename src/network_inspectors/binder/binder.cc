@@ -35,6 +35,7 @@
 
 #include "bind_module.h"
 #include "binding.h"
+#include "binding_index.h"
 
 using namespace snort;
 
@@ -469,6 +470,32 @@ void Stuff::apply_assistant(Flow& flow, const char* service)
         flow.set_assistant_gadget(gadget);
 }
 
+static BindingKey get_key(const Flow& flow, const char* service)
+{
+    BindingKey key;
+    key.type = flow.pkt_type;
+    key.client_ip = &flow.client_ip;
+    key.server_ip = &flow.server_ip;
+    key.client_port = flow.client_port;
+    key.server_port = flow.server_port;
+    key.service = service ? service : flow.service;
+    key.explicit_service = service != nullptr;
+    return key;
+}
+
+static BindingKey get_key(const Packet* p)
+{
+    BindingKey key;
+    key.type = p->type();
+    key.client_ip = p->ptrs.ip_api.is_ip() ? p->ptrs.ip_api.get_src() : nullptr;
+    key.server_ip = p->ptrs.ip_api.is_ip() ? p->ptrs.ip_api.get_dst() : nullptr;
+    key.client_port = p->ptrs.sp;
+    key.server_port = p->ptrs.dp;
+    key.service = nullptr;
+    key.explicit_service = false;
+    return key;
+}
+
 //-------------------------------------------------------------------------
 // class stuff
 //-------------------------------------------------------------------------
@@ -503,6 +530,8 @@ private:
 private:
     std::vector<Binding> bindings;
     std::vector<Binding> policy_bindings;
+    BindingIndex index;
+    BindingIndex policy_index;
     Inspector* default_ssn_inspectors[to_utype(PktType::MAX)]{};
 };
 
@@ -600,6 +629,9 @@ bool Binder::configure(SnortConfig* sc)
     for (Binding& b : policy_bindings)
         b.configure(sc);
 
+    index.build(bindings);
+    policy_index.build(policy_bindings);
+
     // Grab default session inspectors if they exist for this policy
     for (int proto = to_utype(PktType::NONE); proto < to_utype(PktType::MAX); proto++)
     {
@@ -673,6 +705,7 @@ void Binder::remove_inspector_binding(SnortConfig*, const char* name)
         if (!strcmp(key, name))
         {
             bindings.erase(it);
+            index.build(bindings);
             return;
         }
     }
@@ -829,8 +862,12 @@ void Binder::get_policy_bindings(Flow& flow, const char* service)
     // FIXIT-L This will select the first policy ID of each type that it finds and ignore the rest.
     //          It gets potentially hairy if people start specifying overlapping policy types in
     //          overlapping rules.
-    for (const Binding& b : policy_bindings)
+    BindingIndex::Cursor c = policy_index.find(get_key(flow, service));
+
+    for (int i = c.next(); i >= 0; i = c.next())
     {
+        const Binding& b = policy_bindings[i];
+
         // Skip any rules that don't contain an ID for a policy type we haven't set yet.
         if ((!b.use.inspection_index || inspection_index) && (!b.use.ips_index || ips_index))
             continue;
@@ -869,8 +906,12 @@ void Binder::get_policy_bindings(Packet* p)
     // FIXIT-L This will select the first policy ID of each type that it finds and ignore the rest.
     //          It gets potentially hairy if people start specifying overlapping policy types in
     //          overlapping rules.
-    for (const Binding& b : policy_bindings)
+    BindingIndex::Cursor c = policy_index.find(get_key(p));
+
+    for (int i = c.next(); i >= 0; i = c.next())
     {
+        const Binding& b = policy_bindings[i];
+
         // Skip any rules that don't contain an ID for a policy type we haven't set yet.
         if ((!b.use.inspection_index || inspection_index) && (!b.use.ips_index || ips_index))
             continue;
@@ -898,8 +939,8 @@ void Binder::get_policy_bindings(Packet* p)
     }
 }
 
-// FIXIT-P this is a simple linear search until functionality is nailed
-// down.  performance should be the focus of the next iteration.
+// the index only narrows the bindings to those that can match; they are
+// still checked in configuration order so all matches accumulate as before
 void Binder::get_bindings(Flow& flow, Stuff& stuff, const char* service)
 {
     // Evaluate policy ID bindings first
@@ -919,8 +960,12 @@ void Binder::get_bindings(Flow& flow, Stuff& stuff, const char* service)
     // Initialize the session inspector for both client and server to the default for this policy.
     stuff.client = stuff.server = default_ssn_inspectors[to_utype(flow.pkt_type)];
 
-    for (const Binding& b : bindings)
+    BindingIndex::Cursor c = index.find(get_key(flow, service));
+
+    for (int i = c.next(); i >= 0; i = c.next())
     {
+        const Binding& b = bindings[i];
+
         if (!b.check_all(flow, service))
             continue;
 
@@ -950,8 +995,12 @@ void Binder::get_bindings(Packet* p, Stuff& stuff)
     // Initialize the session inspector for both client and server to the default for this policy.
     stuff.client = stuff.server = default_ssn_inspectors[to_utype(p->type())];
 
-    for (const Binding& b : bindings)
+    BindingIndex::Cursor c = index.find(get_key(p));
+
+    for (int i = c.next(); i >= 0; i = c.next())
     {
+        const Binding& b = bindings[i];
+
         if (!b.check_all(p))
             continue;
 
@@ -0,0 +1,413 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// binding_index.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "binding_index.h"
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <set>
+
+#include "sfip/sf_cidr.h"
+#include "sfip/sf_ip.h"
+
+using namespace snort;
+
+//-------------------------------------------------------------------------
+// cursor
+//-------------------------------------------------------------------------
+
+int BindingIndex::Cursor::next()
+{
+    while ( true )
+    {
+        if ( bits )
+        {
+            int bit = __builtin_ctzll(bits);
+            bits &= bits - 1;
+            return (int)((word - 1) * 64 + bit);
+        }
+        if ( word >= words )
+            return -1;
+
+        bits = dims[0][word];
+
+        for ( unsigned i = 1; i < num_dims and bits; ++i )
+            bits &= dims[i][word];
+
+        ++word;
+    }
+}
+
+//-------------------------------------------------------------------------
+// build
+//-------------------------------------------------------------------------
+
+static inline void set_bit(uint64_t* mask, unsigned i)
+{ mask[i / 64] |= 1ULL << (i % 64); }
+
+static const PortBitSet* get_ports(const BindWhen& when, bool server)
+{
+    if ( when.has_criteria(BindWhen::BWC_SPLIT_PORTS) )
+        return server ? &when.dst_ports : &when.src_ports;
+
+    if ( when.has_criteria(BindWhen::BWC_PORTS) )
+    {
+        if ( when.role == (server ? BindWhen::BR_SERVER : BindWhen::BR_CLIENT) )
+            return &when.src_ports;
+    }
+    return nullptr;
+}
+
+static sfip_var_t* get_nets(const BindWhen& when, bool server)
+{
+    sfip_var_t* nets = nullptr;
+
+    if ( when.has_criteria(BindWhen::BWC_NETS) )
+    {
+        if ( when.role == (server ? BindWhen::BR_SERVER : BindWhen::BR_CLIENT) )
+            nets = when.src_nets;
+    }
+
+    // check_split_addr() only tests the lists that are present
+    else if ( when.has_criteria(BindWhen::BWC_SPLIT_NETS) )
+        nets = server ? when.dst_nets : when.src_nets;
+
+    return nets;
+}
+
+void BindingIndex::build(const std::vector<Binding>& bindings)
+{
+    count = bindings.size();
+    words = (count + 63) / 64;
+
+    protos.assign(to_utype(PktType::MAX) * words, 0);
+    no_svc.assign(words, 0);
+    no_match.assign(words, 0);
+
+    for ( unsigned i = 0; i < count; ++i )
+    {
+        const BindWhen& when = bindings[i].when;
+        bool ports = when.has_criteria(BindWhen::BWC_PORTS) or
+            when.has_criteria(BindWhen::BWC_SPLIT_PORTS);
+
+        // NONE is never indexed by proto so it doesn't need a mask
+        for ( unsigned t = to_utype(PktType::IP); t < to_utype(PktType::MAX); ++t )
+        {
+            if ( when.has_criteria(BindWhen::BWC_PROTO) and !(when.protos & (1u << (t - 1))) )
+                continue;
+
+            if ( ports and t != to_utype(PktType::TCP) and t != to_utype(PktType::UDP) )
+                continue;
+
+            set_bit(&protos[t * words], i);
+        }
+    }
+
+    build_services(bindings);
+    build_ports(bindings, false);
+    build_ports(bindings, true);
+    build_nets(bindings, false);
+    build_nets(bindings, true);
+}
+
+void BindingIndex::build_services(const std::vector<Binding>& bindings)
+{
+    svcs.clear();
+
+    for ( unsigned i = 0; i < count; ++i )
+    {
+        const BindWhen& when = bindings[i].when;
+
+        if ( !when.has_criteria(BindWhen::BWC_SVC) )
+        {
+            set_bit(no_svc.data(), i);
+            continue;
+        }
+        auto& masks = svcs[when.svc];
+
+        if ( masks.second.empty() )
+        {
+            masks.first.assign(words, 0);
+            masks.second.assign(words, 0);
+        }
+        set_bit(masks.second.data(), i);
+    }
+
+    for ( auto& svc : svcs )
+    {
+        for ( unsigned w = 0; w < words; ++w )
+            svc.second.first[w] = no_svc[w] | svc.second.second[w];
+    }
+}
+
+void BindingIndex::build_ports(const std::vector<Binding>& bindings, bool server)
+{
+    BindingRanges<uint16_t>& ranges = server ? server_ports : client_ports;
+    std::set<uint16_t> starts { 0 };
+    std::vector<const PortBitSet*> sets;
+    bool any = false;
+
+    ranges.clear();
+
+    for ( const auto& b : bindings )
+    {
+        const PortBitSet* ports = get_ports(b.when, server);
+        sets.emplace_back(ports);
+
+        if ( !ports )
+            continue;
+
+        any = true;
+
+        for ( unsigned p = 1; p < ports->size(); ++p )
+        {
+            if ( ports->test(p) != ports->test(p - 1) )
+                starts.insert(p);
+        }
+    }
+
+    if ( !any )
+        return;
+
+    std::vector<uint64_t> mask(words);
+
+    for ( auto start : starts )
+    {
+        std::fill(mask.begin(), mask.end(), 0);
+
+        for ( unsigned i = 0; i < count; ++i )
+        {
+            if ( !sets[i] or sets[i]->test(start) )
+                set_bit(mask.data(), i);
+        }
+        ranges.add(start, mask.data(), words);
+    }
+}
+
+// the range of addresses a list entry covers, as host order integers
+static void get_range(const SfCidr* cidr, uint32_t& lo, uint32_t& hi)
+{
+    unsigned bits = cidr->get_bits() > 96 ? cidr->get_bits() - 96 : 0;
+    uint32_t addr = ntohl(cidr->get_addr()->get_ip4_value());
+    uint32_t host = bits ? (bits < 32 ? UINT32_MAX >> bits : 0) : UINT32_MAX;
+
+    // fast_cont4() treats 0.0.0.0 as any
+    if ( !addr )
+        host = UINT32_MAX;
+
+    lo = addr & ~host;
+    hi = addr | host;
+}
+
+static void get_range(const SfCidr* cidr, BindingIndex::Ip6& lo, BindingIndex::Ip6& hi)
+{
+    const uint32_t* ip = cidr->get_addr()->get_ip6_ptr();
+    unsigned bits = cidr->get_bits();
+
+    for ( unsigned i = 0; i < 2; ++i )
+    {
+        uint64_t addr = ((uint64_t)ntohl(ip[2*i]) << 32) | ntohl(ip[2*i + 1]);
+        unsigned pre = bits > 64 * i ? bits - 64 * i : 0;
+        uint64_t host = pre >= 64 ? 0 : UINT64_MAX >> pre;
+
+        lo[i] = addr & ~host;
+        hi[i] = addr | host;
+    }
+}
+
+static SfIp make_ip(uint32_t a)
+{
+    SfIp ip;
+    uint32_t n = htonl(a);
+    ip.set(&n, AF_INET);
+    return ip;
+}
+
+static SfIp make_ip(const BindingIndex::Ip6& a)
+{
+    SfIp ip;
+    uint32_t n[4] =
+    {
+        htonl(a[0] >> 32), htonl((uint32_t)a[0]),
+        htonl(a[1] >> 32), htonl((uint32_t)a[1])
+    };
+    ip.set(n, AF_INET6);
+    return ip;
+}
+
+static inline bool inc(uint32_t& a)
+{ return ++a != 0; }
+
+static inline bool inc(BindingIndex::Ip6& a)
+{
+    if ( ++a[1] )
+        return true;
+    return ++a[0] != 0;
+}
+
+// sfvar_ip_in() depends only on which list entries of the address family
+// contain the address, so it is constant between the entries' boundaries
+template<typename T>
+static void build_range(const std::vector<sfip_var_t*>& nets, int family,
+    unsigned words, BindingRanges<T>& ranges)
+{
+    std::set<T> starts { T() };
+    ranges.clear();
+
+    for ( auto* var : nets )
+    {
+        if ( !var )
+            continue;
+
+        for ( sfip_node_t* list : { var->head, var->neg_head } )
+        {
+            for ( sfip_node_t* node = list; node; node = node->next )
+            {
+                if ( node->ip->get_family() != family )
+                    continue;
+
+                T lo, hi;
+                get_range(node->ip, lo, hi);
+                starts.insert(lo);
+
+                if ( inc(hi) )
+                    starts.insert(hi);
+            }
+        }
+    }
+
+    std::vector<uint64_t> mask(words);
+
+    for ( const auto& start : starts )
+    {
+        SfIp ip = make_ip(start);
+        std::fill(mask.begin(), mask.end(), 0);
+
+        for ( unsigned i = 0; i < nets.size(); ++i )
+        {
+            if ( !nets[i] or sfvar_ip_in(nets[i], &ip) )
+                set_bit(mask.data(), i);
+        }
+        ranges.add(start, mask.data(), words);
+    }
+}
+
+void BindingIndex::build_nets(const std::vector<Binding>& bindings, bool server)
+{
+    std::vector<sfip_var_t*> nets;
+    bool any = false;
+
+    for ( const auto& b : bindings )
+    {
+        nets.emplace_back(get_nets(b.when, server));
+        any = any or nets.back();
+    }
+
+    BindingRanges<uint32_t>& ip4 = server ? server_ip4 : client_ip4;
+    BindingRanges<Ip6>& ip6 = server ? server_ip6 : client_ip6;
+
+    if ( !any )
+    {
+        ip4.clear();
+        ip6.clear();
+        return;
+    }
+    build_range(nets, AF_INET, words, ip4);
+    build_range(nets, AF_INET6, words, ip6);
+}
+
+//-------------------------------------------------------------------------
+// lookup
+//-------------------------------------------------------------------------
+
+void BindingIndex::add_dim(Cursor& c, const uint64_t* mask) const
+{
+    if ( mask )
+        c.dims[c.num_dims++] = mask;
+}
+
+const uint64_t* BindingIndex::find_ip(const SfIp* ip, bool server) const
+{
+    if ( !ip )
+        return nullptr;
+
+    if ( ip->is_ip4() )
+    {
+        const BindingRanges<uint32_t>& ranges = server ? server_ip4 : client_ip4;
+        return ranges.empty() ? nullptr : ranges.find(ntohl(ip->get_ip4_value()), words);
+    }
+
+    const BindingRanges<Ip6>& ranges = server ? server_ip6 : client_ip6;
+
+    if ( ranges.empty() )
+        return nullptr;
+
+    const uint32_t* a = ip->get_ip6_ptr();
+    Ip6 key
+    {
+        ((uint64_t)ntohl(a[0]) << 32) | ntohl(a[1]),
+        ((uint64_t)ntohl(a[2]) << 32) | ntohl(a[3])
+    };
+    return ranges.find(key, words);
+}
+
+BindingIndex::Cursor BindingIndex::find(const BindingKey& key) const
+{
+    Cursor c;
+    c.words = words;
+
+    if ( !count )
+        return c;
+
+    unsigned type = to_utype(key.type);
+    add_dim(c, type and type < to_utype(PktType::MAX) ? &protos[type * words] : nullptr);
+
+    if ( key.explicit_service )
+    {
+        auto it = svcs.find(key.service);
+        add_dim(c, it == svcs.end() ? no_match.data() : it->second.second.data());
+    }
+    else if ( key.service )
+    {
+        auto it = svcs.find(key.service);
+        add_dim(c, it == svcs.end() ? no_svc.data() : it->second.first.data());
+    }
+    else
+        add_dim(c, no_svc.data());
+
+    if ( key.type == PktType::TCP or key.type == PktType::UDP )
+    {
+        if ( !client_ports.empty() )
+            add_dim(c, client_ports.find(key.client_port, words));
+
+        if ( !server_ports.empty() )
+            add_dim(c, server_ports.find(key.server_port, words));
+    }
+
+    add_dim(c, find_ip(key.client_ip, false));
+    add_dim(c, find_ip(key.server_ip, true));
+
+    return c;
+}
+
@@ -0,0 +1,157 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// binding_index.h
+
+#ifndef BINDING_INDEX_H
+#define BINDING_INDEX_H
+
+// Prefilter for the binding list compiled at configure time.  Each indexed
+// dimension (packet type, service, client and server port, client and server
+// address) maps a value to a bitmask of the bindings that value does not rule
+// out.  A lookup ands the masks of the dimensions and walks the set bits in
+// ascending order, so callers still see candidates in configuration order and
+// must still run check_all() on each of them.  Criteria that are not indexed
+// (vlans, interfaces, groups, etc.) and role either nets and ports leave the
+// binding set in every mask of the dimension.
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "framework/decode_data.h"
+
+#include "binding.h"
+
+namespace snort
+{
+struct SfIp;
+}
+
+struct BindingKey
+{
+    PktType type;
+    const snort::SfIp* client_ip;
+    const snort::SfIp* server_ip;
+    uint16_t client_port;
+    uint16_t server_port;
+
+    // service of the flow, or the service sought by an explicit lookup
+    const char* service;
+    bool explicit_service;
+};
+
+// values are mapped to the interval of sorted boundaries that holds them
+template<typename T>
+class BindingRanges
+{
+public:
+    void clear()
+    { starts.clear(); masks.clear(); }
+
+    bool empty() const
+    { return starts.empty(); }
+
+    void add(const T& start, const uint64_t* mask, unsigned words)
+    {
+        starts.emplace_back(start);
+        masks.insert(masks.end(), mask, mask + words);
+    }
+
+    const uint64_t* find(const T& value, unsigned words) const;
+
+private:
+    std::vector<T> starts;
+    std::vector<uint64_t> masks;
+};
+
+class BindingIndex
+{
+public:
+    using Ip6 = std::array<uint64_t, 2>;
+
+    class Cursor
+    {
+    public:
+        // returns the index of the next candidate or -1 when done
+        int next();
+
+    private:
+        friend class BindingIndex;
+        enum { MAX_DIMS = 6 };
+
+        const uint64_t* dims[MAX_DIMS];
+        unsigned num_dims = 0;
+        unsigned words = 0;
+        unsigned word = 0;
+        uint64_t bits = 0;
+        bool started = false;
+    };
+
+    void build(const std::vector<Binding>&);
+    Cursor find(const BindingKey&) const;
+
+    unsigned size() const
+    { return count; }
+
+private:
+    void add_dim(Cursor&, const uint64_t*) const;
+    const uint64_t* find_ip(const snort::SfIp*, bool server) const;
+
+    void build_services(const std::vector<Binding>&);
+    void build_ports(const std::vector<Binding>&, bool server);
+    void build_nets(const std::vector<Binding>&, bool server);
+
+private:
+    unsigned count = 0;
+    unsigned words = 0;
+
+    std::vector<uint64_t> protos;    // one mask per PktType
+    std::vector<uint64_t> no_svc;    // bindings without service criteria
+    std::vector<uint64_t> no_match;  // all zero
+
+    // per service, the bindings usable for a flow with that service and
+    // the bindings usable for an explicit lookup of that service
+    std::map<std::string, std::pair<std::vector<uint64_t>, std::vector<uint64_t>>, std::less<>> svcs;
+
+    BindingRanges<uint16_t> client_ports, server_ports;
+    BindingRanges<uint32_t> client_ip4, server_ip4;
+    BindingRanges<Ip6> client_ip6, server_ip6;
+};
+
+template<typename T>
+const uint64_t* BindingRanges<T>::find(const T& value, unsigned words) const
+{
+    // starts[0] is always the minimum value
+    unsigned lo = 0, hi = starts.size();
+
+    while ( hi - lo > 1 )
+    {
+        unsigned mid = (lo + hi) / 2;
+
+        if ( value < starts[mid] )
+            hi = mid;
+        else
+            lo = mid;
+    }
+    return &masks[lo * words];
+}
+
+#endif
+
@@ -0,0 +1,328 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// binding_index_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <arpa/inet.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "network_inspectors/binder/binding_index.h"
+#include "sfip/sf_ip.h"
+
+using namespace snort;
+
+namespace snort
+{
+char* snort_strdup(const char* str) { return strdup(str); }
+char* snort_strndup(const char* src, size_t n) { return strndup(src, n); }
+int SnortSnprintf(char*, size_t, const char*, ...) { return 0; }
+}
+
+Binding::Binding()
+{
+    when.src_nets = nullptr;
+    when.dst_nets = nullptr;
+    when.protos = PROTO_BIT__ANY_TYPE;
+    when.role = BindWhen::BR_EITHER;
+    when.criteria_flags = 0;
+}
+
+void Binding::clear()
+{
+    if ( when.src_nets )
+        sfvar_free(when.src_nets);
+
+    if ( when.dst_nets )
+        sfvar_free(when.dst_nets);
+
+    when.src_nets = when.dst_nets = nullptr;
+}
+
+static SfIp make_ip4(uint32_t a)
+{
+    SfIp ip;
+    uint32_t n = htonl(a);
+    ip.set(&n, AF_INET);
+    return ip;
+}
+
+static SfIp make_ip6(uint32_t a)
+{
+    SfIp ip;
+    uint32_t n[4] = { htonl(0x20010db8), 0, 0, htonl(a) };
+    ip.set(n, AF_INET6);
+    return ip;
+}
+
+static sfip_var_t* make_nets(const char* s)
+{
+    std::string str = std::string("nets ") + s;
+    SfIpRet ret;
+    sfip_var_t* var = sfvar_alloc(nullptr, str.c_str(), &ret);
+    REQUIRE(var);
+    return var;
+}
+
+// the checks of Binding::check_all() for the indexed criteria
+static bool check(const BindWhen& w, const BindingKey& k)
+{
+    if ( k.explicit_service )
+    {
+        if ( !w.has_criteria(BindWhen::BWC_SVC) or w.svc != k.service )
+            return false;
+    }
+    else if ( w.has_criteria(BindWhen::BWC_SVC) and (!k.service or w.svc != k.service) )
+        return false;
+
+    if ( w.has_criteria(BindWhen::BWC_NETS) )
+    {
+        bool c = sfvar_ip_in(w.src_nets, k.client_ip);
+        bool s = sfvar_ip_in(w.src_nets, k.server_ip);
+
+        if ( w.role == BindWhen::BR_CLIENT ? !c : w.role == BindWhen::BR_SERVER ? !s : !(c or s) )
+            return false;
+    }
+    if ( w.has_criteria(BindWhen::BWC_SPLIT_NETS) )
+    {
+        if ( w.src_nets and !sfvar_ip_in(w.src_nets, k.client_ip) )
+            return false;
+
+        if ( w.dst_nets and !sfvar_ip_in(w.dst_nets, k.server_ip) )
+            return false;
+    }
+    if ( w.has_criteria(BindWhen::BWC_PROTO) and !(w.protos & (1u << ((unsigned)k.type - 1))) )
+        return false;
+
+    bool tcp_udp = k.type == PktType::TCP or k.type == PktType::UDP;
+
+    if ( w.has_criteria(BindWhen::BWC_PORTS) )
+    {
+        bool c = w.src_ports.test(k.client_port);
+        bool s = w.src_ports.test(k.server_port);
+
+        if ( !tcp_udp or
+            (w.role == BindWhen::BR_CLIENT ? !c : w.role == BindWhen::BR_SERVER ? !s : !(c or s)) )
+            return false;
+    }
+    if ( w.has_criteria(BindWhen::BWC_SPLIT_PORTS) )
+    {
+        if ( !tcp_udp or !w.src_ports.test(k.client_port) or !w.dst_ports.test(k.server_port) )
+            return false;
+    }
+    return true;
+}
+
+static std::vector<int> get_candidates(const BindingIndex& index, const BindingKey& key)
+{
+    std::vector<int> v;
+    BindingIndex::Cursor c = index.find(key);
+
+    for ( int i = c.next(); i >= 0; i = c.next() )
+        v.emplace_back(i);
+
+    return v;
+}
+
+#ifdef CATCH_TEST_BUILD
+
+TEST_CASE("binding index candidates", "[binder]")
+{
+    std::vector<Binding> bindings(6);
+
+    // 0: tcp server port 80
+    bindings[0].when.add_criteria(BindWhen::BWC_PROTO | BindWhen::BWC_PORTS);
+    bindings[0].when.protos = PROTO_BIT__TCP;
+    bindings[0].when.role = BindWhen::BR_SERVER;
+    bindings[0].when.src_ports.set(80);
+
+    // 1: server nets 10.0.0.0/8 except 10.1.0.0/16
+    bindings[1].when.add_criteria(BindWhen::BWC_NETS);
+    bindings[1].when.role = BindWhen::BR_SERVER;
+    bindings[1].when.src_nets = make_nets("[10.0.0.0/8,!10.1.0.0/16]");
+
+    // 2: http service
+    bindings[2].when.add_criteria(BindWhen::BWC_SVC);
+    bindings[2].when.svc = "http";
+
+    // 3: split ports 1024:65535 -> 443
+    bindings[3].when.add_criteria(BindWhen::BWC_SPLIT_PORTS);
+    for ( unsigned p = 1024; p < 65536; ++p )
+        bindings[3].when.src_ports.set(p);
+    bindings[3].when.dst_ports.set(443);
+
+    // 4: udp
+    bindings[4].when.add_criteria(BindWhen::BWC_PROTO);
+    bindings[4].when.protos = PROTO_BIT__UDP;
+
+    // 5: anything
+    BindingIndex index;
+    index.build(bindings);
+    CHECK(index.size() == 6);
+
+    SfIp cip = make_ip4(0xc0a80001);
+    SfIp sip = make_ip4(0x0a020304);
+    BindingKey key { PktType::TCP, &cip, &sip, 40000, 80, nullptr, false };
+
+    SECTION("in order")
+    {
+        CHECK(get_candidates(index, key) == std::vector<int>({ 0, 1, 5 }));
+    }
+    SECTION("negated subnet")
+    {
+        sip = make_ip4(0x0a010304);
+        CHECK(get_candidates(index, key) == std::vector<int>({ 0, 5 }));
+    }
+    SECTION("split ports")
+    {
+        key.server_port = 443;
+        CHECK(get_candidates(index, key) == std::vector<int>({ 1, 3, 5 }));
+        key.client_port = 1023;
+        CHECK(get_candidates(index, key) == std::vector<int>({ 1, 5 }));
+    }
+    SECTION("service")
+    {
+        key.service = "http";
+        CHECK(get_candidates(index, key) == std::vector<int>({ 0, 1, 2, 5 }));
+        key.explicit_service = true;
+        CHECK(get_candidates(index, key) == std::vector<int>({ 2 }));
+        key.service = "ftp";
+        CHECK(get_candidates(index, key).empty());
+    }
+    SECTION("proto")
+    {
+        key.type = PktType::UDP;
+        CHECK(get_candidates(index, key) == std::vector<int>({ 1, 4, 5 }));
+        key.type = PktType::ICMP;
+        CHECK(get_candidates(index, key) == std::vector<int>({ 1, 5 }));
+    }
+    for ( auto& b : bindings )
+        b.clear();
+}
+
+TEST_CASE("binding index matches linear search", "[binder]")
+{
+    std::mt19937 rng(1);
+    std::vector<Binding> bindings(150);
+
+    const char* nets[] =
+    {
+        "10.0.0.0/8", "[10.0.0.0/8,!10.1.0.0/16]", "192.168.1.0/24", "!10.0.0.0/8",
+        "[2001:db8::/120,10.2.0.0/16]", "0.0.0.0/0", "10.0.0.7"
+    };
+    const char* svcs[] = { "http", "ftp", "dns" };
+
+    for ( auto& b : bindings )
+    {
+        BindWhen& w = b.when;
+        unsigned r = rng();
+
+        if ( r & 1 )
+        {
+            w.add_criteria(BindWhen::BWC_PROTO);
+            w.protos = rng() & PROTO_BIT__ANY_TYPE;
+        }
+        if ( r & 2 )
+        {
+            w.add_criteria(BindWhen::BWC_SVC);
+            w.svc = svcs[rng() % 3];
+        }
+        if ( r & 4 )
+        {
+            w.add_criteria(BindWhen::BWC_PORTS);
+            unsigned lo = rng() % 2000;
+            for ( unsigned p = lo; p < lo + rng() % 100; ++p )
+                w.src_ports.set(p);
+        }
+        else if ( r & 8 )
+        {
+            w.add_criteria(BindWhen::BWC_SPLIT_PORTS);
+            w.src_ports.set(rng() % 2000);
+            w.dst_ports.set(rng() % 2000);
+        }
+        if ( r & 16 )
+        {
+            w.add_criteria(BindWhen::BWC_NETS);
+            w.src_nets = make_nets(nets[rng() % 7]);
+        }
+        else if ( r & 32 )
+        {
+            w.add_criteria(BindWhen::BWC_SPLIT_NETS);
+            if ( rng() & 1 )
+                w.src_nets = make_nets(nets[rng() % 7]);
+            if ( rng() & 1 )
+                w.dst_nets = make_nets(nets[rng() % 7]);
+        }
+        w.role = (BindWhen::Role)(rng() % BindWhen::BR_MAX);
+    }
+
+    BindingIndex index;
+    index.build(bindings);
+
+    const uint32_t addrs[] = { 0x0a000007, 0x0a010001, 0x0a020002, 0xc0a80101, 0x01020304, 0 };
+    const char* flow_svcs[] = { nullptr, "http", "ftp", "ssh" };
+
+    for ( unsigned n = 0; n < 20000; ++n )
+    {
+        SfIp cip = (rng() & 3) ? make_ip4(addrs[rng() % 6]) : make_ip6(rng() % 512);
+        SfIp sip = (rng() & 3) ? make_ip4(addrs[rng() % 6]) : make_ip6(rng() % 512);
+
+        BindingKey key;
+        key.type = (PktType)(1 + rng() % (to_utype(PktType::MAX) - 1));
+        key.client_ip = &cip;
+        key.server_ip = &sip;
+        key.client_port = rng() % 2100;
+        key.server_port = rng() % 2100;
+        key.service = flow_svcs[rng() % 4];
+        key.explicit_service = key.service and !(rng() % 4);
+
+        std::vector<int> candidates = get_candidates(index, key);
+        std::vector<int> matches;
+
+        for ( unsigned i = 0; i < bindings.size(); ++i )
+        {
+            if ( check(bindings[i].when, key) )
+                matches.emplace_back(i);
+        }
+
+        // every match is a candidate and candidates are in order
+        unsigned j = 0;
+        for ( int i : candidates )
+        {
+            if ( j < matches.size() and i == matches[j] )
+                ++j;
+        }
+        REQUIRE(j == matches.size());
+
+        for ( unsigned k = 1; k < candidates.size(); ++k )
+            REQUIRE(candidates[k - 1] < candidates[k]);
+    }
+    for ( auto& b : bindings )
+        b.clear();
+}
+
+#endif // CATCH_TEST_BUILD
+
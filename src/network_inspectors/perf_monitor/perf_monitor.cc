@@ -38,6 +38,7 @@
 #include "main/thread.h"
 #include "profiler/profiler.h"
 #include "protocols/packet.h"
+#include "time/packet_time.h"
 
 #ifdef UNIT_TEST
 #include "catch/snort_catch.h"
@@ -380,7 +381,7 @@ bool PerfMonitor::ready_to_process(Packet* p)
         cur_time = p->pkth->ts.tv_sec;
     }
     else if (cur_time)
-        cur_time = time(nullptr);
+        cur_time = packet_thread_time();
     else
         return false;
 
@@ -33,6 +33,7 @@
 
 #include "ps_inspect.h"
 #include "ps_module.h"
+#include "ps_sketch.h"
 
 using namespace snort;
 
@@ -398,6 +399,7 @@ static void portscan_config_show(const PortscanConfig* config)
         ConfigLogger::log_list("ignore_scanned", to_string(config->ignore_scanned).c_str());
 
     ConfigLogger::log_flag("alert_all", config->alert_all);
+    ConfigLogger::log_flag("sketch", config->sketch);
     ConfigLogger::log_flag("include_midstream", config->include_midstream);
 
     ConfigLogger::log_value("tcp_window", config->tcp_window);
@@ -411,16 +413,28 @@ static void portscan_config_show(const PortscanConfig* config)
 //-------------------------------------------------------------------------
 
 PortScan::PortScan(PortScanModule* mod)
-{ config = mod->get_data(); }
+{
+    config = mod->get_data();
+
+    if ( config->sketch )
+        sketch = ps_new_sketch(config->memcap);
+}
 
 PortScan::~PortScan()
 {
     if ( config )
         delete config;
+
+    delete sketch;
 }
 
 void PortScan::tinit()
-{ ps_init_hash(config->memcap); }
+{
+    if ( sketch )
+        ps_init_sketch(sketch);
+    else
+        ps_init_hash(config->memcap);
+}
 
 void PortScan::tterm()
 { ps_cleanup(); }
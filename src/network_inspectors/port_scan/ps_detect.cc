@@ -46,6 +46,7 @@
 
 #include "ps_inspect.h"
 #include "ps_pegs.h"
+#include "ps_sketch.h"
 
 using namespace snort;
 
@@ -86,6 +87,7 @@ public:
 };
 
 static THREAD_LOCAL PortScanCache* portscan_hash = nullptr;
+static THREAD_LOCAL PsSketchTracker* portscan_sketch = nullptr;
 extern THREAD_LOCAL PsPegStats spstats;
 
 PS_PKT::PS_PKT(Packet* p)
@@ -119,6 +121,9 @@ void ps_cleanup()
         delete portscan_hash;
         portscan_hash = nullptr;
     }
+
+    delete portscan_sketch;
+    portscan_sketch = nullptr;
 }
 
 unsigned ps_node_size()
@@ -126,6 +131,9 @@ unsigned ps_node_size()
 
 bool ps_init_hash(unsigned long memcap)
 {
+    delete portscan_sketch;
+    portscan_sketch = nullptr;
+
     if ( portscan_hash )
     {
         bool need_pruning = (memcap < portscan_hash->get_mem_used());
@@ -155,6 +163,28 @@ void ps_reset()
 {
     if ( portscan_hash )
         portscan_hash->clear_hash();
+
+    if ( portscan_sketch )
+        portscan_sketch->clear();
+}
+
+// each thread keeps a local and a snapshot sketch and all share one more
+PsSharedSketch* ps_new_sketch(unsigned long memcap)
+{ return new PsSharedSketch(PsSketch::get_width(memcap / 2)); }
+
+void ps_init_sketch(PsSharedSketch* shared)
+{
+    if ( portscan_hash )
+    {
+        delete portscan_hash;
+        portscan_hash = nullptr;
+    }
+
+    if ( portscan_sketch and portscan_sketch->get_shared() == shared )
+        return;
+
+    delete portscan_sketch;
+    portscan_sketch = new PsSketchTracker(shared);
 }
 
 //  Check scanner and scanned ips to see if we can filter them out.
@@ -292,8 +322,11 @@ bool PortScan::ps_filter_ignore(PS_PKT* ps_pkt)
 **  Get a tracker node by either finding one or starting a new one.  We may
 **  return null, in which case we wait `til the next packet.
 */
-static PS_TRACKER* ps_tracker_get(PS_HASH_KEY* key)
+static PS_TRACKER* ps_tracker_get(PS_HASH_KEY* key, PsSketchTracker::Slot slot)
 {
+    if ( portscan_sketch )
+        return portscan_sketch->get(slot, PsSketch::hash(key, sizeof(*key)), packet_time());
+
     PS_TRACKER* ht = (PS_TRACKER*)portscan_hash->get_user_data((void*)key);
 
     if ( ht )
@@ -347,7 +380,7 @@ bool PortScan::ps_tracker_lookup(
             key.group = p->get_egress_group();
         }
 
-        *scanned = ps_tracker_get(&key);
+        *scanned = ps_tracker_get(&key, PsSketchTracker::SCANNED);
     }
 
     //  Let's lookup the host that is scanning.
@@ -367,7 +400,7 @@ bool PortScan::ps_tracker_lookup(
             key.group = p->get_ingress_group();
         }
 
-        *scanner = ps_tracker_get(&key);
+        *scanner = ps_tracker_get(&key, PsSketchTracker::SCANNER);
     }
 
     return *scanner or *scanned;
@@ -1273,6 +1306,9 @@ int PortScan::ps_detect(PS_PKT* ps_pkt)
         if ( !ps_tracker_alert(ps_pkt, scanner, scanned) )
             return 0;
 
+        if ( portscan_sketch )
+            portscan_sketch->update(packet_time());
+
         /* This is added to address the case of no
          * session and a RST packet going back from the Server. */
         if ( p->ptrs.tcph and (p->ptrs.tcph->th_flags & TH_RST) and !p->flow )
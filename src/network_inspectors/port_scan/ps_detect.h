@@ -86,6 +86,7 @@ struct PortscanConfig
 
     bool alert_all;
     bool logfile;
+    bool sketch;
 
     unsigned tcp_window;
     unsigned udp_window;
@@ -160,6 +161,8 @@ struct PS_PKT
     PS_PKT(snort::Packet*);
 };
 
+struct PsSharedSketch;
+
 void ps_cleanup();
 void ps_reset();
 
@@ -168,5 +171,8 @@ bool ps_init_hash(unsigned long);
 bool ps_prune_hash(unsigned);
 int ps_detect(PS_PKT*);
 
+PsSharedSketch* ps_new_sketch(unsigned long memcap);
+void ps_init_sketch(PsSharedSketch*);
+
 #endif
 
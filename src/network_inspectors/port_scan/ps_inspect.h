@@ -35,6 +35,7 @@ struct SfIp;
 struct PS_PROTO;
 struct PS_TRACKER;
 struct PS_PKT;
+struct PsSharedSketch;
 
 class PortScan : public snort::Inspector
 {
@@ -79,6 +80,7 @@ private:
 
 private:
     PortscanConfig* config;
+    PsSharedSketch* sketch = nullptr;
 };
 
 #endif
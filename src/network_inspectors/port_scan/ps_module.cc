@@ -81,6 +81,10 @@ static const Parameter ps_params[] =
     { "alert_all", Parameter::PT_BOOL, nullptr, "false",
       "alert on all events over threshold within window if true; else alert on first only" },
 
+    { "sketch", Parameter::PT_BOOL, nullptr, "false",
+      "track with fixed size sketches merged across packet threads instead of the "
+      "tracker table; nets and ports then count distinct values" },
+
     { "include_midstream", Parameter::PT_BOOL, nullptr, "false",
       "list of CIDRs with optional ports" },
 
@@ -256,6 +260,9 @@ bool PortScanModule::set(const char* fqn, Value& v, SnortConfig*)
     else if ( v.is("alert_all") )
         config->alert_all = v.get_bool();
 
+    else if ( v.is("sketch") )
+        config->sketch = v.get_bool();
+
     else if ( v.is("include_midstream") )
         config->include_midstream = v.get_bool();
 
@@ -325,7 +332,7 @@ bool PortScanModule::set(const char* fqn, Value& v, SnortConfig*)
 
 bool PortScanModule::end(const char* fqn, int, SnortConfig* sc)
 {
-    if ( Snort::is_reloading() && strcmp(fqn, "port_scan") == 0 )
+    if ( Snort::is_reloading() && strcmp(fqn, "port_scan") == 0 && !config->sketch )
         sc->register_reload_resource_tuner(new PortScanReloadTuner(config->memcap));
     return true;
 }
@@ -30,6 +30,7 @@ static const PegInfo ps_module_pegs[] =
     { CountType::SUM, "trackers", "number of trackers allocated by port scan" },
     { CountType::SUM, "alloc_prunes", "number of trackers pruned on allocation of new tracking" },
     { CountType::SUM, "reload_prunes", "number of trackers pruned on reload due to reduced memcap" },
+    { CountType::SUM, "sketch_merges", "number of times a thread merged its sketch counts" },
     { CountType::END, nullptr, nullptr },
 };
 
@@ -39,6 +40,7 @@ struct PsPegStats
     PegCount trackers;
     PegCount alloc_prunes;
     PegCount reload_prunes;
+    PegCount sketch_merges;
 };
 
 #endif
@@ -0,0 +1,317 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// ps_sketch.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "ps_sketch.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "main/thread.h"
+#include "utils/util.h"
+
+#include "ps_pegs.h"
+
+extern THREAD_LOCAL PsPegStats spstats;
+
+//-------------------------------------------------------------------------
+// sketch
+//-------------------------------------------------------------------------
+
+PsSketch::PsSketch(unsigned w) : width(w)
+{
+    assert(width);
+    cells = (PsSketchCell*)snort_calloc(size(), sizeof(PsSketchCell));
+}
+
+PsSketch::~PsSketch()
+{ snort_free(cells); }
+
+void PsSketch::clear()
+{ memset(cells, 0, size() * sizeof(PsSketchCell)); }
+
+void PsSketch::copy(const PsSketch& rhs)
+{
+    assert(width == rhs.width);
+    memcpy(cells, rhs.cells, size() * sizeof(PsSketchCell));
+}
+
+unsigned PsSketch::get_width(size_t bytes)
+{
+    size_t w = bytes / (PS_SKETCH_ROWS * sizeof(PsSketchCell));
+    return std::max<size_t>(std::min<size_t>(w, UINT32_MAX / PS_SKETCH_ROWS), 64);
+}
+
+uint64_t PsSketch::hash(const void* data, unsigned len)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    for ( unsigned i = 0; i < len; ++i )
+        h = (h ^ p[i]) * 0x100000001b3ULL;
+
+    // fnv alone leaves the high bits poorly mixed; the hll index uses them
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+void PsSketch::hll_add(uint8_t* regs, uint64_t hash)
+{
+    unsigned idx = hash >> (64 - PS_HLL_BITS);
+    uint64_t rest = (hash << PS_HLL_BITS) | (1ULL << (PS_HLL_BITS - 1));
+    uint8_t rank = __builtin_clzll(rest) + 1;
+
+    if ( regs[idx] < rank )
+        regs[idx] = rank;
+}
+
+// estimate for the union of the given register sets (either may be null)
+unsigned PsSketch::hll_estimate(const uint8_t* a, const uint8_t* b)
+{
+    static const double m = PS_HLL_REGS;
+    double sum = 0;
+    unsigned zeros = 0;
+
+    for ( unsigned i = 0; i < PS_HLL_REGS; ++i )
+    {
+        uint8_t r = std::max(a ? a[i] : 0, b ? b[i] : 0);
+        sum += 1.0 / (double)(1ULL << r);
+        zeros += !r;
+    }
+
+    double e = 0.7213 / (1.0 + 1.079 / m) * m * m / sum;
+
+    // small range correction, which is where the alert thresholds live
+    if ( e <= 2.5 * m and zeros )
+        e = m * log(m / zeros);
+
+    return (unsigned)(e + 0.5);
+}
+
+//-------------------------------------------------------------------------
+// tracker
+//-------------------------------------------------------------------------
+
+// a's counts belong to a window that has ended and been replaced by b's
+static inline bool is_stale(const PsSketchCell& a, const PsSketchCell& b, time_t now)
+{ return a.window < b.window and a.window < now; }
+
+static inline int32_t clamp(int32_t n)
+{ return n < 0 ? 0 : n; }
+
+PsSketchTracker::PsSketchTracker(PsSharedSketch* ss) :
+    shared(ss), local(ss->sketch.get_width()), snapshot(ss->sketch.get_width())
+{
+    memset((void*)views, 0, sizeof(views));
+}
+
+PS_TRACKER* PsSketchTracker::get(Slot slot, uint64_t key, time_t now)
+{
+    View& v = views[slot];
+    PS_PROTO& proto = v.tracker.proto;
+
+    memset((void*)&v.tracker, 0, sizeof(v.tracker));
+    proto.connection_count = proto.priority_count = INT32_MAX;
+    proto.u_ip_count = proto.u_port_count = INT32_MAX;
+    proto.alerts = UINT8_MAX;
+
+    for ( unsigned row = 0; row < PS_SKETCH_ROWS; ++row )
+    {
+        const PsSketchCell& s = snapshot.get_cell(row, key);
+        const PsSketchCell& l = local.get_cell(row, key);
+
+        bool use_s = !is_stale(s, l, now);
+        bool use_l = !is_stale(l, s, now);
+
+        int32_t conn = clamp((use_s ? s.connection_count : 0) + (use_l ? l.connection_count : 0));
+        int32_t pri = clamp((use_s ? s.priority_count : 0) + (use_l ? l.priority_count : 0));
+
+        int ips = PsSketch::hll_estimate(use_s ? s.ips : nullptr, use_l ? l.ips : nullptr);
+        int ports = PsSketch::hll_estimate(use_s ? s.ports : nullptr, use_l ? l.ports : nullptr);
+
+        uint8_t alerts = std::max(use_s ? s.alerts : 0, use_l ? l.alerts : 0);
+        time_t window = std::max(use_s ? s.window : 0, use_l ? l.window : 0);
+
+        proto.connection_count = std::min(proto.connection_count, conn);
+        proto.priority_count = std::min(proto.priority_count, pri);
+        proto.u_ip_count = std::min(proto.u_ip_count, ips);
+        proto.u_port_count = std::min(proto.u_port_count, ports);
+        proto.alerts = std::min(proto.alerts, alerts);
+        proto.window = std::max(proto.window, window);
+
+        for ( const PsSketchCell* c : { &s, &l } )
+        {
+            if ( !c->low_p or (c == &s ? !use_s : !use_l) )
+                continue;
+
+            if ( !proto.low_p or proto.low_p > c->low_p )
+                proto.low_p = c->low_p;
+
+            if ( proto.high_p < c->high_p )
+                proto.high_p = c->high_p;
+        }
+    }
+
+    v.before = proto;
+    v.key = key;
+    v.used = true;
+
+    return &v.tracker;
+}
+
+void PsSketchTracker::update(View& v, time_t now)
+{
+    const PS_PROTO& after = v.tracker.proto;
+
+    // the window rolls over only once all rows have expired
+    bool reset = after.window != v.before.window;
+    bool counted = after.u_ips.is_set();
+
+    PS_PROTO base = v.before;
+
+    if ( reset )
+        memset((void*)&base, 0, sizeof(base));
+
+    uint64_t ip_hash = 0, port_hash = 0;
+
+    if ( counted )
+    {
+        ip_hash = PsSketch::hash(after.u_ips.get_ip6_ptr(), 16);
+        port_hash = PsSketch::hash(&after.u_ports, sizeof(after.u_ports));
+    }
+
+    for ( unsigned row = 0; row < PS_SKETCH_ROWS; ++row )
+    {
+        unsigned idx = row * local.get_width() + local.get_index(row, v.key);
+        const PsSketchCell& s = snapshot.at(idx);
+        PsSketchCell& l = local.at(idx);
+        bool dirty = l.dirty;
+
+        if ( reset or is_stale(l, s, now) )
+            memset((void*)&l, 0, sizeof(l));
+
+        if ( reset )
+            l.window = after.window;
+
+        else if ( l.window < s.window )
+            l.window = s.window;
+
+        l.connection_count += after.connection_count - base.connection_count;
+        l.priority_count += after.priority_count - base.priority_count;
+
+        if ( counted )
+        {
+            PsSketch::hll_add(l.ips, ip_hash);
+            PsSketch::hll_add(l.ports, port_hash);
+
+            if ( after.u_ports )
+            {
+                if ( !l.low_p or l.low_p > after.u_ports )
+                    l.low_p = after.u_ports;
+
+                if ( l.high_p < after.u_ports )
+                    l.high_p = after.u_ports;
+            }
+        }
+
+        if ( reset or after.alerts != v.before.alerts )
+            l.alerts = after.alerts;
+
+        l.dirty = true;
+
+        if ( !dirty )
+            this->dirty.emplace_back(idx);
+    }
+}
+
+void PsSketchTracker::update(time_t now)
+{
+    for ( auto& v : views )
+    {
+        if ( v.used )
+        {
+            update(v, now);
+            v.used = false;
+        }
+    }
+
+    if ( now >= next_merge )
+        merge(now);
+}
+
+void PsSketchTracker::merge(time_t now)
+{
+    std::lock_guard<std::mutex> lock(shared->mutex);
+
+    for ( auto idx : dirty )
+    {
+        PsSketchCell& g = shared->sketch.at(idx);
+        PsSketchCell& l = local.at(idx);
+
+        if ( is_stale(g, l, now) )
+        {
+            g = l;
+            g.connection_count = clamp(g.connection_count);
+            g.priority_count = clamp(g.priority_count);
+        }
+        else if ( !is_stale(l, g, now) )
+        {
+            g.connection_count = clamp(g.connection_count + l.connection_count);
+            g.priority_count = clamp(g.priority_count + l.priority_count);
+            g.window = std::max(g.window, l.window);
+            g.alerts = std::max(g.alerts, l.alerts);
+
+            if ( l.low_p and (!g.low_p or g.low_p > l.low_p) )
+                g.low_p = l.low_p;
+
+            g.high_p = std::max(g.high_p, l.high_p);
+
+            for ( unsigned i = 0; i < PS_HLL_REGS; ++i )
+            {
+                g.ips[i] = std::max(g.ips[i], l.ips[i]);
+                g.ports[i] = std::max(g.ports[i], l.ports[i]);
+            }
+        }
+        g.dirty = false;
+        memset((void*)&l, 0, sizeof(l));
+    }
+    dirty.clear();
+
+    snapshot.copy(shared->sketch);
+    next_merge = now + PS_SKETCH_MERGE;
+    ++spstats.sketch_merges;
+}
+
+void PsSketchTracker::clear()
+{
+    local.clear();
+    snapshot.clear();
+    dirty.clear();
+    next_merge = 0;
+}
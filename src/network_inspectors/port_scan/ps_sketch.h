@@ -0,0 +1,153 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// ps_sketch.h
+
+#ifndef PS_SKETCH_H
+#define PS_SKETCH_H
+
+// Fixed size alternative to the port scan tracker table.  Each tracker key
+// is hashed to one cell in each row of a count-min sketch.  A cell holds the
+// connection and priority counters of all keys sharing it plus HyperLogLog
+// registers for the distinct addresses and ports they touched.  Reading a
+// key takes the minimum over its cells, so collisions can only overestimate.
+//
+// Each packet thread counts into a local sketch of deltas and reads through
+// a snapshot of a sketch shared by all threads.  Once per merge interval the
+// thread adds its deltas to the shared sketch and refreshes its snapshot, so
+// scans spread over several threads are still seen as one.
+
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <vector>
+
+#include "ps_detect.h"
+
+#define PS_SKETCH_ROWS  2
+#define PS_SKETCH_MERGE 1  // seconds between merges with the shared sketch
+
+#define PS_HLL_BITS 7
+#define PS_HLL_REGS (1 << PS_HLL_BITS)
+
+struct PsSketchCell
+{
+    int32_t connection_count;
+    int32_t priority_count;
+    time_t window;
+
+    uint16_t low_p;
+    uint16_t high_p;
+
+    uint8_t alerts;
+    bool dirty;
+
+    uint8_t ips[PS_HLL_REGS];
+    uint8_t ports[PS_HLL_REGS];
+};
+
+class PsSketch
+{
+public:
+    PsSketch(unsigned width);
+    ~PsSketch();
+
+    PsSketch(const PsSketch&) = delete;
+    PsSketch& operator=(const PsSketch&) = delete;
+
+    unsigned get_width() const
+    { return width; }
+
+    PsSketchCell& get_cell(unsigned row, uint64_t hash)
+    { return cells[row * width + get_index(row, hash)]; }
+
+    PsSketchCell& at(unsigned index)
+    { return cells[index]; }
+
+    unsigned get_index(unsigned row, uint64_t hash) const
+    { return (uint32_t)(hash >> (32 * row)) % width; }
+
+    unsigned size() const
+    { return PS_SKETCH_ROWS * width; }
+
+    void clear();
+    void copy(const PsSketch&);
+
+    // width that keeps one sketch within bytes
+    static unsigned get_width(size_t bytes);
+
+    static uint64_t hash(const void*, unsigned len);
+    static void hll_add(uint8_t* regs, uint64_t hash);
+    static unsigned hll_estimate(const uint8_t* a, const uint8_t* b);
+
+private:
+    PsSketchCell* cells;
+    unsigned width;
+};
+
+// shared by the packet threads and owned by the inspector
+struct PsSharedSketch
+{
+    PsSharedSketch(unsigned width) : sketch(width) { }
+
+    PsSketch sketch;
+    std::mutex mutex;
+};
+
+class PsSketchTracker
+{
+public:
+    enum Slot { SCANNED, SCANNER, MAX_SLOT };
+
+    PsSketchTracker(PsSharedSketch*);
+
+    PsSharedSketch* get_shared() const
+    { return shared; }
+
+    // returns a tracker filled with the current estimate for key; the
+    // portscan update and alert logic run on it as on a table entry
+    PS_TRACKER* get(Slot, uint64_t key, time_t now);
+
+    // folds the changes made to the trackers since get() into the sketch
+    void update(time_t now);
+
+    // adds local counts to the shared sketch and refreshes the snapshot
+    void merge(time_t now);
+
+    void clear();
+
+private:
+    struct View
+    {
+        PS_TRACKER tracker;
+        PS_PROTO before;
+        uint64_t key;
+        bool used;
+    };
+
+    void update(View&, time_t now);
+
+private:
+    PsSharedSketch* shared;
+    PsSketch local;
+    PsSketch snapshot;
+    std::vector<unsigned> dirty;
+    time_t next_merge = 0;
+    View views[MAX_SLOT];
+};
+
+#endif
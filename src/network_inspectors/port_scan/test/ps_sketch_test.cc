@@ -0,0 +1,160 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// ps_sketch_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+
+#include "catch/catch.hpp"
+
+#include "main/thread.h"
+#include "network_inspectors/port_scan/ps_pegs.h"
+#include "network_inspectors/port_scan/ps_sketch.h"
+
+using namespace snort;
+
+THREAD_LOCAL PsPegStats spstats;
+
+namespace snort
+{
+char* snort_strdup(const char* str) { return strdup(str); }
+}
+
+static SfIp make_ip(uint32_t n)
+{
+    SfIp ip;
+    uint32_t addr = htonl(0x0a000000 | n);
+    ip.set(&addr, AF_INET);
+    return ip;
+}
+
+// what ps_proto_update does for a connection attempt
+static void connect(PsSketchTracker& t, uint64_t key, uint32_t ip, uint16_t port,
+    time_t now, unsigned window = 60)
+{
+    PS_PROTO& proto = t.get(PsSketchTracker::SCANNER, key, now)->proto;
+
+    if ( now > proto.window )
+    {
+        memset((void*)&proto, 0, sizeof(proto));
+        proto.window = now + window;
+    }
+    proto.connection_count++;
+    proto.u_ips = make_ip(ip);
+    proto.u_ports = port;
+
+    t.update(now);
+}
+
+static PS_PROTO read(PsSketchTracker& t, uint64_t key, time_t now)
+{
+    PS_PROTO proto = t.get(PsSketchTracker::SCANNER, key, now)->proto;
+    t.update(now);
+    return proto;
+}
+
+#ifdef CATCH_TEST_BUILD
+
+TEST_CASE("hll small counts", "[port_scan]")
+{
+    uint8_t regs[PS_HLL_REGS] = { };
+    CHECK(PsSketch::hll_estimate(regs, nullptr) == 0);
+
+    for ( unsigned n = 1; n <= 100; ++n )
+    {
+        PsSketch::hll_add(regs, PsSketch::hash(&n, sizeof(n)));
+        PsSketch::hll_add(regs, PsSketch::hash(&n, sizeof(n)));
+
+        unsigned e = PsSketch::hll_estimate(regs, nullptr);
+        unsigned tolerance = 3 + n / 5;
+
+        CHECK(e + tolerance >= n);
+        CHECK(e <= n + tolerance);
+    }
+}
+
+TEST_CASE("sketch tracker", "[port_scan]")
+{
+    PsSharedSketch shared(PsSketch::get_width(1 << 20));
+    PsSketchTracker t1(&shared);
+    PsSketchTracker t2(&shared);
+
+    const uint64_t key = PsSketch::hash("scanner", 7);
+    time_t now = 1000;
+
+    SECTION("counts within a thread")
+    {
+        for ( uint16_t port = 1; port <= 20; ++port )
+            connect(t1, key, 1, port, now);
+
+        PS_PROTO p = read(t1, key, now);
+        CHECK(p.connection_count == 20);
+        CHECK(p.u_port_count >= 17);
+        CHECK(p.u_port_count <= 23);
+        CHECK(p.u_ip_count == 1);
+        CHECK(p.low_p == 1);
+        CHECK(p.high_p == 20);
+
+        CHECK(read(t1, key + 1, now).connection_count == 0);
+    }
+
+    SECTION("merged across threads")
+    {
+        for ( uint16_t port = 1; port <= 20; ++port )
+            connect((port & 1) ? t1 : t2, key, port, port, now);
+
+        CHECK(read(t1, key, now).connection_count == 10);
+
+        now += PS_SKETCH_MERGE;
+        t1.merge(now);
+        t2.merge(now);
+        t1.merge(now);
+
+        for ( auto* t : { &t1, &t2 } )
+        {
+            PS_PROTO p = read(*t, key, now);
+            CHECK(p.connection_count == 20);
+            CHECK(p.u_ip_count >= 17);
+            CHECK(p.u_ip_count <= 23);
+        }
+    }
+
+    SECTION("window rolls over")
+    {
+        for ( uint16_t port = 1; port <= 5; ++port )
+            connect(t1, key, 1, port, now);
+
+        now += PS_SKETCH_MERGE;
+        t1.merge(now);
+
+        now += 120;
+        connect(t1, key, 2, 80, now);
+
+        PS_PROTO p = read(t1, key, now);
+        CHECK(p.connection_count == 1);
+        CHECK(p.u_port_count == 1);
+
+        t1.merge(now);
+        CHECK(read(t1, key, now).connection_count == 1);
+    }
+}
+
+#endif // CATCH_TEST_BUILD
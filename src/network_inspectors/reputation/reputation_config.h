@@ -82,13 +82,19 @@ struct ReputationConfig
     uint32_t memcap = 500;
     int num_entries = 0;
     bool scanlocal = false;
+    bool poptrie = false;
     IPdecision priority = TRUSTED;
     NestedIP nested_ip = INNER;
     AllowAction allow_action = DO_NOT_BLOCK;
     std::string blocklist_path;
     std::string allowlist_path;
+    std::string table_file;
     bool memcap_reached = false;
+    bool segment_mapped = false;
     uint8_t* reputation_segment = nullptr;
+    size_t segment_size = 0;
+    size_t segment_used = 0;
+    uint32_t memory_usage = 0;
     table_flat_t* ip_list = nullptr;
     ListFiles list_files;
     std::string list_dir;
@@ -96,6 +102,24 @@ struct ReputationConfig
     ~ReputationConfig();
 };
 
+// A table segment replaced by a list update
+struct ReputationSegment
+{
+    uint8_t* base = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+
+    void release();
+};
+
+struct ReputationDelta
+{
+    unsigned added = 0;
+    unsigned removed = 0;
+    unsigned invalid = 0;
+    unsigned failed = 0;
+};
+
 struct IPrepInfo
 {
     char list_indexes[NUM_INDEX_PER_ENTRY];
@@ -36,6 +36,7 @@
 #include "pub_sub/auxiliary_ip_event.h"
 
 #include "reputation_parse.h"
+#include "reputation_table_file.h"
 
 using namespace snort;
 
@@ -73,10 +74,11 @@ const char* AllowActionOption[] =
 /*
  * Function prototype(s)
  */
-static void snort_reputation(ReputationConfig* GlobalConf, Packet* p);
+static void snort_reputation(ReputationConfig* GlobalConf, table_flat_t* ip_list, Packet* p);
 static void populate_trace_data(IPdecision& decision, Packet* p);
 
-static inline IPrepInfo* reputation_lookup(ReputationConfig* config, const SfIp* ip)
+static inline IPrepInfo* reputation_lookup(ReputationConfig* config, table_flat_t* ip_list,
+    const SfIp* ip)
 {
     IPrepInfo* result;
 
@@ -88,18 +90,21 @@ static inline IPrepInfo* reputation_lookup(ReputationConfig* config, const SfIp*
         }
     }
 
-    result = (IPrepInfo*)sfrt_flat_dir8x_lookup(ip, config->ip_list);
+    if (ip_list->poptrie)
+        result = (IPrepInfo*)sfrt_flat_poptrie_lookup(ip, ip_list);
+    else
+        result = (IPrepInfo*)sfrt_flat_dir8x_lookup(ip, ip_list);
 
     return (result);
 }
 
-static inline IPdecision get_reputation(ReputationConfig* config, IPrepInfo* rep_info,
-    uint32_t* listid, uint32_t ingress_intf, uint32_t egress_intf)
+static inline IPdecision get_reputation(ReputationConfig* config, table_flat_t* ip_list,
+    IPrepInfo* rep_info, uint32_t* listid, uint32_t ingress_intf, uint32_t egress_intf)
 {
     IPdecision decision = DECISION_NULL;
 
     /*Walk through the IPrepInfo lists*/
-    uint8_t* base = (uint8_t*)config->ip_list;
+    uint8_t* base = (uint8_t*)ip_list;
     ListFiles& list_info =  config->list_files;
 
     while (rep_info)
@@ -138,7 +143,7 @@ static inline IPdecision get_reputation(ReputationConfig* config, IPrepInfo* rep
     return decision;
 }
 
-static bool decision_per_layer(ReputationConfig* config, Packet* p,
+static bool decision_per_layer(ReputationConfig* config, table_flat_t* ip_list, Packet* p,
     uint32_t ingress_intf, uint32_t egress_intf, const ip::IpApi& ip_api, IPdecision* decision_final)
 {
     const SfIp* ip;
@@ -146,10 +151,11 @@ static bool decision_per_layer(ReputationConfig* config, Packet* p,
     IPrepInfo* result;
 
     ip = ip_api.get_src();
-    result = reputation_lookup(config, ip);
+    result = reputation_lookup(config, ip_list, ip);
     if (result)
     {
-        decision = get_reputation(config, result, &p->iplist_id, ingress_intf, egress_intf);
+        decision = get_reputation(config, ip_list, result, &p->iplist_id, ingress_intf,
+            egress_intf);
 
         if (decision == BLOCKED)
             *decision_final = BLOCKED_SRC;
@@ -165,10 +171,11 @@ static bool decision_per_layer(ReputationConfig* config, Packet* p,
     }
 
     ip = ip_api.get_dst();
-    result = reputation_lookup(config, ip);
+    result = reputation_lookup(config, ip_list, ip);
     if (result)
     {
-        decision = get_reputation(config, result, &p->iplist_id, ingress_intf, egress_intf);
+        decision = get_reputation(config, ip_list, result, &p->iplist_id, ingress_intf,
+            egress_intf);
 
         if (decision == BLOCKED)
             *decision_final = BLOCKED_DST;
@@ -186,7 +193,7 @@ static bool decision_per_layer(ReputationConfig* config, Packet* p,
     return false;
 }
 
-static IPdecision reputation_decision(ReputationConfig* config, Packet* p)
+static IPdecision reputation_decision(ReputationConfig* config, table_flat_t* ip_list, Packet* p)
 {
     IPdecision decision_final = DECISION_NULL;
     uint32_t ingress_intf = 0;
@@ -203,7 +210,8 @@ static IPdecision reputation_decision(ReputationConfig* config, Packet* p)
 
     if (config->nested_ip == INNER)
     {
-        decision_per_layer(config, p, ingress_intf, egress_intf, p->ptrs.ip_api, &decision_final);
+        decision_per_layer(config, ip_list, p, ingress_intf, egress_intf, p->ptrs.ip_api,
+            &decision_final);
         return decision_final;
     }
 
@@ -216,7 +224,8 @@ static IPdecision reputation_decision(ReputationConfig* config, Packet* p)
     if (config->nested_ip == OUTER)
     {
         layer::set_outer_ip_api(p, p->ptrs.ip_api, p->ip_proto_next, num_layer);
-        decision_per_layer(config, p, ingress_intf, egress_intf, p->ptrs.ip_api, &decision_final);
+        decision_per_layer(config, ip_list, p, ingress_intf, egress_intf, p->ptrs.ip_api,
+            &decision_final);
     }
     else if (config->nested_ip == ALL)
     {
@@ -225,8 +234,8 @@ static IPdecision reputation_decision(ReputationConfig* config, Packet* p)
 
         while (!done and layer::set_outer_ip_api(p, p->ptrs.ip_api, p->ip_proto_next, num_layer))
         {
-            done = decision_per_layer(config, p, ingress_intf, egress_intf, p->ptrs.ip_api,
-                &decision_current);
+            done = decision_per_layer(config, ip_list, p, ingress_intf, egress_intf,
+                p->ptrs.ip_api, &decision_current);
             if (decision_current != DECISION_NULL)
             {
                 if (decision_current == BLOCKED_SRC or decision_current == BLOCKED_DST)
@@ -248,11 +257,12 @@ static IPdecision reputation_decision(ReputationConfig* config, Packet* p)
     return decision_final;
 }
 
-static IPdecision snort_reputation_aux_ip(ReputationConfig* config, Packet* p, const SfIp* ip)
+static IPdecision snort_reputation_aux_ip(ReputationConfig* config, table_flat_t* ip_list,
+    Packet* p, const SfIp* ip)
 {
     IPdecision decision = DECISION_NULL;
 
-    if (!config->ip_list)
+    if (!ip_list)
         return decision;
 
     uint32_t ingress_intf = 0;
@@ -267,10 +277,10 @@ static IPdecision snort_reputation_aux_ip(ReputationConfig* config, Packet* p, c
             egress_intf = p->pkth->egress_index;
     }
 
-    IPrepInfo* result = reputation_lookup(config, ip);
+    IPrepInfo* result = reputation_lookup(config, ip_list, ip);
     if (result)
     {
-        decision = get_reputation(config, result, &p->iplist_id, ingress_intf,
+        decision = get_reputation(config, ip_list, result, &p->iplist_id, ingress_intf,
             egress_intf);
 
         if (decision == BLOCKED)
@@ -321,14 +331,14 @@ static IPdecision snort_reputation_aux_ip(ReputationConfig* config, Packet* p, c
     return decision;
 }
 
-static void snort_reputation(ReputationConfig* config, Packet* p)
+static void snort_reputation(ReputationConfig* config, table_flat_t* ip_list, Packet* p)
 {
     IPdecision decision;
 
-    if (!config->ip_list)
+    if (!ip_list)
         return;
 
-    decision = reputation_decision(config, p);
+    decision = reputation_decision(config, ip_list, p);
     Active* act = p->active;
 
     if (BLOCKED_SRC == decision or BLOCKED_DST == decision)
@@ -364,7 +374,7 @@ static void snort_reputation(ReputationConfig* config, Packet* p)
         const auto& aux_ip_list =  p->flow->stash->get_aux_ip_list();
         for ( const auto& ip : aux_ip_list )
         {
-            if ( BLOCKED == snort_reputation_aux_ip(config, p, &ip) )
+            if ( BLOCKED == snort_reputation_aux_ip(config, ip_list, p, &ip) )
                 return;
         }
     }
@@ -493,18 +503,18 @@ static void populate_trace_data(IPdecision& decision, Packet* p)
 class AuxiliaryIpRepHandler : public DataHandler
 {
 public:
-    AuxiliaryIpRepHandler(ReputationConfig& rc) : DataHandler(REPUTATION_NAME), conf(rc) { }
+    AuxiliaryIpRepHandler(Reputation& rep) : DataHandler(REPUTATION_NAME), inspector(rep) { }
     void handle(DataEvent&, Flow*) override;
 
 private:
-    ReputationConfig& conf;
+    Reputation& inspector;
 };
 
 void AuxiliaryIpRepHandler::handle(DataEvent& event, Flow*)
 {
     Profile profile(reputation_perf_stats);
-    snort_reputation_aux_ip(&conf, DetectionEngine::get_current_packet(),
-        static_cast<AuxiliaryIpEvent*>(&event)->get_ip());
+    snort_reputation_aux_ip(inspector.get_config(), inspector.get_ip_list(),
+        DetectionEngine::get_current_packet(), static_cast<AuxiliaryIpEvent*>(&event)->get_ip());
 }
 
 //-------------------------------------------------------------------------
@@ -519,6 +529,14 @@ Reputation::Reputation(ReputationConfig* pc)
         read_manifest(MANIFEST_FILENAME, conf);
 
     add_block_allow_List(conf);
+
+    if (map_table_file(conf))
+    {
+        reputationstats.memory_allocated = conf->memory_usage;
+        ip_list = conf->ip_list;
+        return;
+    }
+
     estimate_num_entries(conf);
     if (conf->num_entries <= 0)
     {
@@ -528,7 +546,21 @@ Reputation::Reputation(ReputationConfig* pc)
     }
 
     ip_list_init(conf->num_entries + 1, conf);
-    reputationstats.memory_allocated = sfrt_flat_usage(conf->ip_list);
+    conf->memory_usage = sfrt_flat_usage(conf->ip_list) + sfrt_flat_poptrie_usage(conf->ip_list);
+    reputationstats.memory_allocated = conf->memory_usage;
+    save_table_file(conf);
+    ip_list = conf->ip_list;
+}
+
+// runs on the main thread; the copy is published once it is complete
+bool Reputation::update_list(const char* list_name, const char* delta_file,
+    ReputationDelta& delta, ReputationSegment& retired)
+{
+    if (!update_ip_list(&config, list_name, delta_file, delta, retired))
+        return false;
+
+    ip_list.store(config.ip_list, std::memory_order_release);
+    return true;
 }
 
 void Reputation::show(const SnortConfig*) const
@@ -537,10 +569,12 @@ void Reputation::show(const SnortConfig*) const
     ConfigLogger::log_value("list_dir", config.list_dir.c_str());
     ConfigLogger::log_value("memcap", config.memcap);
     ConfigLogger::log_value("nested_ip", to_string(config.nested_ip));
+    ConfigLogger::log_flag("poptrie", config.poptrie);
     ConfigLogger::log_value("priority", to_string(config.priority));
     ConfigLogger::log_flag("scan_local", config.scanlocal);
     ConfigLogger::log_value("allow (action)", to_string(config.allow_action));
     ConfigLogger::log_value("allowlist", config.allowlist_path.c_str());
+    ConfigLogger::log_value("table_file", config.table_file.c_str());
 }
 
 void Reputation::eval(Packet* p)
@@ -556,13 +590,13 @@ void Reputation::eval(Packet* p)
     if (PacketTracer::is_daq_activated())
         PacketTracer::pt_timer_start();
 
-    snort_reputation(&config, p);
+    snort_reputation(&config, get_ip_list(), p);
     ++reputationstats.packets;
 }
 
 bool Reputation::configure(SnortConfig*)
 {
-    DataBus::subscribe_network( AUXILIARY_IP_EVENT, new AuxiliaryIpRepHandler(config) );
+    DataBus::subscribe_network( AUXILIARY_IP_EVENT, new AuxiliaryIpRepHandler(*this) );
     return true;
 }
 
@@ -19,6 +19,8 @@
 #ifndef REPUTATION_INSPECT_H
 #define REPUTATION_INSPECT_H
 
+#include <atomic>
+
 #include "flow/flow.h"
 
 #include "reputation_module.h"
@@ -32,8 +34,20 @@ public:
     void eval(snort::Packet*) override;
     bool configure(snort::SnortConfig*) override;
 
+    ReputationConfig* get_config()
+    { return &config; }
+
+    // packet threads take one snapshot per lookup; a retired table is freed
+    // only after every packet thread has passed a command boundary
+    table_flat_t* get_ip_list() const
+    { return ip_list.load(std::memory_order_acquire); }
+
+    bool update_list(const char* list_name, const char* delta_file, ReputationDelta&,
+        ReputationSegment& retired);
+
 private:
     ReputationConfig config;
+    std::atomic<table_flat_t*> ip_list { nullptr };
 };
 
 #endif
@@ -24,11 +24,19 @@
 
 #include "reputation_module.h"
 
+#include <algorithm>
 #include <cassert>
+#include <lua.hpp>
 
+#include "control/control.h"
 #include "log/messages.h"
+#include "main/analyzer_command.h"
+#include "main/policy.h"
+#include "main/snort_config.h"
+#include "managers/inspector_manager.h"
 #include "utils/util.h"
 
+#include "reputation_inspect.h"
 #include "reputation_parse.h"
 
 using namespace snort;
@@ -63,6 +71,9 @@ static const Parameter s_params[] =
     { "nested_ip", Parameter::PT_ENUM, "inner|outer|all", "inner",
       "IP to use when there is IP encapsulation" },
 
+    { "poptrie", Parameter::PT_BOOL, nullptr, "false",
+      "compile the IP lists into a poptrie for faster lookups at the cost of build time" },
+
     { "priority", Parameter::PT_ENUM, "blocklist|allowlist", "allowlist",
       "defines priority when there is a decision conflict during run-time" },
 
@@ -75,9 +86,118 @@ static const Parameter s_params[] =
     { "allowlist", Parameter::PT_STRING, nullptr, nullptr,
       "allowlist file name with IP lists" },
 
+    { "table_file", Parameter::PT_STRING, nullptr, nullptr,
+      "compiled IP table file shared read-only by all packet threads and processes" },
+
+    { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
+};
+
+// Releases the table replaced by an update once every packet thread has
+// executed the command and so can no longer hold a pointer into it
+class ReputationRetireTable : public AnalyzerCommand
+{
+public:
+    ReputationRetireTable(const ReputationSegment& seg, uint32_t usage) :
+        segment(seg), memory_usage(usage) { }
+    ~ReputationRetireTable() override
+    { segment.release(); }
+
+    bool execute(Analyzer&, void**) override
+    {
+        reputationstats.memory_allocated = memory_usage;
+        return true;
+    }
+    const char* stringify() override { return "REPUTATION_RETIRE_TABLE"; }
+
+private:
+    ReputationSegment segment;
+    uint32_t memory_usage;
+};
+
+// Each network policy may configure its own instance, each with its own table
+static vector<Reputation*> get_instances()
+{
+    const SnortConfig* sc = SnortConfig::get_conf();
+    NetworkPolicy* np = get_network_policy();
+    vector<Reputation*> reps;
+
+    for ( unsigned idx = 0; idx < sc->policy_map->network_policy_count(); ++idx )
+    {
+        set_network_policy(sc, idx);
+        Reputation* rep = (Reputation*)InspectorManager::get_inspector(REPUTATION_NAME);
+
+        if ( rep and find(reps.begin(), reps.end(), rep) == reps.end() )
+            reps.emplace_back(rep);
+    }
+    set_network_policy(np);
+
+    return reps;
+}
+
+static int update_list(lua_State* L)
+{
+    ControlConn* ctrlcon = ControlConn::query_from_lua(L);
+    const char* list_name = luaL_optstring(L, 1, nullptr);
+    const char* delta_file = luaL_optstring(L, 2, nullptr);
+
+    if (!list_name or !delta_file)
+    {
+        LogRespond(ctrlcon, "Usage: reputation.update(list, delta_file)\n");
+        return 0;
+    }
+
+    vector<Reputation*> reps = get_instances();
+
+    if (reps.empty())
+    {
+        LogRespond(ctrlcon, "reputation is not configured\n");
+        return 0;
+    }
+
+    // the delta goes to every instance that loaded the list
+    for (unsigned i = 0; i < reps.size(); ++i)
+    {
+        Reputation* rep = reps[i];
+        ReputationDelta delta;
+        ReputationSegment retired;
+
+        if (!rep->update_list(list_name, delta_file, delta, retired))
+        {
+            LogRespond(ctrlcon, "reputation %u/%zu: update of %s failed, table unchanged\n",
+                i + 1, reps.size(), list_name);
+            continue;
+        }
+
+        main_broadcast_command(new ReputationRetireTable(retired,
+            rep->get_config()->memory_usage), ctrlcon);
+
+        LogRespond(ctrlcon, "reputation %u/%zu: %s updated, added: %u, removed: %u, "
+            "invalid: %u, failed: %u\n", i + 1, reps.size(), list_name, delta.added,
+            delta.removed, delta.invalid, delta.failed);
+    }
+
+    return 0;
+}
+
+static const Parameter update_params[] =
+{
+    { "list", Parameter::PT_STRING, nullptr, nullptr,
+      "name of the list file to update" },
+
+    { "delta_file", Parameter::PT_STRING, nullptr, nullptr,
+      "file of addresses to add (+addr or addr) or remove (-addr)" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
+static const Command reputation_cmds[] =
+{
+    { "update", update_list, update_params,
+      "apply a delta to a loaded list without a reload" },
+
+    { nullptr, nullptr, nullptr, nullptr }
+};
+
 static const RuleMap reputation_rules[] =
 {
     { REPUTATION_EVENT_BLOCKLIST_SRC, REPUTATION_EVENT_BLOCKLIST_SRC_STR },
@@ -109,6 +229,9 @@ ReputationModule::~ReputationModule()
 const RuleMap* ReputationModule::get_rules() const
 { return reputation_rules; }
 
+const Command* ReputationModule::get_commands() const
+{ return reputation_cmds; }
+
 const PegInfo* ReputationModule::get_pegs() const
 { return reputation_peg_names; }
 
@@ -135,6 +258,9 @@ bool ReputationModule::set(const char*, Value& v, SnortConfig*)
     else if ( v.is("priority") )
         conf->priority = (IPdecision)(v.get_uint8() + 1);
 
+    else if ( v.is("poptrie") )
+        conf->poptrie = v.get_bool();
+
     else if ( v.is("scan_local") )
         conf->scanlocal = v.get_bool();
 
@@ -144,6 +270,9 @@ bool ReputationModule::set(const char*, Value& v, SnortConfig*)
     else if ( v.is("allowlist") )
         conf->allowlist_path = v.get_string();
 
+    else if ( v.is("table_file") )
+        conf->table_file = v.get_string();
+
     return true;
 }
 
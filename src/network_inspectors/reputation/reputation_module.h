@@ -50,6 +50,7 @@ public:
     { return GID_REPUTATION; }
 
     const snort::RuleMap* get_rules() const override;
+    const snort::Command* get_commands() const override;
     const PegInfo* get_pegs() const override;
     PegCount* get_counts() const override;
     snort::ProfileStats* get_profile() const override;
@@ -24,6 +24,7 @@
 #include "reputation_parse.h"
 
 #include <netinet/in.h>
+#include <sys/stat.h>
 
 #include <cassert>
 #include <climits>
@@ -36,6 +37,8 @@
 #include "utils/util.h"
 #include "utils/util_cstring.h"
 
+#include "reputation_table_file.h"
+
 using namespace snort;
 using namespace std;
 
@@ -77,11 +80,26 @@ unsigned long total_invalids;
 int totalNumEntries = 0;
 
 static void load_list_file(ListFile*, ReputationConfig* config);
+static int update_path_to_file(char* full_filename, unsigned int max_size, const char* filename);
+static int load_file(int total_lines, const char* path);
+
+void ReputationSegment::release()
+{
+    if (!base)
+        return;
+
+    if (mapped)
+        unmap_table_file(base, size);
+    else
+        snort_free(base);
+
+    base = nullptr;
+}
 
 ReputationConfig::~ReputationConfig()
 {
-    if (reputation_segment != nullptr)
-        snort_free(reputation_segment);
+    ReputationSegment segment = { reputation_segment, segment_size, segment_mapped };
+    segment.release();
 
     for (auto& file : list_files)
     {
@@ -114,6 +132,16 @@ static uint32_t estimate_size(uint32_t num_entries, uint32_t memcap)
     return (uint32_t)size;
 }
 
+static void build_poptrie(ReputationConfig* config, table_flat_t* ip_list)
+{
+    if (!config->poptrie)
+        return;
+
+    if (sfrt_flat_poptrie_build(ip_list) != RT_SUCCESS)
+        WarningMessage("reputation: memcap %u Mbytes reached when building the poptrie, "
+            "using the DIR-8x16 table for lookups\n", config->memcap);
+}
+
 void ip_list_init(uint32_t max_entries, ReputationConfig* config)
 {
     if ( !config->ip_list )
@@ -121,6 +149,7 @@ void ip_list_init(uint32_t max_entries, ReputationConfig* config)
         uint32_t mem_size;
         mem_size = estimate_size(max_entries, config->memcap);
         config->reputation_segment = (uint8_t*)snort_alloc(mem_size);
+        config->segment_size = mem_size;
 
         segment_meminit(config->reputation_segment, mem_size);
 
@@ -137,23 +166,31 @@ void ip_list_init(uint32_t max_entries, ReputationConfig* config)
         }
 
         total_duplicates = 0;
-        for (size_t i = 0; i < config->list_files.size(); i++)
-        {
-            config->list_files[i]->list_index = (uint8_t)i + 1;
-            if (config->list_files[i]->file_type == ALLOW_LIST)
-            {
-                if (config->allow_action == DO_NOT_BLOCK)
-                    config->list_files[i]->list_type = TRUSTED_DO_NOT_BLOCK;
-                else
-                    config->list_files[i]->list_type = TRUSTED;
-            }
-            else if (config->list_files[i]->file_type == BLOCK_LIST)
-                config->list_files[i]->list_type = BLOCKED;
-            else if (config->list_files[i]->file_type == MONITOR_LIST)
-                config->list_files[i]->list_type = MONITORED;
+        list_files_init(config);
+        for (auto& file : config->list_files)
+            load_list_file(file, config);
 
-            load_list_file(config->list_files[i], config);
+        build_poptrie(config, config->ip_list);
+        config->segment_used = mem_size - segment_unusedmem();
+    }
+}
+
+void list_files_init(ReputationConfig* config)
+{
+    for (size_t i = 0; i < config->list_files.size(); i++)
+    {
+        config->list_files[i]->list_index = (uint8_t)i + 1;
+        if (config->list_files[i]->file_type == ALLOW_LIST)
+        {
+            if (config->allow_action == DO_NOT_BLOCK)
+                config->list_files[i]->list_type = TRUSTED_DO_NOT_BLOCK;
+            else
+                config->list_files[i]->list_type = TRUSTED;
         }
+        else if (config->list_files[i]->file_type == BLOCK_LIST)
+            config->list_files[i]->list_type = BLOCKED;
+        else if (config->list_files[i]->file_type == MONITOR_LIST)
+            config->list_files[i]->list_type = MONITORED;
     }
 }
 
@@ -215,7 +252,8 @@ static inline int duplicate_info(IPrepInfo* dest_info,IPrepInfo* current_info,
     return bytes_allocated;
 }
 
-static int64_t update_entry_info(INFO* current, INFO new_entry, SaveDest save_dest, uint8_t* base)
+static int64_t update_entry_info(INFO* current, INFO new_entry, SaveDest save_dest, uint8_t* base,
+    void*)
 {
     IPrepInfo* current_info;
     IPrepInfo* new_info;
@@ -311,7 +349,7 @@ static int64_t update_entry_info(INFO* current, INFO new_entry, SaveDest save_de
     return bytes_allocated;
 }
 
-static int add_ip(SfCidr* ip_addr,INFO info_ptr, ReputationConfig* config)
+static int add_ip(SfCidr* ip_addr, INFO info_ptr, table_flat_t* ip_list, uint32_t memcap)
 {
     int ret;
     int final_ret = IP_INSERT_SUCCESS;
@@ -321,16 +359,16 @@ static int add_ip(SfCidr* ip_addr,INFO info_ptr, ReputationConfig* config)
     uint32_t usage_before;
     uint32_t usage_after;
 
-    usage_before =  sfrt_flat_usage(config->ip_list);
+    usage_before =  sfrt_flat_usage(ip_list);
 
     /*Check whether the same or more generic address is already in the table*/
-    if (nullptr != sfrt_flat_lookup(ip_addr->get_addr(), config->ip_list))
+    if (nullptr != sfrt_flat_lookup(ip_addr->get_addr(), ip_list))
     {
         final_ret = IP_INSERT_DUPLICATE;
     }
 
     ret = sfrt_flat_insert(ip_addr, (unsigned char)ip_addr->get_bits(), info_ptr, RT_FAVOR_ALL,
-        config->ip_list, &update_entry_info);
+        ip_list, &update_entry_info);
 
     if (RT_SUCCESS == ret)
     {
@@ -345,9 +383,9 @@ static int add_ip(SfCidr* ip_addr,INFO info_ptr, ReputationConfig* config)
         final_ret = IP_INSERT_FAILURE;
     }
 
-    usage_after = sfrt_flat_usage(config->ip_list);
+    usage_after = sfrt_flat_usage(ip_list);
     /*Compare in the same scale*/
-    if (usage_after  > (config->memcap << 20))
+    if (usage_after  > (memcap << 20))
     {
         final_ret = IP_MEM_ALLOC_FAILURE;
     }
@@ -509,7 +547,267 @@ static int process_line(char* line, INFO info, ReputationConfig* config)
     if ( snort_pton(line, &address) < 1 )
         return IP_INVALID;
 
-    return add_ip(&address, info, config);
+    return add_ip(&address, info, config->ip_list, config->memcap);
+}
+
+static bool has_index(IPrepInfo* rep_info, char index, uint8_t* base)
+{
+    while (rep_info)
+    {
+        for (int i = 0; i < NUM_INDEX_PER_ENTRY and rep_info->list_indexes[i]; i++)
+        {
+            if (rep_info->list_indexes[i] == index)
+                return true;
+        }
+        rep_info = rep_info->next ? (IPrepInfo*)&base[rep_info->next] : nullptr;
+    }
+
+    return false;
+}
+
+/* Drop the list index that context points to from the entry, keeping the
+ * order of the other lists. Every prefix owns its information (more specific
+ * prefixes get a copy of what they inherit), so this does not affect any
+ * address outside of the prefix being removed. */
+static int64_t remove_entry_info(INFO* current, INFO, SaveDest, uint8_t* base, void* context)
+{
+    if (!(*current))
+        return 0;
+
+    const char removed_index = *(const char*)context;
+
+    IPrepInfo* dest_info = (IPrepInfo*)&base[*current];
+    IPrepInfo* src_info = dest_info;
+    int dest = 0;
+
+    while (src_info)
+    {
+        for (int i = 0; i < NUM_INDEX_PER_ENTRY and src_info->list_indexes[i]; i++)
+        {
+            char index = src_info->list_indexes[i];
+
+            if (index == removed_index)
+                continue;
+
+            if (dest == NUM_INDEX_PER_ENTRY)
+            {
+                dest_info = (IPrepInfo*)&base[dest_info->next];
+                dest = 0;
+            }
+            dest_info->list_indexes[dest++] = index;
+        }
+        src_info = src_info->next ? (IPrepInfo*)&base[src_info->next] : nullptr;
+    }
+
+    while (dest < NUM_INDEX_PER_ENTRY)
+        dest_info->list_indexes[dest++] = 0;
+
+    dest_info->next = 0;
+    return 0;
+}
+
+static int64_t copy_entry_info(INFO* current, INFO src, const uint8_t* src_base, uint8_t* base)
+{
+    int64_t bytes_allocated = 0;
+
+    while (src)
+    {
+        MEM_OFFSET info_ptr = segment_snort_alloc(sizeof(IPrepInfo));
+
+        if (!info_ptr)
+            return -1;
+
+        const IPrepInfo* src_info = (const IPrepInfo*)&src_base[src];
+        IPrepInfo* info = (IPrepInfo*)&base[info_ptr];
+
+        *info = *src_info;
+        info->next = 0;
+        *current = info_ptr;
+
+        current = &info->next;
+        src = src_info->next;
+        bytes_allocated += sizeof(IPrepInfo);
+    }
+
+    return bytes_allocated;
+}
+
+static int remove_ip(SfCidr* ip_addr, INFO info_ptr, table_flat_t* ip_list)
+{
+    uint8_t* base = (uint8_t*)ip_list;
+    unsigned char len = (unsigned char)ip_addr->get_bits();
+    IPrepInfo* rep_info = (IPrepInfo*)sfrt_flat_exact_lookup(ip_addr, len, ip_list);
+
+    char removed_index = ((IPrepInfo*)&base[info_ptr])->list_indexes[0];
+
+    if (!rep_info or !has_index(rep_info, removed_index, base))
+        return IP_INVALID;
+
+    if (RT_SUCCESS != sfrt_flat_insert(ip_addr, len, info_ptr, RT_FAVOR_ALL, ip_list,
+        &remove_entry_info, &removed_index))
+        return IP_INSERT_FAILURE;
+
+    return IP_INSERT_SUCCESS;
+}
+
+static ListFile* find_list_file(ReputationConfig* config, const char* list_name)
+{
+    for (auto& file : config->list_files)
+    {
+        if (file->file_name == list_name)
+            return file;
+
+        size_t pos = file->file_name.find_last_of('/');
+
+        if (pos != std::string::npos and !strcmp(file->file_name.c_str() + pos + 1, list_name))
+            return file;
+    }
+
+    return nullptr;
+}
+
+// Builds in a private segment and puts the allocator back as it was on every
+// exit, so a failed update doesn't leave it pointing at the freed segment.
+class SegmentBuild
+{
+public:
+    SegmentBuild(uint8_t* segment, size_t size) : saved(segment_memsave())
+    { segment_meminit(segment, size); }
+
+    ~SegmentBuild()
+    { segment_memrestore(saved); }
+
+private:
+    SegmentMemState saved;
+};
+
+bool update_ip_list(ReputationConfig* config, const char* list_name, const char* delta_file,
+    ReputationDelta& delta, ReputationSegment& retired)
+{
+    char linebuf[MAX_ADDR_LINE_LENGTH];
+    char full_path_filename[PATH_MAX+1];
+
+    if (!config->ip_list)
+    {
+        ErrorMessage("reputation: no IP list to update\n");
+        return false;
+    }
+
+    ListFile* list_info = find_list_file(config, list_name);
+
+    if (!list_info)
+    {
+        ErrorMessage("reputation: unknown list %s\n", list_name);
+        return false;
+    }
+
+    update_path_to_file(full_path_filename, PATH_MAX, delta_file);
+
+    int num_lines = load_file(0, delta_file);
+    FILE* fp = fopen(full_path_filename, "r");
+
+    if (!fp)
+    {
+        ErrorMessage("reputation: unable to open delta file %s, Error: %s\n",
+            full_path_filename, get_error(errno));
+        return false;
+    }
+
+    /* Copy what the live table still uses into a private segment with room
+     * for the delta.  The sub tables and entries replaced by earlier updates
+     * and the old poptrie are left behind, so the used part of the live
+     * segment bounds the copy and the new poptrie. */
+    uint64_t size = (uint64_t)config->segment_used + ((uint64_t)num_lines + 1) * sizeof(INFO) +
+        estimate_size(num_lines, config->memcap);
+
+    if (size > std::numeric_limits<uint32_t>::max())
+        size = std::numeric_limits<uint32_t>::max();
+
+    uint8_t* segment = (uint8_t*)snort_alloc(size);
+    SegmentBuild build(segment, size);
+
+    table_flat_t* ip_list = sfrt_flat_copy(config->ip_list, config->ip_list->num_ent + num_lines,
+        &copy_entry_info);
+
+    MEM_OFFSET ip_info_ptr = ip_list ? segment_snort_calloc(1, sizeof(IPrepInfo)) : 0;
+
+    if (!ip_info_ptr)
+    {
+        ErrorMessage("reputation: memcap %u Mbytes reached when updating %s\n",
+            config->memcap, list_name);
+        fclose(fp);
+        snort_free(segment);
+        return false;
+    }
+
+    ((IPrepInfo*)&segment[ip_info_ptr])->list_indexes[0] = list_info->list_index;
+
+    while ( fgets(linebuf, MAX_ADDR_LINE_LENGTH, fp) )
+    {
+        char* cmt;
+        char* line = linebuf;
+        bool remove = false;
+        SfCidr address;
+
+        if ( (cmt = strchr(line, '#')) )
+            *cmt = '\0';
+
+        if ( (cmt = strchr(line, '\n')) )
+            *cmt = '\0';
+
+        while ( isspace((int)*line) )
+            line++;
+
+        if ( *line == '-' or *line == '+' )
+            remove = (*line++ == '-');
+
+        if ( *line == '\0' )
+            continue;
+
+        if ( snort_pton(line, &address) < 1 )
+        {
+            delta.invalid++;
+            continue;
+        }
+
+        int ret = remove ? remove_ip(&address, ip_info_ptr, ip_list) :
+            add_ip(&address, ip_info_ptr, ip_list, config->memcap);
+
+        if ( ret == IP_INSERT_SUCCESS or ret == IP_INSERT_DUPLICATE )
+        {
+            if ( remove )
+                delta.removed++;
+            else
+                delta.added++;
+        }
+        else if ( ret == IP_INVALID )
+            delta.invalid++;
+
+        else if ( ret == IP_MEM_ALLOC_FAILURE )
+        {
+            ErrorMessage("reputation: memcap %u Mbytes reached when updating %s\n",
+                config->memcap, list_name);
+            fclose(fp);
+            snort_free(segment);
+            return false;
+        }
+        else
+            delta.failed++;
+    }
+
+    fclose(fp);
+    build_poptrie(config, ip_list);
+
+    retired = { config->reputation_segment, config->segment_size, config->segment_mapped };
+
+    config->reputation_segment = segment;
+    config->segment_size = size;
+    config->segment_used = size - segment_unusedmem();
+    config->segment_mapped = false;
+    config->ip_list = ip_list;
+    config->memory_usage = sfrt_flat_usage(ip_list) + sfrt_flat_poptrie_usage(ip_list);
+
+    return true;
 }
 
 static int update_path_to_file(char* full_filename, unsigned int max_size, const char* filename)
@@ -735,6 +1033,47 @@ static int load_file(int total_lines, const char* path)
     return num_lines;
 }
 
+static void hash_bytes(uint64_t& hash, const void* data, size_t len)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+
+    // FNV-1a
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+}
+
+uint64_t get_list_files_signature(const ReputationConfig* config)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    char full_path_filename[PATH_MAX+1];
+
+    hash_bytes(hash, &config->memcap, sizeof(config->memcap));
+    hash_bytes(hash, &config->poptrie, sizeof(config->poptrie));
+
+    for (auto& file : config->list_files)
+    {
+        struct stat st;
+
+        update_path_to_file(full_path_filename, PATH_MAX, file->file_name.c_str());
+        if (stat(full_path_filename, &st))
+            memset(&st, 0, sizeof(st));
+
+        uint64_t file_info[] =
+        {
+            (uint64_t)file->file_type, (uint64_t)st.st_ino, (uint64_t)st.st_size,
+            (uint64_t)st.st_mtim.tv_sec, (uint64_t)st.st_mtim.tv_nsec
+        };
+
+        hash_bytes(hash, full_path_filename, strlen(full_path_filename) + 1);
+        hash_bytes(hash, file_info, sizeof(file_info));
+    }
+
+    return hash;
+}
+
 void estimate_num_entries(ReputationConfig* config)
 {
     int total_lines = 0;
@@ -25,6 +25,10 @@
 #define MANIFEST_FILENAME "interface.info"
 
 void ip_list_init(uint32_t,ReputationConfig *config);
+void list_files_init(ReputationConfig* config);
+uint64_t get_list_files_signature(const ReputationConfig* config);
+bool update_ip_list(ReputationConfig* config, const char* list_name, const char* delta_file,
+    ReputationDelta& delta, ReputationSegment& retired);
 void estimate_num_entries(ReputationConfig* config);
 int read_manifest(const char* filename, ReputationConfig* config);
 void add_block_allow_List(ReputationConfig* config);
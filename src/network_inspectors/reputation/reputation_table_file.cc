@@ -0,0 +1,242 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// reputation_table_file.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "reputation_table_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include "log/messages.h"
+#include "sfrt/sfrt_flat.h"
+#include "utils/segment_mem.h"
+#include "utils/util.h"
+
+#include "reputation_config.h"
+#include "reputation_parse.h"
+
+using namespace snort;
+
+#define TABLE_FILE_MAGIC 0x52455054u   // "REPT"
+#define TABLE_FILE_VERSION 1u
+
+// the header is padded so the table keeps the alignment it was built with
+struct TableFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t layout;
+    uint32_t usage;
+    uint64_t signature;
+    uint64_t table_size;
+    uint8_t pad[32];
+};
+
+static_assert(sizeof(TableFileHeader) == 64, "table file header must stay 64 bytes");
+
+// anything that changes the in-memory layout invalidates saved tables
+static uint32_t get_layout()
+{
+    return (uint32_t)(sizeof(table_flat_t) << 16) ^ (uint32_t)(sizeof(IPrepInfo) << 8) ^
+        (uint32_t)sizeof(MEM_OFFSET);
+}
+
+// the packet threads follow the info chains of the table without checks;
+// every entry has its own chain, so they can't hold more links than fit
+static bool check_entries(const table_flat_t* table, size_t size, size_t num_lists)
+{
+    const uint8_t* base = (const uint8_t*)table;
+    const INFO* data = (const INFO*)&base[table->data];
+    size_t links = size / sizeof(IPrepInfo);
+
+    for (uint32_t i = 0; i < table->num_ent; i++)
+    {
+        for (MEM_OFFSET ptr = data[i]; ptr; )
+        {
+            if (!links-- or !segment_contains(ptr, sizeof(IPrepInfo), size))
+                return false;
+
+            const IPrepInfo* info = (const IPrepInfo*)&base[ptr];
+
+            for (int j = 0; j < NUM_INDEX_PER_ENTRY; j++)
+            {
+                int list_index = info->list_indexes[j];
+
+                if (list_index < 0 or (size_t)list_index > num_lists)
+                    return false;
+            }
+            ptr = info->next;
+        }
+    }
+
+    return true;
+}
+
+bool map_table_file(ReputationConfig* config)
+{
+    if ( config->table_file.empty() )
+        return false;
+
+    int fd = open(config->table_file.c_str(), O_RDONLY);
+
+    if ( fd < 0 )
+        return false;
+
+    struct stat st;
+
+    if ( fstat(fd, &st) or (size_t)st.st_size <= sizeof(TableFileHeader) )
+    {
+        close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if ( map == MAP_FAILED )
+    {
+        WarningMessage("reputation: can't map %s: %s\n", config->table_file.c_str(),
+            get_error(errno));
+        return false;
+    }
+
+    const TableFileHeader* hdr = (const TableFileHeader*)map;
+
+    if ( hdr->magic != TABLE_FILE_MAGIC or hdr->version != TABLE_FILE_VERSION or
+        hdr->layout != get_layout() or hdr->table_size != size - sizeof(TableFileHeader) or
+        hdr->signature != get_list_files_signature(config) )
+    {
+        munmap(map, size);
+        return false;
+    }
+
+    // a truncated or corrupt table would crash every packet thread using it
+    const table_flat_t* table = (const table_flat_t*)((uint8_t*)map + sizeof(TableFileHeader));
+
+    if ( !sfrt_flat_check(table, hdr->table_size) or
+        !check_entries(table, hdr->table_size, config->list_files.size()) )
+    {
+        WarningMessage("reputation: %s is corrupt, rebuilding the table\n",
+            config->table_file.c_str());
+        munmap(map, size);
+        return false;
+    }
+
+    config->reputation_segment = (uint8_t*)map;
+    config->segment_size = size;
+    config->segment_mapped = true;
+    config->ip_list = (table_flat_t*)table;
+    config->segment_used = hdr->table_size;
+    config->memory_usage = hdr->usage;
+    list_files_init(config);
+
+    LogMessage("reputation: mapped %s\n", config->table_file.c_str());
+    return true;
+}
+
+// the table is written to a private name and renamed over the old one so
+// processes mapping the previous table keep it until they are reloaded
+bool save_table_file(ReputationConfig* config)
+{
+    if ( config->table_file.empty() or !config->ip_list or config->segment_mapped )
+        return false;
+
+    TableFileHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+
+    hdr.magic = TABLE_FILE_MAGIC;
+    hdr.version = TABLE_FILE_VERSION;
+    hdr.layout = get_layout();
+    hdr.usage = config->memory_usage;
+    hdr.signature = get_list_files_signature(config);
+    hdr.table_size = config->segment_used;
+
+    std::string tmp = config->table_file + ".tmp." + std::to_string(getpid());
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if ( fd < 0 )
+    {
+        WarningMessage("reputation: can't create %s: %s\n", tmp.c_str(), get_error(errno));
+        return false;
+    }
+
+    bool ok = write(fd, &hdr, sizeof(hdr)) == (ssize_t)sizeof(hdr);
+    const uint8_t* data = config->reputation_segment;
+    size_t left = hdr.table_size;
+
+    while ( ok and left )
+    {
+        ssize_t n = write(fd, data, left);
+
+        if ( n <= 0 )
+        {
+            if ( n < 0 and errno == EINTR )
+                continue;
+            ok = false;
+            break;
+        }
+        data += n;
+        left -= n;
+    }
+
+    ok = ok and !fsync(fd);
+    ok = !close(fd) and ok;
+
+    if ( !ok or rename(tmp.c_str(), config->table_file.c_str()) )
+    {
+        WarningMessage("reputation: can't save %s: %s\n", config->table_file.c_str(),
+            get_error(errno));
+        unlink(tmp.c_str());
+        return false;
+    }
+
+    // switch to the shared copy so the heap table can be released
+    uint8_t* segment = config->reputation_segment;
+    size_t size = config->segment_size;
+    table_flat_t* ip_list = config->ip_list;
+
+    config->reputation_segment = nullptr;
+    config->ip_list = nullptr;
+
+    if ( !map_table_file(config) )
+    {
+        config->reputation_segment = segment;
+        config->segment_size = size;
+        config->ip_list = ip_list;
+        return true;
+    }
+
+    snort_free(segment);
+    return true;
+}
+
+void unmap_table_file(uint8_t* segment, size_t size)
+{
+    munmap(segment, size);
+}
@@ -0,0 +1,36 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// reputation_table_file.h
+
+#ifndef REPUTATION_TABLE_FILE_H
+#define REPUTATION_TABLE_FILE_H
+
+// The compiled IP table is position independent (all links are segment
+// offsets), so it can be saved once and mapped read-only by every packet
+// thread and every snort process sharing the same lists.
+
+#include <cstddef>
+#include <cstdint>
+
+struct ReputationConfig;
+
+bool map_table_file(ReputationConfig*);
+bool save_table_file(ReputationConfig*);
+void unmap_table_file(uint8_t* segment, size_t size);
+
+#endif
@@ -0,0 +1,359 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// reputation_parse_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "catch/catch.hpp"
+
+#include "network_inspectors/reputation/reputation_common.h"
+#include "network_inspectors/reputation/reputation_config.h"
+#include "network_inspectors/reputation/reputation_parse.h"
+#include "network_inspectors/reputation/reputation_table_file.h"
+#include "sfip/sf_ip.h"
+#include "utils/segment_mem.h"
+
+using namespace snort;
+
+const char* get_snort_conf_dir() { return "/"; }
+
+namespace snort
+{
+void ErrorMessage(const char*, ...) { }
+void LogMessage(const char*, ...) { }
+void WarningMessage(const char*, ...) { }
+const char* get_error(int) { return ""; }
+char* snort_strdup(const char* str) { return strdup(str); }
+}
+
+#ifdef CATCH_TEST_BUILD
+
+static std::string make_dir()
+{
+    char dir[] = "/tmp/reputation_test_XXXXXX";
+    REQUIRE(mkdtemp(dir));
+    return dir;
+}
+
+static std::string write_file(const std::string& dir, const char* name, const char* text)
+{
+    std::string path = dir + "/" + name;
+    FILE* fp = fopen(path.c_str(), "w");
+    REQUIRE(fp);
+    fputs(text, fp);
+    fclose(fp);
+    return path;
+}
+
+static void load(ReputationConfig& conf, const std::string& dir, const char* block,
+    const char* allow)
+{
+    conf.blocklist_path = write_file(dir, "block.list", block);
+    conf.allowlist_path = write_file(dir, "allow.list", allow);
+    add_block_allow_List(&conf);
+    estimate_num_entries(&conf);
+    ip_list_init(conf.num_entries + 1, &conf);
+    REQUIRE(conf.ip_list);
+}
+
+// the first list of the address, 1 for the blocklist and 2 for the allowlist
+static int list_of(ReputationConfig& conf, const char* addr)
+{
+    SfIp ip;
+    REQUIRE(ip.set(addr) == SFIP_SUCCESS);
+
+    // the lookups of the inspector, they don't depend on the segment allocator
+    IPrepInfo* info = (IPrepInfo*)sfrt_flat_dir8x_lookup(&ip, conf.ip_list);
+
+    if (conf.ip_list->poptrie)
+        CHECK((IPrepInfo*)sfrt_flat_poptrie_lookup(&ip, conf.ip_list) == info);
+
+    return info ? info->list_indexes[0] : 0;
+}
+
+static bool update(ReputationConfig& conf, const std::string& dir, const char* list,
+    const char* text, ReputationDelta& delta)
+{
+    std::string delta_file = write_file(dir, "delta", text);
+    ReputationSegment retired;
+
+    if (!update_ip_list(&conf, list, delta_file.c_str(), delta, retired))
+        return false;
+
+    retired.release();
+    return true;
+}
+
+static void cleanup(const std::string& dir)
+{
+    for (const char* name : { "block.list", "allow.list", "delta", "table" })
+        unlink((dir + "/" + name).c_str());
+    rmdir(dir.c_str());
+}
+
+TEST_CASE("reputation delta adds and removes addresses", "[reputation]")
+{
+    std::string dir = make_dir();
+    ReputationConfig conf;
+    load(conf, dir, "10.0.0.1\n10.1.0.0/16\n", "192.168.0.1\n");
+
+    CHECK(list_of(conf, "10.0.0.1") == 1);
+    CHECK(list_of(conf, "10.0.0.2") == 0);
+
+    ReputationDelta delta;
+    REQUIRE(update(conf, dir, "block.list",
+        "+10.0.0.2\n10.0.0.3\n-10.0.0.1\n-10.9.9.9\nbogus\n# comment\n", delta));
+
+    CHECK(delta.added == 2);
+    CHECK(delta.removed == 1);
+    CHECK(delta.invalid == 2);
+    CHECK(delta.failed == 0);
+
+    CHECK(list_of(conf, "10.0.0.1") == 0);
+    CHECK(list_of(conf, "10.0.0.2") == 1);
+    CHECK(list_of(conf, "10.0.0.3") == 1);
+    CHECK(list_of(conf, "10.1.2.3") == 1);
+    CHECK(list_of(conf, "192.168.0.1") == 2);
+
+    // the other list
+    delta = { };
+    REQUIRE(update(conf, dir, "allow.list", "10.2.0.0/16\n-192.168.0.1\n", delta));
+
+    CHECK(delta.added == 1);
+    CHECK(delta.removed == 1);
+    CHECK(list_of(conf, "10.2.3.4") == 2);
+    CHECK(list_of(conf, "192.168.0.1") == 0);
+    CHECK(list_of(conf, "10.0.0.2") == 1);
+
+    // nothing changes for an unknown list
+    table_flat_t* ip_list = conf.ip_list;
+    CHECK(!update(conf, dir, "other.list", "10.3.0.1\n", delta));
+    CHECK(conf.ip_list == ip_list);
+
+    cleanup(dir);
+}
+
+TEST_CASE("reputation delta with poptrie", "[reputation]")
+{
+    std::string dir = make_dir();
+    ReputationConfig conf;
+    conf.poptrie = true;
+
+    // enough lines for the segment to hold the poptrie's direct arrays
+    std::string block = "10.0.0.0/8\n2001:db8::/32\n";
+
+    for (int i = 0; i < 250; i++)
+        block += "172.16.0." + std::to_string(i) + "\n";
+
+    load(conf, dir, block.c_str(), "10.1.1.1\n");
+
+    REQUIRE(conf.ip_list->poptrie);
+    CHECK(list_of(conf, "10.1.1.1") == 1);
+
+    ReputationDelta delta;
+    REQUIRE(update(conf, dir, "block.list", "-10.0.0.0/8\n2001:db8:1::1\n", delta));
+    CHECK(delta.added == 1);
+    CHECK(delta.removed == 1);
+
+    REQUIRE(conf.ip_list->poptrie);
+    CHECK(list_of(conf, "10.2.2.2") == 0);
+    CHECK(list_of(conf, "10.1.1.1") == 2);
+    CHECK(list_of(conf, "2001:db8:1::1") == 1);
+    CHECK(list_of(conf, "2001:db8:2::1") == 1);
+
+    cleanup(dir);
+}
+
+TEST_CASE("reputation deltas don't grow the table", "[reputation]")
+{
+    std::string dir = make_dir();
+    ReputationConfig conf;
+    load(conf, dir, "10.0.0.1\n10.1.0.0/16\n", "192.168.0.1\n");
+
+    ReputationDelta delta;
+    REQUIRE(update(conf, dir, "block.list", "10.5.5.5\n", delta));
+    REQUIRE(update(conf, dir, "block.list", "-10.5.5.5\n", delta));
+
+    size_t used = conf.segment_used;
+    uint32_t entries = sfrt_flat_num_entries(conf.ip_list);
+
+    for (int i = 0; i < 50; i++)
+    {
+        REQUIRE(update(conf, dir, "block.list", "10.5.5.5\n", delta));
+        REQUIRE(update(conf, dir, "block.list", "-10.5.5.5\n", delta));
+    }
+
+    CHECK(delta.added == 51);
+    CHECK(delta.removed == 51);
+    CHECK(conf.segment_used == used);
+    CHECK(sfrt_flat_num_entries(conf.ip_list) == entries);
+    CHECK(list_of(conf, "10.5.5.5") == 0);
+    CHECK(list_of(conf, "10.1.5.5") == 1);
+
+    cleanup(dir);
+}
+
+TEST_CASE("failed reputation delta keeps the segment allocator", "[reputation]")
+{
+    std::string dir = make_dir();
+    ReputationConfig conf;
+    load(conf, dir, "10.0.0.1\n", "192.168.0.1\n");
+
+    uint8_t other[64];
+    segment_meminit(other, sizeof(other));
+    REQUIRE(segment_snort_alloc(8) == 0);
+
+    // no room for any address
+    conf.memcap = 0;
+    table_flat_t* ip_list = conf.ip_list;
+    ReputationDelta delta;
+    CHECK(!update(conf, dir, "block.list", "10.0.0.2\n", delta));
+
+    CHECK(conf.ip_list == ip_list);
+    CHECK(list_of(conf, "10.0.0.1") == 1);
+    CHECK(list_of(conf, "10.0.0.2") == 0);
+
+    CHECK(segment_basePtr() == other);
+    CHECK(segment_unusedmem() == sizeof(other) - 8);
+    CHECK(segment_snort_alloc(8) == 8);
+
+    cleanup(dir);
+}
+
+TEST_CASE("reputation table file round trip", "[reputation]")
+{
+    std::string dir = make_dir();
+    ReputationConfig conf;
+    conf.table_file = dir + "/table";
+    load(conf, dir, "10.0.0.1\n10.1.0.0/16\n", "192.168.0.1\n");
+
+    // the heap table is released once the saved one is mapped
+    REQUIRE(save_table_file(&conf));
+    REQUIRE(conf.segment_mapped);
+    CHECK(list_of(conf, "10.0.0.1") == 1);
+    CHECK(list_of(conf, "10.1.2.3") == 1);
+    CHECK(list_of(conf, "192.168.0.1") == 2);
+    CHECK(list_of(conf, "10.0.0.2") == 0);
+
+    // a mapped table is updated into a new heap table
+    ReputationDelta delta;
+    REQUIRE(update(conf, dir, "block.list", "10.0.0.2\n", delta));
+    CHECK(!conf.segment_mapped);
+    CHECK(list_of(conf, "10.0.0.2") == 1);
+    CHECK(list_of(conf, "10.1.2.3") == 1);
+
+    // another config of the same lists maps the saved table
+    ReputationConfig other;
+    other.table_file = conf.table_file;
+    other.blocklist_path = conf.blocklist_path;
+    other.allowlist_path = conf.allowlist_path;
+    add_block_allow_List(&other);
+
+    REQUIRE(map_table_file(&other));
+    CHECK(list_of(other, "10.0.0.1") == 1);
+    CHECK(list_of(other, "192.168.0.1") == 2);
+    CHECK(list_of(other, "10.0.0.2") == 0);
+
+    cleanup(dir);
+}
+
+// overwrite "size" bytes at "offset" of the table saved after the 64 bytes header
+static void patch_table(const std::string& file, size_t offset, const void* data, size_t size)
+{
+    FILE* fp = fopen(file.c_str(), "r+");
+    REQUIRE(fp);
+    REQUIRE(!fseek(fp, 64 + offset, SEEK_SET));
+    REQUIRE(fwrite(data, size, 1, fp) == 1);
+    fclose(fp);
+}
+
+TEST_CASE("corrupt reputation table file", "[reputation]")
+{
+    std::string dir = make_dir();
+    ReputationConfig conf;
+    conf.table_file = dir + "/table";
+    conf.poptrie = true;
+
+    // enough lines for the segment to hold the poptrie's direct arrays
+    std::string block = "10.0.0.1\n10.1.0.0/16\n2001:db8::/32\n";
+
+    for (int i = 0; i < 250; i++)
+        block += "172.16.0." + std::to_string(i) + "\n";
+
+    load(conf, dir, block.c_str(), "192.168.0.1\n");
+    REQUIRE(save_table_file(&conf));
+    REQUIRE(conf.segment_mapped);
+
+    // a copy of what is saved, the mapped table stays as it is
+    table_flat_t table = *conf.ip_list;
+    REQUIRE(table.poptrie);
+
+    const uint8_t* base = (const uint8_t*)conf.ip_list;
+    MEM_OFFSET info = ((const INFO*)&base[table.data])[1];
+    REQUIRE(info);
+
+    MEM_OFFSET bad_offset = conf.segment_used;
+    char bad_index = 3;
+
+    SECTION("table")
+    {
+        patch_table(conf.table_file, offsetof(table_flat_t, rt), &bad_offset, sizeof(bad_offset));
+    }
+    SECTION("data")
+    {
+        patch_table(conf.table_file, offsetof(table_flat_t, data), &bad_offset,
+            sizeof(bad_offset));
+    }
+    SECTION("poptrie")
+    {
+        patch_table(conf.table_file, offsetof(table_flat_t, poptrie), &bad_offset,
+            sizeof(bad_offset));
+    }
+    SECTION("list index")
+    {
+        patch_table(conf.table_file, info, &bad_index, sizeof(bad_index));
+    }
+    SECTION("info chain")
+    {
+        patch_table(conf.table_file, info + offsetof(IPrepInfo, next), &bad_offset,
+            sizeof(bad_offset));
+    }
+
+    ReputationConfig other;
+    other.table_file = conf.table_file;
+    other.poptrie = conf.poptrie;
+    other.blocklist_path = conf.blocklist_path;
+    other.allowlist_path = conf.allowlist_path;
+    add_block_allow_List(&other);
+
+    CHECK(!map_table_file(&other));
+
+    cleanup(dir);
+}
+
+#endif
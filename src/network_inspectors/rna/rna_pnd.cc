@@ -35,6 +35,7 @@
 #include "protocols/icmp4.h"
 #include "protocols/icmp6.h"
 #include "protocols/protocol_ids.h"
+#include "time/packet_time.h"
 
 #include "rna_app_discovery.h"
 #include "rna_cpe_os.h"
@@ -515,7 +516,7 @@ void RnaPnd::generate_change_host_update()
 
     auto hosts = host_cache.get_all_data();
     auto mac_hosts = local_mac_cache_ptr->get_all_data();
-    auto sec = time(nullptr);
+    auto sec = packet_thread_time();
 
     for ( auto & h : hosts )
         generate_change_host_update(&h.second, nullptr, &h.first, nullptr, sec);
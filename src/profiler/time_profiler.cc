@@ -31,6 +31,8 @@
 #include "time_profiler_defs.h"
 
 #ifdef UNIT_TEST
+#include <limits>
+
 #include "catch/snort_catch.h"
 #endif
 
@@ -593,14 +595,15 @@ TEST_CASE( "time profiler time context", "[profiler][time_profiler]" )
 TEST_CASE( "time context exclude", "[profiler][time_profiler]" )
 {
     // NOTE: this test *may* fail if the time it takes to execute the exclude context is 0_ticks (unlikely)
-    TimeProfilerStats stats = { hr_duration::max(), 0 };
+    const hr_duration max_ticks(std::numeric_limits<SnortClock::rep>::max());
+    TimeProfilerStats stats = { max_ticks, 0 };
 
     {
         TimeExclude exclude(stats);
         avoid_optimization();
     }
 
-    CHECK( stats.elapsed < hr_duration::max() );
+    CHECK( stats.elapsed < max_ticks );
 }
 
 #endif
@@ -24,7 +24,7 @@
 #include "http2_hpack_string_decode.h"
 
 #include "http2_enum.h"
-#include "http2_huffman_state_machine.h"
+#include "http2_huffman_table.h"
 
 #include <cmath>
 
@@ -32,10 +32,6 @@ using namespace Http2Enums;
 
 static const uint8_t HUFFMAN_FLAG = 0x80;
 
-// Minimum bit length for each lookup table
-static const uint8_t min_decode_len[HUFFMAN_LOOKUP_MAX + 1] =
-    {5, 2, 2, 3, 5, 1, 1, 2, 2, 2, 2, 3, 3, 3, 4};
-
 bool Http2HpackStringDecode::translate(const uint8_t* in_buff, const uint32_t in_len,
     uint32_t& bytes_consumed, uint8_t* out_buff, const uint32_t out_len, uint32_t& bytes_written,
     Http2EventGen* const events, Http2Infractions* const infractions, bool partial_header) const
@@ -96,63 +92,11 @@ bool Http2HpackStringDecode::get_string(const uint8_t* in_buff, const uint32_t e
     return true;
 }
 
-// return is tail/padding
-bool Http2HpackStringDecode::get_next_byte(const uint8_t* in_buff, const uint32_t last_byte,
-    uint32_t& bytes_consumed, uint8_t& cur_bit, uint8_t match_len, uint8_t& byte,
-    bool& another_search) const
-{
-    another_search = true;
-    cur_bit += match_len;
-
-    if (cur_bit >= 8) // done with current bit
-    {
-        bytes_consumed++;
-        cur_bit -= 8;
-    }
-
-    bool tail = false;
-    uint8_t msb, lsb = 0xff;
-    if (bytes_consumed == last_byte)
-    {
-        // bytes consumed must be bigger than 1 - int length is at least 1
-        msb = in_buff[bytes_consumed-1];
-        another_search = false;
-        tail = true;
-    }
-    else if ((bytes_consumed + 1) == last_byte)
-    {
-        if (cur_bit != 0)
-        {
-            msb = in_buff[bytes_consumed++];
-            tail = true;
-        }
-        else
-        {
-            byte = in_buff[bytes_consumed];
-            return false;
-        }
-    }
-    else
-    {
-        msb = in_buff[bytes_consumed];
-        lsb = in_buff[bytes_consumed+1];
-    }
-
-    const uint16_t tmp = (uint16_t)(msb << 8) | lsb;
-    byte = (tmp & (0xff00 >> cur_bit)) >> (8 - cur_bit);
-    return tail;
-}
-
 bool Http2HpackStringDecode::get_huffman_string(const uint8_t* in_buff, const uint32_t encoded_len,
     uint32_t& bytes_consumed, uint8_t* out_buff, const uint32_t out_len, uint32_t& bytes_written,
     Http2Infractions* const infractions) const
 {
     const uint32_t last_encoded_byte = bytes_consumed + encoded_len;
-    uint8_t byte;
-    uint8_t cur_bit = 0;
-    HuffmanEntry result = { 0, 0, HUFFMAN_LOOKUP_1 };
-    bool another_search = false;
-    HuffmanState state = HUFFMAN_LOOKUP_1;
 
     // Check length
     const uint32_t max_length = floor(encoded_len * 8.0/5.0);
@@ -162,83 +106,71 @@ bool Http2HpackStringDecode::get_huffman_string(const uint8_t* in_buff, const ui
         return false;
     }
 
-    while (!get_next_byte(in_buff, last_encoded_byte, bytes_consumed, cur_bit, result.len, byte,
-        another_search))
+    // Input bits are kept left aligned in the accumulator
+    uint64_t bits = 0;
+    unsigned avail = 0;
+
+    while (true)
     {
-        result = huffman_decode[state][byte];
+        while (avail <= 56 and bytes_consumed < last_encoded_byte)
+        {
+            bits |= (uint64_t)in_buff[bytes_consumed++] << (56 - avail);
+            avail += 8;
+        }
 
-        switch (result.state) {
+        uint8_t len;
 
-        case HUFFMAN_MATCH:
-            out_buff[bytes_written++] = result.symbol;
-            state = HUFFMAN_LOOKUP_1;
-            break;
+        if (avail >= Http2HuffmanTable::WINDOW_BITS)
+        {
+            const uint32_t entry = huffman.lookup(bits);
+            const uint8_t count = Http2HuffmanTable::entry_count(entry);
+
+            if (count)
+            {
+                out_buff[bytes_written++] = Http2HuffmanTable::entry_symbol(entry, 0);
+                if (count > 1)
+                    out_buff[bytes_written++] = Http2HuffmanTable::entry_symbol(entry, 1);
+                if (count > 2)
+                    out_buff[bytes_written++] = Http2HuffmanTable::entry_symbol(entry, 2);
+
+                len = Http2HuffmanTable::entry_len(entry);
+                bits <<= len;
+                avail -= len;
+                continue;
+            }
+        }
 
-        case HUFFMAN_LOOKUP_2:
-        case HUFFMAN_LOOKUP_3:
-        case HUFFMAN_LOOKUP_4:
-        case HUFFMAN_LOOKUP_5:
-        case HUFFMAN_LOOKUP_6:
-        case HUFFMAN_LOOKUP_7:
-        case HUFFMAN_LOOKUP_8:
-        case HUFFMAN_LOOKUP_9:
-        case HUFFMAN_LOOKUP_10:
-        case HUFFMAN_LOOKUP_11:
-        case HUFFMAN_LOOKUP_12:
-        case HUFFMAN_LOOKUP_13:
-        case HUFFMAN_LOOKUP_14:
-        case HUFFMAN_LOOKUP_15:
-            state = result.state;
+        // A code longer than the window or the tail of the string
+        uint16_t symbol;
+        len = huffman.decode_code(bits, avail, symbol);
+        if (!len)
             break;
 
-        case HUFFMAN_FAILURE:
+        if (symbol == Http2HuffmanTable::EOS)
+        {
+            // Point to the byte where EOS ends
+            bytes_consumed -= (avail - len + 7) / 8;
             *infractions += INF_HUFFMAN_DECODED_EOS;
             return false;
-
-        default:
-            break;
         }
-    }
-
-    // Tail needs 1 last lookup in case the leftover is big enough for a match.
-    // Make sure match length <= available length
-    uint8_t leftover_len = 8 - cur_bit;
-    uint8_t old_result_len = result.len;
-    HuffmanState old_result_state = result.state;
 
-    if (another_search && (leftover_len >= min_decode_len[state]))
-    {
-        result = huffman_decode[state][byte];
-        if ((result.state == HUFFMAN_MATCH) && (result.len <= leftover_len))
-        {
-            out_buff[bytes_written++] = result.symbol;
-            byte = (byte << result.len) | (((uint16_t)1 << result.len) - 1);
-        }
-        else
-        {
-            // Use leftover bits for padding check if previous lookup was a match
-            if (old_result_state == HUFFMAN_MATCH)
-                result.len = leftover_len;
-            else
-                result.len = old_result_len;
-        }
+        out_buff[bytes_written++] = symbol;
+        bits <<= len;
+        avail -= len;
     }
 
-    // Padding check
-    if (result.len < 8)
+    // Leftover bits must be a padding, the most significant bits of EOS code
+    if (avail >= 8)
     {
-        if (byte != 0xff)
-        {
-            *infractions += INF_HUFFMAN_BAD_PADDING;
-            return false;
-        }
+        *infractions += INF_HUFFMAN_INCOMPLETE_CODE_PADDING;
+        return false;
     }
-    else if (result.state != HUFFMAN_MATCH)
+
+    if (avail and (bits >> (64 - avail)) != ((1u << avail) - 1))
     {
-        *infractions += INF_HUFFMAN_INCOMPLETE_CODE_PADDING;
+        *infractions += INF_HUFFMAN_BAD_PADDING;
         return false;
     }
 
     return true;
 }
-
@@ -22,6 +22,7 @@
 
 #include "http2_enum.h"
 #include "http2_hpack_int_decode.h"
+#include "http2_huffman_table.h"
 
 #include "main/snort_types.h"
 #include "utils/event_gen.h"
@@ -30,7 +31,7 @@
 class Http2HpackStringDecode
 {
 public:
-    Http2HpackStringDecode() : decode7(7) { }
+    Http2HpackStringDecode() : decode7(7), huffman(Http2HuffmanTable::get()) { }
     bool translate(const uint8_t* in_buff, const uint32_t in_len, uint32_t& bytes_consumed,
         uint8_t* out_buff, const uint32_t out_len, uint32_t& bytes_written,
         Http2EventGen* const events, Http2Infractions* const infractions,
@@ -43,11 +44,9 @@ private:
     bool get_huffman_string(const uint8_t* in_buff, const uint32_t encoded_len,
         uint32_t& bytes_consumed, uint8_t* out_buff, const uint32_t out_len, uint32_t&
         bytes_written, Http2Infractions* const infractions) const;
-    bool get_next_byte(const uint8_t* in_buff, const uint32_t last_byte,
-        uint32_t& bytes_consumed, uint8_t& cur_bit, uint8_t match_len, uint8_t& byte,
-        bool& another_search) const;
 
     const Http2HpackIntDecode decode7;
+    const Http2HuffmanTable& huffman;
 };
 
 #endif
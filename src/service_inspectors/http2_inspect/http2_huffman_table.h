@@ -0,0 +1,69 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// http2_huffman_table.h
+
+#ifndef HTTP2_HUFFMAN_TABLE_H
+#define HTTP2_HUFFMAN_TABLE_H
+
+#include "main/snort_types.h"
+
+// Decoding tables for the HPACK Huffman code (RFC 7541 Appendix B).
+//
+// The input is looked up 12 bits at a time. A window entry holds all symbols whose codes fit
+// completely in the window (two at most, since the shortest code is 5 bits) and the number of
+// bits they take. Every code of the common header characters fits in the window; longer codes
+// are rare and decoded canonically, one bit length at a time. The window table takes 16 KB so it
+// stays in L1 between header blocks.
+class Http2HuffmanTable
+{
+public:
+    static const unsigned WINDOW_BITS = 12;
+    static const unsigned MIN_CODE_LEN = 5;
+    static const unsigned MAX_CODE_LEN = 30;
+    static const unsigned NUM_SYMBOLS = 257;
+    static const uint16_t EOS = 256;
+
+    static const Http2HuffmanTable& get();
+
+    // Bits are left aligned in a 64-bit accumulator
+    uint32_t lookup(uint64_t bits) const
+    { return window[bits >> (64 - WINDOW_BITS)]; }
+
+    // Window entry: bits 0-4 length taken, bits 5-6 number of symbols, bits 8-31 symbols
+    static uint8_t entry_len(uint32_t entry) { return entry & 0x1f; }
+    static uint8_t entry_count(uint32_t entry) { return (entry >> 5) & 0x3; }
+    static uint8_t entry_symbol(uint32_t entry, unsigned i) { return entry >> (8 + 8 * i); }
+
+    // Decodes the first code of left-aligned bits, of which avail bits are valid. Returns the code
+    // length or 0 if avail bits don't make a complete code.
+    uint8_t decode_code(uint64_t bits, unsigned avail, uint16_t& symbol) const;
+
+private:
+    Http2HuffmanTable();
+
+    uint32_t window[1 << WINDOW_BITS];
+
+    // Canonical code layout, the code is canonical with symbols ordered by value within a length
+    uint32_t first_code[MAX_CODE_LEN + 1];
+    uint16_t code_count[MAX_CODE_LEN + 1];
+    uint16_t first_index[MAX_CODE_LEN + 1];
+    uint16_t symbols[NUM_SYMBOLS];
+};
+
+#endif
+
@@ -23,7 +23,6 @@
 #endif
 
 #include "../http2_enum.h"
-#include "../http2_huffman_state_machine.h"
 #include "../http2_hpack_string_decode.h"
 #include "../../http_inspect/http_common.h"
 #include "../../http_inspect/http_enum.h"
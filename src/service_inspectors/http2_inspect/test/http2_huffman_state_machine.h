@@ -17,6 +17,9 @@
 //--------------------------------------------------------------------------
 // http2_huffman_state_machine.h author Maya Dagon <mdagon@cisco.com>
 
+// Byte-at-a-time HPACK Huffman decoding tables. They were replaced by Http2HuffmanTable and are
+// kept as a reference decoder for http2_huffman_test.
+
 #ifndef HTTP2_HUFFMAN_STATE_MACHINE_H
 #define HTTP2_HUFFMAN_STATE_MACHINE_H
 
@@ -0,0 +1,497 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// http2_huffman_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "../http2_enum.h"
+#include "../http2_hpack_string_decode.h"
+#include "http2_huffman_state_machine.h"
+
+namespace snort
+{
+// Stubs whose sole purpose is to make the test code link
+int DetectionEngine::queue_event(unsigned int, unsigned int) { return 0; }
+}
+
+using namespace Http2Enums;
+
+enum HuffmanResult { RES_OK, RES_EOS, RES_BAD_PADDING, RES_INCOMPLETE, RES_OTHER };
+
+static HuffmanResult to_result(bool success, const Http2Infractions& inf)
+{
+    if (success)
+        return RES_OK;
+    if (inf & INF_HUFFMAN_DECODED_EOS)
+        return RES_EOS;
+    if (inf & INF_HUFFMAN_BAD_PADDING)
+        return RES_BAD_PADDING;
+    if (inf & INF_HUFFMAN_INCOMPLETE_CODE_PADDING)
+        return RES_INCOMPLETE;
+    return RES_OTHER;
+}
+
+// HPACK string literal with Huffman flag set and 7-bit prefix length
+static std::vector<uint8_t> make_literal(const std::vector<uint8_t>& encoded)
+{
+    std::vector<uint8_t> literal;
+    size_t len = encoded.size();
+
+    if (len < 127)
+        literal.push_back(0x80 | len);
+    else
+    {
+        literal.push_back(0xff);
+        len -= 127;
+        while (len >= 128)
+        {
+            literal.push_back(0x80 | (len & 0x7f));
+            len >>= 7;
+        }
+        literal.push_back(len);
+    }
+
+    literal.insert(literal.end(), encoded.begin(), encoded.end());
+    return literal;
+}
+
+//
+// Reference decoder, the byte-at-a-time state machine walk Http2HpackStringDecode used before
+//
+
+static const uint8_t min_decode_len[HUFFMAN_LOOKUP_MAX + 1] =
+    {5, 2, 2, 3, 5, 1, 1, 2, 2, 2, 2, 3, 3, 3, 4};
+
+static bool sm_get_next_byte(const uint8_t* in_buff, const uint32_t last_byte,
+    uint32_t& bytes_consumed, uint8_t& cur_bit, uint8_t match_len, uint8_t& byte,
+    bool& another_search)
+{
+    another_search = true;
+    cur_bit += match_len;
+
+    if (cur_bit >= 8)
+    {
+        bytes_consumed++;
+        cur_bit -= 8;
+    }
+
+    bool tail = false;
+    uint8_t msb, lsb = 0xff;
+    if (bytes_consumed == last_byte)
+    {
+        msb = in_buff[bytes_consumed-1];
+        another_search = false;
+        tail = true;
+    }
+    else if ((bytes_consumed + 1) == last_byte)
+    {
+        if (cur_bit != 0)
+        {
+            msb = in_buff[bytes_consumed++];
+            tail = true;
+        }
+        else
+        {
+            byte = in_buff[bytes_consumed];
+            return false;
+        }
+    }
+    else
+    {
+        msb = in_buff[bytes_consumed];
+        lsb = in_buff[bytes_consumed+1];
+    }
+
+    const uint16_t tmp = (uint16_t)(msb << 8) | lsb;
+    byte = (tmp & (0xff00 >> cur_bit)) >> (8 - cur_bit);
+    return tail;
+}
+
+// The literal must have a single byte length prefix
+static HuffmanResult sm_decode(const std::vector<uint8_t>& literal, std::string& out)
+{
+    uint32_t bytes_consumed = 1;
+    const uint32_t last_encoded_byte = literal.size();
+    const uint8_t* in_buff = literal.data();
+    uint8_t byte;
+    uint8_t cur_bit = 0;
+    HuffmanEntry result = { 0, 0, HUFFMAN_LOOKUP_1 };
+    bool another_search = false;
+    HuffmanState state = HUFFMAN_LOOKUP_1;
+
+    out.clear();
+
+    while (!sm_get_next_byte(in_buff, last_encoded_byte, bytes_consumed, cur_bit, result.len,
+        byte, another_search))
+    {
+        result = huffman_decode[state][byte];
+
+        if (result.state == HUFFMAN_MATCH)
+        {
+            out.push_back(result.symbol);
+            state = HUFFMAN_LOOKUP_1;
+        }
+        else if (result.state == HUFFMAN_FAILURE)
+            return RES_EOS;
+        else
+            state = result.state;
+    }
+
+    uint8_t leftover_len = 8 - cur_bit;
+    uint8_t old_result_len = result.len;
+    HuffmanState old_result_state = result.state;
+
+    if (another_search && (leftover_len >= min_decode_len[state]))
+    {
+        result = huffman_decode[state][byte];
+        if ((result.state == HUFFMAN_MATCH) && (result.len <= leftover_len))
+        {
+            out.push_back(result.symbol);
+            byte = (byte << result.len) | (((uint16_t)1 << result.len) - 1);
+        }
+        else
+        {
+            if (old_result_state == HUFFMAN_MATCH)
+                result.len = leftover_len;
+            else
+                result.len = old_result_len;
+        }
+    }
+
+    if (result.len < 8)
+    {
+        if (byte != 0xff)
+            return RES_BAD_PADDING;
+    }
+    else if (result.state != HUFFMAN_MATCH)
+        return RES_INCOMPLETE;
+
+    return RES_OK;
+}
+
+//
+// Bit-by-bit decoder following RFC 7541 to the letter, with codes taken from the state machine
+//
+
+struct Code
+{
+    uint32_t code;
+    unsigned len;
+};
+
+static void walk_state(std::vector<Code>& codes, unsigned state, uint32_t prefix, unsigned len)
+{
+    for (unsigned b = 0; b <= UINT8_MAX; b++)
+    {
+        const HuffmanEntry& e = huffman_decode[state][b];
+
+        if (e.state == HUFFMAN_MATCH or e.state == HUFFMAN_FAILURE)
+        {
+            const unsigned sym = (e.state == HUFFMAN_MATCH) ? (uint8_t)e.symbol : 256;
+            codes[sym] = { (prefix << e.len) | (b >> (8 - e.len)), len + e.len };
+        }
+        else
+            walk_state(codes, e.state, (prefix << 8) | b, len + 8);
+    }
+}
+
+static const std::vector<Code>& get_codes()
+{
+    static std::vector<Code> codes;
+
+    if (codes.empty())
+    {
+        codes.resize(257);
+        walk_state(codes, HUFFMAN_LOOKUP_1, 0, 0);
+    }
+
+    return codes;
+}
+
+static HuffmanResult rfc_decode(const std::vector<uint8_t>& encoded, std::string& out)
+{
+    static std::map<std::pair<unsigned, uint32_t>, unsigned> symbols;
+
+    if (symbols.empty())
+    {
+        const auto& codes = get_codes();
+        for (unsigned sym = 0; sym < codes.size(); sym++)
+            symbols[{ codes[sym].len, codes[sym].code }] = sym;
+    }
+
+    uint32_t code = 0;
+    unsigned len = 0;
+
+    out.clear();
+
+    for (uint8_t byte : encoded)
+    {
+        for (int bit = 7; bit >= 0; bit--)
+        {
+            code = (code << 1) | ((byte >> bit) & 1);
+            len++;
+
+            auto sym = symbols.find({ len, code });
+            if (sym == symbols.end())
+                continue;
+
+            if (sym->second == 256)
+                return RES_EOS;
+
+            out.push_back(sym->second);
+            code = 0;
+            len = 0;
+        }
+    }
+
+    if (len >= 8)
+        return RES_INCOMPLETE;
+    if (code != (1u << len) - 1)
+        return RES_BAD_PADDING;
+
+    return RES_OK;
+}
+
+static std::vector<uint8_t> encode(const std::string& str)
+{
+    const auto& codes = get_codes();
+    std::vector<uint8_t> encoded;
+    uint64_t bits = 0;
+    unsigned len = 0;
+
+    for (uint8_t c : str)
+    {
+        bits = (bits << codes[c].len) | codes[c].code;
+        len += codes[c].len;
+
+        while (len >= 8)
+        {
+            encoded.push_back(bits >> (len - 8));
+            len -= 8;
+        }
+    }
+
+    if (len)
+        encoded.push_back((bits << (8 - len)) | ((1 << (8 - len)) - 1));
+
+    return encoded;
+}
+
+static HuffmanResult table_decode(const std::vector<uint8_t>& literal, std::string& out)
+{
+    static const Http2HpackStringDecode decode;
+    static uint8_t buf[MAX_OCTETS];
+
+    Http2EventGen events;
+    Http2Infractions inf;
+    uint32_t bytes_consumed = 0;
+    uint32_t bytes_written = 0;
+
+    bool ret = decode.translate(literal.data(), literal.size(), bytes_consumed, buf, sizeof(buf),
+        bytes_written, &events, &inf, false);
+
+    out.assign((const char*)buf, bytes_written);
+
+    if (ret)
+        CHECK(bytes_consumed == literal.size());
+
+    return to_result(ret, inf);
+}
+
+static std::string random_string(std::mt19937& rng, unsigned len)
+{
+    std::string str;
+
+    for (unsigned i = 0; i < len; i++)
+    {
+        if (rng() % 4)
+            str.push_back(' ' + rng() % 95);
+        else
+            str.push_back(rng() % 256);
+    }
+
+    return str;
+}
+
+// Unit tests
+
+#ifdef CATCH_TEST_BUILD
+
+TEST_CASE("multi-symbol table vs state machine, valid strings", "[http2_hpack]")
+{
+    std::mt19937 rng(1);
+
+    for (unsigned n = 0; n < 200000; n++)
+    {
+        const std::string str = random_string(rng, rng() % 64);
+        const auto encoded = encode(str);
+        const auto literal = make_literal(encoded);
+        std::string table_out;
+        std::string sm_out;
+
+        REQUIRE(table_decode(literal, table_out) == RES_OK);
+        REQUIRE(table_out == str);
+
+        if (encoded.size() >= 127)
+            continue;
+
+        // The state machine rejects some valid strings, whatever it decodes must be the same
+        const auto sm_res = sm_decode(literal, sm_out);
+        if (sm_res == RES_OK)
+            REQUIRE(sm_out == table_out);
+        else
+            REQUIRE(sm_res == RES_BAD_PADDING);
+    }
+}
+
+TEST_CASE("multi-symbol table vs state machine, random input", "[http2_hpack]")
+{
+    std::mt19937 rng(2);
+
+    for (unsigned n = 0; n < 500000; n++)
+    {
+        const unsigned len = 1 + rng() % 64;
+        const unsigned mode = rng() % 3;
+        std::vector<uint8_t> encoded;
+
+        for (unsigned i = 0; i < len; i++)
+        {
+            uint8_t byte = rng();
+            if (mode == 1)
+                byte |= 0xf0 & rng();  // more long codes and EOS
+            else if (mode == 2)
+                byte &= rng();         // more short codes
+            encoded.push_back(byte);
+        }
+
+        const auto literal = make_literal(encoded);
+        std::string table_out;
+        std::string sm_out;
+        std::string rfc_out;
+
+        const auto table_res = table_decode(literal, table_out);
+        const auto sm_res = sm_decode(literal, sm_out);
+        const auto rfc_res = rfc_decode(encoded, rfc_out);
+
+        REQUIRE(table_res == rfc_res);
+        if (table_res == RES_OK)
+            REQUIRE(table_out == rfc_out);
+
+        if (sm_res == RES_EOS)
+            REQUIRE(table_res == RES_EOS);
+
+        if (sm_res == RES_OK and table_res == RES_OK)
+            REQUIRE(sm_out == table_out);
+    }
+}
+
+TEST_CASE("multi-symbol table, all short strings", "[http2_hpack]")
+{
+    for (uint32_t v = 0; v < (1 << 16); v++)
+    {
+        const std::vector<uint8_t> one = { (uint8_t)v };
+        const std::vector<uint8_t> two = { (uint8_t)(v >> 8), (uint8_t)v };
+        std::string table_out;
+        std::string rfc_out;
+
+        if (v <= UINT8_MAX)
+        {
+            REQUIRE(table_decode(make_literal(one), table_out) == rfc_decode(one, rfc_out));
+            REQUIRE(table_out.substr(0, rfc_out.size()) == rfc_out);
+        }
+
+        REQUIRE(table_decode(make_literal(two), table_out) == rfc_decode(two, rfc_out));
+        REQUIRE(table_out.substr(0, rfc_out.size()) == rfc_out);
+    }
+}
+
+#endif // CATCH_TEST_BUILD
+
+// Benchmark tests
+
+#ifdef BENCHMARK_TEST
+
+TEST_CASE("HPACK Huffman decoding", "[http2_hpack]")
+{
+    static const char* values[] =
+    {
+        "text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,*/*;q=0.8",
+        "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/96.0",
+        "gzip, deflate, br",
+        "en-US,en;q=0.9",
+        "https://www.example.com/path/to/resource?query=value&other=1",
+        "max-age=0, no-cache, no-store, must-revalidate",
+        "Wed, 21 Oct 2015 07:28:00 GMT",
+    };
+
+    std::mt19937 rng(3);
+    std::vector<std::vector<uint8_t>> literals;
+    size_t total = 0;
+
+    for (const char* value : values)
+    {
+        literals.push_back(make_literal(encode(value)));
+        total += literals.back().size();
+    }
+
+    // Cookies short enough for a single byte length prefix, as the state machine decoder needs
+    for (unsigned n = 0; n < 8; n++)
+    {
+        std::string cookie;
+        while (cookie.size() < 90)
+            cookie += "id=" + std::to_string(rng()) + "; ";
+        literals.push_back(make_literal(encode(cookie)));
+        total += literals.back().size();
+    }
+
+    std::string out;
+
+    BENCHMARK("state machine, " + std::to_string(total) + " bytes")
+    {
+        size_t decoded = 0;
+        for (const auto& literal : literals)
+        {
+            sm_decode(literal, out);
+            decoded += out.size();
+        }
+        return decoded;
+    };
+
+    BENCHMARK("multi-symbol table, " + std::to_string(total) + " bytes")
+    {
+        size_t decoded = 0;
+        for (const auto& literal : literals)
+        {
+            table_decode(literal, out);
+            decoded += out.size();
+        }
+        return decoded;
+    };
+}
+
+#endif // BENCHMARK_TEST
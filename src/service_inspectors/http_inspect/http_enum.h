@@ -295,6 +295,7 @@ enum Infraction
     INF_INVALID_SUBVERSION = 133,
     INF_VERSION_0 = 134,
     INF_GZIP_FEXTRA = 135,
+    INF_FILE_DECOMPR_BUDGET = 136,
     INF__MAX_VALUE
 };
 
@@ -433,6 +434,7 @@ enum EventSid
     EVENT_VERSION_0 = 276,
     EVENT_VERSION_HIGHER_THAN_1 = 277,
     EVENT_GZIP_FEXTRA = 278,
+    EVENT_FILE_DECOMPR_BUDGET = 279,
     EVENT__MAX_VALUE
 };
 
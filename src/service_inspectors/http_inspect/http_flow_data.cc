@@ -107,6 +107,13 @@ HttpFlowData::~HttpFlowData()
         debug_log(4, http_trace, TRACE_JS_PROC, nullptr,
             "js_normalizer deleted\n");
     }
+    if (js_normalizer_idle)
+    {
+        delete js_normalizer_idle;
+
+        debug_log(4, http_trace, TRACE_JS_PROC, nullptr,
+            "idle js_normalizer deleted\n");
+    }
 #endif
 
     for (int k=0; k <= 1; k++)
@@ -250,14 +257,28 @@ void HttpFlowData::reset_js_ident_ctx()
 
 snort::JSNormalizer& HttpFlowData::acquire_js_ctx(int32_t ident_depth, size_t norm_depth,
     uint8_t max_template_nesting, uint32_t max_bracket_depth, uint32_t max_scope_depth,
-    const std::unordered_set<std::string>& ignored_ids)
+    const std::unordered_set<std::string>& ignored_ids, bool incremental, bool flat_ident_ctx)
 {
     if (js_normalizer)
         return *js_normalizer;
 
+    if (js_normalizer_idle)
+    {
+        js_normalizer = js_normalizer_idle;
+        js_normalizer_idle = nullptr;
+
+        debug_log(4, http_trace, TRACE_JS_PROC, nullptr,
+            "js_normalizer reused\n");
+
+        return *js_normalizer;
+    }
+
     if (!js_ident_ctx)
     {
-        js_ident_ctx = new JSIdentifierCtx(ident_depth, max_scope_depth, ignored_ids);
+        if (flat_ident_ctx)
+            js_ident_ctx = new JSIdentifierCtxFlat(ident_depth, max_scope_depth, ignored_ids);
+        else
+            js_ident_ctx = new JSIdentifierCtx(ident_depth, max_scope_depth, ignored_ids);
 
         debug_logf(4, http_trace, TRACE_JS_PROC, nullptr,
             "js_ident_ctx created (ident_depth %d)\n", ident_depth);
@@ -265,6 +286,7 @@ snort::JSNormalizer& HttpFlowData::acquire_js_ctx(int32_t ident_depth, size_t no
 
     js_normalizer = new JSNormalizer(*js_ident_ctx, norm_depth,
         max_template_nesting, max_bracket_depth);
+    js_incremental = incremental;
 
     debug_logf(4, http_trace, TRACE_JS_PROC, nullptr,
         "js_normalizer created (norm_depth %zd, max_template_nesting %d)\n",
@@ -287,6 +309,19 @@ void HttpFlowData::release_js_ctx()
     if (!js_normalizer)
         return;
 
+    // in incremental mode the normalizer and its buffers are kept for the next script,
+    // the output lent to detection stays intact till the next normalization
+    if (js_incremental)
+    {
+        js_normalizer->reset();
+        js_normalizer_idle = js_normalizer;
+        js_normalizer = nullptr;
+
+        debug_log(4, http_trace, TRACE_JS_PROC, nullptr,
+            "js_normalizer idle\n");
+        return;
+    }
+
     delete js_normalizer;
     js_normalizer = nullptr;
 
@@ -296,7 +331,7 @@ void HttpFlowData::release_js_ctx()
 #else
 void HttpFlowData::reset_js_ident_ctx() {}
 snort::JSNormalizer& HttpFlowData::acquire_js_ctx(int32_t, size_t, uint8_t, uint32_t, uint32_t,
-    const std::unordered_set<std::string>&)
+    const std::unordered_set<std::string>&, bool, bool)
 { return *js_normalizer; }
 void HttpFlowData::release_js_ctx() {}
 #endif
@@ -165,6 +165,8 @@ private:
     snort::MimeSession* mime_state[2] = { nullptr, nullptr };
     snort::UtfDecodeSession* utf_state = nullptr; // SRC_SERVER only
     fd_session_t* fd_state = nullptr; // SRC_SERVER only
+    uint64_t fd_budget = 0; // SRC_SERVER only, shared by the messages of the flow
+    bool fd_budget_set = false;
     int64_t file_depth_remaining[2] = { HttpCommon::STAT_NOT_PRESENT,
         HttpCommon::STAT_NOT_PRESENT };
     int64_t detect_depth_remaining[2] = { HttpCommon::STAT_NOT_PRESENT,
@@ -216,6 +218,8 @@ private:
     // *** HttpJsNorm
     JSIdentifierCtxBase* js_ident_ctx = nullptr;
     snort::JSNormalizer* js_normalizer = nullptr;
+    snort::JSNormalizer* js_normalizer_idle = nullptr;
+    bool js_incremental = false;
     bool js_continue = false;
     bool js_built_in_event = false;
 
@@ -223,7 +227,7 @@ private:
     void reset_js_ident_ctx();
     snort::JSNormalizer& acquire_js_ctx(int32_t ident_depth, size_t norm_depth,
         uint8_t max_template_nesting, uint32_t max_bracket_depth, uint32_t max_scope_depth,
-        const std::unordered_set<std::string>& ignored_ids);
+        const std::unordered_set<std::string>& ignored_ids, bool incremental, bool flat_ident_ctx);
     void release_js_ctx();
     bool is_pdu_missed();
 
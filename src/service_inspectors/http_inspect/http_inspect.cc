@@ -170,6 +170,8 @@ void HttpInspect::show(const SnortConfig*) const
     ConfigLogger::log_value("js_norm_max_scope_depth", params->js_norm_param.max_scope_depth);
     if (!js_norm_ident_ignore.empty())
         ConfigLogger::log_list("js_norm_ident_ignore", js_norm_ident_ignore.c_str());
+    ConfigLogger::log_flag("js_norm_incremental", params->js_norm_param.js_norm_incremental);
+    ConfigLogger::log_flag("js_norm_flat_ident_ctx", params->js_norm_param.js_norm_flat_ident_ctx);
     ConfigLogger::log_value("bad_characters", bad_chars.c_str());
     ConfigLogger::log_value("ignore_unreserved", unreserved_chars.c_str());
     ConfigLogger::log_flag("percent_u", params->uri_param.percent_u);
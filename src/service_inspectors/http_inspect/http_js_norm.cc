@@ -82,7 +82,8 @@ static inline JSTokenizer::JSRet js_normalize(JSNormalizer& ctx, const char* con
 
 HttpJsNorm::HttpJsNorm(const HttpParaList::UriParam& uri_param_, int64_t normalization_depth_,
     int32_t identifier_depth_, uint8_t max_template_nesting_, uint32_t max_bracket_depth_,
-    uint32_t max_scope_depth_, const std::unordered_set<std::string>& ignored_ids_) :
+    uint32_t max_scope_depth_, const std::unordered_set<std::string>& ignored_ids_,
+    bool incremental_, bool flat_ident_ctx_) :
     uri_param(uri_param_),
     detection_depth(UINT64_MAX),
     normalization_depth(normalization_depth_),
@@ -91,6 +92,8 @@ HttpJsNorm::HttpJsNorm(const HttpParaList::UriParam& uri_param_, int64_t normali
     max_bracket_depth(max_bracket_depth_),
     max_scope_depth(max_scope_depth_),
     ignored_ids(ignored_ids_),
+    incremental(incremental_),
+    flat_ident_ctx(flat_ident_ctx_),
     mpse_otag(nullptr),
     mpse_attr(nullptr),
     mpse_type(nullptr)
@@ -160,7 +163,7 @@ void HttpJsNorm::do_external(const Field& input, Field& output,
             "script continues\n");
 
     auto& js_ctx = ssn->acquire_js_ctx(identifier_depth, normalization_depth, max_template_nesting,
-        max_bracket_depth, max_scope_depth, ignored_ids);
+        max_bracket_depth, max_scope_depth, ignored_ids, incremental, flat_ident_ctx);
 
     while (ptr < end)
     {
@@ -225,14 +228,18 @@ void HttpJsNorm::do_external(const Field& input, Field& output,
 
     if (data_len)
     {
-        const char* data = final_portion ? js_ctx.take_script() : js_ctx.get_script();
+        // a lent script is owned by the normalizer and reused by its next
+        // normalization, which comes with the next body section
+        bool own = final_portion;
+        const char* data = !final_portion ? js_ctx.get_script()
+            : incremental ? js_ctx.lend_script(own) : js_ctx.take_script();
 
         if (data)
         {
             trace_logf(1, http_trace, TRACE_JS_DUMP, nullptr,
                        "js_data[%u]: %.*s\n", data_len, data_len, data);
 
-            output.set(data_len, (const uint8_t*)data, final_portion);
+            output.set(data_len, (const uint8_t*)data, own);
         }
     }
 }
@@ -295,7 +302,8 @@ void HttpJsNorm::do_inline(const Field& input, Field& output,
         }
 
         auto& js_ctx = ssn->acquire_js_ctx(identifier_depth, normalization_depth,
-            max_template_nesting, max_bracket_depth, max_scope_depth, ignored_ids);
+            max_template_nesting, max_bracket_depth, max_scope_depth, ignored_ids, incremental,
+            flat_ident_ctx);
         auto output_size_before = js_ctx.script_size();
 
         auto ret = js_normalize(js_ctx, end, ptr);
@@ -364,14 +372,18 @@ void HttpJsNorm::do_inline(const Field& input, Field& output,
 
     if (data_len)
     {
-        const char* data = final_portion ? js_ctx->take_script() : js_ctx->get_script();
+        // a lent script is owned by the normalizer and reused by its next
+        // normalization, which comes with the next body section
+        bool own = final_portion;
+        const char* data = !final_portion ? js_ctx->get_script()
+            : incremental ? js_ctx->lend_script(own) : js_ctx->take_script();
 
         if (data)
         {
             trace_logf(1, http_trace, TRACE_JS_DUMP, nullptr,
                        "js_data[%u]: %.*s\n", data_len, data_len, data);
 
-            output.set(data_len, (const uint8_t*)data, final_portion);
+            output.set(data_len, (const uint8_t*)data, own);
         }
     }
 
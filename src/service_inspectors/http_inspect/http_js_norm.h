@@ -38,7 +38,8 @@ class HttpJsNorm
 public:
     HttpJsNorm(const HttpParaList::UriParam&, int64_t normalization_depth,
         int32_t identifier_depth, uint8_t max_template_nesting, uint32_t max_bracket_depth,
-        uint32_t max_scope_depth, const std::unordered_set<std::string>& ignored_ids);
+        uint32_t max_scope_depth, const std::unordered_set<std::string>& ignored_ids,
+        bool incremental, bool flat_ident_ctx);
     ~HttpJsNorm();
 
     void set_detection_depth(size_t depth)
@@ -70,6 +71,8 @@ private:
     uint32_t max_bracket_depth;
     uint32_t max_scope_depth;
     const std::unordered_set<std::string>& ignored_ids;
+    bool incremental;
+    bool flat_ident_ctx;
     bool configure_once = false;
 
     snort::SearchTool* mpse_otag;
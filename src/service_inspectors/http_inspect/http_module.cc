@@ -109,6 +109,12 @@ const Parameter HttpModule::http_params[] =
     { "js_norm_ident_ignore", Parameter::PT_LIST, js_norm_ident_ignore_param, nullptr,
       "list of JavaScript ignored identifiers which will not be normalized" },
 
+    { "js_norm_incremental", Parameter::PT_BOOL, nullptr, "false",
+      "keep enhanced JavaScript normalizer and its output buffer between scripts of a flow" },
+
+    { "js_norm_flat_ident_ctx", Parameter::PT_BOOL, nullptr, "false",
+      "use allocation-free identifier context in enhanced JavaScript normalizer" },
+
     { "max_javascript_whitespaces", Parameter::PT_INT, "1:65535", "200",
       "maximum consecutive whitespaces allowed within the JavaScript obfuscated data" },
 
@@ -293,6 +299,14 @@ bool HttpModule::set(const char*, Value& val, SnortConfig*)
     {
         params->js_norm_param.ignored_ids.insert(val.get_string());
     }
+    else if (val.is("js_norm_incremental"))
+    {
+        params->js_norm_param.js_norm_incremental = val.get_bool();
+    }
+    else if (val.is("js_norm_flat_ident_ctx"))
+    {
+        params->js_norm_param.js_norm_flat_ident_ctx = val.get_bool();
+    }
     else if (val.is("max_javascript_whitespaces"))
     {
         params->js_norm_param.max_javascript_whitespaces = val.get_uint16();
@@ -477,7 +491,8 @@ bool HttpModule::end(const char* fqn, int, SnortConfig*)
     params->js_norm_param.js_norm = new HttpJsNorm(params->uri_param,
         params->js_norm_param.js_norm_bytes_depth, params->js_norm_param.js_identifier_depth,
         params->js_norm_param.max_template_nesting, params->js_norm_param.max_bracket_depth,
-        params->js_norm_param.max_scope_depth, params->js_norm_param.ignored_ids);
+        params->js_norm_param.max_scope_depth, params->js_norm_param.ignored_ids,
+        params->js_norm_param.js_norm_incremental, params->js_norm_param.js_norm_flat_ident_ctx);
 
     params->script_detection_handle = script_detection_handle;
 
@@ -72,6 +72,8 @@ public:
         uint32_t max_bracket_depth = 256;
         uint32_t max_scope_depth = 256;
         std::unordered_set<std::string> ignored_ids;
+        bool js_norm_incremental = false;
+        bool js_norm_flat_ident_ctx = false;
         int max_javascript_whitespaces = 200;
         class HttpJsNorm* js_norm = nullptr;
     };
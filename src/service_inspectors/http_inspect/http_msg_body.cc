@@ -304,6 +304,14 @@ void HttpMsgBody::do_file_decompression(const Field& input, Field& output)
         File_Decomp_StopFree(session_data->fd_state);
         session_data->fd_state = nullptr;
         break;
+    case File_Decomp_BudgetOut:
+        add_infraction(INF_FILE_DECOMPR_BUDGET);
+        create_event(EVENT_FILE_DECOMPR_BUDGET);
+        delete[] buffer;
+        output.set(input);
+        File_Decomp_StopFree(session_data->fd_state);
+        session_data->fd_state = nullptr;
+        break;
     case File_Decomp_BlockOut:
         add_infraction(INF_FILE_DECOMPR_OVERRUN);
         create_event(EVENT_FILE_DECOMPR_OVERRUN);
@@ -673,6 +673,18 @@ void HttpMsgHeader::setup_file_decompression()
     session_data->fd_state->Compr_Depth = 0;
     session_data->fd_state->Decompr_Depth = 0;
 
+    const uint64_t budget = FileService::decode_conf.get_decompress_flow_budget();
+
+    if ( budget )
+    {
+        if ( !session_data->fd_budget_set )
+        {
+            session_data->fd_budget = budget;
+            session_data->fd_budget_set = true;
+        }
+        session_data->fd_state->Budget = &session_data->fd_budget;
+    }
+
     (void)File_Decomp_Init(session_data->fd_state);
 }
 
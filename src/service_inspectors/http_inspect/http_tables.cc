@@ -338,6 +338,7 @@ const RuleMap HttpModule::http_events[] =
     { EVENT_VERSION_0,                  "HTTP version in start line is 0" },
     { EVENT_VERSION_HIGHER_THAN_1,      "HTTP version in start line is higher than 1" },
     { EVENT_GZIP_FEXTRA,                "HTTP gzip body with the FEXTRA flag set" },
+    { EVENT_FILE_DECOMPR_BUDGET,        "PDF/SWF/ZIP decompression budget of the flow exhausted" },
     { 0, nullptr }
 };
 
@@ -690,6 +690,11 @@ void ImapMime::decompress_alert()
     DetectionEngine::queue_event(GID_IMAP, IMAP_FILE_DECOMP_FAILED);
 }
 
+void ImapMime::decompress_budget_alert()
+{
+    DetectionEngine::queue_event(GID_IMAP, IMAP_FILE_DECOMP_BUDGET);
+}
+
 void ImapMime::reset_state(Flow* ssn)
 {
     IMAP_ResetState(ssn);
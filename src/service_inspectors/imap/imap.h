@@ -152,6 +152,7 @@ class ImapMime : public snort::MimeSession
 private:
     void decode_alert() override;
     void decompress_alert() override;
+    void decompress_budget_alert() override;
     void reset_state(snort::Flow* ssn) override;
     bool is_end_of_data(snort::Flow* ssn) override;
 };
@@ -68,6 +68,7 @@ static const RuleMap imap_rules[] =
     { IMAP_QP_DECODING_FAILED, "quoted-printable decoding failed" },
     { IMAP_UU_DECODING_FAILED, "Unix-to-Unix decoding failed" },
     { IMAP_FILE_DECOMP_FAILED, "file decompression failed" },
+    { IMAP_FILE_DECOMP_BUDGET, "file decompression budget of the flow exhausted" },
 
     { 0, nullptr }
 };
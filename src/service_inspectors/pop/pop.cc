@@ -629,6 +629,11 @@ void PopMime::decompress_alert()
     DetectionEngine::queue_event(GID_POP, POP_FILE_DECOMP_FAILED);
 }
 
+void PopMime::decompress_budget_alert()
+{
+    DetectionEngine::queue_event(GID_POP, POP_FILE_DECOMP_BUDGET);
+}
+
 void PopMime::reset_state(Flow* ssn)
 {
     POP_ResetState(ssn);
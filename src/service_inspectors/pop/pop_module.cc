@@ -68,6 +68,7 @@ static const RuleMap pop_rules[] =
     { POP_QP_DECODING_FAILED, "quoted-printable decoding failed" },
     { POP_UU_DECODING_FAILED, "Unix-to-Unix decoding failed" },
     { POP_FILE_DECOMP_FAILED, "file decompression failed" },
+    { POP_FILE_DECOMP_BUDGET, "file decompression budget of the flow exhausted" },
     { 0, nullptr }
 };
 
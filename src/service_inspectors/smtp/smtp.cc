@@ -1396,6 +1396,11 @@ void SmtpMime::decompress_alert()
     DetectionEngine::queue_event(GID_SMTP, SMTP_FILE_DECOMP_FAILED);
 }
 
+void SmtpMime::decompress_budget_alert()
+{
+    DetectionEngine::queue_event(GID_SMTP, SMTP_FILE_DECOMP_BUDGET);
+}
+
 void SmtpMime::reset_state(Flow* ssn)
 {
     SMTP_ResetState(ssn);
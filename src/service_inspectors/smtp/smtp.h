@@ -151,6 +151,7 @@ private:
 #endif
     void decode_alert() override;
     void decompress_alert() override;
+    void decompress_budget_alert() override;
     void reset_state(snort::Flow* ssn) override;
     bool is_end_of_data(snort::Flow* ssn) override;
 };
@@ -170,6 +170,7 @@ static const RuleMap smtp_rules[] =
     { SMTP_AUTH_ABORT_AUTH, "Cyrus SASL authentication attack" },
     { SMTP_AUTH_COMMAND_OVERFLOW, "attempted authentication command buffer overflow" },
     { SMTP_FILE_DECOMP_FAILED, "file decompression failed" },
+    { SMTP_FILE_DECOMP_BUDGET, "file decompression budget of the flow exhausted" },
 
     { 0, nullptr }
 };
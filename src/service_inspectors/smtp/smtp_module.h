@@ -45,6 +45,7 @@
 #define SMTP_AUTH_ABORT_AUTH        14
 #define SMTP_AUTH_COMMAND_OVERFLOW  15
 #define SMTP_FILE_DECOMP_FAILED     16
+#define SMTP_FILE_DECOMP_BUDGET     17
 
 #define SMTP_NAME "smtp"
 #define SMTP_HELP "smtp inspection"
@@ -24,7 +24,10 @@
 
 #include "sfrt_flat.h"
 
+#include <cstring>
+
 #include "sfip/sf_cidr.h"
+#include "utils/util.h"
 
 using namespace snort;
 
@@ -99,6 +102,7 @@ table_flat_t* sfrt_flat_new(char table_flat_type, char ip_type,  long data_size,
     /* This will point to the actual table lookup algorithm */
     table->rt = 0;
     table->rt6 = 0;
+    table->poptrie = 0;
 
     /* index 0 will be used for failed lookups, so set this to 1 */
     table->num_ent = 1;
@@ -210,7 +214,7 @@ GENERIC sfrt_flat_lookup(const SfIp* ip, table_flat_t* table)
 
 /* Insert "ip", of length "len", into "table", and have it point to "ptr" */
 int sfrt_flat_insert(SfCidr* cidr, unsigned char len, INFO ptr,
-    int behavior, table_flat_t* table, updateEntryInfoFunc updateEntry)
+    int behavior, table_flat_t* table, updateEntryInfoFunc updateEntry, void* update_ctx)
 {
     const SfIp* ip;
     int index;
@@ -282,7 +286,7 @@ int sfrt_flat_insert(SfCidr* cidr, unsigned char len, INFO ptr,
         index = tuple.index;
     }
 
-    bytesAllocated = updateEntry(&data[index], ptr, SAVE_TO_CURRENT, base);
+    bytesAllocated = updateEntry(&data[index], ptr, SAVE_TO_CURRENT, base, update_ctx);
 
     if (bytesAllocated < 0)
     {
@@ -295,7 +299,8 @@ int sfrt_flat_insert(SfCidr* cidr, unsigned char len, INFO ptr,
 
     /* The actual value that is looked-up is an index
      * into the data table. */
-    res = sfrt_dir_flat_insert(addr, numAddrDwords, len, index, behavior, rt, updateEntry, data);
+    res = sfrt_dir_flat_insert(addr, numAddrDwords, len, index, behavior, rt, updateEntry,
+        update_ctx, data);
 
     /* Check if we ran out of memory. If so, need to decrement
      * table->num_ent */
@@ -312,6 +317,153 @@ int sfrt_flat_insert(SfCidr* cidr, unsigned char len, INFO ptr,
     return res;
 }
 
+/* Return the information stored for "ip" of length "len" only if that very
+ * prefix was inserted, rather than inherited from a less specific one */
+GENERIC sfrt_flat_exact_lookup(const SfCidr* cidr, unsigned char len, table_flat_t* table)
+{
+    const SfIp* ip;
+    const uint32_t* addr;
+    int numAddrDwords;
+    TABLE_PTR rt;
+    tuple_flat_t tuple;
+    INFO* data;
+    uint8_t* base;
+
+    if (!cidr || !table || !table->data || len == 0 || len > 128)
+        return nullptr;
+
+    ip = cidr->get_addr();
+    if (ip->is_ip4())
+    {
+        if (len < 96)
+            return nullptr;
+        len -= 96;
+        addr = ip->get_ip4_ptr();
+        numAddrDwords = 1;
+        rt = table->rt;
+    }
+    else if (ip->is_ip6())
+    {
+        addr = ip->get_ip6_ptr();
+        numAddrDwords = 4;
+        rt = table->rt6;
+    }
+    else
+        return nullptr;
+
+    tuple = sfrt_dir_flat_lookup(addr, numAddrDwords, rt);
+
+    if (tuple.length != len || tuple.index >= table->num_ent)
+        return nullptr;
+
+    base = (uint8_t*)segment_basePtr();
+    data = (INFO*)(&base[table->data]);
+
+    if (data[tuple.index])
+        return (GENERIC)&base[data[tuple.index]];
+
+    return nullptr;
+}
+
+struct CopyContext
+{
+    const table_flat_t* src;
+    table_flat_t* table;
+    FLAT_INDEX* index_map;
+    copyEntryInfoFunc copy_entry;
+};
+
+/* Give each data index still used by the routing tables a new index, in the
+ * order they are found, and copy its data on first use */
+static FLAT_INDEX copy_index(FLAT_INDEX index, void* context)
+{
+    CopyContext* cc = (CopyContext*)context;
+
+    if (index < cc->src->num_ent and cc->index_map[index])
+        return cc->index_map[index];
+
+    table_flat_t* table = cc->table;
+
+    if (table->num_ent >= table->max_size)
+        return 0;
+
+    const uint8_t* src_base = (const uint8_t*)cc->src;
+    const INFO* src_data = (const INFO*)(&src_base[cc->src->data]);
+    uint8_t* base = (uint8_t*)segment_basePtr();
+    INFO* data = (INFO*)(&base[table->data]);
+    FLAT_INDEX new_index = table->num_ent;
+
+    data[new_index] = 0;
+
+    if (index < cc->src->num_ent and src_data[index])
+    {
+        int64_t bytes_allocated = cc->copy_entry(&data[new_index], src_data[index],
+            src_base, base);
+
+        if (bytes_allocated < 0)
+            return 0;
+
+        table->allocated += (uint32_t)bytes_allocated;
+    }
+    if (index < cc->src->num_ent)
+        cc->index_map[index] = new_index;
+
+    table->num_ent++;
+
+    return new_index;
+}
+
+/* Copy the table "src", which starts a segment, to the start of the current
+ * segment with room for "max_size" data entries.  Only what the routing
+ * tables still reach is copied, so the sub tables, data tables and entries
+ * left behind by earlier updates are dropped.  The poptrie is not copied;
+ * build it again once the copy is updated. */
+table_flat_t* sfrt_flat_copy(const table_flat_t* src, uint32_t max_size,
+    copyEntryInfoFunc copyEntry)
+{
+    const uint8_t* src_base = (const uint8_t*)src;
+
+    if (segment_unusedmem() < sizeof(table_flat_t))
+        return nullptr;
+
+    MEM_OFFSET table_ptr = segment_snort_alloc(sizeof(table_flat_t));
+    assert(!table_ptr);
+
+    if (max_size < src->num_ent)
+        max_size = src->num_ent;
+
+    uint8_t* base = (uint8_t*)segment_basePtr();
+    table_flat_t* table = (table_flat_t*)(&base[table_ptr]);
+
+    *table = *src;
+    table->max_size = max_size;
+    table->num_ent = 1;
+    table->rt = table->rt6 = table->poptrie = 0;
+    table->list_info = 0;
+    table->data = (INFO)segment_snort_calloc(sizeof(INFO) * max_size, 1);
+
+    if (!table->data)
+        return nullptr;
+
+    table->allocated = sizeof(table_flat_t) + sizeof(INFO) * max_size;
+
+    CopyContext cc = { src, table, (FLAT_INDEX*)snort_calloc(src->num_ent, sizeof(FLAT_INDEX)),
+        copyEntry };
+
+    if (src->rt)
+        table->rt = sfrt_dir_flat_copy(src_base, src->rt, copy_index, &cc);
+
+    if (src->rt6 and (table->rt or !src->rt))
+        table->rt6 = sfrt_dir_flat_copy(src_base, src->rt6, copy_index, &cc);
+
+    snort_free(cc.index_map);
+
+    if ((src->rt and !table->rt) or (src->rt6 and !table->rt6))
+        return nullptr;
+
+    return table;
+}
+
 uint32_t sfrt_flat_num_entries(table_flat_t* table)
 {
     if (!table)
@@ -328,6 +480,29 @@ uint32_t sfrt_flat_num_entries(table_flat_t* table)
     return table->num_ent - 1;
 }
 
+/* Check that a table read from an untrusted source, taking "size" bytes from
+ * "table", only refers to memory inside them.  Only DIR_8x16 tables are
+ * accepted, sfrt_flat_dir8x_lookup() depends on their layout.  What the data
+ * array entries point to is up to the caller to check. */
+bool sfrt_flat_check(const table_flat_t* table, size_t size)
+{
+    static const int dims4[] = { 16, 8, 4, 4 };
+    static const int dims6[] = { 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8 };
+
+    if (size < sizeof(table_flat_t) or table->table_flat_type != DIR_8x16 or
+        !table->num_ent or table->num_ent > table->max_size or
+        !segment_contains(table->data, (uint64_t)table->max_size * sizeof(INFO), size))
+        return false;
+
+    const uint8_t* base = (const uint8_t*)table;
+
+    if (!sfrt_dir_flat_check(base, size, table->rt, dims4, 4, table->num_ent) or
+        !sfrt_dir_flat_check(base, size, table->rt6, dims6, 16, table->num_ent))
+        return false;
+
+    return !table->poptrie or sfrt_flat_poptrie_check(table, size);
+}
+
 uint32_t sfrt_flat_usage(table_flat_t* table)
 {
     uint32_t usage;
@@ -41,8 +41,14 @@ typedef enum
     SAVE_TO_CURRENT
 }SaveDest;
 
+/* "context" is the update_ctx passed to sfrt_flat_insert() */
 typedef int64_t (* updateEntryInfoFunc)(INFO* entryInfo, INFO newInfo,
-    SaveDest saveDest, uint8_t* base);
+    SaveDest saveDest, uint8_t* base, void* context);
+
+/* Copy the entry at "srcInfo" in the segment at "srcBase" to "entryInfo" in
+ * the current segment, returning the bytes allocated or -1 */
+typedef int64_t (* copyEntryInfoFunc)(INFO* entryInfo, INFO srcInfo,
+    const uint8_t* srcBase, uint8_t* base);
 typedef struct
 {
     FLAT_INDEX index;
@@ -66,6 +72,7 @@ typedef struct
     TABLE_PTR rt; /* Actual "routing" table */
     TABLE_PTR rt6; /* Actual "routing" table */
     TABLE_PTR list_info; /* List file information table (entry information)*/
+    TABLE_PTR poptrie; /* Optional compiled lookup table, see sfrt_flat_poptrie.h */
 } table_flat_t;
 /*******************************************************************/
 
@@ -75,11 +82,19 @@ table_flat_t* sfrt_flat_new(char table_flat_type, char ip_type,
 
 GENERIC sfrt_flat_lookup(const snort::SfIp* ip, table_flat_t* table);
 GENERIC sfrt_flat_dir8x_lookup(const snort::SfIp* ip, table_flat_t* table);
+GENERIC sfrt_flat_poptrie_lookup(const snort::SfIp* ip, table_flat_t* table);
+int sfrt_flat_poptrie_build(table_flat_t* table);
+uint32_t sfrt_flat_poptrie_usage(table_flat_t* table);
+bool sfrt_flat_poptrie_check(const table_flat_t* table, size_t size);
 
 int sfrt_flat_insert(snort::SfCidr* cidr, unsigned char len, INFO ptr, int behavior,
-    table_flat_t* table, updateEntryInfoFunc updateEntry);
+    table_flat_t* table, updateEntryInfoFunc updateEntry, void* update_ctx = nullptr);
+GENERIC sfrt_flat_exact_lookup(const snort::SfCidr* cidr, unsigned char len, table_flat_t* table);
+table_flat_t* sfrt_flat_copy(const table_flat_t* src, uint32_t max_size,
+    copyEntryInfoFunc copyEntry);
 uint32_t sfrt_flat_usage(table_flat_t* table);
 uint32_t sfrt_flat_num_entries(table_flat_t* table);
+bool sfrt_flat_check(const table_flat_t* table, size_t size);
 
 #endif
 
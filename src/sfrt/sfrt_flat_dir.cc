@@ -25,7 +25,9 @@
 #include "sfrt_flat.h" // FIXIT-L these includes are circular
 #include "sfrt_flat_dir.h"
 
+#include <algorithm>
 #include <cstdarg>
+#include <cstring>
 
 #if SIZEOF_UNSIGNED_LONG_INT == 8
 #define ARCH_WIDTH 64
@@ -262,7 +264,8 @@ static inline void _dir_fill_less_specific(int index, int fill,
 #endif
 
 static inline int64_t _dir_update_info(int index, int fill,
-    word length, uint32_t val, SUB_TABLE_PTR sub_ptr, updateEntryInfoFunc updateEntry, INFO* data)
+    word length, uint32_t val, SUB_TABLE_PTR sub_ptr, updateEntryInfoFunc updateEntry,
+    void* update_ctx, INFO* data)
 {
     dir_sub_table_flat_t* subtable;
     uint8_t* base;
@@ -291,7 +294,7 @@ static inline int64_t _dir_update_info(int index, int fill,
             int64_t bytesAllocated;
             dir_sub_table_flat_t* next = (dir_sub_table_flat_t*)(&base[entry[index].value]);
             bytesAllocated = _dir_update_info(0, 1 << next->width, length, val,
-                    entry[index].value, updateEntry, data);
+                    entry[index].value, updateEntry, update_ctx, data);
             if (bytesAllocated < 0)
                 return bytesAllocated;
             else
@@ -303,7 +306,7 @@ static inline int64_t _dir_update_info(int index, int fill,
             {
                 int64_t bytesAllocated;
                 bytesAllocated =  updateEntry(&data[entry[index].value], data[val],
-                    SAVE_TO_NEW, base);
+                    SAVE_TO_NEW, base, update_ctx);
                 if (bytesAllocated < 0)
                     return bytesAllocated;
                 else
@@ -317,7 +320,7 @@ static inline int64_t _dir_update_info(int index, int fill,
         {
             int64_t bytesAllocated;
             bytesAllocated = updateEntry(&data[entry[index].value], data[val],
-                SAVE_TO_CURRENT,  base);
+                SAVE_TO_CURRENT,  base, update_ctx);
             if (bytesAllocated < 0)
                 return bytesAllocated;
             else
@@ -339,7 +342,7 @@ static inline int64_t _dir_update_info(int index, int fill,
 static int _dir_sub_insert(IPLOOKUP* ip, int length, int cur_len, INFO ptr,
     int current_depth, int behavior,
     SUB_TABLE_PTR sub_ptr, dir_table_flat_t* root_table,updateEntryInfoFunc updateEntry,
-    INFO* data)
+    void* update_ctx, INFO* data)
 {
     word index;
     uint8_t* base = (uint8_t*)segment_basePtr();
@@ -400,7 +403,7 @@ static int _dir_sub_insert(IPLOOKUP* ip, int length, int cur_len, INFO ptr,
             int64_t bytesAllocated;
 
             bytesAllocated = _dir_update_info(index, fill, length, (word)ptr,
-                sub_ptr, updateEntry, data);
+                sub_ptr, updateEntry, update_ctx, data);
 
             if (bytesAllocated < 0)
                 return MEM_ALLOC_FAILURE;
@@ -444,7 +447,7 @@ static int _dir_sub_insert(IPLOOKUP* ip, int length, int cur_len, INFO ptr,
         ip->bits += sub_table->width;
         return (_dir_sub_insert(ip, length,
                cur_len - sub_table->width, ptr, current_depth+1,
-               behavior, entry[index].value, root_table, updateEntry, data));
+               behavior, entry[index].value, root_table, updateEntry, update_ctx, data));
     }
 
     return RT_SUCCESS;
@@ -452,7 +455,8 @@ static int _dir_sub_insert(IPLOOKUP* ip, int length, int cur_len, INFO ptr,
 
 /* Insert entry into DIR-n-m tables */
 int sfrt_dir_flat_insert(const uint32_t* addr, int /* numAddrDwords */, int len, word data_index,
-    int behavior, TABLE_PTR table_ptr, updateEntryInfoFunc updateEntry, INFO* data)
+    int behavior, TABLE_PTR table_ptr, updateEntryInfoFunc updateEntry, void* update_ctx,
+    INFO* data)
 {
     dir_table_flat_t* root;
     uint8_t* base;
@@ -497,7 +501,7 @@ int sfrt_dir_flat_insert(const uint32_t* addr, int /* numAddrDwords */, int len,
 
     /* Find the sub table in which to insert */
     return _dir_sub_insert(&iplu, len, len, data_index,
-        0, behavior, root->sub_table, root, updateEntry, data);
+        0, behavior, root->sub_table, root, updateEntry, update_ctx, data);
 }
 
 /* Traverse sub tables looking for match
@@ -578,6 +582,200 @@ tuple_flat_t sfrt_dir_flat_lookup(const uint32_t* addr, int numAddrDwords, TABLE
     return _dir_sub_flat_lookup(&iplu, root->sub_table);
 }
 
+/* Check whether all addresses starting with the first "len" bits of the
+ * host order address "h_addr" resolve to the same entry; if so, return it.
+ * The bits of "h_addr" after "len" must be clear. */
+bool sfrt_dir_flat_uniform(const uint32_t* h_addr, int len, TABLE_PTR table_ptr,
+    tuple_flat_t* tuple)
+{
+    uint8_t* base = (uint8_t*)segment_basePtr();
+    dir_table_flat_t* root;
+    SUB_TABLE_PTR sub_ptr;
+    int bits = 0;
+
+    tuple->index = 0;
+    tuple->length = 0;
+
+    if (!table_ptr)
+        return true;
+
+    root = (dir_table_flat_t*)(&base[table_ptr]);
+    sub_ptr = root->sub_table;
+
+    while (sub_ptr)
+    {
+        dir_sub_table_flat_t* sub = (dir_sub_table_flat_t*)(&base[sub_ptr]);
+        DIR_Entry* entry = (DIR_Entry*)(&base[sub->entries]);
+        uint32_t index = (h_addr[bits / 32] << (bits % 32)) >> (32 - sub->width);
+
+        if (bits + sub->width <= len)
+        {
+            if ( !entry[index].value || entry[index].length )
+            {
+                tuple->index = entry[index].value;
+                tuple->length = entry[index].length;
+                return true;
+            }
+            sub_ptr = entry[index].value;
+            bits += sub->width;
+            continue;
+        }
+
+        /* the prefix ends inside this table, so it spans a run of entries */
+        uint32_t count = 1 << (bits + sub->width - len);
+
+        for (uint32_t i = index; i < index + count; i++)
+        {
+            if ( entry[i].value && !entry[i].length )
+                return false;
+
+            if ( entry[i].value != entry[index].value )
+                return false;
+        }
+        tuple->index = entry[index].value;
+        tuple->length = entry[index].length;
+        return true;
+    }
+
+    return true;
+}
+
+/* Copy a sub table and the sub tables below it.  Data indexes are replaced
+ * by what remap returns for them, 0 if the copy should fail. */
+static SUB_TABLE_PTR _sub_table_flat_copy(dir_table_flat_t* root, const uint8_t* src_base,
+    SUB_TABLE_PTR src_ptr, FLAT_INDEX (* remap)(FLAT_INDEX, void*), void* context)
+{
+    const dir_sub_table_flat_t* src = (const dir_sub_table_flat_t*)(&src_base[src_ptr]);
+    const DIR_Entry* src_entry = (const DIR_Entry*)(&src_base[src->entries]);
+
+    SUB_TABLE_PTR sub_ptr = segment_snort_alloc(sizeof(dir_sub_table_flat_t));
+    ENTRIES_PTR entries_ptr = segment_snort_alloc(sizeof(DIR_Entry) * src->num_entries);
+
+    if (!sub_ptr or !entries_ptr)
+        return 0;
+
+    uint8_t* base = (uint8_t*)segment_basePtr();
+    dir_sub_table_flat_t* sub = (dir_sub_table_flat_t*)(&base[sub_ptr]);
+    DIR_Entry* entry = (DIR_Entry*)(&base[entries_ptr]);
+
+    *sub = *src;
+    sub->entries = entries_ptr;
+
+    for (int index = 0; index < src->num_entries; index++)
+    {
+        MEM_OFFSET value = src_entry[index].value;
+
+        entry[index].length = src_entry[index].length;
+
+        /* The entry is a pointer if it has a value but no length */
+        if ( !value )
+            entry[index].value = 0;
+
+        else if ( !src_entry[index].length )
+            entry[index].value = _sub_table_flat_copy(root, src_base, value, remap, context);
+
+        else
+            entry[index].value = remap(value, context);
+
+        if ( value and !entry[index].value )
+            return 0;
+    }
+
+    root->allocated += sizeof(dir_sub_table_flat_t) + sizeof(DIR_Entry) * sub->num_entries;
+    root->cur_num++;
+
+    return sub_ptr;
+}
+
+/* Copy the DIR-n-m table "src", held in the segment at "src_base", to the
+ * current segment.  Only the sub tables reachable from the root are copied. */
+TABLE_PTR sfrt_dir_flat_copy(const uint8_t* src_base, TABLE_PTR src,
+    FLAT_INDEX (* remap)(FLAT_INDEX, void*), void* context)
+{
+    const dir_table_flat_t* src_table = (const dir_table_flat_t*)(&src_base[src]);
+    TABLE_PTR table_ptr = segment_snort_alloc(sizeof(dir_table_flat_t));
+
+    if (!table_ptr)
+        return 0;
+
+    uint8_t* base = (uint8_t*)segment_basePtr();
+    dir_table_flat_t* table = (dir_table_flat_t*)(&base[table_ptr]);
+
+    *table = *src_table;
+    table->allocated = sizeof(dir_table_flat_t) + sizeof(int) * table->dim_size;
+    table->cur_num = 0;
+
+    if (src_table->sub_table)
+    {
+        table->sub_table = _sub_table_flat_copy(table, src_base, src_table->sub_table,
+            remap, context);
+
+        if (!table->sub_table)
+            return 0;
+    }
+
+    return table_ptr;
+}
+
+/* Check a sub table read from an untrusted source and the sub tables below it.
+ * "budget" bounds the number of sub tables walked, so shared sub tables can't
+ * make the walk explode. */
+static bool _sub_table_flat_check(const uint8_t* base, size_t size,
+    const dir_table_flat_t* root, SUB_TABLE_PTR sub_ptr, int depth, FLAT_INDEX num_ent,
+    uint64_t& budget)
+{
+    if (!budget-- or !segment_contains(sub_ptr, sizeof(dir_sub_table_flat_t), size))
+        return false;
+
+    const dir_sub_table_flat_t* sub = (const dir_sub_table_flat_t*)(&base[sub_ptr]);
+
+    if (sub->width != root->dimensions[depth] or sub->num_entries != 1 << sub->width or
+        !segment_contains(sub->entries, sizeof(DIR_Entry) * sub->num_entries, size))
+        return false;
+
+    const DIR_Entry* entry = (const DIR_Entry*)(&base[sub->entries]);
+
+    for (int index = 0; index < sub->num_entries; index++)
+    {
+        if (entry[index].length)
+        {
+            if (entry[index].value >= num_ent)
+                return false;
+        }
+        /* The entry is a pointer if it has a value but no length */
+        else if (entry[index].value)
+        {
+            if (depth + 1 >= root->dim_size or !_sub_table_flat_check(base, size, root,
+                entry[index].value, depth + 1, num_ent, budget))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/* Check that the DIR-n-m table "table_ptr", in the "size" bytes at "base",
+ * has the dimensions "dims", only refers to memory inside those bytes and
+ * only holds data indexes below "num_ent" */
+bool sfrt_dir_flat_check(const uint8_t* base, size_t size, TABLE_PTR table_ptr,
+    const int* dims, int dim_size, FLAT_INDEX num_ent)
+{
+    if (!table_ptr or !segment_contains(table_ptr, sizeof(dir_table_flat_t), size))
+        return false;
+
+    const dir_table_flat_t* root = (const dir_table_flat_t*)(&base[table_ptr]);
+
+    if (root->dim_size != dim_size or memcmp(root->dimensions, dims, sizeof(int) * dim_size) or
+        !root->sub_table)
+        return false;
+
+    /* every sub table takes room in the segment */
+    uint64_t budget = std::min((uint64_t)(unsigned)root->cur_num,
+        (uint64_t)(size / sizeof(dir_sub_table_flat_t)));
+
+    return _sub_table_flat_check(base, size, root, root->sub_table, 0, num_ent, budget);
+}
+
 uint32_t sfrt_dir_flat_usage(TABLE_PTR table_ptr)
 {
     dir_table_flat_t* table;
@@ -71,8 +71,14 @@ typedef struct
 TABLE_PTR sfrt_dir_flat_new(uint32_t mem_cap, int count,...);
 tuple_flat_t sfrt_dir_flat_lookup(const uint32_t* addr, int numAddrDwords, TABLE_PTR table);
 int sfrt_dir_flat_insert(const uint32_t* addr, int numAddrDwords, int len, word data_index,
-                    int behavior, TABLE_PTR, updateEntryInfoFunc updateEntry, INFO *data);
+                    int behavior, TABLE_PTR, updateEntryInfoFunc updateEntry, void* update_ctx,
+                    INFO *data);
 uint32_t sfrt_dir_flat_usage(TABLE_PTR);
+TABLE_PTR sfrt_dir_flat_copy(const uint8_t* src_base, TABLE_PTR src,
+    FLAT_INDEX (* remap)(FLAT_INDEX, void*), void* context);
+bool sfrt_dir_flat_uniform(const uint32_t* h_addr, int len, TABLE_PTR, tuple_flat_t*);
+bool sfrt_dir_flat_check(const uint8_t* base, size_t size, TABLE_PTR, const int* dims,
+    int dim_size, FLAT_INDEX num_ent);
 
 #endif /* SFRT_FLAT_DIR_H */
 
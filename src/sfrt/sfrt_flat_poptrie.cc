@@ -0,0 +1,407 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// sfrt_flat_poptrie.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "sfrt_flat.h"
+#include "sfrt_flat_poptrie.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "sfip/sf_ip.h"
+
+using namespace snort;
+
+namespace
+{
+struct PoptrieBuild
+{
+    std::vector<uint32_t> direct;
+    std::vector<poptrie_node_t> nodes;
+    std::vector<uint32_t> leaves;
+};
+}
+
+/* Set "width" bits of the 128 bit key at "offset"; bits past the end of the
+ * key are dropped */
+static void put_bits(uint64_t& hi, uint64_t& lo, unsigned offset, unsigned width,
+    uint64_t value)
+{
+    for (unsigned b = 0; b < width; b++)
+    {
+        uint64_t bit = (value >> (width - 1 - b)) & 1;
+        unsigned pos = offset + b;
+
+        if (pos < 64)
+            hi |= bit << (63 - pos);
+        else if (pos < 128)
+            lo |= bit << (127 - pos);
+    }
+}
+
+static inline unsigned get_slot(uint64_t hi, uint64_t lo, unsigned offset)
+{
+    if (offset + POPTRIE_STRIDE <= 64)
+        return (hi >> (64 - POPTRIE_STRIDE - offset)) & 0x3f;
+
+    if (offset >= 64)
+    {
+        offset -= 64;
+        if (offset + POPTRIE_STRIDE <= 64)
+            return (lo >> (64 - POPTRIE_STRIDE - offset)) & 0x3f;
+        return (lo << (offset + POPTRIE_STRIDE - 64)) & 0x3f;
+    }
+
+    return ((hi << (offset + POPTRIE_STRIDE - 64)) |
+        (lo >> (128 - POPTRIE_STRIDE - offset))) & 0x3f;
+}
+
+static bool is_uniform(uint64_t hi, uint64_t lo, unsigned len, unsigned addr_bits,
+    TABLE_PTR rt, uint32_t* index)
+{
+    uint32_t h_addr[4] =
+    {
+        (uint32_t)(hi >> 32), (uint32_t)hi, (uint32_t)(lo >> 32), (uint32_t)lo
+    };
+    tuple_flat_t tuple;
+
+    if (len > addr_bits)
+        len = addr_bits;
+
+    if (addr_bits == 32)
+        h_addr[1] = h_addr[2] = h_addr[3] = 0;
+
+    if (!sfrt_dir_flat_uniform(h_addr, len, rt, &tuple))
+        return false;
+
+    *index = tuple.index;
+    return true;
+}
+
+static void build_node(PoptrieBuild& pt, TABLE_PTR rt, unsigned addr_bits,
+    uint64_t hi, uint64_t lo, unsigned offset, uint32_t node_index)
+{
+    uint32_t values[64];
+    uint64_t vector = 0;
+    uint64_t leafvec = 0;
+    unsigned num_children = 0;
+
+    for (unsigned slot = 0; slot < 64; slot++)
+    {
+        uint64_t slot_hi = hi, slot_lo = lo;
+        put_bits(slot_hi, slot_lo, offset, POPTRIE_STRIDE, slot);
+
+        if (!is_uniform(slot_hi, slot_lo, offset + POPTRIE_STRIDE, addr_bits, rt, &values[slot]))
+        {
+            vector |= 1ULL << slot;
+            num_children++;
+        }
+    }
+
+    poptrie_node_t node;
+    node.base0 = pt.leaves.size();
+    node.base1 = pt.nodes.size();
+
+    bool have_leaf = false;
+    uint32_t last_leaf = 0;
+
+    for (unsigned slot = 0; slot < 64; slot++)
+    {
+        if ( vector & (1ULL << slot) )
+            continue;
+
+        if ( !have_leaf or values[slot] != last_leaf )
+        {
+            leafvec |= 1ULL << slot;
+            pt.leaves.emplace_back(values[slot]);
+            last_leaf = values[slot];
+            have_leaf = true;
+        }
+    }
+
+    node.vector = vector;
+    node.leafvec = leafvec;
+    pt.nodes.resize(pt.nodes.size() + num_children);
+    pt.nodes[node_index] = node;
+
+    uint32_t child = node.base1;
+
+    for (unsigned slot = 0; slot < 64; slot++)
+    {
+        if ( !(vector & (1ULL << slot)) )
+            continue;
+
+        uint64_t slot_hi = hi, slot_lo = lo;
+        put_bits(slot_hi, slot_lo, offset, POPTRIE_STRIDE, slot);
+        build_node(pt, rt, addr_bits, slot_hi, slot_lo, offset + POPTRIE_STRIDE, child++);
+    }
+}
+
+static void build_root(PoptrieBuild& pt, TABLE_PTR rt, unsigned addr_bits)
+{
+    pt.direct.resize(1 << POPTRIE_DIRECT_BITS);
+
+    for (uint32_t i = 0; i < pt.direct.size(); i++)
+    {
+        uint64_t hi = (uint64_t)i << (64 - POPTRIE_DIRECT_BITS);
+        uint32_t value;
+
+        if (is_uniform(hi, 0, POPTRIE_DIRECT_BITS, addr_bits, rt, &value))
+        {
+            pt.direct[i] = POPTRIE_LEAF | value;
+            continue;
+        }
+
+        uint32_t node_index = pt.nodes.size();
+        pt.nodes.resize(node_index + 1);
+        build_node(pt, rt, addr_bits, hi, 0, POPTRIE_DIRECT_BITS, node_index);
+        pt.direct[i] = node_index;
+    }
+}
+
+static MEM_OFFSET copy_to_segment(const void* data, size_t size, size_t align)
+{
+    MEM_OFFSET ptr = segment_snort_alloc(size + align);
+
+    if (!ptr)
+        return 0;
+
+    uint8_t* base = (uint8_t*)segment_basePtr();
+    MEM_OFFSET aligned = ptr + (align - (uintptr_t)&base[ptr] % align) % align;
+
+    memcpy(&base[aligned], data, size);
+    return aligned;
+}
+
+static bool save_root(const PoptrieBuild& pt, poptrie_root_t* root, uint32_t* allocated)
+{
+    size_t direct_size = pt.direct.size() * sizeof(uint32_t);
+    size_t nodes_size = pt.nodes.size() * sizeof(poptrie_node_t);
+    size_t leaves_size = pt.leaves.size() * sizeof(uint32_t);
+
+    root->direct = copy_to_segment(pt.direct.data(), direct_size, sizeof(uint32_t));
+    root->nodes = copy_to_segment(pt.nodes.data(), nodes_size, sizeof(uint64_t));
+    root->leaves = copy_to_segment(pt.leaves.data(), leaves_size, sizeof(uint32_t));
+
+    if (!root->direct or !root->nodes or !root->leaves)
+        return false;
+
+    *allocated += direct_size + nodes_size + leaves_size;
+    return true;
+}
+
+/* Compile the table into a poptrie stored in the current segment.  The
+ * poptrie is a snapshot: it must be rebuilt after further inserts. */
+int sfrt_flat_poptrie_build(table_flat_t* table)
+{
+    if (!table || !table->rt || !table->rt6)
+        return RT_INSERT_FAILURE;
+
+    table->poptrie = 0;
+
+    MEM_OFFSET pt_ptr = segment_snort_calloc(1, sizeof(poptrie_flat_t) + sizeof(uint64_t));
+
+    if (!pt_ptr)
+        return MEM_ALLOC_FAILURE;
+
+    PoptrieBuild pt4, pt6;
+    build_root(pt4, table->rt, 32);
+    build_root(pt6, table->rt6, 128);
+
+    uint8_t* base = (uint8_t*)segment_basePtr();
+    poptrie_flat_t* pt = (poptrie_flat_t*)&base[pt_ptr];
+    pt->allocated = sizeof(poptrie_flat_t);
+
+    if (!save_root(pt4, &pt->root4, &pt->allocated) or
+        !save_root(pt6, &pt->root6, &pt->allocated))
+        return MEM_ALLOC_FAILURE;
+
+    table->poptrie = pt_ptr;
+    return RT_SUCCESS;
+}
+
+uint32_t sfrt_flat_poptrie_usage(table_flat_t* table)
+{
+    if (!table || !table->poptrie)
+        return 0;
+
+    const uint8_t* base = (const uint8_t*)table;
+    return ((const poptrie_flat_t*)&base[table->poptrie])->allocated;
+}
+
+// without hardware popcnt enabled at build time the builtin is a library call
+static inline unsigned popcount(uint64_t v)
+{
+#ifdef __POPCNT__
+    return __builtin_popcountll(v);
+#else
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (v * 0x0101010101010101ULL) >> 56;
+#endif
+}
+
+static inline uint32_t poptrie_lookup(const uint8_t* base, const poptrie_root_t& root,
+    uint64_t hi, uint64_t lo)
+{
+    const uint32_t* direct = (const uint32_t*)&base[root.direct];
+    uint32_t index = direct[hi >> (64 - POPTRIE_DIRECT_BITS)];
+
+    if (index & POPTRIE_LEAF)
+        return index & ~POPTRIE_LEAF;
+
+    const poptrie_node_t* nodes = (const poptrie_node_t*)&base[root.nodes];
+    const poptrie_node_t* node = &nodes[index];
+    unsigned offset = POPTRIE_DIRECT_BITS;
+    unsigned slot = get_slot(hi, lo, offset);
+
+    while (node->vector & (1ULL << slot))
+    {
+        node = &nodes[node->base1 + popcount(node->vector & ((2ULL << slot) - 1)) - 1];
+        offset += POPTRIE_STRIDE;
+        slot = get_slot(hi, lo, offset);
+    }
+
+    const uint32_t* leaves = (const uint32_t*)&base[root.leaves];
+    return leaves[node->base0 + popcount(node->leafvec & ((2ULL << slot) - 1)) - 1];
+}
+
+/* Same as sfrt_flat_dir8x_lookup() but walks the poptrie, which must have
+ * been built with sfrt_flat_poptrie_build() */
+GENERIC sfrt_flat_poptrie_lookup(const SfIp* ip, table_flat_t* table)
+{
+    const uint8_t* base = (const uint8_t*)table;
+    const poptrie_flat_t* pt = (const poptrie_flat_t*)&base[table->poptrie];
+    const INFO* data = (const INFO*)&base[table->data];
+    uint32_t index;
+
+    if (ip->is_ip4())
+    {
+        uint64_t hi = (uint64_t)ntohl(*ip->get_ip4_ptr()) << 32;
+        index = poptrie_lookup(base, pt->root4, hi, 0);
+    }
+    else if (ip->is_ip6())
+    {
+        const uint32_t* addr = ip->get_ip6_ptr();
+        uint64_t hi = ((uint64_t)ntohl(addr[0]) << 32) | ntohl(addr[1]);
+        uint64_t lo = ((uint64_t)ntohl(addr[2]) << 32) | ntohl(addr[3]);
+        index = poptrie_lookup(base, pt->root6, hi, lo);
+    }
+    else
+        return nullptr;
+
+    if (data[index])
+        return (GENERIC)&base[data[index]];
+
+    return nullptr;
+}
+
+static bool poptrie_root_check(const uint8_t* base, size_t size, const poptrie_root_t& root,
+    unsigned addr_bits, FLAT_INDEX num_ent)
+{
+    if (!segment_contains(root.direct, sizeof(uint32_t) << POPTRIE_DIRECT_BITS, size))
+        return false;
+
+    const uint32_t* direct = (const uint32_t*)&base[root.direct];
+    uint64_t num_nodes = 0;
+
+    for (uint32_t i = 0; i < (1 << POPTRIE_DIRECT_BITS); i++)
+    {
+        if (!(direct[i] & POPTRIE_LEAF))
+            num_nodes = std::max(num_nodes, (uint64_t)direct[i] + 1);
+
+        else if ((direct[i] & ~POPTRIE_LEAF) >= num_ent)
+            return false;
+    }
+
+    // children are stored after their parent, so a single pass in index
+    // order sees every node and knows its depth when it gets to it
+    if (!segment_contains(root.nodes, num_nodes * sizeof(poptrie_node_t), size))
+        return false;
+
+    const poptrie_node_t* nodes = (const poptrie_node_t*)&base[root.nodes];
+    std::vector<uint8_t> depth(num_nodes, 0);
+    uint64_t num_leaves = 0;
+
+    for (uint32_t i = 0; i < num_nodes; i++)
+    {
+        const poptrie_node_t& node = nodes[i];
+        uint64_t no_child = ~node.vector;
+
+        // the first slot without a child starts a run of leaves
+        if (no_child and !(node.leafvec & (no_child & -no_child)))
+            return false;
+
+        if (node.leafvec)
+            num_leaves = std::max(num_leaves, (uint64_t)node.base0 + popcount(node.leafvec));
+
+        if (!node.vector)
+            continue;
+
+        // the children must not need address bits past the end
+        unsigned offset = POPTRIE_DIRECT_BITS + POPTRIE_STRIDE * depth[i];
+
+        if (node.base1 <= i or offset + POPTRIE_STRIDE >= addr_bits)
+            return false;
+
+        uint64_t end = (uint64_t)node.base1 + popcount(node.vector);
+        num_nodes = std::max(num_nodes, end);
+
+        if (!segment_contains(root.nodes, num_nodes * sizeof(poptrie_node_t), size))
+            return false;
+
+        depth.resize(num_nodes, 0);
+
+        for (uint64_t child = node.base1; child < end; child++)
+            depth[child] = std::max(depth[child], (uint8_t)(depth[i] + 1));
+    }
+
+    if (!segment_contains(root.leaves, num_leaves * sizeof(uint32_t), size))
+        return false;
+
+    const uint32_t* leaves = (const uint32_t*)&base[root.leaves];
+
+    for (uint64_t i = 0; i < num_leaves; i++)
+    {
+        if (leaves[i] >= num_ent)
+            return false;
+    }
+
+    return true;
+}
+
+/* Check that the poptrie of a table loaded from an untrusted source, taking
+ * "size" bytes from "table", only refers to memory inside them and only
+ * yields data indexes of the table */
+bool sfrt_flat_poptrie_check(const table_flat_t* table, size_t size)
+{
+    if (!segment_contains(table->poptrie, sizeof(poptrie_flat_t), size))
+        return false;
+
+    const uint8_t* base = (const uint8_t*)table;
+    const poptrie_flat_t* pt = (const poptrie_flat_t*)&base[table->poptrie];
+
+    return poptrie_root_check(base, size, pt->root4, 32, table->num_ent) and
+        poptrie_root_check(base, size, pt->root6, 128, table->num_ent);
+}
@@ -0,0 +1,60 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// sfrt_flat_poptrie.h
+
+#ifndef SFRT_FLAT_POPTRIE_H
+#define SFRT_FLAT_POPTRIE_H
+
+// Poptrie (Asai and Ohara, SIGCOMM 2015) compiled from the DIR-n-m tables.
+// The first 18 bits index a direct array; the rest of the address is
+// consumed 6 bits at a time by nodes whose children and leaves are stored
+// contiguously and located by counting the bits set in the node's vectors,
+// so a node is 24 bytes however sparse it is. Like the rest of sfrt_flat,
+// everything lives in the segment and is referenced by offset.
+
+#include <cstdint>
+
+#include "utils/segment_mem.h"
+
+#define POPTRIE_DIRECT_BITS 18
+#define POPTRIE_STRIDE 6
+#define POPTRIE_LEAF 0x80000000
+
+typedef struct
+{
+    uint64_t vector;    /* slots that continue in a child node */
+    uint64_t leafvec;   /* slots that start a run of identical leaves */
+    uint32_t base0;     /* first leaf of this node */
+    uint32_t base1;     /* first child of this node */
+} poptrie_node_t;
+
+typedef struct
+{
+    MEM_OFFSET direct;  /* 1 << POPTRIE_DIRECT_BITS node indices or leaves */
+    MEM_OFFSET nodes;
+    MEM_OFFSET leaves;  /* indices into the table's data array */
+} poptrie_root_t;
+
+typedef struct
+{
+    poptrie_root_t root4;
+    poptrie_root_t root6;
+    uint32_t allocated;
+} poptrie_flat_t;
+
+#endif
@@ -0,0 +1,271 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// sfrt_poptrie_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "sfip/sf_cidr.h"
+#include "sfrt/sfrt_flat.h"
+
+using namespace snort;
+
+namespace snort
+{
+char* snort_strdup(const char* str) { return strdup(str); }
+}
+
+// the first insert of a prefix stores its payload, later ones keep it
+static int64_t keep_entry(INFO* current, INFO new_entry, SaveDest, uint8_t*, void*)
+{
+    if (!*current)
+        *current = new_entry;
+    return 0;
+}
+
+class TestTable
+{
+public:
+    TestTable(size_t size, uint32_t max_entries) : size(size)
+    {
+        segment = (uint8_t*)malloc(size);
+        segment_meminit(segment, size);
+        table = sfrt_flat_new(DIR_8x16, IPv6, max_entries, (size >> 20) - 1);
+    }
+
+    ~TestTable()
+    { free(segment); }
+
+    bool insert(const SfIp& ip, unsigned bits)
+    {
+        SfCidr cidr;
+        cidr.set(ip);
+        unsigned len = ip.is_ip4() ? bits + 96 : bits;
+        cidr.set_bits(len);
+
+        MEM_OFFSET payload = segment_snort_calloc(1, sizeof(uint32_t));
+        if (!payload)
+            return false;
+
+        return sfrt_flat_insert(&cidr, len, payload, RT_FAVOR_ALL, table, keep_entry) ==
+            RT_SUCCESS;
+    }
+
+    size_t used() const
+    { return size - segment_unusedmem(); }
+
+    uint8_t* segment;
+    size_t size;
+    table_flat_t* table;
+};
+
+static SfIp make_ip4(uint32_t addr)
+{
+    SfIp ip;
+    addr = htonl(addr);
+    ip.set(&addr, AF_INET);
+    return ip;
+}
+
+static SfIp make_ip6(uint64_t hi, uint64_t lo)
+{
+    uint32_t addr[4] =
+    {
+        htonl((uint32_t)(hi >> 32)), htonl((uint32_t)hi),
+        htonl((uint32_t)(lo >> 32)), htonl((uint32_t)lo)
+    };
+    SfIp ip;
+    ip.set(addr, AF_INET6);
+    return ip;
+}
+
+static uint32_t mask4(uint32_t addr, unsigned bits)
+{ return bits ? addr & ~((1ULL << (32 - bits)) - 1) : 0; }
+
+static uint64_t mask64(uint64_t addr, unsigned bits)
+{ return bits >= 64 ? addr : (bits ? addr & ~((1ULL << (64 - bits)) - 1) : 0); }
+
+// prefix lengths roughly follow a routing table: mostly /24 for IPv4 and
+// /32 or /48 allocations clustered under a few thousand /16s for IPv6
+static void fill_table(TestTable& t, unsigned num4, unsigned num6, std::vector<SfIp>& probes)
+{
+    std::mt19937_64 rng(42);
+
+    for (unsigned i = 0; i < num4; i++)
+    {
+        uint32_t addr = (uint32_t)rng();
+        unsigned r = rng() % 100;
+        unsigned bits = r < 60 ? 24 : (r < 95 ? 16 + r % 8 : (r < 98 ? 8 + r % 8 : 32));
+
+        t.insert(make_ip4(mask4(addr, bits)), bits);
+        probes.emplace_back(make_ip4(addr));
+        probes.emplace_back(make_ip4((uint32_t)rng()));
+    }
+
+    for (unsigned i = 0; i < num6; i++)
+    {
+        uint64_t hi = (0x2000ULL | (rng() % 2048)) << 48 | (rng() & 0xffffffffffffULL);
+        uint64_t lo = rng();
+        unsigned r = rng() % 100;
+        unsigned bits = r < 50 ? 32 : (r < 90 ? 48 : (r < 98 ? 20 + r % 12 : 128));
+
+        if (bits <= 64)
+            t.insert(make_ip6(mask64(hi, bits), 0), bits);
+        else
+            t.insert(make_ip6(hi, lo), bits);
+
+        probes.emplace_back(make_ip6(hi, lo));
+        probes.emplace_back(make_ip6(hi ^ (rng() & 0xffffffff), rng()));
+    }
+}
+
+#ifdef CATCH_TEST_BUILD
+
+TEST_CASE("poptrie agrees with DIR-8x16", "[sfrt]")
+{
+    TestTable t(256 << 20, 1 << 16);
+    std::vector<SfIp> probes;
+
+    SECTION("empty table")
+    {
+        SfIp ip4 = make_ip4(0x0a000001);
+        SfIp ip6 = make_ip6(1, 1);
+
+        REQUIRE(sfrt_flat_poptrie_build(t.table) == RT_SUCCESS);
+        CHECK(sfrt_flat_poptrie_lookup(&ip4, t.table) == nullptr);
+        CHECK(sfrt_flat_poptrie_lookup(&ip6, t.table) == nullptr);
+    }
+
+    SECTION("nested prefixes")
+    {
+        REQUIRE(t.insert(make_ip4(0x0a000000), 8));
+        REQUIRE(t.insert(make_ip4(0x0a010000), 16));
+        REQUIRE(t.insert(make_ip4(0x0a010200), 24));
+        REQUIRE(t.insert(make_ip4(0x0a010203), 32));
+        REQUIRE(t.insert(make_ip4(0x0a0102fc), 30));
+        REQUIRE(t.insert(make_ip6(0x20010db800000000ULL, 0), 32));
+        REQUIRE(t.insert(make_ip6(0x20010db800010000ULL, 0), 48));
+        REQUIRE(t.insert(make_ip6(0x20010db800010000ULL, 1), 128));
+        REQUIRE(t.insert(make_ip6(0x20010db800010000ULL, 0x8000000000000000ULL), 65));
+        REQUIRE(sfrt_flat_poptrie_build(t.table) == RT_SUCCESS);
+
+        for (uint32_t a : { 0x0a000000u, 0x0a010000u, 0x0a0101ffu, 0x0a010200u, 0x0a010203u,
+                0x0a010204u, 0x0a0102fbu, 0x0a0102fcu, 0x0a0102ffu, 0x0b000000u, 0x09ffffffu })
+        {
+            SfIp ip = make_ip4(a);
+            CHECK(sfrt_flat_poptrie_lookup(&ip, t.table) == sfrt_flat_dir8x_lookup(&ip, t.table));
+        }
+
+        for (uint64_t lo : { 0ULL, 1ULL, 2ULL, 0x8000000000000000ULL, ~0ULL })
+        {
+            for (uint64_t hi : { 0x20010db800000000ULL, 0x20010db800010000ULL,
+                    0x20010db800020000ULL, 0x20010db900000000ULL })
+            {
+                SfIp ip = make_ip6(hi, lo);
+                CHECK(sfrt_flat_poptrie_lookup(&ip, t.table) ==
+                    sfrt_flat_dir8x_lookup(&ip, t.table));
+            }
+        }
+
+        CHECK(sfrt_flat_check(t.table, t.used()));
+    }
+
+    SECTION("random prefixes")
+    {
+        fill_table(t, 20000, 5000, probes);
+        REQUIRE(sfrt_flat_poptrie_build(t.table) == RT_SUCCESS);
+
+        unsigned mismatches = 0;
+        unsigned hits = 0;
+
+        for (const auto& ip : probes)
+        {
+            GENERIC expected = sfrt_flat_dir8x_lookup(&ip, t.table);
+            mismatches += sfrt_flat_poptrie_lookup(&ip, t.table) != expected;
+            hits += expected != nullptr;
+        }
+        CHECK(mismatches == 0);
+        CHECK(hits > probes.size() / 4);
+
+        CHECK(sfrt_flat_check(t.table, t.used()));
+        CHECK(!sfrt_flat_check(t.table, t.used() / 2));
+    }
+}
+
+#endif // CATCH_TEST_BUILD
+
+#ifdef BENCHMARK_TEST
+
+TEST_CASE("sfrt lookup, 1M IPv4 and 500k IPv6 prefixes", "[sfrt]")
+{
+    TestTable t((size_t)3 << 30, 1600000);
+    std::vector<SfIp> probes;
+
+    fill_table(t, 1000000, 500000, probes);
+    REQUIRE(sfrt_flat_poptrie_build(t.table) == RT_SUCCESS);
+
+    printf("DIR-8x16 %u bytes, poptrie %u bytes\n", sfrt_flat_usage(t.table),
+        sfrt_flat_poptrie_usage(t.table));
+
+    std::vector<SfIp> probes4, probes6;
+    for (const auto& ip : probes)
+        (ip.is_ip4() ? probes4 : probes6).emplace_back(ip);
+
+    BENCHMARK("DIR-8x16 IPv4")
+    {
+        unsigned found = 0;
+        for (const auto& ip : probes4)
+            found += sfrt_flat_dir8x_lookup(&ip, t.table) != nullptr;
+        return found;
+    };
+
+    BENCHMARK("poptrie IPv4")
+    {
+        unsigned found = 0;
+        for (const auto& ip : probes4)
+            found += sfrt_flat_poptrie_lookup(&ip, t.table) != nullptr;
+        return found;
+    };
+
+    BENCHMARK("DIR-8x16 IPv6")
+    {
+        unsigned found = 0;
+        for (const auto& ip : probes6)
+            found += sfrt_flat_dir8x_lookup(&ip, t.table) != nullptr;
+        return found;
+    };
+
+    BENCHMARK("poptrie IPv6")
+    {
+        unsigned found = 0;
+        for (const auto& ip : probes6)
+            found += sfrt_flat_poptrie_lookup(&ip, t.table) != nullptr;
+        return found;
+    };
+}
+
+#endif // BENCHMARK_TEST
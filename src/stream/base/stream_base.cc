@@ -30,11 +30,13 @@
 #include "log/messages.h"
 #include "main/snort_config.h"
 #include "main/snort_types.h"
+#include "main/thread_config.h"
 #include "managers/inspector_manager.h"
 #include "profiler/profiler_defs.h"
 #include "protocols/packet.h"
 #include "protocols/tcp.h"
 #include "stream/flush_bucket.h"
+#include "stream/tcp/reassembly_memcap.h"
 #include "stream/tcp/tcp_stream_tracker.h"
 
 #include "stream_ha.h"
@@ -214,6 +216,7 @@ void StreamBase::tinit()
         flow_con->init_exp(config.flow_cache_cfg.max_flows);
 
     TcpStreamTracker::set_held_packet_timeout(config.held_packet_timeout);
+    ReassemblyMemcap::tinit(config.reassembly_memcap, ThreadConfig::get_instance_max());
 
 #ifdef REG_TEST
     FlushBucket::set(config.footprint);
@@ -229,6 +232,7 @@ void StreamBase::tterm()
     base_prep();
     delete flow_con;
     flow_con = nullptr;
+    ReassemblyMemcap::tterm();
 }
 
 void StreamBase::show(const SnortConfig* sc) const
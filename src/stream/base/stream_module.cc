@@ -56,7 +56,7 @@ static THREAD_LOCAL timeval reload_time { };
 static const Parameter name[] = \
 { \
     { "idle_timeout", Parameter::PT_INT, "1:max32", idle, \
-      "maximum inactive time before retiring session tracker" }, \
+      "maximum inactive time before retiring session tracker with no session timeout" }, \
  \
     { "cap_weight", Parameter::PT_INT, "0:65535", weight, \
       "additional bytes to track per flow for better estimation against cap" }, \
@@ -94,6 +94,9 @@ static const Parameter s_params[] =
     { "held_packet_timeout", Parameter::PT_INT, "1:max32", "1000",
       "timeout in milliseconds for held packets" },
 
+    { "reassembly_memcap", Parameter::PT_INT, "0:maxSZ", "0",
+      "maximum bytes queued for TCP reassembly by all packet threads before releasing the largest flows (0 is unlimited)" },
+
     FLOW_TYPE_TABLE("ip_cache",   "ip",   ip_params),
     FLOW_TYPE_TABLE("icmp_cache", "icmp", icmp_params),
     FLOW_TYPE_TABLE("tcp_cache",  "tcp",  tcp_params),
@@ -191,6 +194,11 @@ bool StreamModule::set(const char* fqn, Value& v, SnortConfig* c)
         config.held_packet_timeout = v.get_uint32();
         return true;
     }
+    else if ( v.is("reassembly_memcap") )
+    {
+        config.reassembly_memcap = v.get_size();
+        return true;
+    }
     else if ( strstr(fqn, "ip_cache") )
         type = PktType::IP;
     else if ( strstr(fqn, "icmp_cache") )
@@ -349,6 +357,7 @@ void StreamModuleConfig::show() const
     ConfigLogger::log_value("max_flows", flow_cache_cfg.max_flows);
     ConfigLogger::log_value("max_aux_ip", SnortConfig::get_conf()->max_aux_ip);
     ConfigLogger::log_value("pruning_timeout", flow_cache_cfg.pruning_timeout);
+    ConfigLogger::log_value("reassembly_memcap", (uint64_t)reassembly_memcap);
 
     for (int i = to_utype(PktType::IP); i < to_utype(PktType::PDU); ++i)
     {
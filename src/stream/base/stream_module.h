@@ -87,6 +87,7 @@ struct StreamModuleConfig
     unsigned footprint = 0;
 #endif
     uint32_t held_packet_timeout = 1000;  // in milliseconds
+    size_t reassembly_memcap = 0;
 
     void show() const;
 };
@@ -82,6 +82,7 @@
 #include "profiler/profiler_defs.h"
 #include "protocols/ipv4_options.h"
 #include "time/timersub.h"
+#include "utils/list_treap.h"
 #include "utils/safec.h"
 #include "utils/stats.h"
 #include "utils/util.h"
@@ -116,6 +117,9 @@ using namespace snort;
 #define FRAG_LAST_DUPLICATE     1
 #define FRAG_LAST_OFFSET_ADJUST 2
 
+/* fragment data up to this size is kept in the node itself */
+#define FRAG_INLINE_DATA 128
+
 /*  D A T A   S T R U C T U R E S  **********************************/
 
 
@@ -135,10 +139,14 @@ struct Fragment
 
     ~Fragment()
     {
-        delete[] fptr;
+        if ( fptr != buf )
+            delete[] fptr;
         ip_stats.nodes_released++;
     }
 
+    static void* operator new(size_t);
+    static void operator delete(void*);
+
     uint8_t* data = nullptr;    /* ptr to adjusted start position */
     uint16_t size = 0;          /* adjusted frag size */
     uint16_t offset = 0;        /* adjusted offset position */
@@ -152,21 +160,138 @@ struct Fragment
     int ord = 0;
     char last = 0;
 
+    /* treap over the fraglist in list order */
+    Fragment* parent = nullptr;
+    Fragment* lchild = nullptr;
+    Fragment* rchild = nullptr;
+    uint32_t prio = 0;
+    uint16_t min_key = 0;       /* min offset in this subtree */
+    uint16_t max_key = 0;       /* max offset in this subtree */
+
 private:
     inline void init(uint16_t flen, const uint8_t* fptr, int ord)
     {
         assert(flen > 0);
 
         this->flen = flen;
-        this->fptr = new uint8_t[flen];
+        this->fptr = flen <= sizeof(buf) ? buf : new uint8_t[flen];
         this->ord = ord;
 
         memcpy(this->fptr, fptr, flen);
 
         ip_stats.nodes_created++;
     }
+
+    uint8_t buf[FRAG_INLINE_DATA];
 };
 
+/*  F R A G M E N T   P O O L  **************************************/
+
+/*
+ * Each packet thread preallocates stream_ip.prealloc_frags nodes so that
+ * storing a fragment doesn't hit the heap, and with the data of tiny
+ * fragments kept inline a flood of them doesn't allocate at all.  When
+ * the pool runs dry nodes come from the heap.  The pool is released
+ * when the thread terminates or, if fragments are still stored then,
+ * when the last one is freed.
+ */
+class FragPool
+{
+public:
+    FragPool(unsigned n)
+    {
+        if ( !n )
+            return;
+
+        slab = (uint8_t*)snort_calloc(n, sizeof(Fragment));
+        slab_end = slab + n * sizeof(Fragment);
+
+        for ( uint8_t* p = slab_end; p > slab; )
+        {
+            p -= sizeof(Fragment);
+            Node* node = (Node*)p;
+            node->next = free_list;
+            free_list = node;
+        }
+    }
+
+    ~FragPool()
+    { snort_free(slab); }
+
+    void* get()
+    {
+        if ( !free_list or closing )
+            return nullptr;
+
+        Node* node = free_list;
+        free_list = node->next;
+        in_use++;
+        return node;
+    }
+
+    bool put(void* p)
+    {
+        if ( (uint8_t*)p < slab or (uint8_t*)p >= slab_end )
+            return false;
+
+        Node* node = (Node*)p;
+        node->next = free_list;
+        free_list = node;
+        in_use--;
+        return true;
+    }
+
+    bool close()
+    {
+        closing = true;
+        return !in_use;
+    }
+
+    bool closed() const
+    { return closing and !in_use; }
+
+private:
+    struct Node
+    {
+        Node* next;
+    };
+
+    uint8_t* slab = nullptr;
+    uint8_t* slab_end = nullptr;
+    Node* free_list = nullptr;
+    unsigned in_use = 0;
+    bool closing = false;
+};
+
+static THREAD_LOCAL FragPool* frag_pool = nullptr;
+
+void* Fragment::operator new(size_t n)
+{
+    assert(n == sizeof(Fragment));
+
+    if ( frag_pool )
+    {
+        if ( void* p = frag_pool->get() )
+            return p;
+    }
+    ip_stats.pool_misses++;
+    return snort_alloc(n);
+}
+
+void Fragment::operator delete(void* p)
+{
+    if ( frag_pool and frag_pool->put(p) )
+    {
+        if ( frag_pool->closed() )
+        {
+            delete frag_pool;
+            frag_pool = nullptr;
+        }
+        return;
+    }
+    snort_free(p);
+}
+
 /*  G L O B A L S  **************************************************/
 
 /* enum for policy names */
@@ -724,6 +849,41 @@ static void FragRebuild(FragTracker* ft, Packet* p)
     ft->frag_flags |= FRAG_REBUILT;
 }
 
+/*
+ * Inserting a fragment starts with the first fragment in the fraglist at or
+ * above its offset.  Walking the list to find it is quadratic under a flood
+ * of tiny overlapping fragments, so the list is also kept in a ListTreap.
+ * Overlap handling can leave the list out of offset order, the treap finds
+ * the same fragment as the walk anyway.
+ */
+struct FragIndex
+{
+    static uint16_t key(const Fragment* node)
+    { return node->offset; }
+
+    static bool less(uint16_t a, uint16_t b)
+    { return a < b; }
+};
+
+using FragTree = ListTreap<Fragment, uint16_t, FragIndex>;
+
+// overlap trimming only moves the start of a fragment up
+static inline void move_node(Fragment* node, uint16_t offset)
+{
+    assert(offset >= node->offset);
+    node->offset = offset;
+    FragTree::rekey(node);
+}
+
+// get the fragment after which one at the given offset goes
+static Fragment* find_left(FragTracker* ft, uint16_t offset)
+{
+    if ( Fragment* node = FragTree::find_first_geq(ft->fragtree, offset) )
+        return node->prev;
+
+    return ft->fraglist ? ft->fraglist_tail : nullptr;
+}
+
 /**
  * Plug a Fragment into the fraglist of a FragTracker
  *
@@ -756,6 +916,7 @@ static inline void add_node(FragTracker* ft, Fragment* prev, Fragment* node)
         ft->fraglist = node;
     }
 
+    FragTree::insert(ft->fragtree, prev, node);
     ft->fraglist_count++;
 }
 
@@ -764,6 +925,8 @@ static inline void delete_node(FragTracker* ft, Fragment* node)
     debug_logf(stream_ip_trace, nullptr, "Deleting list node %p (p %p n %p)\n",
         (void*) node, (void*) node->prev, (void*) node->next);
 
+    FragTree::remove(ft->fragtree, node);
+
     if (node->prev)
     {
         node->prev->next = node->next;
@@ -806,6 +969,8 @@ static void delete_tracker(FragTracker* ft)
         delete dump_me;
     }
     ft->fraglist = nullptr;
+    ft->fraglist_tail = nullptr;
+    ft->fragtree = nullptr;
     if (ft->ip_options_data)
     {
         snort_free(ft->ip_options_data);
@@ -843,6 +1008,23 @@ void Defrag::show() const
     ConfigLogger::log_value("min_frag_length", engine.min_fragment_length);
     ConfigLogger::log_value("min_ttl", engine.min_ttl);
     ConfigLogger::log_value("policy", frag_policy_names[engine.frag_policy]);
+    ConfigLogger::log_value("prealloc_frags", engine.prealloc_frags);
+}
+
+// the pool is sized by the first instance and kept across reloads
+void Defrag::tinit()
+{
+    if ( !frag_pool )
+        frag_pool = new FragPool(engine.prealloc_frags);
+}
+
+void Defrag::tterm()
+{
+    if ( frag_pool and frag_pool->close() )
+    {
+        delete frag_pool;
+        frag_pool = nullptr;
+    }
 }
 
 void Defrag::cleanup(FragTracker* ft)
@@ -1058,7 +1240,6 @@ int Defrag::insert(Packet* p, FragTracker* ft, FragEngine* fe)
     int16_t slide = 0;      /* slide up the front of the current frag */
     int done = 0;           /* flag for right-side overlap handling loop */
     int addthis = 1;        /* flag for right-side overlap handling loop */
-    int i = 0;              /* counter */
     int firstLastOk;
     int ret = FRAG_INSERT_OK;
     unsigned char lastfrag = 0;     /* Set to 1 when this is the 'last' frag */
@@ -1066,7 +1247,6 @@ int Defrag::insert(Packet* p, FragTracker* ft, FragEngine* fe)
     Fragment* right = nullptr;      /* frag ptr for right-side overlap loop */
     Fragment* newfrag = nullptr;    /* new frag container */
     Fragment* left = nullptr;       /* left-side overlap fragment ptr */
-    Fragment* idx = nullptr;        /* indexing fragment pointer for loops */
     Fragment* dump_me = nullptr;    /* frag ptr for complete overlaps to dump */
     const uint8_t* fragStart;
     int16_t fragLength;
@@ -1199,28 +1379,10 @@ int Defrag::insert(Packet* p, FragTracker* ft, FragEngine* fe)
      * Need to figure out where in the frag list this frag should go
      * and who its neighbors are
      */
-    for (idx = ft->fraglist; idx; idx = idx->next)
-    {
-        i++;
-        right = idx;
-
-        debug_logf(stream_ip_trace, p, "%d right o %d s %d ptr %p prv %p nxt %p\n",
-            i, right->offset, right->size, (void*) right,
-            (void*) right->prev, (void*) right->next);
-
-        if (right->offset >= frag_offset)
-        {
-            break;
-        }
-
-        left = right;
-    }
+    left = find_left(ft, frag_offset);
+    right = left ? left->next : ft->fraglist;
 
-    /*
-     * null things out if we walk to the end of the list
-     */
-    if (idx == nullptr)
-        right = nullptr;
+    debug_logf(stream_ip_trace, p, "left %p right %p\n", (void*) left, (void*) right);
 
     /*
      * handle forward (left-side) overlaps...
@@ -1340,7 +1502,7 @@ int Defrag::insert(Packet* p, FragTracker* ft, FragEngine* fe)
                     left->size -= (int16_t)overlap;
                     ft->frag_bytes -= (int16_t)overlap;
 
-                    right->offset = frag_offset + len;
+                    move_node(right, frag_offset + len);
                     right->size -= (frag_offset + len - left->offset);
                     right->data += (frag_offset + len - left->offset);
                     ft->frag_bytes -= (frag_offset + len - left->offset);
@@ -1461,7 +1623,7 @@ left_overlap_last:
                 }
                 else
                 {
-                    right->offset += (int16_t)overlap;
+                    move_node(right, right->offset + (int16_t)overlap);
                     right->data += (int16_t)overlap;
                     right->size -= (int16_t)overlap;
                     ft->frag_bytes -= (int16_t)overlap;
@@ -1832,9 +1994,7 @@ int Defrag::new_tracker(Packet* p, FragTracker* ft)
     }
 
     /* insert the fragment into the frag list */
-    ft->fraglist = f;
-    ft->fraglist_tail = f;
-    ft->fraglist_count = 1;  /* Are these duplicates? */
+    add_node(ft, nullptr, f);
     ft->frag_pkts = 1;
 
     /*
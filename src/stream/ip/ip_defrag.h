@@ -45,6 +45,9 @@ public:
     void process(snort::Packet*, FragTracker*);
     void cleanup(FragTracker*);
 
+    void tinit();
+    static void tterm();
+
     static void init();
 
 private:
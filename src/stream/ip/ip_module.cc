@@ -118,6 +118,9 @@ static const Parameter s_params[] =
     { "policy", Parameter::PT_ENUM, IP_POLICIES, "linux",
       "fragment reassembly policy" },
 
+    { "prealloc_frags", Parameter::PT_INT, "0:65535", "1024",
+      "number of fragments preallocated per packet thread" },
+
     { "session_timeout", Parameter::PT_INT, "1:max31", "60",
       "session tracking timeout" },
 
@@ -178,6 +181,9 @@ bool StreamIpModule::set(const char*, Value& v, SnortConfig*)
     else if ( v.is("policy") )
         config->frag_engine.frag_policy = v.get_uint16() + 1;
 
+    else if ( v.is("prealloc_frags") )
+        config->frag_engine.prealloc_frags = v.get_uint32();
+
     else if ( v.is("session_timeout") )
     {
         // FIXIT-L need to integrate to eliminate redundant data
@@ -81,6 +81,7 @@ struct IpStats
     PegCount nodes_released;
     PegCount reassembled_bytes; // total_ipreassembled_bytes
     PegCount fragmented_bytes;  // total_ipfragmented_bytes
+    PegCount pool_misses;
 };
 
 extern const PegInfo ip_pegs[];
@@ -72,6 +72,8 @@ public:
     bool configure(SnortConfig*) override;
     void show(const SnortConfig*) const override;
 
+    void tinit() override;
+
     NORETURN_ASSERT void eval(Packet*) override;
 
 public:
@@ -106,6 +108,11 @@ void StreamIp::show(const SnortConfig*) const
     ConfigLogger::log_value("session_timeout", config->session_timeout);
 }
 
+void StreamIp::tinit()
+{
+    defrag->tinit();
+}
+
 NORETURN_ASSERT void StreamIp::eval(Packet*)
 {
     // session::process() instead
@@ -142,6 +149,7 @@ static void ip_tinit()
 static void ip_tterm()
 {
     IpHAManager::tterm();
+    Defrag::tterm();
 }
 
 static Inspector* ip_ctor(Module* m)
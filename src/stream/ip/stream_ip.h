@@ -46,6 +46,7 @@ struct FragEngine
     uint32_t max_frags;
     uint32_t max_overlaps;
     uint32_t min_fragment_length;
+    uint32_t prealloc_frags; /* fragment nodes pooled per packet thread */
 
     uint32_t frag_timeout; /* timeout for frags in this policy */
     uint16_t frag_policy;  /* policy to use for engine-based reassembly */
@@ -0,0 +1,425 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// ip_defrag_test.cc
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// the fragment index and pool are private to ip_defrag.cc
+#include "../ip_defrag.cc"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "detection/ips_context.h"
+
+using namespace snort;
+
+//-------------------------------------------------------------------------
+// stubs
+//-------------------------------------------------------------------------
+
+THREAD_LOCAL IpStats ip_stats;
+THREAD_LOCAL const Trace* stream_ip_trace = nullptr;
+
+static Packet* rebuilt = nullptr;
+static std::vector<std::string> reassembled;
+
+namespace snort
+{
+void ConfigLogger::log_value(const char*, const char*, bool) { }
+void ConfigLogger::log_value(const char*, int, bool) { }
+void ConfigLogger::log_value(const char*, unsigned int, bool) { }
+
+int PacketManager::encode_format(
+    EncodeFlags, const Packet*, Packet*, PseudoPacketType, const DAQ_PktHdr_t*, uint32_t)
+{ return 0; }
+void PacketManager::encode_update(Packet*) { }
+
+DetectionEngine::DetectionEngine() { }
+DetectionEngine::~DetectionEngine() { }
+int DetectionEngine::queue_event(unsigned, unsigned) { return 0; }
+void DetectionEngine::disable_content(Packet*) { }
+Packet* DetectionEngine::set_next_packet(Packet*, Flow*) { return rebuilt; }
+void DetectionEngine::set_encode_packet(Packet*) { }
+
+void Active::daq_drop_packet(const Packet*) { }
+
+const ip::IP6Frag* layer::get_inner_ip6_frag() { return nullptr; }
+
+namespace ip
+{
+IpOptionIterator::IpOptionIterator(const IP4Hdr*, const Packet*) { }
+IpOptionIteratorIter IpOptionIterator::begin() const { return IpOptionIteratorIter(nullptr); }
+IpOptionIteratorIter IpOptionIterator::end() const { return IpOptionIteratorIter(nullptr); }
+IpOptionIteratorIter::IpOptionIteratorIter(const IpOptions* p) : opt(p) { }
+const IpOptions& IpOptionIteratorIter::operator*() const { return *opt; }
+
+void IpApi::set(const IP4Hdr* h4)
+{
+    iph = h4;
+    type = IAT_4;
+}
+
+uint16_t IpApi::off() const
+{ return ((const IP4Hdr*)iph)->off(); }
+
+uint8_t IpApi::ttl() const
+{ return ((const IP4Hdr*)iph)->ttl(); }
+
+uint16_t IpApi::dgram_len() const
+{ return ((const IP4Hdr*)iph)->len(); }
+}
+
+Packet::Packet(bool) { }
+Packet::~Packet() = default;
+
+IpsContext::IpsContext(unsigned) { }
+IpsContext::~IpsContext() = default;
+
+SnortConfig::SnortConfig(const SnortConfig* const, const char*)
+{ daq_config = new SFDAQConfig; }
+
+SnortConfig::~SnortConfig()
+{ delete daq_config; }
+}
+
+FragEngine::FragEngine()
+{ memset(this, 0, sizeof(*this)); }
+
+SFDAQConfig::SFDAQConfig() : batch_size(BATCH_SIZE_UNSET), mru_size(SNAPLEN_UNSET), timeout(0) { }
+SFDAQConfig::~SFDAQConfig() = default;
+
+Analyzer* Analyzer::get_local_analyzer()
+{
+    static Analyzer* analyzer = (Analyzer*)&reassembled;
+    return analyzer;
+}
+
+bool Analyzer::process_rebuilt_packet(Packet* p, const DAQ_PktHdr_t*, const uint8_t*, uint32_t)
+{
+    reassembled.emplace_back((const char*)p->data, p->dsize);
+    return true;
+}
+
+//-------------------------------------------------------------------------
+// helpers
+//-------------------------------------------------------------------------
+
+static void pool_init(uint32_t n)
+{
+    FragEngine engine;
+    engine.prealloc_frags = n;
+
+    Defrag defrag(engine);
+    defrag.tinit();
+}
+
+struct Datagram
+{
+    Datagram(uint16_t policy)
+    {
+        engine.frag_policy = policy;
+        engine.min_ttl = 1;
+        engine.frag_timeout = 60;
+
+        defrag = new Defrag(engine);
+
+        conf = new SnortConfig(nullptr, nullptr);
+        context = new IpsContext(0);
+        context->conf = conf;
+
+        flow = (Flow*)snort_calloc(sizeof(Flow));
+        memset(&tracker, 0, sizeof(tracker));
+
+        rebuilt = &out;
+        out.data = out_buf;
+        out.ptrs.ip_api.set((const ip::IP4Hdr*)out_hdr);
+        reassembled.clear();
+    }
+
+    ~Datagram()
+    {
+        defrag->cleanup(&tracker);
+
+        snort_free(flow);
+        delete context;
+        delete conf;
+        delete defrag;
+    }
+
+    void add(uint16_t off, uint16_t len, char c, bool more = true)
+    {
+        Packet p(false);
+        DAQ_PktHdr_t pkth { };
+        Active active { };
+        ip::IP4Hdr iph { };
+        std::string data(len, c);
+
+        iph.ip_verhl = 0x45;
+        iph.ip_ttl = 64;
+        iph.ip_off = htons((off >> 3) | (more ? 0x2000 : 0));
+
+        p.ptrs.ip_api.set(&iph);
+        p.ptrs.decode_flags = DECODE_FRAG | (more ? DECODE_MF : 0);
+        p.data = (const uint8_t*)data.data();
+        p.dsize = len;
+        p.pkth = &pkth;
+        p.flow = flow;
+        p.context = context;
+        p.active = &active;
+
+        defrag->process(&p, &tracker);
+    }
+
+    FragEngine engine;
+    Defrag* defrag;
+    SnortConfig* conf;
+    IpsContext* context;
+    Flow* flow;
+    FragTracker tracker;
+
+    Packet out { false };
+    uint8_t out_buf[IP_MAXPACKET] { };
+    alignas(4) uint8_t out_hdr[ip::IP4_HEADER_LEN] { 0x45 };
+};
+
+#ifdef CATCH_TEST_BUILD
+
+static Fragment* check_tree(Fragment* node, Fragment* first)
+{
+    if ( node->lchild )
+    {
+        REQUIRE(node->lchild->parent == node);
+        REQUIRE(node->lchild->prio <= node->prio);
+        first = check_tree(node->lchild, first);
+    }
+    REQUIRE(node == first);
+    first = node->next;
+
+    if ( node->rchild )
+    {
+        REQUIRE(node->rchild->parent == node);
+        REQUIRE(node->rchild->prio <= node->prio);
+        first = check_tree(node->rchild, first);
+    }
+    uint16_t min = node->offset;
+    uint16_t max = node->offset;
+
+    if ( node->lchild )
+    {
+        min = std::min(min, node->lchild->min_key);
+        max = std::max(max, node->lchild->max_key);
+    }
+
+    if ( node->rchild )
+    {
+        min = std::min(min, node->rchild->min_key);
+        max = std::max(max, node->rchild->max_key);
+    }
+
+    REQUIRE(node->min_key == min);
+    REQUIRE(node->max_key == max);
+    return first;
+}
+
+// the index mirrors the fraglist and finds the same neighbors as a walk
+static void check_index(FragTracker* ft)
+{
+    if ( ft->fragtree )
+    {
+        REQUIRE(!ft->fragtree->parent);
+        REQUIRE(!check_tree(ft->fragtree, ft->fraglist));
+    }
+    else
+        REQUIRE(!ft->fraglist);
+
+    for ( unsigned off = 0; off < 2100; off += 4 )
+    {
+        Fragment* left = nullptr;
+        Fragment* frag;
+
+        for ( frag = ft->fraglist; frag and frag->offset < off; frag = frag->next )
+            left = frag;
+
+        REQUIRE(find_left(ft, off) == left);
+    }
+}
+
+TEST_CASE("defrag reassembles out of order fragments", "[defrag]")
+{
+    for ( uint16_t policy = FRAG_POLICY_FIRST; policy <= FRAG_POLICY_SOLARIS; policy++ )
+    {
+        Datagram dg(policy);
+        std::vector<uint16_t> offs;
+
+        for ( uint16_t off = 0; off < 800; off += 8 )
+            offs.emplace_back(off);
+
+        std::mt19937 rng(policy);
+        std::shuffle(offs.begin(), offs.end(), rng);
+
+        for ( auto off : offs )
+        {
+            bool last = off == 792;
+            dg.add(off, 8, 'a' + off / 8 % 26, !last);
+        }
+        REQUIRE(reassembled.size() == 1);
+
+        std::string expect;
+
+        for ( uint16_t off = 0; off < 800; off += 8 )
+            expect.append(8, 'a' + off / 8 % 26);
+
+        CHECK(reassembled[0] == expect);
+    }
+}
+
+TEST_CASE("defrag overlap policies", "[defrag]")
+{
+    SECTION("first")
+    {
+        Datagram dg(FRAG_POLICY_FIRST);
+        dg.add(0, 16, 'a');
+        dg.add(8, 16, 'b');
+        dg.add(24, 8, 'c', false);
+        REQUIRE(reassembled.size() == 1);
+        CHECK(reassembled[0] == std::string(16, 'a') + std::string(8, 'b') + std::string(8, 'c'));
+    }
+    SECTION("last")
+    {
+        Datagram dg(FRAG_POLICY_LAST);
+        dg.add(0, 16, 'a');
+        dg.add(8, 16, 'b');
+        dg.add(24, 8, 'c', false);
+        REQUIRE(reassembled.size() == 1);
+        CHECK(reassembled[0] == std::string(8, 'a') + std::string(16, 'b') + std::string(8, 'c'));
+    }
+    SECTION("last splits the old fragment")
+    {
+        Datagram dg(FRAG_POLICY_LAST);
+        dg.add(0, 32, 'a');
+        dg.add(8, 8, 'b');
+        dg.add(32, 8, 'c', false);
+        REQUIRE(reassembled.size() == 1);
+        CHECK(reassembled[0] == std::string(8, 'a') + std::string(8, 'b') +
+            std::string(16, 'a') + std::string(8, 'c'));
+    }
+}
+
+TEST_CASE("defrag index under tiny overlapping fragments", "[defrag]")
+{
+    pool_init(64);
+
+    for ( uint16_t policy = FRAG_POLICY_FIRST; policy <= FRAG_POLICY_SOLARIS; policy++ )
+    {
+        Datagram dg(policy);
+        std::mt19937 rng(policy);
+
+        for ( unsigned n = 0; n < 3000; n++ )
+        {
+            uint16_t off = (rng() % 256) * 8;
+            uint16_t len = (1 + rng() % 4) * 8;
+            dg.add(off, len, 'a' + n % 26);
+
+            REQUIRE(dg.tracker.engine);
+            check_index(&dg.tracker);
+        }
+        unsigned count = 0;
+
+        for ( Fragment* frag = dg.tracker.fraglist; frag; frag = frag->next )
+            count++;
+
+        CHECK(count > 64);
+    }
+    Defrag::tterm();
+    CHECK(!frag_pool);
+}
+
+TEST_CASE("defrag pool", "[defrag]")
+{
+    ip_stats.pool_misses = 0;
+    pool_init(8);
+    Datagram dg(FRAG_POLICY_LINUX);
+
+    for ( uint16_t off = 0; off < 64; off += 8 )
+        dg.add(off, 8, 'a');
+
+    CHECK(ip_stats.pool_misses == 0);
+
+    dg.add(64, 8, 'a');
+    CHECK(ip_stats.pool_misses == 1);
+
+    // the pool is released with its last fragment after tterm
+    Defrag::tterm();
+    CHECK(frag_pool);
+    dg.defrag->cleanup(&dg.tracker);
+    CHECK(!frag_pool);
+}
+
+#endif
+
+#ifdef BENCHMARK_TEST
+
+// a flood of 8 byte fragments in random order, each overlapped by a 16 byte
+// one, without the last fragment so the datagram is never completed
+static void flood(uint16_t policy, unsigned size)
+{
+    Datagram dg(policy);
+    std::mt19937 rng(1);
+    std::vector<uint16_t> offs;
+
+    for ( uint16_t off = 0; off < size; off += 16 )
+        offs.emplace_back(off);
+
+    std::shuffle(offs.begin(), offs.end(), rng);
+
+    for ( auto off : offs )
+    {
+        dg.add(off, 8, 'a');
+        dg.add(off + 8, 16, 'b');
+    }
+}
+
+TEST_CASE("defrag tiny overlapping fragments", "[defrag]")
+{
+    pool_init(8192);
+
+    BENCHMARK("linux 16K")
+    { flood(FRAG_POLICY_LINUX, 16384); };
+
+    BENCHMARK("linux 64K")
+    { flood(FRAG_POLICY_LINUX, 65000); };
+
+    BENCHMARK("windows 64K")
+    { flood(FRAG_POLICY_WINDOWS, 65000); };
+
+    Defrag::tterm();
+
+    BENCHMARK("linux 64K without pool")
+    { flood(FRAG_POLICY_LINUX, 65000); };
+}
+
+#endif
@@ -43,6 +43,7 @@
 #include "target_based/snort_protocols.h"
 #include "utils/util.h"
 
+#include "tcp/reassembly_memcap.h"
 #include "tcp/tcp_session.h"
 #include "tcp/tcp_stream_session.h"
 #include "tcp/tcp_stream_tracker.h"
@@ -378,6 +379,21 @@ void Stream::handle_timeouts(bool idle)
 
     int max_remove = idle ? -1 : 1;       // -1 = all eligible
     TcpStreamTracker::release_held_packets(cur_time, max_remove);
+
+    if ( flow_con )
+    {
+        unsigned max_prunes = idle ? IDLE_PRUNE_MAX : 1;
+
+        while ( max_prunes-- )
+        {
+            Flow* flow = ReassemblyMemcap::get_victim();
+
+            if ( !flow )
+                break;
+
+            flow_con->release_flow(flow, PruneReason::MEMCAP);
+        }
+    }
 }
 
 bool Stream::prune_flows()
@@ -0,0 +1,197 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// reassembly_memcap.cc
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "reassembly_memcap.h"
+
+#include <atomic>
+#include <cassert>
+
+#include "flow/flow.h"
+#include "main/thread.h"
+
+#include "tcp_module.h"
+
+// flows are listed by the log2 of their queued bytes so one of the largest
+// is found without a scan; within a list they are in the order they reached
+// that size so the oldest goes first
+static constexpr unsigned num_buckets = 33;
+
+// the global total is only updated when a thread's usage has changed this
+// much since it was last published
+static constexpr uint64_t publish_step = 64 * 1024;
+
+struct ThreadUsage
+{
+    ReassemblyMemcapEntry* head[num_buckets];
+    ReassemblyMemcapEntry* tail[num_buckets];
+    uint64_t listed;            // bit per non-empty bucket
+    uint64_t bytes;
+    uint64_t published;
+    uint64_t cap;
+    uint64_t share;
+};
+
+static std::atomic<uint64_t> global_bytes { 0 };
+static THREAD_LOCAL ThreadUsage usage;
+
+static inline unsigned get_bucket(uint32_t bytes)
+{ return bytes ? 32 - __builtin_clz(bytes) : 0; }
+
+static void unlink(ReassemblyMemcapEntry& e)
+{
+    unsigned b = e.bucket;
+
+    if ( e.prev )
+        e.prev->next = e.next;
+    else
+        usage.head[b] = e.next;
+
+    if ( e.next )
+        e.next->prev = e.prev;
+    else
+        usage.tail[b] = e.prev;
+
+    if ( !usage.head[b] )
+        usage.listed &= ~(1ULL << b);
+
+    e.prev = e.next = nullptr;
+}
+
+static void append(ReassemblyMemcapEntry& e, unsigned b)
+{
+    e.bucket = b;
+    e.next = nullptr;
+    e.prev = usage.tail[b];
+
+    if ( e.prev )
+        e.prev->next = &e;
+    else
+        usage.head[b] = &e;
+
+    usage.tail[b] = &e;
+    usage.listed |= 1ULL << b;
+}
+
+static void publish(bool force)
+{
+    uint64_t delta = usage.bytes > usage.published ?
+        usage.bytes - usage.published : usage.published - usage.bytes;
+
+    if ( !force and delta < publish_step )
+        return;
+
+    if ( usage.bytes > usage.published )
+        global_bytes += delta;
+    else
+        global_bytes -= delta;
+
+    usage.published = usage.bytes;
+}
+
+void ReassemblyMemcap::tinit(uint64_t cap, unsigned num_threads)
+{
+    usage.cap = cap;
+    usage.share = num_threads ? cap / num_threads : cap;
+}
+
+void ReassemblyMemcap::tterm()
+{
+    usage.bytes = 0;
+    publish(true);
+}
+
+void ReassemblyMemcap::update(ReassemblyMemcapEntry& e, uint32_t bytes)
+{
+    if ( bytes == e.bytes )
+        return;
+
+    usage.bytes = usage.bytes + bytes - e.bytes;
+    e.bytes = bytes;
+
+    unsigned b = get_bucket(bytes);
+
+    if ( b != e.bucket )
+    {
+        if ( e.bucket )
+            unlink(e);
+
+        if ( b )
+            append(e, b);
+        else
+            e.bucket = 0;
+    }
+    publish(false);
+
+    tcpStats.reassembly_bytes = usage.bytes;
+
+    uint64_t global = global_bytes.load(std::memory_order_relaxed);
+
+    if ( global > tcpStats.max_reassembly_global_bytes )
+        tcpStats.max_reassembly_global_bytes = global;
+}
+
+snort::Flow* ReassemblyMemcap::get_victim()
+{
+    if ( !usage.cap or usage.bytes <= usage.share or !usage.listed )
+        return nullptr;
+
+    if ( global_bytes.load(std::memory_order_relaxed) <= usage.cap )
+        return nullptr;
+
+    for ( uint64_t listed = usage.listed; listed; )
+    {
+        unsigned b = 63 - __builtin_clzll(listed);
+        listed &= ~(1ULL << b);
+
+        ReassemblyMemcapEntry* first = usage.head[b];
+        ReassemblyMemcapEntry* e = first;
+        assert(e);
+
+        do
+        {
+            // so a flow that can't be released doesn't keep the rest from going
+            if ( e->next )
+            {
+                unlink(*e);
+                append(*e, b);
+            }
+            // a suspended flow still has packets out for offload
+            if ( !e->flow->is_suspended() )
+            {
+                tcpStats.reassembly_memcap_prunes++;
+                return e->flow;
+            }
+            e = usage.head[b];
+        }
+        while ( e != first );
+    }
+    return nullptr;
+}
+
+uint64_t ReassemblyMemcap::get_thread_usage()
+{ return usage.bytes; }
+
+uint64_t ReassemblyMemcap::get_global_usage()
+{ return global_bytes.load(std::memory_order_relaxed); }
+
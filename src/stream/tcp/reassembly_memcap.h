@@ -0,0 +1,66 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// reassembly_memcap.h
+
+
+#ifndef REASSEMBLY_MEMCAP_H
+#define REASSEMBLY_MEMCAP_H
+
+// Bytes queued for TCP reassembly are tracked per flow and per packet thread
+// and the thread totals are summed into an approximate global total.  While
+// the global total is over stream.reassembly_memcap, each thread using more
+// than its fair share, the cap divided by the number of packet threads,
+// releases its flows with the most queued bytes first.  So a thread with a
+// few elephant flows frees space by releasing those instead of having the
+// memory manager prune thousands of small flows in LRU order.
+
+#include <cstdint>
+
+namespace snort
+{
+class Flow;
+}
+
+struct ReassemblyMemcapEntry
+{
+    snort::Flow* flow = nullptr;
+    ReassemblyMemcapEntry* prev = nullptr;
+    ReassemblyMemcapEntry* next = nullptr;
+    uint32_t bytes = 0;
+    uint8_t bucket = 0;         // 0 if the flow has nothing queued
+};
+
+class ReassemblyMemcap
+{
+public:
+    // packet threads
+    static void tinit(uint64_t cap, unsigned num_threads);
+    static void tterm();
+
+    // set the bytes the flow has queued, zero before the entry goes away
+    static void update(ReassemblyMemcapEntry&, uint32_t bytes);
+
+    // get the next flow to release to get under the cap, if any
+    static snort::Flow* get_victim();
+
+    static uint64_t get_thread_usage();
+    static uint64_t get_global_usage();
+};
+
+#endif
+
@@ -286,7 +286,7 @@ void SegmentOverlapEditor::left_overlap_keep_last(TcpReassemblerState& trs)
             trs.sos.left->c_len -= (int16_t)trs.sos.overlap;
             trs.sos.left->i_len -= (int16_t)trs.sos.overlap;
 
-            trs.sos.right->i_seq = trs.sos.seq + trs.sos.len;
+            trs.sos.seglist.move(trs.sos.right, trs.sos.seq + trs.sos.len);
             trs.sos.right->c_seq = trs.sos.right->i_seq;
             uint16_t delta = (int16_t)(trs.sos.right->i_seq - trs.sos.left->i_seq);
             trs.sos.right->c_len -= delta;
@@ -315,7 +315,7 @@ void SegmentOverlapEditor::right_overlap_truncate_existing(TcpReassemblerState&
     else
     {
         /* partial overlap */
-        trs.sos.right->i_seq += trs.sos.overlap;
+        trs.sos.seglist.move(trs.sos.right, trs.sos.right->i_seq + trs.sos.overlap);
         trs.sos.right->c_seq = trs.sos.right->i_seq;
         trs.sos.right->offset += trs.sos.overlap;
         trs.sos.right->c_len -= (int16_t)trs.sos.overlap;
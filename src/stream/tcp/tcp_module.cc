@@ -115,6 +115,10 @@ const PegInfo tcp_pegs[] =
     { CountType::MAX, "max_segs", "maximum number of segments queued in any flow" },
     { CountType::MAX, "max_bytes", "maximum number of bytes queued in any flow" },
     { CountType::SUM, "zero_len_tcp_opt", "number of zero length tcp options" },
+    { CountType::SUM, "seglists_indexed", "number of segment lists indexed for out of order inserts" },
+    { CountType::NOW, "reassembly_bytes", "bytes currently queued for reassembly" },
+    { CountType::MAX, "max_reassembly_global_bytes", "maximum bytes queued for reassembly by all threads" },
+    { CountType::SUM, "reassembly_memcap_prunes", "flows with the most queued bytes released to stay under the reassembly memcap" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -113,6 +113,10 @@ struct TcpStats
     PegCount max_segs;
     PegCount max_bytes;
     PegCount zero_len_tcp_opt;
+    PegCount seglists_indexed;
+    PegCount reassembly_bytes;
+    PegCount max_reassembly_global_bytes;
+    PegCount reassembly_memcap_prunes;
 };
 
 extern THREAD_LOCAL struct TcpStats tcpStats;
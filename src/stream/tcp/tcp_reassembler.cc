@@ -1237,6 +1237,23 @@ void TcpReassembler::init_overlap_editor(
             dist_tail = trs.sos.seglist.tail->i_seq - tsd.get_seq();
     }
 
+    // the index finds the same neighbors as the walk from the same end
+    if ( trs.sos.seglist.use_index() )
+    {
+        if ( SEQ_LEQ(dist_head, dist_tail) )
+        {
+            right = trs.sos.seglist.find_right(tsd.get_seq());
+            left = right ? right->prev : trs.sos.seglist.tail;
+        }
+        else
+        {
+            left = trs.sos.seglist.find_left(tsd.get_seq());
+            right = left ? left->next : trs.sos.seglist.head;
+        }
+        trs.sos.init_soe(tsd, left, right);
+        return;
+    }
+
     if ( SEQ_LEQ(dist_head, dist_tail) )
     {
         for ( tsn = trs.sos.seglist.head; tsn; tsn = tsn->next )
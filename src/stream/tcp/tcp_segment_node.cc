@@ -152,3 +152,36 @@ bool TcpSegmentNode::is_retransmit(const uint8_t* rdata, uint16_t rsize,
 
     return false;
 }
+
+//-------------------------------------------------------------------------
+// TcpSegmentList index
+//-------------------------------------------------------------------------
+
+void TcpSegmentList::build()
+{
+    TcpSegmentNode* prev = nullptr;
+
+    // each segment goes right of the last one which has no right child
+    for ( TcpSegmentNode* tsn = head; tsn; tsn = tsn->next )
+    {
+        SegTree::insert(root, prev, tsn);
+        prev = tsn;
+    }
+    tcpStats.seglists_indexed++;
+}
+
+TcpSegmentNode* TcpSegmentList::find_right(uint32_t seq)
+{
+    if ( !root )
+        build();
+
+    return SegTree::find_first_geq(root, seq);
+}
+
+TcpSegmentNode* TcpSegmentList::find_left(uint32_t seq)
+{
+    if ( !root )
+        build();
+
+    return SegTree::find_last_lt(root, seq);
+}
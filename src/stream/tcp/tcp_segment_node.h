@@ -22,6 +22,8 @@
 #ifndef TCP_SEGMENT_H
 #define TCP_SEGMENT_H
 
+#include "utils/list_treap.h"
+
 #include "tcp_segment_descriptor.h"
 #include "tcp_defs.h"
 
@@ -72,6 +74,14 @@ public:
     TcpSegmentNode* prev;
     TcpSegmentNode* next;
 
+    // seq index, only valid while the list is indexed
+    TcpSegmentNode* parent;
+    TcpSegmentNode* lchild;
+    TcpSegmentNode* rchild;
+    uint32_t prio;
+    uint32_t min_key;           // min i_seq of this subtree
+    uint32_t max_key;           // max i_seq of this subtree
+
     struct timeval tv;
     uint32_t ts;
     uint32_t i_seq;             // initial seq # of the data segment
@@ -83,9 +93,28 @@ public:
     uint8_t data[1];
 };
 
+struct TcpSegmentIndex
+{
+    static uint32_t key(const TcpSegmentNode* tsn)
+    { return tsn->i_seq; }
+
+    static bool less(uint32_t a, uint32_t b)
+    { return SEQ_LT(a, b); }
+};
+
+// segments are searched by walking the list from the closer end, which is
+// quadratic for a flow with a long queue of out of order segments.  once a
+// list gets that long it is also indexed with a ListTreap keyed by i_seq.
+// in order flows only append and purge so they never build the index.
 class TcpSegmentList
 {
+    using SegTree = snort::ListTreap<TcpSegmentNode, uint32_t, TcpSegmentIndex>;
+
 public:
+    // shuffled inserts into a list of 128 to 256 segments take half the time
+    // walking, into one of 256 to 512 segments half the time indexed
+    static constexpr uint32_t index_min = 256;
+
     uint32_t reset()
     {
         int i = 0;
@@ -99,6 +128,7 @@ public:
         }
 
         head = tail = cur_rseg = cur_sseg = nullptr;
+        root = nullptr;
         count = 0;
         return i;
     }
@@ -128,6 +158,9 @@ public:
         }
 
         count++;
+
+        if ( root )
+            SegTree::insert(root, prev, ss);
     }
 
     void remove(TcpSegmentNode* ss)
@@ -143,6 +176,33 @@ public:
             tail = ss->prev;
 
         count--;
+
+        if ( root )
+        {
+            if ( count < index_min / 2 )
+                root = nullptr;
+            else
+                SegTree::remove(root, ss);
+        }
+    }
+
+    bool use_index() const
+    { return root or count >= index_min; }
+
+    // get the first segment in list order at or above seq, indexing the
+    // list first if needed; null if there is none
+    TcpSegmentNode* find_right(uint32_t seq);
+
+    // get the last segment in list order below seq, likewise
+    TcpSegmentNode* find_left(uint32_t seq);
+
+    // overlap trimming only moves the start of a segment up
+    void move(TcpSegmentNode* ss, uint32_t seq)
+    {
+        ss->i_seq = seq;
+
+        if ( root )
+            SegTree::rekey(ss);
     }
 
     TcpSegmentNode* head = nullptr;
@@ -150,6 +210,11 @@ public:
     TcpSegmentNode* cur_rseg = nullptr;
     TcpSegmentNode* cur_sseg = nullptr;
     uint32_t count = 0;
+
+private:
+    void build();
+
+    TcpSegmentNode* root = nullptr;
 };
 
 #endif
@@ -85,12 +85,14 @@ TcpSession::TcpSession(Flow* f) : TcpStreamSession(f)
 
     client.session = this;
     server.session = this;
+    memcap_entry.flow = f;
     tcpStats.instantiated++;
 }
 
 TcpSession::~TcpSession()
 {
     clear_session(true, false, false);
+    ReassemblyMemcap::update(memcap_entry, 0);
 }
 
 bool TcpSession::setup(Packet*)
@@ -185,6 +187,7 @@ void TcpSession::clear_session(bool free_flow_data, bool flush_segments, bool re
 
     client.reassembler.purge_segment_list();
     server.reassembler.purge_segment_list();
+    ReassemblyMemcap::update(memcap_entry, 0);
 
     update_perf_base_state(TcpStreamTracker::TCP_CLOSED);
 
@@ -1098,10 +1101,17 @@ bool TcpSession::validate_packet_established_session(TcpSegmentDescriptor& tsd)
     return ( pkt_action_mask & ACTION_BAD_PKT ) ? false : true;
 }
 
+void TcpSession::update_queued_bytes()
+{
+    ReassemblyMemcap::update(memcap_entry,
+        client.reassembler.get_seg_bytes_total() + server.reassembler.get_seg_bytes_total());
+}
+
 int TcpSession::process_tcp_packet(TcpSegmentDescriptor& tsd, const Packet* p)
 {
     tsm->eval(tsd);
     check_events_and_actions(tsd);
+    update_queued_bytes();
 
     S5TraceTCP(tsd, p);
 
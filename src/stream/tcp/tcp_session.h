@@ -20,6 +20,7 @@
 #ifndef TCP_SESSION_H
 #define TCP_SESSION_H
 
+#include "reassembly_memcap.h"
 #include "tcp_state_machine.h"
 #include "tcp_stream_session.h"
 #include "tcp_stream_tracker.h"
@@ -88,10 +89,12 @@ private:
     void init_tcp_packet_analysis(TcpSegmentDescriptor&);
     void check_events_and_actions(const TcpSegmentDescriptor& tsd);
     void flush_tracker(TcpStreamTracker&, snort::Packet*, uint32_t dir, bool final_flush);
+    void update_queued_bytes();
 
 private:
     TcpStateMachine* tsm;
     bool splitter_init;
+    ReassemblyMemcapEntry memcap_entry;
 };
 
 #endif
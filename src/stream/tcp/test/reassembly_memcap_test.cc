@@ -0,0 +1,179 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// reassembly_memcap_test.cc
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <future>
+#include <thread>
+
+#include "catch/catch.hpp"
+
+#include "flow/flow.h"
+#include "stream/tcp/reassembly_memcap.h"
+#include "stream/tcp/tcp_module.h"
+
+using namespace snort;
+
+THREAD_LOCAL TcpStats tcpStats;
+
+Flow::Flow() { memset(this, 0, sizeof(*this)); }
+Flow::~Flow() = default;
+
+static Flow flows[4];
+
+static Flow* make_flow(unsigned n)
+{ return &flows[n]; }
+
+#ifdef CATCH_TEST_BUILD
+
+TEST_CASE("reassembly memcap releases the largest flows first", "[stream_tcp]")
+{
+    ReassemblyMemcap::tinit(1000000, 1);
+
+    ReassemblyMemcapEntry small, medium, large;
+    small.flow = make_flow(1);
+    medium.flow = make_flow(2);
+    large.flow = make_flow(3);
+
+    ReassemblyMemcap::update(small, 10000);
+    ReassemblyMemcap::update(large, 900000);
+    ReassemblyMemcap::update(medium, 200000);
+
+    CHECK(ReassemblyMemcap::get_thread_usage() == 1110000);
+    CHECK(ReassemblyMemcap::get_global_usage() == 1110000);
+
+    CHECK(ReassemblyMemcap::get_victim() == large.flow);
+    ReassemblyMemcap::update(large, 0);
+
+    CHECK(ReassemblyMemcap::get_victim() == nullptr);
+    CHECK(tcpStats.reassembly_memcap_prunes == 1);
+    CHECK(tcpStats.reassembly_bytes == 210000);
+
+    ReassemblyMemcap::update(small, 0);
+    ReassemblyMemcap::update(medium, 0);
+    ReassemblyMemcap::tterm();
+    CHECK(ReassemblyMemcap::get_global_usage() == 0);
+}
+
+TEST_CASE("reassembly memcap rotates flows of the same size", "[stream_tcp]")
+{
+    ReassemblyMemcap::tinit(100000, 1);
+
+    ReassemblyMemcapEntry a, b;
+    a.flow = make_flow(1);
+    b.flow = make_flow(2);
+
+    ReassemblyMemcap::update(a, 70000);
+    ReassemblyMemcap::update(b, 80000);
+
+    // a flow that isn't released doesn't block the next one
+    CHECK(ReassemblyMemcap::get_victim() == a.flow);
+    CHECK(ReassemblyMemcap::get_victim() == b.flow);
+    CHECK(ReassemblyMemcap::get_victim() == a.flow);
+
+    ReassemblyMemcap::update(a, 0);
+    ReassemblyMemcap::update(b, 0);
+    ReassemblyMemcap::tterm();
+}
+
+TEST_CASE("reassembly memcap skips suspended flows", "[stream_tcp]")
+{
+    ReassemblyMemcap::tinit(100000, 1);
+
+    ReassemblyMemcapEntry a, b, c;
+    a.flow = make_flow(1);
+    b.flow = make_flow(2);
+    c.flow = make_flow(3);
+
+    ReassemblyMemcap::update(a, 70000);
+    ReassemblyMemcap::update(b, 80000);
+    ReassemblyMemcap::update(c, 20000);
+
+    // only the front of the chain is looked at
+    int offload;
+    a.flow->context_chain.push_back((IpsContext*)&offload);
+    b.flow->context_chain.push_back((IpsContext*)&offload);
+
+    PegCount prunes = tcpStats.reassembly_memcap_prunes;
+
+    // the largest flows are waiting on offload so a smaller one goes
+    CHECK(ReassemblyMemcap::get_victim() == c.flow);
+    CHECK(ReassemblyMemcap::get_victim() == c.flow);
+
+    ReassemblyMemcap::update(c, 0);
+    CHECK(ReassemblyMemcap::get_victim() == nullptr);
+    CHECK(tcpStats.reassembly_memcap_prunes == prunes + 2);
+
+    b.flow->context_chain.abort();
+    CHECK(ReassemblyMemcap::get_victim() == b.flow);
+
+    a.flow->context_chain.abort();
+    ReassemblyMemcap::update(a, 0);
+    ReassemblyMemcap::update(b, 0);
+    ReassemblyMemcap::tterm();
+}
+
+TEST_CASE("reassembly memcap fair share", "[stream_tcp]")
+{
+    const uint64_t cap = 1000000;
+    ReassemblyMemcap::tinit(cap, 4);
+
+    ReassemblyMemcapEntry mine;
+    mine.flow = make_flow(1);
+    ReassemblyMemcap::update(mine, 300000);
+
+    // over the share of this thread but not the cap
+    CHECK(ReassemblyMemcap::get_victim() == nullptr);
+
+    // another thread with an elephant flow
+    std::promise<void> queued, finish;
+    std::thread other([&queued, &finish, cap]()
+    {
+        ReassemblyMemcapEntry elephant;
+        elephant.flow = make_flow(2);
+
+        ReassemblyMemcap::tinit(cap, 4);
+        ReassemblyMemcap::update(elephant, 900000);
+        queued.set_value();
+
+        finish.get_future().wait();
+        ReassemblyMemcap::update(elephant, 0);
+        ReassemblyMemcap::tterm();
+    });
+    queued.get_future().wait();
+
+    CHECK(ReassemblyMemcap::get_global_usage() == 1200000);
+    CHECK(ReassemblyMemcap::get_victim() == mine.flow);
+
+    // under the share of this thread, so it is up to the other thread
+    ReassemblyMemcap::update(mine, 200000);
+    CHECK(ReassemblyMemcap::get_victim() == nullptr);
+
+    finish.set_value();
+    other.join();
+
+    ReassemblyMemcap::update(mine, 0);
+    ReassemblyMemcap::tterm();
+    CHECK(ReassemblyMemcap::get_global_usage() == 0);
+}
+
+#endif
@@ -0,0 +1,200 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// tcp_segment_list_test.cc
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "stream/tcp/tcp_module.h"
+#include "stream/tcp/tcp_segment_node.h"
+#include "utils/util.h"
+
+THREAD_LOCAL TcpStats tcpStats;
+
+static TcpSegmentNode* make_seg(uint32_t seq)
+{
+    TcpSegmentNode* tsn = (TcpSegmentNode*)snort_calloc(sizeof(TcpSegmentNode));
+    tsn->i_seq = tsn->c_seq = seq;
+    tsn->i_len = tsn->c_len = 1;
+    return tsn;
+}
+
+// what init_overlap_editor() walked from the head to find
+static TcpSegmentNode* walk_right(TcpSegmentList& list, uint32_t seq)
+{
+    TcpSegmentNode* tsn = list.head;
+
+    while ( tsn and SEQ_LT(tsn->i_seq, seq) )
+        tsn = tsn->next;
+
+    return tsn;
+}
+
+// what init_overlap_editor() walked from the tail to find
+static TcpSegmentNode* walk_left(TcpSegmentList& list, uint32_t seq)
+{
+    TcpSegmentNode* tsn = list.tail;
+
+    while ( tsn and !SEQ_LT(tsn->i_seq, seq) )
+        tsn = tsn->prev;
+
+    return tsn;
+}
+
+#ifdef CATCH_TEST_BUILD
+
+static TcpSegmentNode* get(TcpSegmentList& list, unsigned n)
+{
+    TcpSegmentNode* tsn = list.head;
+
+    while ( n-- )
+        tsn = tsn->next;
+
+    return tsn;
+}
+
+static void queue(TcpSegmentList& list, uint32_t seq)
+{
+    TcpSegmentNode* right = list.use_index() ? list.find_right(seq) : walk_right(list, seq);
+    list.insert(right ? right->prev : list.tail, make_seg(seq));
+}
+
+TEST_CASE("segment list index matches walk", "[stream_tcp]")
+{
+    std::mt19937 rng(7);
+    TcpSegmentList list;
+
+    // around the seq wrap
+    const uint32_t base = 0xffff0000;
+
+    for ( unsigned n = 0; n < 20000; ++n )
+    {
+        unsigned op = rng() % 8;
+
+        if ( op < 4 or list.count < 2 )
+            queue(list, base + rng() % 0x20000);
+
+        else if ( op < 6 )
+        {
+            TcpSegmentNode* tsn = get(list, rng() % list.count);
+            list.remove(tsn);
+            tsn->term();
+        }
+        else if ( op == 6 )
+        {
+            TcpSegmentNode* tsn = get(list, rng() % list.count);
+            list.move(tsn, tsn->i_seq + rng() % 64);
+        }
+        else
+        {
+            uint32_t seq = base + rng() % 0x20000;
+
+            if ( list.use_index() )
+            {
+                REQUIRE(list.find_right(seq) == walk_right(list, seq));
+                REQUIRE(list.find_left(seq) == walk_left(list, seq));
+            }
+        }
+    }
+    CHECK(tcpStats.seglists_indexed > 0);
+    list.reset();
+}
+
+TEST_CASE("segment list index threshold", "[stream_tcp]")
+{
+    TcpSegmentList list;
+
+    for ( uint32_t i = 0; i < TcpSegmentList::index_min; ++i )
+        list.insert(list.tail, make_seg(i * 10));
+
+    CHECK(list.use_index());
+    CHECK(list.find_right(15) == list.head->next->next);
+    CHECK(list.find_right(10 * TcpSegmentList::index_min) == nullptr);
+    CHECK(list.find_left(15) == list.head->next);
+    CHECK(list.find_left(0) == nullptr);
+
+    while ( list.count >= TcpSegmentList::index_min / 2 )
+    {
+        TcpSegmentNode* tsn = list.head;
+        list.remove(tsn);
+        tsn->term();
+    }
+    CHECK(!list.use_index());
+    list.reset();
+}
+
+#endif
+
+#ifdef BENCHMARK_TEST
+
+// what init_overlap_editor() walks without the index, from the closer end
+static TcpSegmentNode* walk_near(TcpSegmentList& list, uint32_t seq)
+{
+    if ( !list.head or seq - list.head->i_seq <= list.tail->i_seq - seq )
+        return walk_right(list, seq);
+
+    TcpSegmentNode* left = walk_left(list, seq);
+    return left ? left->next : list.head;
+}
+
+// segments of a window arriving in random order mostly go in the middle
+static void shuffled_queue(const std::vector<uint32_t>& seqs, bool index)
+{
+    TcpSegmentList list;
+
+    for ( auto seq : seqs )
+    {
+        TcpSegmentNode* right = index ? list.find_right(seq) : walk_near(list, seq);
+        list.insert(right ? right->prev : list.tail, make_seg(seq));
+    }
+    list.reset();
+}
+
+TEST_CASE("segment list out of order", "[stream_tcp]")
+{
+    std::mt19937 rng(1);
+    std::vector<uint32_t> seqs;
+
+    for ( uint32_t i = 0; i < 4096; ++i )
+        seqs.emplace_back(i * 1460);
+
+    std::shuffle(seqs.begin(), seqs.end(), rng);
+    std::vector<uint32_t> few(seqs.begin(), seqs.begin() + 1024);
+
+    BENCHMARK("walk 1K")
+    { shuffled_queue(few, false); };
+
+    BENCHMARK("index 1K")
+    { shuffled_queue(few, true); };
+
+    BENCHMARK("walk 4K")
+    { shuffled_queue(seqs, false); };
+
+    BENCHMARK("index 4K")
+    { shuffled_queue(seqs, true); };
+}
+
+#endif
@@ -35,11 +35,14 @@
 
 #include "packet_time.h"
 
+#include <ctime>
+
 #include "main/thread.h"
 #include "time/timersub.h"
 
 static THREAD_LOCAL struct timeval s_recent_packet = { 0, 0 };
 static THREAD_LOCAL uint32_t s_first_packet = 0;
+static THREAD_LOCAL time_t s_thread_time = 0;
 
 namespace snort
 {
@@ -65,6 +68,11 @@ int64_t timersub_ms(const struct timeval* end, const struct timeval* start)
     TIMERSUB(end, start, &difftime);
     return difftime.tv_sec*1000 + difftime.tv_usec/1000;
 }
+
+time_t packet_thread_time()
+{
+    return s_thread_time ? s_thread_time : time(nullptr);
+}
 }
 
 void packet_time_update(const struct timeval* cur_tv)
@@ -83,3 +91,8 @@ uint32_t packet_first_time()
     return s_first_packet;
 }
 
+void packet_thread_time_update()
+{
+    s_thread_time = time(nullptr);
+}
+
@@ -29,9 +29,15 @@ namespace snort
 SO_PUBLIC void packet_gettimeofday(struct timeval* tv);
 SO_PUBLIC time_t packet_time();
 SO_PUBLIC int64_t timersub_ms(const struct timeval* end, const struct timeval* start);
+
+// wall clock seconds for work that needs real rather than packet time but
+// not precision.  packet threads read the clock once per DAQ batch; other
+// threads read it on each call.
+SO_PUBLIC time_t packet_thread_time();
 }
 
 void packet_time_update(const struct timeval* cur_tv);
+void packet_thread_time_update();
 uint32_t packet_first_time();
 
 #endif
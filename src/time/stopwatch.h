@@ -59,6 +59,9 @@ public:
     bool active() const
     { return running; }
 
+    time_point started() const
+    { return start_time; }
+
     void reset()
     { running = false; elapsed = DURA_ZERO; }
 
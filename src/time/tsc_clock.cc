@@ -25,21 +25,34 @@
 
 #include <ctime>
 
+#ifdef USE_TSC_CLOCK
+// counts ticks over a short sleep timed with the monotonic clock; the actual
+// interval is measured so oversleeping doesn't skew the result
+static long calibrate()
+{
+    struct timespec t0, t1;
+    struct timespec nap = { 0, 20000000 };
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &t0);
+    uint64_t start = TscClock::counter();
+    nanosleep(&nap, nullptr);
+    uint64_t end = TscClock::counter();
+    clock_gettime(CLOCK_MONOTONIC_RAW, &t1);
+
+    double usecs = (t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3;
+    long tpus = (long)((end - start) / usecs + 0.5);
+
+    return tpus ? tpus : 1;
+}
+#endif
+
 long clock_scale()
 {
 #ifndef USE_TSC_CLOCK
     return 1;
 #else
-    static long tpus = 0;  // ticks / usec
-
-    if ( !tpus )
-    {
-        struct timespec one_sec = { 1, 0 };
-        uint64_t start = TscClock::counter();
-        nanosleep(&one_sec, nullptr);
-        uint64_t end = TscClock::counter();
-        tpus = (long)((end - start)/1e6);
-    }
+    // ticks / usec; a local static so concurrent first calls are safe
+    static const long tpus = calibrate();
     return tpus;
 #endif
 }
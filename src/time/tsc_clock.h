@@ -37,6 +37,7 @@
 
 struct TscClock
 {
+    typedef uint64_t rep;
     typedef uint64_t duration;
     typedef uint64_t time_point;
 
@@ -23,7 +23,9 @@
 
 #include "js_identifier_ctx.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
 #if !defined(CATCH_TEST_BUILD) && !defined(BENCHMARK_TEST)
 #include "service_inspectors/http_inspect/http_enum.h"
@@ -46,6 +48,7 @@ public:
 
 #define MAX_LAST_NAME     65535
 #define HEX_DIGIT_MASK       15
+#define FLAT_MIN_SLOTS       64
 
 static const char hex_digits[] = 
 {
@@ -64,6 +67,32 @@ static inline std::string format_name(int32_t num)
     return name;
 }
 
+static inline void format_name(int32_t num, char* name)
+{
+    memcpy(name, "var_", 4);
+    name[4] = hex_digits[(num >> 12) & HEX_DIGIT_MASK];
+    name[5] = hex_digits[(num >> 8) & HEX_DIGIT_MASK];
+    name[6] = hex_digits[(num >> 4) & HEX_DIGIT_MASK];
+    name[7] = hex_digits[num & HEX_DIGIT_MASK];
+    name[8] = '\0';
+}
+
+// FNV-1a, the length is evaluated along the way
+static inline uint32_t hash_ident(const char* identifier, size_t& len)
+{
+    uint32_t hash = 2166136261u;
+    const char* ptr = identifier;
+
+    while (*ptr)
+    {
+        hash ^= (uint8_t)*ptr++;
+        hash *= 16777619u;
+    }
+
+    len = ptr - identifier;
+    return hash;
+}
+
 JSIdentifierCtx::JSIdentifierCtx(int32_t depth, uint32_t max_scope_depth,
     const std::unordered_set<std::string>& ignored_ids)
     : ignored_ids(ignored_ids), depth(depth), max_scope_depth(max_scope_depth)
@@ -158,6 +187,204 @@ const char* JSIdentifierCtx::ProgramScope::get_alias_value(const char* alias) co
         return nullptr;
 }
 
+JSIdentifierCtxFlat::JSIdentifierCtxFlat(int32_t depth, uint32_t max_scope_depth,
+    const std::unordered_set<std::string>& ignored_ids)
+    : slots(FLAT_MIN_SLOTS, 0), depth(depth), max_scope_depth(max_scope_depth)
+{
+    for (const auto& ignored : ignored_ids)
+    {
+        size_t len;
+        uint32_t hash = hash_ident(ignored.c_str(), len);
+        idents[intern(ignored.c_str(), len, hash)].ignored = true;
+    }
+
+    ignored_count = idents.size();
+    ignored_keys = keys.size();
+
+    scopes.push_back({JSProgramScopeType::GLOBAL, 0});
+}
+
+int32_t JSIdentifierCtxFlat::find(const char* identifier) const
+{
+    assert(identifier);
+
+    size_t len;
+    uint32_t hash = hash_ident(identifier, len);
+    uint32_t mask = slots.size() - 1;
+
+    for (uint32_t pos = hash & mask; slots[pos]; pos = (pos + 1) & mask)
+    {
+        const Ident& id = idents[slots[pos] - 1];
+
+        if (id.hash == hash && id.key_len == len &&
+            !memcmp(keys.data() + id.key_off, identifier, len))
+            return slots[pos] - 1;
+    }
+
+    return -1;
+}
+
+uint32_t JSIdentifierCtxFlat::intern(const char* identifier)
+{
+    int32_t idx = find(identifier);
+
+    if (idx >= 0)
+        return idx;
+
+    size_t len;
+    uint32_t hash = hash_ident(identifier, len);
+    return intern(identifier, len, hash);
+}
+
+// the identifier must not be in the table yet
+uint32_t JSIdentifierCtxFlat::intern(const char* identifier, size_t len, uint32_t hash)
+{
+    uint32_t mask = slots.size() - 1;
+    uint32_t pos = hash & mask;
+
+    while (slots[pos])
+        pos = (pos + 1) & mask;
+
+    Ident id;
+    id.key_off = keys.size();
+    id.key_len = len;
+    id.hash = hash;
+    id.alias = -1;
+    id.ignored = false;
+    id.name[0] = '\0';
+
+    keys.insert(keys.end(), identifier, identifier + len + 1);
+    idents.push_back(id);
+    slots[pos] = idents.size();
+
+    if (idents.size() * 2 > slots.size())
+        rehash(slots.size() * 2);
+
+    return idents.size() - 1;
+}
+
+void JSIdentifierCtxFlat::rehash(size_t slots_num)
+{
+    slots.assign(slots_num, 0);
+    uint32_t mask = slots.size() - 1;
+
+    for (uint32_t i = 0; i < idents.size(); ++i)
+    {
+        uint32_t pos = idents[i].hash & mask;
+
+        while (slots[pos])
+            pos = (pos + 1) & mask;
+
+        slots[pos] = i + 1;
+    }
+}
+
+const char* JSIdentifierCtxFlat::substitute(const char* identifier)
+{
+    int32_t idx = find(identifier);
+
+    if (idx >= 0 && idents[idx].name[0])
+        return idents[idx].name;
+
+    if (ident_last_name >= depth || ident_last_name > MAX_LAST_NAME)
+        return nullptr;
+
+    Ident& id = idents[idx >= 0 ? idx : intern(identifier)];
+    format_name(ident_last_name++, id.name);
+    HttpModule::increment_peg_counts(HttpEnums::PEG_JS_IDENTIFIER);
+    return id.name;
+}
+
+bool JSIdentifierCtxFlat::is_ignored(const char* identifier) const
+{
+    int32_t idx = find(identifier);
+    return idx >= 0 and idents[idx].ignored;
+}
+
+bool JSIdentifierCtxFlat::scope_push(JSProgramScopeType t)
+{
+    assert(t != JSProgramScopeType::GLOBAL && t != JSProgramScopeType::PROG_SCOPE_TYPE_MAX);
+
+    if (scopes.size() >= max_scope_depth)
+        return false;
+
+    scopes.push_back({t, (uint32_t)aliases.size()});
+    return true;
+}
+
+bool JSIdentifierCtxFlat::scope_pop(JSProgramScopeType t)
+{
+    assert(t != JSProgramScopeType::GLOBAL && t != JSProgramScopeType::PROG_SCOPE_TYPE_MAX);
+
+    if (scopes.back().type != t)
+        return false;
+
+    assert(scopes.size() != 1);
+
+    // aliases of the scope are the tail of the list
+    auto base = scopes.back().alias_base;
+    while (aliases.size() > base)
+    {
+        const Alias& a = aliases.back();
+        idents[a.ident].alias = a.prev;
+        aliases.pop_back();
+    }
+
+    scopes.pop_back();
+    return true;
+}
+
+void JSIdentifierCtxFlat::reset()
+{
+    ident_last_name = 0;
+
+    idents.resize(ignored_count);
+    keys.resize(ignored_keys);
+
+    for (auto& id : idents)
+    {
+        id.alias = -1;
+        id.name[0] = '\0';
+    }
+
+    rehash(slots.size());
+
+    aliases.clear();
+    scopes.clear();
+    scopes.push_back({JSProgramScopeType::GLOBAL, 0});
+}
+
+void JSIdentifierCtxFlat::add_alias(const char* alias, const std::string&& value)
+{
+    assert(alias);
+    assert(!scopes.empty());
+
+    uint32_t idx = intern(alias);
+    uint32_t scope = scopes.size() - 1;
+    Ident& id = idents[idx];
+
+    if (id.alias >= 0 && aliases[id.alias].scope == scope)
+    {
+        aliases[id.alias].value = value;
+        return;
+    }
+
+    aliases.push_back({value, idx, scope, id.alias});
+    id.alias = aliases.size() - 1;
+}
+
+const char* JSIdentifierCtxFlat::alias_lookup(const char* alias) const
+{
+    assert(alias);
+
+    int32_t idx = find(alias);
+
+    if (idx < 0 || idents[idx].alias < 0)
+        return nullptr;
+
+    return aliases[idents[idx].alias].value.c_str();
+}
+
 // advanced program scope access for testing
 
 #ifdef CATCH_TEST_BUILD
@@ -198,5 +425,44 @@ bool JSIdentifierCtx::scope_contains(size_t pos, const char* alias) const
     return false;
 }
 
+bool JSIdentifierCtxFlat::scope_check(const std::list<JSProgramScopeType>& compare) const
+{
+    if (scopes.size() != compare.size())
+        return false;
+
+    auto cmp = compare.begin();
+    for (auto it = scopes.begin(); it != scopes.end(); ++it, ++cmp)
+    {
+        if (it->type != *cmp)
+            return false;
+    }
+    return true;
+}
+
+const std::list<JSProgramScopeType> JSIdentifierCtxFlat::get_types() const
+{
+    std::list<JSProgramScopeType> return_list;
+    for (const auto& scope : scopes)
+        return_list.push_back(scope.type);
+    return return_list;
+}
+
+bool JSIdentifierCtxFlat::scope_contains(size_t pos, const char* alias) const
+{
+    assert(pos < scopes.size());
+
+    int32_t idx = find(alias);
+
+    if (idx < 0)
+        return false;
+
+    for (auto r = idents[idx].alias; r >= 0; r = aliases[r].prev)
+    {
+        if (aliases[r].scope == pos)
+            return true;
+    }
+    return false;
+}
+
 #endif // CATCH_TEST_BUILD
 
@@ -24,6 +24,7 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 enum JSProgramScopeType : unsigned int
 {
@@ -106,5 +107,91 @@ public:
 #endif // CATCH_TEST_BUILD
 };
 
+// Identifier context over flat arrays, a drop-in replacement for JSIdentifierCtx.
+// Identifiers are interned once into an open-addressing table, so the per-token
+// lookups neither build std::string nor allocate. Aliases are kept per identifier
+// as a chain of records, which is unwound when the owning scope is popped.
+// Returned pointers are valid till the next call modifying the context.
+class JSIdentifierCtxFlat : public JSIdentifierCtxBase
+{
+public:
+    JSIdentifierCtxFlat(int32_t depth, uint32_t max_scope_depth,
+        const std::unordered_set<std::string>& ignored_ids);
+
+    virtual const char* substitute(const char* identifier) override;
+    virtual void add_alias(const char* alias, const std::string&& value) override;
+    virtual const char* alias_lookup(const char* alias) const override;
+    virtual bool is_ignored(const char* identifier) const override;
+
+    virtual bool scope_push(JSProgramScopeType) override;
+    virtual bool scope_pop(JSProgramScopeType) override;
+
+    virtual void reset() override;
+
+    // approximated to 500 unique identifiers with 16 bytes names
+    // approximated to 3 program scopes in the list
+    virtual size_t size() const override
+    { return (sizeof(JSIdentifierCtxFlat) + (sizeof(Ident) + 16 + 2 * sizeof(uint32_t)) * 500 +
+        (sizeof(Scope) * 3)); }
+
+private:
+    struct Ident
+    {
+        uint32_t key_off;
+        uint32_t key_len;
+        uint32_t hash;
+        int32_t alias;      // index of the innermost alias record, -1 if none
+        bool ignored;
+        char name[9];       // "var_xxxx", empty if not substituted yet
+    };
+
+    struct Alias
+    {
+        std::string value;
+        uint32_t ident;
+        uint32_t scope;
+        int32_t prev;       // alias record of the same identifier in an outer scope
+    };
+
+    struct Scope
+    {
+        JSProgramScopeType type;
+        uint32_t alias_base;
+    };
+
+    // index of the identifier or -1 if it is not in the table
+    int32_t find(const char* identifier) const;
+    uint32_t intern(const char* identifier, size_t len, uint32_t hash);
+    uint32_t intern(const char* identifier);
+    void rehash(size_t slots_num);
+
+    // ignored identifiers are interned first and kept over reset, the rest
+    // are interned only when substituted or aliased, so the table is bounded
+    // by the ignore list, the depth and the aliases of the script
+    std::vector<Ident> idents;
+    std::vector<char> keys;
+    std::vector<uint32_t> slots;
+    uint32_t ignored_count;
+    uint32_t ignored_keys;
+
+    std::vector<Alias> aliases;
+    std::vector<Scope> scopes;
+
+    int32_t ident_last_name = 0;
+    int32_t depth;
+    uint32_t max_scope_depth;
+
+// advanced program scope access for testing
+#ifdef CATCH_TEST_BUILD
+public:
+    // compare scope list with the passed pattern
+    bool scope_check(const std::list<JSProgramScopeType>& compare) const;
+    const std::list<JSProgramScopeType> get_types() const;
+    bool scope_contains(size_t pos, const char* alias) const;
+    size_t get_interned() const
+    { return idents.size() - ignored_count; }
+#endif // CATCH_TEST_BUILD
+};
+
 #endif // JS_IDENTIFIER_CTX
 
@@ -33,6 +33,7 @@ JSNormalizer::JSNormalizer(JSIdentifierCtxBase& js_ident_ctx, size_t norm_depth,
     : depth(norm_depth),
       rem_bytes(norm_depth),
       unlim(norm_depth == static_cast<size_t>(-1)),
+      out_reclaim(false),
       src_next(nullptr),
       tmp_buf(nullptr),
       tmp_buf_size(0),
@@ -49,10 +50,32 @@ JSNormalizer::~JSNormalizer()
     tmp_buf_size = 0;
 }
 
+void JSNormalizer::reset()
+{
+    tokenizer.reset();
+
+    rem_bytes = depth;
+    src_next = nullptr;
+    out_reclaim = true;
+}
+
+void JSNormalizer::reclaim_output()
+{
+    if (out_buf.buf_size() > JSNORM_OUT_KEEP_SIZE)
+        delete[] out_buf.take_data();
+    else
+        rewind_output();
+
+    out_reclaim = false;
+}
+
 JSTokenizer::JSRet JSNormalizer::normalize(const char* src, size_t src_len)
 {
     assert(src);
 
+    if (out_reclaim)
+        reclaim_output();
+
     if (src_len == 0)
     {
         src_next = src;
@@ -27,6 +27,9 @@
 #include "js_tokenizer.h"
 #include "streambuf.h"
 
+// Max size of the output buffer kept by the normalizer for reuse
+#define JSNORM_OUT_KEEP_SIZE (1 << 16)
+
 namespace snort
 {
 
@@ -46,14 +49,32 @@ public:
     void reset_depth()
     { rem_bytes = depth; }
 
+    // prepares the normalizer for a new script keeping allocated memory,
+    // the current output is reclaimed on the next normalization
+    void reset();
+
     const char* take_script()
     { return out_buf.take_data(); }
 
     const char* get_script() const
     { return out_buf.data(); }
 
+    // a buffer small enough to be kept is lent, the output stays valid till the
+    // next normalization, then the buffer is reused for the new data; a larger one
+    // is handed over like take_script() does, the caller owns it if 'own' is set
+    const char* lend_script(bool& own)
+    {
+        own = out_buf.buf_size() > JSNORM_OUT_KEEP_SIZE;
+
+        if (own)
+            return take_script();
+
+        out_reclaim = true;
+        return out_buf.data();
+    }
+
     size_t script_size()
-    { return out.tellp(); }
+    { return out_reclaim ? 0 : static_cast<size_t>(out.tellp()); }
 
     static size_t size()
     { return sizeof(JSNormalizer) + 16834; /* YY_BUF_SIZE */ }
@@ -65,15 +86,16 @@ public:
     { return tmp_buf_size; }
 #endif
 
-#ifdef BENCHMARK_TEST
     void rewind_output()
     { out_buf.pubseekoff(0, std::ios_base::beg, std::ios_base::out); }
-#endif
 
 private:
+    void reclaim_output();
+
     size_t depth;
     size_t rem_bytes;
     bool unlim;
+    bool out_reclaim;
     const char* src_next;
 
     char* tmp_buf;
@@ -153,6 +153,9 @@ public:
 
     JSRet process(size_t& bytes_in);
 
+    // brings the tokenizer to its initial state, keeping allocated resources
+    void reset();
+
 protected:
     [[noreturn]] void LexerError(const char* msg) override
     { snort::FatalError("%s", msg); }
@@ -0,0 +1,240 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// list_treap.h
+
+#ifndef LIST_TREAP_H
+#define LIST_TREAP_H
+
+// An index over an intrusive doubly linked list that isn't sorted by key, as
+// the fragment and segment lists are once overlaps have been trimmed.  The
+// nodes are kept in a treap in list order, not key order, where each node has
+// the min and max key of its subtree.  That finds the first node in list order
+// at or above a key, or the last one below it, in logarithmic time, which is
+// exactly what a walk from the head or the tail of the list finds.
+//
+// Node must have these members, the list links are maintained by the caller:
+//
+//     Node* next;
+//     Node* parent;
+//     Node* lchild;
+//     Node* rchild;
+//     uint32_t prio;
+//     Key min_key;
+//     Key max_key;
+//
+// Traits must have these, less() may be a modular compare like SEQ_LT():
+//
+//     static Key key(const Node*);
+//     static bool less(Key, Key);
+//
+// The root is held by the caller so the tree can live in a memset struct.
+
+#include <cstdint>
+
+#include "main/thread.h"
+
+namespace snort
+{
+// xorshift32, the priorities only need to be unrelated to the keys
+inline uint32_t list_treap_prio()
+{
+    static THREAD_LOCAL uint32_t seed = 0x9e3779b9;
+
+    uint32_t x = seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return seed = x;
+}
+
+template<typename Node, typename Key, typename Traits>
+class ListTreap
+{
+public:
+    // the node is already in the list after prev (null if it is the head)
+    static void insert(Node*& root, Node* prev, Node* node)
+    {
+        node->lchild = node->rchild = nullptr;
+        node->min_key = node->max_key = Traits::key(node);
+        node->prio = list_treap_prio();
+
+        if ( !root )
+        {
+            node->parent = nullptr;
+            root = node;
+            return;
+        }
+
+        // the successor is leftmost in the subtree right of prev, if any
+        if ( prev and !prev->rchild )
+        {
+            prev->rchild = node;
+            node->parent = prev;
+        }
+        else
+        {
+            node->next->lchild = node;
+            node->parent = node->next;
+        }
+
+        update_up(node->parent);
+
+        while ( node->parent and node->parent->prio < node->prio )
+            rotate_up(root, node);
+    }
+
+    // the node is still in the list
+    static void remove(Node*& root, Node* node)
+    {
+        while ( node->lchild and node->rchild )
+            rotate_up(root, node->lchild->prio > node->rchild->prio ? node->lchild : node->rchild);
+
+        Node* child = node->lchild ? node->lchild : node->rchild;
+        Node* parent = node->parent;
+
+        if ( child )
+            child->parent = parent;
+
+        if ( !parent )
+            root = child;
+        else if ( parent->lchild == node )
+            parent->lchild = child;
+        else
+            parent->rchild = child;
+
+        update_up(parent);
+    }
+
+    // call after changing the key of a node in the tree
+    static void rekey(Node* node)
+    { update_up(node); }
+
+    // first node in list order with a key at or above the given one
+    static Node* find_first_geq(Node* root, Key key)
+    {
+        Node* node = root;
+
+        while ( node )
+        {
+            if ( node->lchild and !Traits::less(node->lchild->max_key, key) )
+                node = node->lchild;
+
+            else if ( !Traits::less(Traits::key(node), key) )
+                return node;
+
+            else if ( node->rchild and !Traits::less(node->rchild->max_key, key) )
+                node = node->rchild;
+
+            else
+                break;
+        }
+        return nullptr;
+    }
+
+    // last node in list order with a key below the given one
+    static Node* find_last_lt(Node* root, Key key)
+    {
+        Node* node = root;
+
+        while ( node )
+        {
+            if ( node->rchild and Traits::less(node->rchild->min_key, key) )
+                node = node->rchild;
+
+            else if ( Traits::less(Traits::key(node), key) )
+                return node;
+
+            else if ( node->lchild and Traits::less(node->lchild->min_key, key) )
+                node = node->lchild;
+
+            else
+                break;
+        }
+        return nullptr;
+    }
+
+private:
+    static void update(Node* node)
+    {
+        Key min = Traits::key(node);
+        Key max = min;
+
+        if ( Node* l = node->lchild )
+        {
+            if ( Traits::less(l->min_key, min) )
+                min = l->min_key;
+
+            if ( Traits::less(max, l->max_key) )
+                max = l->max_key;
+        }
+
+        if ( Node* r = node->rchild )
+        {
+            if ( Traits::less(r->min_key, min) )
+                min = r->min_key;
+
+            if ( Traits::less(max, r->max_key) )
+                max = r->max_key;
+        }
+
+        node->min_key = min;
+        node->max_key = max;
+    }
+
+    static void update_up(Node* node)
+    {
+        for ( ; node; node = node->parent )
+            update(node);
+    }
+
+    static void rotate_up(Node*& root, Node* node)
+    {
+        Node* parent = node->parent;
+        Node* grand = parent->parent;
+
+        if ( node == parent->lchild )
+        {
+            parent->lchild = node->rchild;
+            if ( node->rchild )
+                node->rchild->parent = parent;
+            node->rchild = parent;
+        }
+        else
+        {
+            parent->rchild = node->lchild;
+            if ( node->lchild )
+                node->lchild->parent = parent;
+            node->lchild = parent;
+        }
+        parent->parent = node;
+        node->parent = grand;
+
+        if ( !grand )
+            root = node;
+        else if ( grand->lchild == parent )
+            grand->lchild = node;
+        else
+            grand->rchild = node;
+
+        update(parent);
+        update(node);
+    }
+};
+}
+
+#endif
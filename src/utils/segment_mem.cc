@@ -114,3 +114,15 @@ void* segment_basePtr()
     return base_ptr;
 }
 
+SegmentMemState segment_memsave()
+{
+    return { base_ptr, unused_ptr, unused_mem };
+}
+
+void segment_memrestore(const SegmentMemState& state)
+{
+    base_ptr = state.base_ptr;
+    unused_ptr = state.unused_ptr;
+    unused_mem = state.unused_mem;
+}
+
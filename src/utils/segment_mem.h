@@ -35,5 +35,20 @@ MEM_OFFSET segment_snort_calloc(size_t num, size_t size);
 size_t segment_unusedmem();
 void* segment_basePtr();
 
+// Allocator state, saved while another segment is being built
+struct SegmentMemState
+{
+    void* base_ptr;
+    MEM_OFFSET unused_ptr;
+    size_t unused_mem;
+};
+
+SegmentMemState segment_memsave();
+void segment_memrestore(const SegmentMemState&);
+
+// Whether "len" bytes at "ptr" are inside a segment of "size" bytes
+inline bool segment_contains(MEM_OFFSET ptr, uint64_t len, size_t size)
+{ return ptr <= size and len <= size - ptr; }
+
 #endif
 
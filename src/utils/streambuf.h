@@ -87,6 +87,9 @@ public:
     std::streamsize data_len() const
     { return pptr() - pbase(); }
 
+    std::streamsize buf_size() const
+    { return epptr() - pbase(); }
+
 protected:
     virtual std::streambuf* setbuf(char* s, std::streamsize n) override;
     virtual std::streampos seekoff(std::streamoff off, std::ios_base::seekdir way,
@@ -178,3 +178,242 @@ TEST_CASE("JSIdentifierCtx::scopes", "[JSIdentifierCtx]")
         CHECK(ident_ctx_limited.scope_check({GLOBAL, FUNCTION}));
     }
 }
+
+TEST_CASE("JSIdentifierCtxFlat::substitute()", "[JSIdentifierCtx]")
+{
+    SECTION("same name")
+    {
+        JSIdentifierCtxFlat ident_ctx(DEPTH, SCOPE_DEPTH, s_ignored_ids);
+
+        CHECK(!strcmp(ident_ctx.substitute("a"), "var_0000"));
+        CHECK(!strcmp(ident_ctx.substitute("a"), "var_0000"));
+    }
+    SECTION("different names")
+    {
+        JSIdentifierCtxFlat ident_ctx(DEPTH, SCOPE_DEPTH, s_ignored_ids);
+
+        CHECK(!strcmp(ident_ctx.substitute("a"), "var_0000"));
+        CHECK(!strcmp(ident_ctx.substitute("b"), "var_0001"));
+        CHECK(!strcmp(ident_ctx.substitute("a"), "var_0000"));
+    }
+    SECTION("depth reached")
+    {
+        JSIdentifierCtxFlat ident_ctx(2, SCOPE_DEPTH, s_ignored_ids);
+
+        CHECK(!strcmp(ident_ctx.substitute("a"), "var_0000"));
+        CHECK(!strcmp(ident_ctx.substitute("b"), "var_0001"));
+        CHECK(ident_ctx.substitute("c") == nullptr);
+        CHECK(ident_ctx.substitute("d") == nullptr);
+        CHECK(!strcmp(ident_ctx.substitute("a"), "var_0000"));
+    }
+    SECTION("table bounded by depth")
+    {
+        JSIdentifierCtxFlat ident_ctx(2, SCOPE_DEPTH, s_ignored_ids);
+
+        for (int it = 0; it < 1000; ++it)
+        {
+            auto n = "n" + std::to_string(it);
+            ident_ctx.substitute(n.c_str());
+            ident_ctx.is_ignored(n.c_str());
+            CHECK(ident_ctx.alias_lookup(n.c_str()) == nullptr);
+        }
+
+        CHECK(ident_ctx.get_interned() == 2);
+        CHECK(ident_ctx.is_ignored("console"));
+        CHECK(ident_ctx.get_interned() == 2);
+
+        ident_ctx.add_alias("x", "y");
+        CHECK(ident_ctx.get_interned() == 3);
+        CHECK(!strcmp(ident_ctx.alias_lookup("x"), "y"));
+        CHECK(ident_ctx.substitute("x") == nullptr);
+    }
+    SECTION("max names")
+    {
+        JSIdentifierCtxFlat ident_ctx(DEPTH + 2, SCOPE_DEPTH, s_ignored_ids);
+        JSIdentifierCtx ident_ctx_exp(DEPTH + 2, SCOPE_DEPTH, s_ignored_ids);
+
+        for (int it = 0; it < DEPTH; ++it)
+        {
+            auto n = "n" + std::to_string(it);
+            CHECK(!strcmp(ident_ctx.substitute(n.c_str()), ident_ctx_exp.substitute(n.c_str())));
+        }
+
+        CHECK(ident_ctx.substitute("overflow_1") == nullptr);
+        CHECK(ident_ctx.substitute("overflow_2") == nullptr);
+        CHECK(!strcmp(ident_ctx.substitute("n0"), "var_0000"));
+        CHECK(!strcmp(ident_ctx.substitute("n65535"), "var_ffff"));
+    }
+    SECTION("after reset")
+    {
+        JSIdentifierCtxFlat ident_ctx(DEPTH, SCOPE_DEPTH, s_ignored_ids);
+
+        CHECK(!strcmp(ident_ctx.substitute("a"), "var_0000"));
+        CHECK(!strcmp(ident_ctx.substitute("b"), "var_0001"));
+        ident_ctx.reset();
+        CHECK(!strcmp(ident_ctx.substitute("b"), "var_0000"));
+        CHECK(!strcmp(ident_ctx.substitute("a"), "var_0001"));
+    }
+}
+
+TEST_CASE("JSIdentifierCtxFlat::is_ignored()", "[JSIdentifierCtx]")
+{
+    JSIdentifierCtxFlat ident_ctx(DEPTH, SCOPE_DEPTH, s_ignored_ids);
+
+    CHECK(ident_ctx.is_ignored("console") == true);
+    CHECK(ident_ctx.is_ignored("foo") == false);
+    CHECK(ident_ctx.is_ignored("consol") == false);
+    CHECK(ident_ctx.is_ignored("console") == true);
+
+    SECTION("after reset")
+    {
+        ident_ctx.add_alias("console", "a");
+        CHECK(ident_ctx.substitute("foo") != nullptr);
+        ident_ctx.reset();
+
+        CHECK(ident_ctx.is_ignored("console") == true);
+        CHECK(ident_ctx.is_ignored("foo") == false);
+        CHECK(ident_ctx.alias_lookup("console") == nullptr);
+        CHECK(ident_ctx.get_interned() == 0);
+    }
+}
+
+TEST_CASE("JSIdentifierCtxFlat::scopes", "[JSIdentifierCtx]")
+{
+    JSIdentifierCtxFlat ident_ctx(DEPTH, SCOPE_DEPTH, s_ignored_ids);
+
+    SECTION("scope stack")
+    {
+        CHECK(ident_ctx.scope_check({GLOBAL}));
+
+        ident_ctx.scope_push(JSProgramScopeType::FUNCTION);
+        ident_ctx.scope_push(JSProgramScopeType::BLOCK);
+        ident_ctx.scope_push(JSProgramScopeType::BLOCK);
+        CHECK(ident_ctx.scope_check({GLOBAL, FUNCTION, BLOCK, BLOCK}));
+
+        CHECK(ident_ctx.scope_pop(JSProgramScopeType::BLOCK));
+        CHECK(ident_ctx.scope_check({GLOBAL, FUNCTION, BLOCK}));
+
+        ident_ctx.reset();
+        CHECK(ident_ctx.scope_check({GLOBAL}));
+    }
+    SECTION("aliases")
+    {
+        ident_ctx.add_alias("a", "console.log");
+        ident_ctx.add_alias("b", "document");
+        CHECK(ident_ctx.scope_contains(0, "a"));
+        CHECK(ident_ctx.scope_contains(0, "b"));
+        CHECK(!strcmp(ident_ctx.alias_lookup("a"), "console.log"));
+        CHECK(!strcmp(ident_ctx.alias_lookup("b"), "document"));
+
+        REQUIRE(ident_ctx.scope_push(JSProgramScopeType::FUNCTION));
+        ident_ctx.add_alias("a", "document");
+        CHECK(ident_ctx.scope_contains(1, "a"));
+        CHECK(!ident_ctx.scope_contains(1, "b"));
+        CHECK(!strcmp(ident_ctx.alias_lookup("a"), "document"));
+        CHECK(!strcmp(ident_ctx.alias_lookup("b"), "document"));
+
+        REQUIRE(ident_ctx.scope_push(JSProgramScopeType::BLOCK));
+        ident_ctx.add_alias("b", "console.log");
+        CHECK(ident_ctx.scope_contains(2, "b"));
+        CHECK(!ident_ctx.scope_contains(2, "a"));
+        CHECK(!strcmp(ident_ctx.alias_lookup("b"), "console.log"));
+        CHECK(!strcmp(ident_ctx.alias_lookup("a"), "document"));
+
+        REQUIRE(ident_ctx.scope_pop(JSProgramScopeType::BLOCK));
+        REQUIRE(ident_ctx.scope_pop(JSProgramScopeType::FUNCTION));
+        ident_ctx.add_alias("a", "eval");
+        CHECK(ident_ctx.scope_contains(0, "a"));
+        CHECK(ident_ctx.scope_contains(0, "b"));
+        CHECK(!strcmp(ident_ctx.alias_lookup("a"), "eval"));
+        CHECK(!strcmp(ident_ctx.alias_lookup("b"), "document"));
+
+        CHECK(ident_ctx.alias_lookup("c") == nullptr);
+    }
+    SECTION("scope mismatch")
+    {
+        CHECK(!ident_ctx.scope_pop(JSProgramScopeType::FUNCTION));
+        CHECK(ident_ctx.scope_check({GLOBAL}));
+        CHECK(!ident_ctx.scope_check({FUNCTION}));
+
+        CHECK(ident_ctx.scope_push(JSProgramScopeType::FUNCTION));
+        CHECK(ident_ctx.scope_check({GLOBAL, FUNCTION}));
+        CHECK(!ident_ctx.scope_pop(JSProgramScopeType::BLOCK));
+        CHECK(ident_ctx.scope_check({GLOBAL, FUNCTION}));
+        CHECK(!ident_ctx.scope_check({GLOBAL}));
+    }
+    SECTION("scope max nesting")
+    {
+        JSIdentifierCtxFlat ident_ctx_limited(DEPTH, 2, s_ignored_ids);
+
+        CHECK(ident_ctx_limited.scope_push(JSProgramScopeType::FUNCTION));
+        CHECK(ident_ctx_limited.scope_check({GLOBAL, FUNCTION}));
+
+        CHECK(!ident_ctx_limited.scope_push(JSProgramScopeType::FUNCTION));
+        CHECK(ident_ctx_limited.scope_check({GLOBAL, FUNCTION}));
+        CHECK(!ident_ctx_limited.scope_push(JSProgramScopeType::FUNCTION));
+        CHECK(ident_ctx_limited.scope_check({GLOBAL, FUNCTION}));
+
+        CHECK(ident_ctx_limited.scope_pop(JSProgramScopeType::FUNCTION));
+        CHECK(ident_ctx_limited.scope_push(JSProgramScopeType::FUNCTION));
+        CHECK(ident_ctx_limited.scope_check({GLOBAL, FUNCTION}));
+    }
+}
+
+TEST_CASE("JSIdentifierCtxFlat vs JSIdentifierCtx", "[JSIdentifierCtx]")
+{
+    static const char* names[] = { "a", "b", "console", "document", "x1", "long_identifier_name" };
+    static const JSProgramScopeType types[] = { FUNCTION, BLOCK };
+    constexpr unsigned names_num = sizeof(names) / sizeof(*names);
+
+    JSIdentifierCtx ctx_map(DEPTH, 8, s_ignored_ids);
+    JSIdentifierCtxFlat ctx_flat(DEPTH, 8, s_ignored_ids);
+
+    unsigned seed = 1;
+    auto next = [&seed]() { seed = seed * 1103515245 + 12345; return (seed >> 16) & 0x7fff; };
+
+    for (int it = 0; it < 20000; ++it)
+    {
+        const char* name = names[next() % names_num];
+
+        switch (next() % 6)
+        {
+        case 0:
+            CHECK(!strcmp(ctx_map.substitute(name), ctx_flat.substitute(name)));
+            break;
+        case 1:
+        {
+            const char* value = names[next() % names_num];
+            ctx_map.add_alias(name, value);
+            ctx_flat.add_alias(name, value);
+            break;
+        }
+        case 2:
+        {
+            const char* m = ctx_map.alias_lookup(name);
+            const char* f = ctx_flat.alias_lookup(name);
+            CHECK((m == nullptr) == (f == nullptr));
+            if (m && f)
+                CHECK(!strcmp(m, f));
+            break;
+        }
+        case 3:
+            CHECK(ctx_map.is_ignored(name) == ctx_flat.is_ignored(name));
+            break;
+        case 4:
+        {
+            auto t = types[next() % 2];
+            CHECK(ctx_map.scope_push(t) == ctx_flat.scope_push(t));
+            break;
+        }
+        case 5:
+        {
+            auto t = types[next() % 2];
+            if (!ctx_map.scope_check({GLOBAL}))
+                CHECK(ctx_map.scope_pop(t) == ctx_flat.scope_pop(t));
+            break;
+        }
+        }
+
+        CHECK(ctx_map.get_types() == ctx_flat.get_types());
+    }
+}
@@ -0,0 +1,260 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2022-2022 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef BENCHMARK_TEST
+// ThroughputListener below needs the reporter interfaces
+#define CATCH_CONFIG_EXTERNAL_INTERFACES
+#endif
+
+#include "catch/catch.hpp"
+
+#include "utils/test/js_test_utils.h"
+
+using namespace snort;
+
+// Feeds the script PDU by PDU, collecting the output as detection would see it
+static std::string normalize_by_pdu(JSNormalizer& normalizer, const std::string& script,
+    size_t pdu_size, bool incremental)
+{
+    std::string result;
+    const char* ptr = script.c_str();
+    const char* end = ptr + script.size();
+
+    while (ptr < end)
+    {
+        size_t len = std::min(pdu_size, (size_t)(end - ptr));
+        auto ret = normalizer.normalize(ptr, len);
+        ptr = normalizer.get_src_next();
+
+        size_t out_len = normalizer.script_size();
+        if (out_len)
+        {
+            bool own = true;
+            const char* data = incremental ? normalizer.lend_script(own)
+                : normalizer.take_script();
+
+            result.append(data, out_len);
+
+            if (own)
+                delete[] data;
+        }
+
+        if (ret != JSTokenizer::SCRIPT_CONTINUE)
+            break;
+    }
+
+    return result;
+}
+
+static std::string make_script(size_t len)
+{
+    static constexpr const char* line =
+        "var abc = document.getElementById('x'); if (abc) { abc.text = \"foo\" + 42; }\n";
+
+    std::string s;
+    while (s.size() < len)
+        s.append(line);
+
+    s.append("</script>");
+    return s;
+}
+
+// Unit tests
+
+#ifdef CATCH_TEST_BUILD
+
+TEST_CASE("incremental output", "[JSNormalizer]")
+{
+    JSIdentifierCtxStub ident_ctx;
+    JSNormalizer normalizer(ident_ctx, unlim_depth, max_template_nesting, max_bracket_depth);
+
+    SECTION("lent output stays till the next normalization")
+    {
+        const char src1[] = "var a = 1 ;";
+        const char src2[] = "var b = 2 ;";
+
+        bool own;
+
+        normalizer.normalize(src1, sizeof(src1) - 1);
+        size_t len1 = normalizer.script_size();
+        const char* out1 = normalizer.lend_script(own);
+        CHECK(!own);
+        CHECK(std::string(out1, len1) == "var a=1;");
+        CHECK(normalizer.script_size() == 0);
+
+        normalizer.normalize(src2, sizeof(src2) - 1);
+        size_t len2 = normalizer.script_size();
+        const char* out2 = normalizer.lend_script(own);
+        CHECK(!own);
+        CHECK(std::string(out2, len2) == "var b=2;");
+        CHECK(out1 == out2);
+    }
+
+    SECTION("output over the keep size is handed over")
+    {
+        const auto src1 = make_script(JSNORM_OUT_KEEP_SIZE);
+        const char src2[] = "var b = 2 ;";
+        bool own;
+
+        normalizer.normalize(src1.c_str(), src1.size());
+        size_t len1 = normalizer.script_size();
+        const char* out1 = normalizer.lend_script(own);
+        CHECK(own);
+        CHECK(len1 > 0);
+        CHECK(std::string(out1, 8) == "var abc=");
+
+        normalizer.reset();
+        normalizer.normalize(src2, sizeof(src2) - 1);
+        size_t len2 = normalizer.script_size();
+        const char* out2 = normalizer.lend_script(own);
+        CHECK(!own);
+        CHECK(std::string(out2, len2) == "var b=2;");
+        CHECK(std::string(out1, 8) == "var abc=");
+
+        delete[] out1;
+    }
+
+    SECTION("reset between scripts")
+    {
+        const char src1[] = "a = { b : [ 1 , 2 ";
+        const char src2[] = "c = 3 ;</script>";
+
+        bool own;
+
+        normalizer.normalize(src1, sizeof(src1) - 1);
+        normalizer.lend_script(own);
+        normalizer.reset();
+
+        auto ret = normalizer.normalize(src2, sizeof(src2) - 1);
+        std::string out(normalizer.get_script(), normalizer.script_size());
+        CHECK(ret == JSTokenizer::SCRIPT_ENDED);
+        CHECK(out == "c=3;");
+    }
+}
+
+TEST_CASE("incremental vs fresh normalizer", "[JSNormalizer]")
+{
+    const auto script = make_script(1 << 14);
+
+    JSIdentifierCtx ident_ctx_exp(norm_depth, max_scope_depth, s_ignored_ids);
+    JSNormalizer fresh(ident_ctx_exp, unlim_depth, max_template_nesting, max_bracket_depth);
+    const auto expected = normalize_by_pdu(fresh, script, 1460, false);
+
+    JSIdentifierCtx ident_ctx(norm_depth, max_scope_depth, s_ignored_ids);
+    JSNormalizer normalizer(ident_ctx, unlim_depth, max_template_nesting, max_bracket_depth);
+
+    SECTION("single script")
+    {
+        CHECK(normalize_by_pdu(normalizer, script, 1460, true) == expected);
+    }
+
+    SECTION("reused for the next script")
+    {
+        normalize_by_pdu(normalizer, script, 1460, true);
+        normalizer.reset();
+        ident_ctx.reset();
+        CHECK(normalize_by_pdu(normalizer, script, 1460, true) == expected);
+    }
+
+    SECTION("reused after an unfinished script")
+    {
+        const char src[] = "var a = { ( ";
+        normalizer.normalize(src, sizeof(src) - 1);
+        normalizer.reset();
+        ident_ctx.reset();
+        CHECK(normalize_by_pdu(normalizer, script, 1460, true) == expected);
+    }
+}
+
+#endif // CATCH_TEST_BUILD
+
+// Benchmark tests
+
+#ifdef BENCHMARK_TEST
+
+// every benchmark in this file normalizes one script of this size per run
+static constexpr size_t script_size = 1 << 20;
+
+// Catch reports the time per run, turn its mean into throughput; the figures
+// are printed once the benchmarks are done to keep them out of Catch's own table
+struct ThroughputListener : Catch::TestEventListenerBase
+{
+    using TestEventListenerBase::TestEventListenerBase;
+
+    void benchmarkEnded(const Catch::BenchmarkStats<>& stats) override
+    {
+        std::chrono::duration<double> mean = stats.mean.point;
+        double rate = (double)script_size / mean.count();
+
+        results.emplace_back(stats.info.name, rate / (1 << 20));
+    }
+
+    void testCaseEnded(const Catch::TestCaseStats& stats) override
+    {
+        for (const auto& r : results)
+            printf("%-40s %10.2f MB/s\n", r.first.c_str(), r.second);
+
+        results.clear();
+        TestEventListenerBase::testCaseEnded(stats);
+    }
+
+    std::vector<std::pair<std::string, double>> results;
+};
+
+CATCH_REGISTER_LISTENER(ThroughputListener)
+
+TEST_CASE("JS Normalizer, incremental mode", "[JSNormalizer]")
+{
+    const auto script = make_script(script_size);
+
+    JSIdentifierCtxStub ident_ctx;
+
+    for (size_t pdu_size : { 1460, 16384 })
+    {
+        std::string fresh_name = "fresh per script, PDU " + std::to_string(pdu_size);
+        std::string incr_name = "incremental, PDU " + std::to_string(pdu_size);
+
+        JSNormalizer normalizer(ident_ctx, unlim_depth, max_template_nesting, max_bracket_depth);
+
+        BENCHMARK(fresh_name.c_str())
+        {
+            JSNormalizer fresh(ident_ctx, unlim_depth, max_template_nesting,
+                max_bracket_depth);
+            return normalize_by_pdu(fresh, script, pdu_size, false);
+        };
+
+        BENCHMARK(incr_name.c_str())
+        {
+            normalizer.reset();
+            return normalize_by_pdu(normalizer, script, pdu_size, true);
+        };
+    }
+}
+
+#endif // BENCHMARK_TEST
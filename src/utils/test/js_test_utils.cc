@@ -38,28 +38,34 @@ THREAD_LOCAL const snort::Trace* http_trace = nullptr;
 
 using namespace snort;
 
-void test_scope(const char* context, std::list<JSProgramScopeType> stack)
+// every case is checked against each identifier context implementation
+
+template<typename Ctx>
+static void check_scope(const char* context, const std::list<JSProgramScopeType>& stack)
 {
     std::string buf(context);
     buf += "</script>";
-    JSIdentifierCtx ident_ctx(norm_depth, max_scope_depth, s_ignored_ids);
+    Ctx ident_ctx(norm_depth, max_scope_depth, s_ignored_ids);
     JSNormalizer normalizer(ident_ctx, norm_depth, max_template_nesting, max_bracket_depth);
     normalizer.normalize(buf.c_str(), buf.size());
     CHECK(ident_ctx.get_types() == stack);
 }
 
-void test_normalization(const char* source, const char* expected)
+template<typename Ctx>
+static void check_normalization(const char* source, const char* expected)
 {
-    JSIdentifierCtx ident_ctx(norm_depth, max_scope_depth, s_ignored_ids);
+    Ctx ident_ctx(norm_depth, max_scope_depth, s_ignored_ids);
     JSNormalizer normalizer(ident_ctx, norm_depth, max_template_nesting, max_bracket_depth);
     normalizer.normalize(source, strlen(source));
     std::string result_buf(normalizer.get_script(), normalizer.script_size());
     CHECK(result_buf == expected);
 }
 
-void test_normalization_bad(const char* source, const char* expected, JSTokenizer::JSRet eret)
+template<typename Ctx>
+static void check_normalization_bad(const char* source, const char* expected,
+    JSTokenizer::JSRet eret)
 {
-    JSIdentifierCtx ident_ctx(norm_depth, max_scope_depth, s_ignored_ids);
+    Ctx ident_ctx(norm_depth, max_scope_depth, s_ignored_ids);
     JSNormalizer normalizer(ident_ctx, norm_depth, max_template_nesting, max_bracket_depth);
     auto ret = normalizer.normalize(source, strlen(source));
     std::string result_buf(normalizer.get_script(), normalizer.script_size());
@@ -67,9 +73,10 @@ void test_normalization_bad(const char* source, const char* expected, JSTokenize
     CHECK(result_buf == expected);
 }
 
-void test_normalization(const std::vector<PduCase>& pdus)
+template<typename Ctx>
+static void check_normalization(const std::vector<PduCase>& pdus)
 {
-    JSIdentifierCtx ident_ctx(norm_depth, max_scope_depth, s_ignored_ids);
+    Ctx ident_ctx(norm_depth, max_scope_depth, s_ignored_ids);
     JSNormalizer normalizer(ident_ctx, norm_depth, max_template_nesting, max_bracket_depth);
 
     for (const auto& pdu : pdus)
@@ -82,9 +89,10 @@ void test_normalization(const std::vector<PduCase>& pdus)
     }
 }
 
-void test_normalization(std::list<ScopedPduCase> pdus)
+template<typename Ctx>
+static void check_normalization(const std::list<ScopedPduCase>& pdus)
 {
-    JSIdentifierCtx ident_ctx(norm_depth, max_scope_depth, s_ignored_ids);
+    Ctx ident_ctx(norm_depth, max_scope_depth, s_ignored_ids);
     JSNormalizer normalizer(ident_ctx, norm_depth, max_template_nesting, max_bracket_depth);
     for (auto pdu:pdus)
     {
@@ -98,3 +106,33 @@ void test_normalization(std::list<ScopedPduCase> pdus)
         CHECK(result_buf == expected);
     }
 }
+
+void test_scope(const char* context, std::list<JSProgramScopeType> stack)
+{
+    check_scope<JSIdentifierCtx>(context, stack);
+    check_scope<JSIdentifierCtxFlat>(context, stack);
+}
+
+void test_normalization(const char* source, const char* expected)
+{
+    check_normalization<JSIdentifierCtx>(source, expected);
+    check_normalization<JSIdentifierCtxFlat>(source, expected);
+}
+
+void test_normalization_bad(const char* source, const char* expected, JSTokenizer::JSRet eret)
+{
+    check_normalization_bad<JSIdentifierCtx>(source, expected, eret);
+    check_normalization_bad<JSIdentifierCtxFlat>(source, expected, eret);
+}
+
+void test_normalization(const std::vector<PduCase>& pdus)
+{
+    check_normalization<JSIdentifierCtx>(pdus);
+    check_normalization<JSIdentifierCtxFlat>(pdus);
+}
+
+void test_normalization(std::list<ScopedPduCase> pdus)
+{
+    check_normalization<JSIdentifierCtx>(pdus);
+    check_normalization<JSIdentifierCtxFlat>(pdus);
+}
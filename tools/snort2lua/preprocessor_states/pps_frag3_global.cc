@@ -63,7 +63,7 @@ bool Frag3Global::convert(std::istringstream& data_stream)
             tmpval = parse_deleted_option("prealloc_memcap", args_stream);
 
         else if (keyword == "prealloc_frags")
-            tmpval = parse_deleted_option("prealloc_frags", args_stream);
+            tmpval = parse_int_option("prealloc_frags", args_stream, false);
 
         else
             tmpval = false;
@@ -70,7 +70,10 @@ bool StreamGlobal::convert(std::istringstream& data_stream)
             table_api.close_table();
         }
         else if (keyword == "memcap")
-            table_api.add_deleted_comment("memcap");
+        {
+            table_api.add_diff_option_comment("memcap", "reassembly_memcap");
+            tmpval = parse_int_option("reassembly_memcap", arg_stream, false);
+        }
 
         else if (keyword == "no_midstream_drop_alerts")
             table_api.add_deleted_comment("no_midstream_drop_alerts");